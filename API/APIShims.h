@@ -66,6 +66,9 @@ public:
         : APIEntryShimWithoutLock(&exec->globalData(), registerThread)
         , m_lock(exec)
     {
+#if ENABLE(JSC_MULTIPLE_THREADS)
+        exec->globalData().heap.switchAllocationCacheToCurrentThread();
+#endif
     }
 
     // JSPropertyNameAccumulator only has a globalData.
@@ -73,6 +76,9 @@ public:
         : APIEntryShimWithoutLock(globalData, registerThread)
         , m_lock(globalData->isSharedInstance() ? LockForReal : SilenceAssertionsOnly)
     {
+#if ENABLE(JSC_MULTIPLE_THREADS)
+        globalData->heap.switchAllocationCacheToCurrentThread();
+#endif
     }
 
 private:
@@ -29,6 +29,7 @@
 
 #include "APICast.h"
 #include "APIShims.h"
+#include "HeapSnapshot.h"
 #include "OpaqueJSString.h"
 #include "SourceCode.h"
 #include <interpreter/CallFrame.h>
@@ -109,6 +110,44 @@ void JSGarbageCollect(JSContextRef ctx)
     // the collector is busy.
 }
 
+void JSGarbageCollectAndCompact(JSContextRef ctx)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec, false);
+
+    JSGlobalData& globalData = exec->globalData();
+    if (!globalData.heap.isBusy())
+        globalData.heap.collectAllGarbage(Heap::DoCompact);
+}
+
+size_t JSGetHeapSizeClassStatistics(JSContextRef ctx, JSHeapSizeClassStatistics* statistics, size_t count)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec, false);
+
+    Vector<NewSpace::SizeClassStatistics> sizeClasses;
+    exec->globalData().heap.getSizeClassStatistics(sizeClasses);
+    for (size_t i = 0; i < sizeClasses.size() && i < count; ++i) {
+        statistics[i].cellSize = sizeClasses[i].cellSize;
+        statistics[i].blockCount = sizeClasses[i].blockCount;
+        statistics[i].liveCellCount = sizeClasses[i].liveCellCount;
+        statistics[i].cellCapacity = sizeClasses[i].cellCapacity;
+    }
+    return sizeClasses.size();
+}
+
+bool JSWriteHeapSnapshot(JSContextRef ctx, JSHeapSnapshotWriteCallback callback, void* context)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec, false);
+
+    JSGlobalData& globalData = exec->globalData();
+    if (globalData.heap.isBusy())
+        return false;
+    HeapSnapshotWriter writer(callback, context);
+    return globalData.heap.writeSnapshot(writer);
+}
+
 void JSReportExtraMemoryCost(JSContextRef ctx, size_t size)
 {
     ExecState* exec = toJS(ctx);
@@ -45,6 +45,68 @@ region.
 */
 JS_EXPORT void JSReportExtraMemoryCost(JSContextRef ctx, size_t size) AVAILABLE_IN_WEBKIT_VERSION_4_0;
 
+/*!
+@function
+@abstract Performs a JavaScript garbage collection that also compacts the heap.
+@param ctx The execution context to use.
+@discussion Live objects are moved out of sparsely filled blocks of the heap, so
+that those blocks can be given back. Objects are never moved while the stack,
+a protected value or the engine's own caches point to them, but the client must
+not keep any other pointer to an object across this call.
+*/
+JS_EXPORT void JSGarbageCollectAndCompact(JSContextRef ctx);
+
+/*!
+@struct JSHeapSizeClassStatistics
+@abstract How densely one size class of the garbage collected heap fills its blocks.
+@field cellSize The size, in bytes, of each cell in the size class.
+@field blockCount The number of blocks that hold cells of the size class.
+@field liveCellCount The number of cells that survived the last collection or were allocated since.
+@field cellCapacity The number of cells that those blocks can hold.
+*/
+typedef struct {
+    size_t cellSize;
+    size_t blockCount;
+    size_t liveCellCount;
+    size_t cellCapacity;
+} JSHeapSizeClassStatistics;
+
+/*!
+@function
+@abstract Gets the fragmentation of each size class of the garbage collected heap.
+@param ctx The execution context to use.
+@param statistics An array to fill with one entry for each size class that has blocks.
+@param count The number of entries that statistics can hold.
+@result The number of size classes that have blocks, which may be more than count.
+@discussion A size class whose cellCapacity is well above its liveCellCount
+holds blocks that JSGarbageCollectAndCompact could give back.
+*/
+JS_EXPORT size_t JSGetHeapSizeClassStatistics(JSContextRef ctx, JSHeapSizeClassStatistics* statistics, size_t count);
+
+/*!
+@typedef JSHeapSnapshotWriteCallback
+@abstract The callback invoked to write out the next part of a heap snapshot.
+@param data The bytes to write.
+@param size The number of bytes to write.
+@param context The context that was passed to JSWriteHeapSnapshot.
+@result true if the bytes were written, otherwise false, which abandons the snapshot.
+*/
+typedef bool (*JSHeapSnapshotWriteCallback)(const void* data, size_t size, void* context);
+
+/*!
+@function
+@abstract Performs a JavaScript garbage collection, then writes a snapshot of the live heap.
+@param ctx The execution context to use.
+@param callback The callback that writes out the snapshot, a few kilobytes at a time.
+@param context A pointer to pass to callback.
+@result true if the whole snapshot was written, otherwise false.
+@discussion The snapshot records each live object's class, its size including the
+storage it owns, and the objects it points to. It is written as the heap is walked,
+so taking one needs little memory. The jsc shell can read one back and report
+which classes retain the most memory.
+*/
+JS_EXPORT bool JSWriteHeapSnapshot(JSContextRef ctx, JSHeapSnapshotWriteCallback callback, void* context);
+
 #ifdef __cplusplus
 }
 #endif
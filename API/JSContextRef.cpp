@@ -64,6 +64,59 @@ void JSContextGroupRelease(JSContextGroupRef group)
     toJS(group)->deref();
 }
 
+COMPILE_ASSERT(static_cast<int>(kJSGarbageCollectionPhaseCount) == static_cast<int>(GCStatistics::NumberOfPhases), garbage_collection_phases_match);
+
+class APIGCStatisticsObserver : public GCStatisticsObserver {
+public:
+    APIGCStatisticsObserver(JSGarbageCollectionCallback callback, void* context)
+        : m_callback(callback)
+        , m_context(context)
+    {
+    }
+
+    virtual void didCollect(const GCStatistics& statistics)
+    {
+        Vector<JSGarbageCollectionSizeClass, 16> sizeClasses;
+        for (size_t i = 0; i < statistics.sizeClasses.size(); ++i) {
+            JSGarbageCollectionSizeClass sizeClass = { statistics.sizeClasses[i].cellSize, statistics.sizeClasses[i].bytesAllocated, statistics.sizeClasses[i].bytesSurvived };
+            sizeClasses.append(sizeClass);
+        }
+
+        JSGarbageCollectionStatistics result;
+        result.collectionNumber = statistics.collectionNumber;
+        result.isFullCollection = statistics.isFullCollection;
+        result.pauseTime = statistics.pauseTime;
+        for (size_t i = 0; i < kJSGarbageCollectionPhaseCount; ++i)
+            result.phaseTimes[i] = statistics.phaseTimes[i];
+        result.incrementalMarkingSliceCount = statistics.incrementalMarkingSliceCount;
+        result.incrementalMarkingTime = statistics.incrementalMarkingTime;
+        result.longestIncrementalMarkingSlice = statistics.longestIncrementalMarkingSlice;
+        result.bytesAllocated = statistics.bytesAllocated;
+        result.extraMemoryCost = statistics.extraMemoryCost;
+        result.sizeBefore = statistics.sizeBefore;
+        result.sizeAfter = statistics.sizeAfter;
+        result.sizeClasses = sizeClasses.data();
+        result.sizeClassCount = sizeClasses.size();
+        result.totalPauseTime = statistics.totalPauseTime;
+        result.longestPause = statistics.longestPause;
+        m_callback(&result, m_context);
+    }
+
+private:
+    JSGarbageCollectionCallback m_callback;
+    void* m_context;
+};
+
+void JSContextGroupSetGarbageCollectionCallback(JSContextGroupRef group, JSGarbageCollectionCallback callback, void* context)
+{
+    JSGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+    if (callback)
+        globalData->heap.setStatisticsObserver(adoptPtr(new APIGCStatisticsObserver(callback, context)));
+    else
+        globalData->heap.setStatisticsObserver(nullptr);
+}
+
 JSGlobalContextRef JSGlobalContextCreate(JSClassRef globalObjectClass)
 {
     initializeThreading();
@@ -232,7 +285,7 @@ JSStringRef JSContextCreateBacktrace(JSContextRef ctx, unsigned maxStackSize)
         builder.append(UString::number(lineNumber));
         if (!function || ++count == maxStackSize)
             break;
-        callFrame = callFrame->callerFrame();
+        callFrame = callFrame->trueCallerFrame();
     }
     return OpaqueJSString::create(builder.toUString()).leakRef();
 }
@@ -54,6 +54,99 @@ JS_EXPORT JSGlobalContextRef JSContextGetGlobalContext(JSContextRef ctx);
 @result A string containing the backtrace
 */
 JS_EXPORT JSStringRef JSContextCreateBacktrace(JSContextRef ctx, unsigned maxStackSize) AVAILABLE_IN_WEBKIT_VERSION_4_0;
+
+/*!
+@enum JSGarbageCollectionPhase
+@constant kJSGarbageCollectionPhaseGatherConservativeRoots Scanning the machine stacks and the register file for pointers into the heap.
+@constant kJSGarbageCollectionPhaseMarkRoots Marking everything reachable from the roots.
+@constant kJSGarbageCollectionPhaseHarvestWeakReferences Clearing the caches that point to objects weakly.
+@constant kJSGarbageCollectionPhaseVisitWeakHandles Marking what weak handles keep alive.
+@constant kJSGarbageCollectionPhaseFinalizeWeakHandles Clearing the weak handles to dead objects.
+@constant kJSGarbageCollectionPhaseCompact Moving objects out of sparsely filled blocks, for JSGarbageCollectAndCompact.
+@constant kJSGarbageCollectionPhaseSweep Getting ready to allocate out of the free space. Dead objects are destroyed lazily, as allocation reaches them.
+@constant kJSGarbageCollectionPhaseShrink Giving back blocks that are now empty.
+@constant kJSGarbageCollectionPhaseCount The number of phases.
+*/
+enum {
+    kJSGarbageCollectionPhaseGatherConservativeRoots,
+    kJSGarbageCollectionPhaseMarkRoots,
+    kJSGarbageCollectionPhaseHarvestWeakReferences,
+    kJSGarbageCollectionPhaseVisitWeakHandles,
+    kJSGarbageCollectionPhaseFinalizeWeakHandles,
+    kJSGarbageCollectionPhaseCompact,
+    kJSGarbageCollectionPhaseSweep,
+    kJSGarbageCollectionPhaseShrink,
+    kJSGarbageCollectionPhaseCount
+};
+
+/*!
+@struct JSGarbageCollectionSizeClass
+@abstract What one size class of the garbage collected heap did between two collections.
+@field cellSize The size, in bytes, of each cell in the size class.
+@field bytesAllocated The bytes allocated in the size class since the previous collection.
+@field bytesSurvived The bytes in the size class that survived the collection.
+*/
+typedef struct {
+    size_t cellSize;
+    size_t bytesAllocated;
+    size_t bytesSurvived;
+} JSGarbageCollectionSizeClass;
+
+/*!
+@struct JSGarbageCollectionStatistics
+@abstract What one garbage collection cost, and what it found. Times are in seconds.
+@field collectionNumber The number of the collection, counting from 1.
+@field isFullCollection true if the collection looked at the whole heap, false if it only looked at the objects allocated since the previous collection.
+@field pauseTime The time the collection stopped JavaScript for, not counting incremental marking.
+@field phaseTimes The time spent in each JSGarbageCollectionPhase, during pauseTime.
+@field incrementalMarkingSliceCount The number of pauses in which marking was done ahead of the collection, interleaved with JavaScript.
+@field incrementalMarkingTime The total time of those pauses.
+@field longestIncrementalMarkingSlice The longest of those pauses.
+@field bytesAllocated The bytes of objects allocated since the previous collection.
+@field extraMemoryCost The bytes reported with JSReportExtraMemoryCost since the previous collection.
+@field sizeBefore The bytes of objects the collection started out with.
+@field sizeAfter The bytes of objects that survived the collection.
+@field sizeClasses What each size class of the heap did. Only valid during the callback.
+@field sizeClassCount The number of entries in sizeClasses.
+@field totalPauseTime The time all collections so far stopped JavaScript for, counting incremental marking.
+@field longestPause The longest time any collection so far stopped JavaScript for at once.
+@discussion Sizes do not count the storage that objects own outside of the heap.
+*/
+typedef struct {
+    unsigned collectionNumber;
+    bool isFullCollection;
+    double pauseTime;
+    double phaseTimes[kJSGarbageCollectionPhaseCount];
+    unsigned incrementalMarkingSliceCount;
+    double incrementalMarkingTime;
+    double longestIncrementalMarkingSlice;
+    size_t bytesAllocated;
+    size_t extraMemoryCost;
+    size_t sizeBefore;
+    size_t sizeAfter;
+    const JSGarbageCollectionSizeClass* sizeClasses;
+    size_t sizeClassCount;
+    double totalPauseTime;
+    double longestPause;
+} JSGarbageCollectionStatistics;
+
+/*!
+@typedef JSGarbageCollectionCallback
+@abstract The callback invoked at the end of each garbage collection.
+@param statistics What the collection cost, and what it found.
+@param context The context that was passed to JSContextGroupSetGarbageCollectionCallback.
+@discussion The callback is invoked on the thread that collected, while the collector is still busy. It must not call any JavaScriptCore function.
+*/
+typedef void (*JSGarbageCollectionCallback)(const JSGarbageCollectionStatistics* statistics, void* context);
+
+/*!
+@function
+@abstract Sets the callback to invoke at the end of each garbage collection in a context group.
+@param group The JSContextGroup whose garbage collections to report.
+@param callback The callback to invoke, or NULL to stop reporting.
+@param context A pointer to pass to callback.
+*/
+JS_EXPORT void JSContextGroupSetGarbageCollectionCallback(JSContextGroupRef group, JSGarbageCollectionCallback callback, void* context);
     
 #ifdef __cplusplus
 }
@@ -28,12 +28,15 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "config.h"
 #include "JSSettingsEA.h"
+#include "Options.h"
 #include "Profiler.h"
 
 struct JSSettingsEAPrivate
 {
     size_t    mJavaScriptStackSize;	    // In bytes.  This is the approximate stack size in bytes and not the capacity of the stack array.
     size_t	  mJavaScriptHeapWatermark;	
+    unsigned  mGCMarkerThreadCount;
+    double    mGCPauseBudget;           // In milliseconds.
 	bool      mPrintExceptions;
     const char8_t*  mdefaultLocale;
 
@@ -43,6 +46,8 @@ struct JSSettingsEAPrivate
     JSSettingsEAPrivate(void)
     : mJavaScriptStackSize(128 * 1024)
 	, mJavaScriptHeapWatermark(1 * 1024 * 1024)
+    , mGCMarkerThreadCount(1)
+    , mGCPauseBudget(0)
     , mPrintExceptions(false)
 	, mdefaultLocale(NULL)
     , mCallstackCallback(NULL)
@@ -75,6 +80,32 @@ size_t JSGetHeapWatermark(void)
 	return sSettingsJS.mJavaScriptHeapWatermark;
 }
 
+void JSSetGCMarkerThreadCount(unsigned count)
+{
+    if (!count)
+        count = 1;
+    sSettingsJS.mGCMarkerThreadCount = count;
+    JSC::Options::numberOfGCMarkers = count;
+}
+
+unsigned JSGetGCMarkerThreadCount(void)
+{
+    return sSettingsJS.mGCMarkerThreadCount;
+}
+
+void JSSetGCPauseBudget(double milliseconds)
+{
+    if (milliseconds < 0)
+        milliseconds = 0;
+    sSettingsJS.mGCPauseBudget = milliseconds;
+    JSC::Options::incrementalMarkingPauseBudget = milliseconds / 1000;
+}
+
+double JSGetGCPauseBudget(void)
+{
+    return sSettingsJS.mGCPauseBudget;
+}
+
 void JSSetPrintExceptions(bool active)
 {
     sSettingsJS.mPrintExceptions = active;            
@@ -43,6 +43,17 @@ size_t JSGetStackSize(void);
 void JSSetHeapWatermark(size_t  size);
 size_t JSGetHeapWatermark(void);
 
+// Number of threads, including the collecting thread, that take part in marking.
+// Must be set before the first garbage collection; 1 disables parallel marking.
+void JSSetGCMarkerThreadCount(unsigned count);
+unsigned JSGetGCMarkerThreadCount(void);
+
+// Longest pause, in milliseconds, that one slice of incremental marking may take.
+// Once a collection is due, marking is spread over the allocations that follow,
+// and a final short pause finishes the collection. 0 collects in a single pause.
+void JSSetGCPauseBudget(double milliseconds);
+double JSGetGCPauseBudget(void);
+
 // For exception printing
 void JSSetPrintExceptions(bool active);
 bool JSPrintExceptionsEnabled(void);
@@ -511,6 +511,20 @@ public:
         m_assembler.movl_i32m(imm.m_value, address.offset, address.base);
     }
 
+    void store8(TrustedImm32 imm, ImplicitAddress address)
+    {
+        m_assembler.movb_i8m(imm.m_value, address.offset, address.base);
+    }
+
+    void store8(RegisterID src, BaseIndex address)
+    {
+#if CPU(X86)
+        // Only eax, ecx, edx and ebx have byte forms without a REX prefix.
+        ASSERT(src < X86Registers::esp);
+#endif
+        m_assembler.movb_rm(src, address.offset, address.base, address.index, address.scale);
+    }
+
 
     // Floating-point operation:
     //
@@ -674,6 +688,14 @@ public:
         return branch32(branchType ? NotEqual : Equal, dest, TrustedImm32(0x80000000));
     }
 
+    // Truncates 'src' to an integer, and places the resulting 'dest'. The
+    // result is INT_MIN if 'src' is not representable as a 32 bit value.
+    void truncateDoubleToInt32(FPRegisterID src, RegisterID dest)
+    {
+        ASSERT(isSSE2Present());
+        m_assembler.cvttsd2si_rr(src, dest);
+    }
+
     // Convert 'src' to an integer, and places the resulting 'dest'.
     // If the result is not representable as a 32 bit value, branch.
     // May also branch for some values that are representable in 32 bits
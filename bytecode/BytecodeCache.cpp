@@ -0,0 +1,1296 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "BytecodeCache.h"
+
+#include "BatchedTransitionOptimizer.h"
+#include "BytecodeGenerator.h"
+#include "Interpreter.h"
+#include "JSFunction.h"
+#include "JSGlobalObject.h"
+#include "RegExp.h"
+#include "ScopeChain.h"
+#include "UStringConcatenate.h"
+#include <stdio.h>
+#include <wtf/Decoder.h>
+#include <wtf/Encoder.h>
+#include <wtf/SHA1.h>
+#include <wtf/text/CString.h>
+#include <wtf/text/WTFString.h>
+
+#if HAVE(MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace JSC {
+
+// Bump whenever the encoding below changes.
+static const uint32_t formatVersion = 1;
+static const uint32_t fileMagic = 0x4342534a; // "JSBC"
+
+static const size_t checksumSize = 20;
+
+class BytecodeEncoder : public Encoder {
+public:
+    Vector<uint8_t>& buffer() { return m_buffer; }
+
+    virtual void encodeBytes(const uint8_t* bytes, size_t size)
+    {
+        encodeUInt32(size);
+        m_buffer.append(bytes, size);
+    }
+
+    virtual void encodeBool(bool value) { m_buffer.append(value); }
+    virtual void encodeUInt32(uint32_t value) { encodeRaw(value); }
+    virtual void encodeUInt64(uint64_t value) { encodeRaw(value); }
+    virtual void encodeInt32(int32_t value) { encodeRaw(value); }
+    virtual void encodeInt64(int64_t value) { encodeRaw(value); }
+    virtual void encodeFloat(float value) { encodeRaw(value); }
+    virtual void encodeDouble(double value) { encodeRaw(value); }
+
+    virtual void encodeString(const String& string)
+    {
+        if (string.isNull()) {
+            encodeUInt32(std::numeric_limits<uint32_t>::max());
+            return;
+        }
+        encodeUInt32(string.length());
+        m_buffer.append(reinterpret_cast<const uint8_t*>(string.characters()), string.length() * sizeof(UChar));
+    }
+
+    void encodeUString(const UString& string) { encodeString(String(string.impl())); }
+    void encodeIdentifier(const Identifier& identifier) { encodeUString(identifier.ustring()); }
+
+private:
+    template <typename T> void encodeRaw(T value)
+    {
+        m_buffer.append(reinterpret_cast<const uint8_t*>(&value), sizeof(T));
+    }
+
+    Vector<uint8_t> m_buffer;
+};
+
+class BytecodeDecoder : public Decoder {
+public:
+    BytecodeDecoder(JSGlobalData* globalData, const uint8_t* buffer, size_t size)
+        : m_globalData(globalData)
+        , m_position(buffer)
+        , m_end(buffer + size)
+    {
+    }
+
+    bool atEnd() const { return m_position == m_end; }
+
+    virtual bool decodeBytes(Vector<uint8_t>& bytes)
+    {
+        uint32_t size;
+        if (!decodeUInt32(size) || static_cast<size_t>(m_end - m_position) < size)
+            return false;
+        bytes.clear();
+        bytes.append(m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    virtual bool decodeBool(bool& value)
+    {
+        uint8_t byte;
+        if (!decodeRaw(byte) || byte > 1)
+            return false;
+        value = byte;
+        return true;
+    }
+
+    virtual bool decodeUInt32(uint32_t& value) { return decodeRaw(value); }
+    virtual bool decodeUInt64(uint64_t& value) { return decodeRaw(value); }
+    virtual bool decodeInt32(int32_t& value) { return decodeRaw(value); }
+    virtual bool decodeInt64(int64_t& value) { return decodeRaw(value); }
+    virtual bool decodeFloat(float& value) { return decodeRaw(value); }
+    virtual bool decodeDouble(double& value) { return decodeRaw(value); }
+
+    virtual bool decodeString(String& string)
+    {
+        uint32_t length;
+        if (!decodeUInt32(length))
+            return false;
+        if (length == std::numeric_limits<uint32_t>::max()) {
+            string = String();
+            return true;
+        }
+        if (static_cast<size_t>(m_end - m_position) / sizeof(UChar) < length)
+            return false;
+        Vector<UChar> characters(length);
+        memcpy(characters.data(), m_position, length * sizeof(UChar));
+        m_position += length * sizeof(UChar);
+        string = String::adopt(characters);
+        return true;
+    }
+
+    bool decodeUString(UString& string)
+    {
+        String result;
+        if (!decodeString(result))
+            return false;
+        string = UString(result.impl());
+        return true;
+    }
+
+    bool decodeIdentifier(Identifier& identifier)
+    {
+        UString string;
+        if (!decodeUString(string))
+            return false;
+        identifier = string.isNull() ? Identifier() : Identifier(m_globalData, string);
+        return true;
+    }
+
+    bool decodeInt(int& value) { return decodeInt32(reinterpret_cast<int32_t&>(value)); }
+    bool decodeUnsigned(unsigned& value) { return decodeUInt32(reinterpret_cast<uint32_t&>(value)); }
+
+    // Reads a count of items that each take at least one byte.
+    bool decodeCount(uint32_t& count) { return decodeUInt32(count) && count <= static_cast<size_t>(m_end - m_position); }
+
+private:
+    template <typename T> bool decodeRaw(T& value)
+    {
+        if (static_cast<size_t>(m_end - m_position) < sizeof(T))
+            return false;
+        memcpy(&value, m_position, sizeof(T));
+        m_position += sizeof(T);
+        return true;
+    }
+
+    JSGlobalData* m_globalData;
+    const uint8_t* m_position;
+    const uint8_t* m_end;
+};
+
+// Files written by a build with a different instruction set are ignored.
+static uint32_t bytecodeFingerprint()
+{
+    uint32_t fingerprint = sizeof(Instruction) * 0x01000193 + numOpcodeIDs;
+    for (int i = 0; i < numOpcodeIDs; ++i)
+        fingerprint = (fingerprint ^ opcodeLengths[i]) * 0x01000193;
+    return fingerprint;
+}
+
+static void computeChecksum(const uint8_t* data, size_t size, Vector<uint8_t, 20>& checksum)
+{
+    SHA1 sha1;
+    sha1.addBytes(data, size);
+    sha1.computeHash(checksum);
+}
+
+static inline uint64_t entryKey(unsigned startOffset, unsigned endOffset)
+{
+    return static_cast<uint64_t>(startOffset) << 32 | endOffset;
+}
+
+// A source's file: the entries read from disk, and those generated since.
+class BytecodeCache::SourceFile {
+    WTF_MAKE_NONCOPYABLE(SourceFile); WTF_MAKE_FAST_ALLOCATED;
+public:
+    SourceFile(const UString& path, unsigned sourceLength)
+        : m_path(path)
+        , m_sourceLength(sourceLength)
+        , m_mappedData(0)
+        , m_mappedSize(0)
+        , m_isDirty(false)
+    {
+        read();
+    }
+
+    ~SourceFile()
+    {
+#if HAVE(MMAP)
+        if (m_mappedData)
+            munmap(const_cast<uint8_t*>(m_mappedData), m_mappedSize);
+#endif
+        deleteAllValues(m_newEntries);
+    }
+
+    bool find(EntryKind kind, unsigned startOffset, unsigned endOffset, const uint8_t*& data, size_t& size)
+    {
+        EntryMap::iterator iter = m_entries[kind].find(entryKey(startOffset, endOffset));
+        if (iter == m_entries[kind].end())
+            return false;
+        data = iter->second.data;
+        size = iter->second.size;
+        return true;
+    }
+
+    // Takes the contents of the buffer.
+    void add(EntryKind kind, unsigned startOffset, unsigned endOffset, Vector<uint8_t>& buffer)
+    {
+        Vector<uint8_t>* data = new Vector<uint8_t>;
+        data->swap(buffer);
+        m_newEntries.append(data);
+        Entry entry = { data->data(), data->size() };
+        m_entries[kind].set(entryKey(startOffset, endOffset), entry);
+        m_isDirty = true;
+    }
+
+    void write();
+
+private:
+    struct Entry {
+        const uint8_t* data;
+        size_t size;
+    };
+    typedef HashMap<uint64_t, Entry, IntHash<uint64_t>, WTF::UnsignedWithZeroKeyHashTraits<uint64_t> > EntryMap;
+
+    // Each index entry is its kind, the range of the source, and where its data is in the file.
+    static const size_t headerSize = 5 * sizeof(uint32_t);
+    static const size_t indexEntrySize = 5 * sizeof(uint32_t);
+
+    void read();
+    bool readIndex(const uint8_t* data, size_t size);
+
+    UString m_path;
+    unsigned m_sourceLength;
+    const uint8_t* m_mappedData;
+    size_t m_mappedSize;
+    Vector<uint8_t> m_readData;
+    EntryMap m_entries[NumberOfEntryKinds];
+    Vector<Vector<uint8_t>*> m_newEntries;
+    bool m_isDirty;
+};
+
+void BytecodeCache::SourceFile::read()
+{
+    CString path = m_path.utf8();
+#if HAVE(MMAP)
+    int fd = open(path.data(), O_RDONLY);
+    if (fd == -1)
+        return;
+    struct stat status;
+    if (!fstat(fd, &status) && status.st_size > 0) {
+        void* data = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            m_mappedData = static_cast<const uint8_t*>(data);
+            m_mappedSize = status.st_size;
+        }
+    }
+    close(fd);
+    if (m_mappedData && !readIndex(m_mappedData, m_mappedSize)) {
+        for (int kind = 0; kind < NumberOfEntryKinds; ++kind)
+            m_entries[kind].clear();
+    }
+#else
+    FILE* file = fopen(path.data(), "rb");
+    if (!file)
+        return;
+    uint8_t buffer[4096];
+    while (size_t size = fread(buffer, 1, sizeof(buffer), file))
+        m_readData.append(buffer, size);
+    fclose(file);
+    if (!readIndex(m_readData.data(), m_readData.size())) {
+        for (int kind = 0; kind < NumberOfEntryKinds; ++kind)
+            m_entries[kind].clear();
+    }
+#endif
+}
+
+bool BytecodeCache::SourceFile::readIndex(const uint8_t* data, size_t size)
+{
+    BytecodeDecoder decoder(0, data, size);
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fingerprint;
+    uint32_t sourceLength;
+    uint32_t entryCount;
+    if (!decoder.decodeUInt32(magic) || magic != fileMagic)
+        return false;
+    if (!decoder.decodeUInt32(version) || version != formatVersion)
+        return false;
+    if (!decoder.decodeUInt32(fingerprint) || fingerprint != bytecodeFingerprint())
+        return false;
+    if (!decoder.decodeUInt32(sourceLength) || sourceLength != m_sourceLength)
+        return false;
+    if (!decoder.decodeUInt32(entryCount) || entryCount > (size - headerSize) / indexEntrySize)
+        return false;
+
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        uint32_t kind;
+        uint32_t startOffset;
+        uint32_t endOffset;
+        uint32_t offset;
+        uint32_t entrySize;
+        if (!decoder.decodeUInt32(kind) || kind >= NumberOfEntryKinds)
+            return false;
+        if (!decoder.decodeUInt32(startOffset) || !decoder.decodeUInt32(endOffset) || startOffset > endOffset || endOffset > m_sourceLength)
+            return false;
+        if (!decoder.decodeUInt32(offset) || !decoder.decodeUInt32(entrySize) || offset > size || entrySize > size - offset)
+            return false;
+        Entry entry = { data + offset, entrySize };
+        m_entries[kind].set(entryKey(startOffset, endOffset), entry);
+    }
+    return true;
+}
+
+void BytecodeCache::SourceFile::write()
+{
+    if (!m_isDirty)
+        return;
+    m_isDirty = false;
+
+    uint32_t entryCount = 0;
+    for (int kind = 0; kind < NumberOfEntryKinds; ++kind)
+        entryCount += m_entries[kind].size();
+
+    BytecodeEncoder header;
+    header.encodeUInt32(fileMagic);
+    header.encodeUInt32(formatVersion);
+    header.encodeUInt32(bytecodeFingerprint());
+    header.encodeUInt32(m_sourceLength);
+    header.encodeUInt32(entryCount);
+
+    uint32_t offset = headerSize + entryCount * indexEntrySize;
+    for (int kind = 0; kind < NumberOfEntryKinds; ++kind) {
+        EntryMap::iterator end = m_entries[kind].end();
+        for (EntryMap::iterator iter = m_entries[kind].begin(); iter != end; ++iter) {
+            header.encodeUInt32(kind);
+            header.encodeUInt32(static_cast<uint32_t>(iter->first >> 32));
+            header.encodeUInt32(static_cast<uint32_t>(iter->first));
+            header.encodeUInt32(offset);
+            header.encodeUInt32(iter->second.size);
+            offset += iter->second.size;
+        }
+    }
+
+    // Write to a temporary file first, so that a reader never sees half a file.
+    CString path = m_path.utf8();
+    CString temporaryPath = makeUString(m_path, ".tmp").utf8();
+    FILE* file = fopen(temporaryPath.data(), "wb");
+    if (!file)
+        return;
+    bool success = fwrite(header.buffer().data(), 1, header.buffer().size(), file) == header.buffer().size();
+    for (int kind = 0; kind < NumberOfEntryKinds && success; ++kind) {
+        EntryMap::iterator end = m_entries[kind].end();
+        for (EntryMap::iterator iter = m_entries[kind].begin(); iter != end && success; ++iter)
+            success = fwrite(iter->second.data, 1, iter->second.size, file) == iter->second.size;
+    }
+    success = !fclose(file) && success;
+#if OS(WINDOWS)
+    if (success)
+        remove(path.data());
+#endif
+    if (!success || rename(temporaryPath.data(), path.data()))
+        remove(temporaryPath.data());
+}
+
+BytecodeCache::BytecodeCache(const UString& directory)
+    : m_directory(directory)
+{
+}
+
+BytecodeCache::~BytecodeCache()
+{
+    flush();
+    deleteAllValues(m_sourceFiles);
+}
+
+void BytecodeCache::flush()
+{
+    HashMap<String, SourceFile*>::iterator end = m_sourceFiles.end();
+    for (HashMap<String, SourceFile*>::iterator iter = m_sourceFiles.begin(); iter != end; ++iter)
+        iter->second->write();
+}
+
+BytecodeCache* BytecodeCache::forScopeChain(ScopeChainNode* scopeChain)
+{
+    BytecodeCache* cache = scopeChain->globalData->bytecodeCache.get();
+    if (!cache)
+        return 0;
+    JSGlobalObject* globalObject = scopeChain->globalObject.get();
+    if (globalObject->debugger() || globalObject->supportsProfiling())
+        return 0;
+    return cache;
+}
+
+BytecodeCache::SourceFile* BytecodeCache::sourceFile(SourceProvider* provider)
+{
+    // Eval code and code made up on the fly rarely runs again.
+    if (provider->url().isEmpty())
+        return 0;
+
+    if (provider->bytecodeCacheKey().isNull()) {
+        Vector<uint8_t, 20> hash;
+        computeChecksum(reinterpret_cast<const uint8_t*>(provider->data()), provider->length() * sizeof(UChar), hash);
+        char key[2 * 20 + 1];
+        for (size_t i = 0; i < hash.size(); ++i)
+            snprintf(key + 2 * i, 3, "%02x", hash[i]);
+        provider->setBytecodeCacheKey(UString(key));
+    }
+
+    const UString& key = provider->bytecodeCacheKey();
+    pair<HashMap<String, SourceFile*>::iterator, bool> result = m_sourceFiles.add(String(key.impl()), 0);
+    if (result.second)
+        result.first->second = new SourceFile(makeUString(m_directory, "/", key, ".jsbc"), provider->length());
+    return result.first->second;
+}
+
+// What else the bytecode depends on, besides the source and the scope chain.
+enum EntryFlags {
+    EntryUsesJIT = 1 << 0,
+    EntryHasRichSourceInfo = 1 << 1,
+    EntryIsStrictMode = 1 << 2,
+    EntryForcesUsesArguments = 1 << 3
+};
+
+static uint32_t entryFlags(ScriptExecutable* executable, bool isFunctionCode, ScopeChainNode* scopeChain)
+{
+    uint32_t flags = 0;
+    if (scopeChain->globalData->canUseJIT())
+        flags |= EntryUsesJIT;
+    if (scopeChain->globalObject->supportsRichSourceInfo())
+        flags |= EntryHasRichSourceInfo;
+    if (executable->isStrictMode())
+        flags |= EntryIsStrictMode;
+    if (isFunctionCode && static_cast<FunctionExecutable*>(executable)->forceUsesArguments())
+        flags |= EntryForcesUsesArguments;
+    return flags;
+}
+
+enum ScopeFlags {
+    VariableObjectScope = 1 << 0,
+    GlobalObjectScope = 1 << 1,
+    DynamicScope = 1 << 2,
+    DynamicChecksScope = 1 << 3
+};
+
+static uint32_t scopeFlags(JSObject* scope)
+{
+    if (!scope->isVariableObject())
+        return 0;
+    uint32_t flags = VariableObjectScope;
+    if (scope->isGlobalObject())
+        flags |= GlobalObjectScope;
+    bool requiresDynamicChecks = false;
+    if (static_cast<JSVariableObject*>(scope)->isDynamicScope(requiresDynamicChecks))
+        flags |= DynamicScope;
+    if (requiresDynamicChecks)
+        flags |= DynamicChecksScope;
+    return flags;
+}
+
+static uint32_t scopeChainLength(ScopeChainNode* scopeChain)
+{
+    uint32_t length = 0;
+    ScopeChainIterator end = scopeChain->end();
+    for (ScopeChainIterator iter = scopeChain->begin(); iter != end; ++iter)
+        ++length;
+    return length;
+}
+
+// Records the shape of the scope chain, and what the names the generator
+// looked up resolve to in each of its variable objects.
+static void encodeScopeChain(BytecodeEncoder& encoder, ScopeChainNode* scopeChain, const HashSet<RefPtr<StringImpl>, IdentifierRepHash>& names)
+{
+    ScopeChainIterator end = scopeChain->end();
+    encoder.encodeUInt32(scopeChainLength(scopeChain));
+    for (ScopeChainIterator iter = scopeChain->begin(); iter != end; ++iter)
+        encoder.encodeUInt32(scopeFlags(iter->get()));
+
+    encoder.encodeUInt32(names.size());
+    HashSet<RefPtr<StringImpl>, IdentifierRepHash>::const_iterator namesEnd = names.end();
+    for (HashSet<RefPtr<StringImpl>, IdentifierRepHash>::const_iterator name = names.begin(); name != namesEnd; ++name) {
+        encoder.encodeUString(UString(name->get()));
+        for (ScopeChainIterator iter = scopeChain->begin(); iter != end; ++iter) {
+            if (!iter->get()->isVariableObject())
+                continue;
+            SymbolTableEntry entry = static_cast<JSVariableObject*>(iter->get())->symbolTable().get(name->get());
+            encoder.encodeBool(entry.isNull());
+            encoder.encodeInt32(entry.getIndex());
+            encoder.encodeUInt32(entry.getAttributes());
+        }
+    }
+}
+
+static bool scopeChainMatches(BytecodeDecoder& decoder, ScopeChainNode* scopeChain)
+{
+    ScopeChainIterator end = scopeChain->end();
+    uint32_t length;
+    if (!decoder.decodeUInt32(length) || length != scopeChainLength(scopeChain))
+        return false;
+    for (ScopeChainIterator iter = scopeChain->begin(); iter != end; ++iter) {
+        uint32_t flags;
+        if (!decoder.decodeUInt32(flags) || flags != scopeFlags(iter->get()))
+            return false;
+    }
+
+    uint32_t nameCount;
+    if (!decoder.decodeCount(nameCount))
+        return false;
+    for (uint32_t i = 0; i < nameCount; ++i) {
+        Identifier name;
+        if (!decoder.decodeIdentifier(name) || name.isNull())
+            return false;
+        for (ScopeChainIterator iter = scopeChain->begin(); iter != end; ++iter) {
+            if (!iter->get()->isVariableObject())
+                continue;
+            SymbolTableEntry entry = static_cast<JSVariableObject*>(iter->get())->symbolTable().get(name.impl());
+            bool isNull;
+            int32_t index;
+            uint32_t attributes;
+            if (!decoder.decodeBool(isNull) || !decoder.decodeInt32(index) || !decoder.decodeUInt32(attributes))
+                return false;
+            if (isNull != entry.isNull() || index != entry.getIndex() || attributes != entry.getAttributes())
+                return false;
+        }
+    }
+    return true;
+}
+
+static void encodeFunction(BytecodeEncoder& encoder, const Identifier& name, const SourceCode& source, int lineNo, int lastLine, bool forceUsesArguments, bool isStrictMode, FunctionParameters* parameters)
+{
+    encoder.encodeIdentifier(name);
+    encoder.encodeInt32(source.startOffset());
+    encoder.encodeInt32(source.endOffset());
+    encoder.encodeInt32(source.firstLine());
+    encoder.encodeInt32(lineNo);
+    encoder.encodeInt32(lastLine);
+    encoder.encodeBool(forceUsesArguments);
+    encoder.encodeBool(isStrictMode);
+    encoder.encodeUInt32(parameters->size());
+    for (size_t i = 0; i < parameters->size(); ++i)
+        encoder.encodeIdentifier(parameters->at(i));
+}
+
+static void encodeFunction(BytecodeEncoder& encoder, FunctionExecutable* function)
+{
+    encodeFunction(encoder, function->name(), function->source(), function->lineNo(), function->lastLine(), function->forceUsesArguments(), function->isStrictMode(), function->parameters());
+}
+
+static void encodeFunction(BytecodeEncoder& encoder, FunctionBodyNode* body)
+{
+    encodeFunction(encoder, body->ident(), body->source(), body->lineNo(), body->lastLine(), body->usesArguments(), body->isStrictMode(), body->parameters());
+}
+
+bool CachedBytecode::decodeFunction(BytecodeDecoder& decoder, Function& function)
+{
+    uint32_t parameterCount;
+    if (!decoder.decodeIdentifier(function.name)
+        || !decoder.decodeInt(function.startOffset)
+        || !decoder.decodeInt(function.endOffset)
+        || !decoder.decodeInt(function.firstLine)
+        || !decoder.decodeInt(function.lineNo)
+        || !decoder.decodeInt(function.lastLine)
+        || !decoder.decodeBool(function.forceUsesArguments)
+        || !decoder.decodeBool(function.isStrictMode)
+        || !decoder.decodeCount(parameterCount))
+        return false;
+    function.parameters = FunctionParameters::create(0);
+    function.parameters->resize(parameterCount);
+    for (uint32_t i = 0; i < parameterCount; ++i) {
+        if (!decoder.decodeIdentifier(function.parameters->at(i)))
+            return false;
+    }
+    return true;
+}
+
+FunctionExecutable* CachedBytecode::createFunction(JSGlobalData& globalData, SourceProvider* provider, const Function& function)
+{
+    SourceCode source(provider, function.startOffset, function.endOffset, function.firstLine);
+    return FunctionExecutable::create(globalData, function.name, source, function.forceUsesArguments, function.parameters.get(), function.isStrictMode, function.lineNo, function.lastLine);
+}
+
+// Only values that can be made again in another run go in the cache. Array
+// literal buffers hold strings that are also constant registers, which keep
+// them alive; they are recorded as references to those registers.
+bool CachedBytecode::encodeConstant(BytecodeEncoder& encoder, JSValue value, CodeBlock* codeBlock, const HashMap<JSCell*, unsigned>* constantRegisters)
+{
+    if (!value)
+        encoder.encodeUInt32(CachedBytecode::ConstantEmpty);
+    else if (value.isInt32()) {
+        encoder.encodeUInt32(CachedBytecode::ConstantInt32);
+        encoder.encodeDouble(value.asInt32());
+    } else if (value.isDouble()) {
+        encoder.encodeUInt32(CachedBytecode::ConstantDouble);
+        encoder.encodeDouble(value.asDouble());
+    } else if (value.isBoolean()) {
+        encoder.encodeUInt32(CachedBytecode::ConstantBoolean);
+        encoder.encodeDouble(value.getBoolean());
+    } else if (value.isNull())
+        encoder.encodeUInt32(CachedBytecode::ConstantNull);
+    else if (value.isUndefined())
+        encoder.encodeUInt32(CachedBytecode::ConstantUndefined);
+    else if (constantRegisters) {
+        HashMap<JSCell*, unsigned>::const_iterator iter = constantRegisters->find(value.asCell());
+        if (iter == constantRegisters->end())
+            return false;
+        encoder.encodeUInt32(CachedBytecode::ConstantRegister);
+        encoder.encodeDouble(iter->second);
+    } else if (value.isString()) {
+        encoder.encodeUInt32(CachedBytecode::ConstantString);
+        encoder.encodeUString(asString(value)->tryGetValue());
+    } else if (value == codeBlock->globalObject())
+        encoder.encodeUInt32(CachedBytecode::ConstantGlobalObject);
+    else
+        return false;
+    return true;
+}
+
+bool CachedBytecode::decodeConstant(BytecodeDecoder& decoder, Constant& constant, size_t numberOfConstantRegisters)
+{
+    uint32_t type;
+    if (!decoder.decodeUInt32(type))
+        return false;
+    constant.type = static_cast<CachedBytecode::ConstantType>(type);
+    switch (constant.type) {
+    case CachedBytecode::ConstantInt32:
+    case CachedBytecode::ConstantDouble:
+    case CachedBytecode::ConstantBoolean:
+        return decoder.decodeDouble(constant.number);
+    case CachedBytecode::ConstantRegister:
+        return decoder.decodeDouble(constant.number) && constant.number >= 0 && constant.number < numberOfConstantRegisters;
+    case CachedBytecode::ConstantString:
+        return decoder.decodeUString(constant.string) && !constant.string.isNull();
+    case CachedBytecode::ConstantNull:
+    case CachedBytecode::ConstantUndefined:
+    case CachedBytecode::ConstantEmpty:
+    case CachedBytecode::ConstantGlobalObject:
+        return true;
+    }
+    return false;
+}
+
+JSValue CachedBytecode::createConstant(JSGlobalData& globalData, JSGlobalObject* globalObject, CodeBlock* codeBlock, const Constant& constant)
+{
+    switch (constant.type) {
+    case ConstantInt32:
+        return jsNumber(static_cast<int32_t>(constant.number));
+    case ConstantDouble:
+        return jsNumber(constant.number);
+    case ConstantBoolean:
+        return jsBoolean(constant.number);
+    case ConstantNull:
+        return jsNull();
+    case ConstantUndefined:
+        return jsUndefined();
+    case ConstantEmpty:
+        return JSValue();
+    case ConstantString:
+        return jsOwnedString(&globalData, constant.string);
+    case ConstantGlobalObject:
+        return globalObject;
+    case ConstantRegister:
+        return codeBlock->constantRegister(FirstConstantRegisterIndex + static_cast<int>(constant.number)).get();
+    }
+    ASSERT_NOT_REACHED();
+    return JSValue();
+}
+
+static void encodeSimpleJumpTable(BytecodeEncoder& encoder, const SimpleJumpTable& table)
+{
+    encoder.encodeInt32(table.min);
+    encoder.encodeUInt32(table.branchOffsets.size());
+    for (size_t i = 0; i < table.branchOffsets.size(); ++i)
+        encoder.encodeInt32(table.branchOffsets[i]);
+}
+
+static bool decodeSimpleJumpTable(BytecodeDecoder& decoder, SimpleJumpTable& table)
+{
+    uint32_t size;
+    if (!decoder.decodeInt32(table.min) || !decoder.decodeCount(size))
+        return false;
+    table.branchOffsets.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        if (!decoder.decodeInt32(table.branchOffsets[i]))
+            return false;
+    }
+    return true;
+}
+
+// Operand 2 of op_jneq_ptr is the only cell the generator puts in the instruction stream.
+enum InstructionCell { CallFunctionCell, ApplyFunctionCell };
+
+bool CachedBytecode::encode(BytecodeEncoder& encoder, CodeBlock* codeBlock)
+{
+    Interpreter* interpreter = codeBlock->globalData()->interpreter;
+    JSGlobalObject* globalObject = codeBlock->globalObject();
+
+    Vector<Instruction>& instructions = codeBlock->instructions();
+    encoder.encodeUInt32(instructions.size());
+    for (size_t i = 0; i < instructions.size(); ) {
+        OpcodeID opcodeID = interpreter->getOpcodeID(instructions[i].u.opcode);
+        encoder.encodeUInt32(opcodeID);
+        for (int j = 1; j < opcodeLengths[opcodeID]; ++j) {
+            if (opcodeID == op_jneq_ptr && j == 2) {
+                JSCell* cell = instructions[i + j].u.jsCell.get();
+                if (cell == globalObject->callFunction())
+                    encoder.encodeUInt32(CallFunctionCell);
+                else if (cell == globalObject->applyFunction())
+                    encoder.encodeUInt32(ApplyFunctionCell);
+                else
+                    return false;
+                continue;
+            }
+            encoder.encodeInt32(instructions[i + j].u.operand);
+        }
+        i += opcodeLengths[opcodeID];
+    }
+
+    encoder.encodeUInt32(codeBlock->m_identifiers.size());
+    for (size_t i = 0; i < codeBlock->m_identifiers.size(); ++i)
+        encoder.encodeIdentifier(codeBlock->m_identifiers[i]);
+
+    HashMap<JSCell*, unsigned> constantRegisters;
+    encoder.encodeUInt32(codeBlock->m_constantRegisters.size());
+    for (size_t i = 0; i < codeBlock->m_constantRegisters.size(); ++i) {
+        JSValue value = codeBlock->m_constantRegisters[i].get();
+        if (!encodeConstant(encoder, value, codeBlock, 0))
+            return false;
+        if (value && value.isCell())
+            constantRegisters.add(value.asCell(), i);
+    }
+
+    encoder.encodeUInt32(codeBlock->m_functionDecls.size());
+    for (size_t i = 0; i < codeBlock->m_functionDecls.size(); ++i)
+        encodeFunction(encoder, codeBlock->m_functionDecls[i].get());
+    encoder.encodeUInt32(codeBlock->m_functionExprs.size());
+    for (size_t i = 0; i < codeBlock->m_functionExprs.size(); ++i)
+        encodeFunction(encoder, codeBlock->m_functionExprs[i].get());
+
+    encoder.encodeUInt32(codeBlock->m_jumpTargets.size());
+    for (size_t i = 0; i < codeBlock->m_jumpTargets.size(); ++i)
+        encoder.encodeUInt32(codeBlock->m_jumpTargets[i]);
+
+#if ENABLE(JIT)
+    encoder.encodeUInt32(codeBlock->m_globalResolveInfos.size());
+    for (size_t i = 0; i < codeBlock->m_globalResolveInfos.size(); ++i)
+        encoder.encodeUInt32(codeBlock->m_globalResolveInfos[i].bytecodeOffset);
+#else
+    encoder.encodeUInt32(0);
+#endif
+#if ENABLE(INTERPRETER)
+    encoder.encodeUInt32(codeBlock->m_globalResolveInstructions.size());
+    for (size_t i = 0; i < codeBlock->m_globalResolveInstructions.size(); ++i)
+        encoder.encodeUInt32(codeBlock->m_globalResolveInstructions[i]);
+    encoder.encodeUInt32(codeBlock->m_propertyAccessInstructions.size());
+    for (size_t i = 0; i < codeBlock->m_propertyAccessInstructions.size(); ++i)
+        encoder.encodeUInt32(codeBlock->m_propertyAccessInstructions[i]);
+#else
+    encoder.encodeUInt32(0);
+    encoder.encodeUInt32(0);
+#endif
+
+    CodeBlock::RareData* rareData = codeBlock->m_rareData.get();
+    encoder.encodeBool(rareData);
+    if (rareData) {
+        encoder.encodeUInt32(rareData->m_exceptionHandlers.size());
+        for (size_t i = 0; i < rareData->m_exceptionHandlers.size(); ++i) {
+            const HandlerInfo& handler = rareData->m_exceptionHandlers[i];
+            encoder.encodeUInt32(handler.start);
+            encoder.encodeUInt32(handler.end);
+            encoder.encodeUInt32(handler.target);
+            encoder.encodeUInt32(handler.scopeDepth);
+        }
+
+        encoder.encodeUInt32(rareData->m_regexps.size());
+        for (size_t i = 0; i < rareData->m_regexps.size(); ++i) {
+            RegExp* regExp = rareData->m_regexps[i].get();
+            encoder.encodeUString(regExp->pattern());
+            encoder.encodeUInt32(regExp->flags());
+        }
+
+        encoder.encodeUInt32(rareData->m_constantBuffers.size());
+        for (size_t i = 0; i < rareData->m_constantBuffers.size(); ++i) {
+            const Vector<JSValue>& buffer = rareData->m_constantBuffers[i];
+            encoder.encodeUInt32(buffer.size());
+            for (size_t j = 0; j < buffer.size(); ++j) {
+                if (!encodeConstant(encoder, buffer[j], codeBlock, &constantRegisters))
+                    return false;
+            }
+        }
+
+        encoder.encodeUInt32(rareData->m_immediateSwitchJumpTables.size());
+        for (size_t i = 0; i < rareData->m_immediateSwitchJumpTables.size(); ++i)
+            encodeSimpleJumpTable(encoder, rareData->m_immediateSwitchJumpTables[i]);
+        encoder.encodeUInt32(rareData->m_characterSwitchJumpTables.size());
+        for (size_t i = 0; i < rareData->m_characterSwitchJumpTables.size(); ++i)
+            encodeSimpleJumpTable(encoder, rareData->m_characterSwitchJumpTables[i]);
+        encoder.encodeUInt32(rareData->m_stringSwitchJumpTables.size());
+        for (size_t i = 0; i < rareData->m_stringSwitchJumpTables.size(); ++i) {
+            const StringJumpTable::StringOffsetTable& offsetTable = rareData->m_stringSwitchJumpTables[i].offsetTable;
+            encoder.encodeUInt32(offsetTable.size());
+            StringJumpTable::StringOffsetTable::const_iterator end = offsetTable.end();
+            for (StringJumpTable::StringOffsetTable::const_iterator iter = offsetTable.begin(); iter != end; ++iter) {
+                encoder.encodeUString(UString(iter->first.get()));
+                encoder.encodeInt32(iter->second.branchOffset);
+            }
+        }
+
+        encoder.encodeUInt32(rareData->m_expressionInfo.size());
+        for (size_t i = 0; i < rareData->m_expressionInfo.size(); ++i) {
+            const ExpressionRangeInfo& info = rareData->m_expressionInfo[i];
+            encoder.encodeUInt32(info.instructionOffset);
+            encoder.encodeUInt32(info.divotPoint);
+            encoder.encodeUInt32(info.startOffset);
+            encoder.encodeUInt32(info.endOffset);
+        }
+
+        encoder.encodeUInt32(rareData->m_lineInfo.size());
+        for (size_t i = 0; i < rareData->m_lineInfo.size(); ++i) {
+            encoder.encodeUInt32(rareData->m_lineInfo[i].instructionOffset);
+            encoder.encodeInt32(rareData->m_lineInfo[i].lineNumber);
+        }
+    }
+
+    // Program code declares its variables in the global object's symbol table.
+    if (codeBlock->codeType() == FunctionCode) {
+        SymbolTable* symbolTable = codeBlock->symbolTable();
+        encoder.encodeUInt32(symbolTable->size());
+        SymbolTable::iterator end = symbolTable->end();
+        for (SymbolTable::iterator iter = symbolTable->begin(); iter != end; ++iter) {
+            encoder.encodeUString(UString(iter->first.get()));
+            encoder.encodeInt32(iter->second.getIndex());
+            encoder.encodeUInt32(iter->second.getAttributes());
+        }
+    } else
+        encoder.encodeUInt32(0);
+
+    encoder.encodeInt32(codeBlock->m_numCalleeRegisters);
+    encoder.encodeInt32(codeBlock->m_numVars);
+    encoder.encodeInt32(codeBlock->m_numCapturedVars);
+    encoder.encodeInt32(codeBlock->m_numParameters);
+    encoder.encodeInt32(codeBlock->m_thisRegister);
+    encoder.encodeInt32(codeBlock->m_argumentsRegister);
+    encoder.encodeInt32(codeBlock->m_activationRegister);
+    encoder.encodeBool(codeBlock->m_needsFullScopeChain);
+    encoder.encodeBool(codeBlock->m_isNumericCompareFunction);
+    return true;
+}
+
+bool CachedBytecode::decode(BytecodeDecoder& decoder, Interpreter* interpreter)
+{
+    uint32_t size;
+    if (!decoder.decodeCount(size))
+        return false;
+    m_instructions.reserveInitialCapacity(size);
+    while (m_instructions.size() < size) {
+        uint32_t opcodeID;
+        if (!decoder.decodeUInt32(opcodeID) || opcodeID >= static_cast<uint32_t>(numOpcodeIDs) || m_instructions.size() + opcodeLengths[opcodeID] > size)
+            return false;
+        m_instructions.append(Instruction(interpreter->getOpcode(static_cast<OpcodeID>(opcodeID))));
+        for (int j = 1; j < opcodeLengths[opcodeID]; ++j) {
+            if (opcodeID == op_jneq_ptr && j == 2) {
+                uint32_t cell;
+                if (!decoder.decodeUInt32(cell))
+                    return false;
+                if (cell == CallFunctionCell)
+                    m_callFunctionOperands.append(m_instructions.size());
+                else if (cell == ApplyFunctionCell)
+                    m_applyFunctionOperands.append(m_instructions.size());
+                else
+                    return false;
+                m_instructions.append(Instruction(0));
+                continue;
+            }
+            int operand;
+            if (!decoder.decodeInt(operand))
+                return false;
+            m_instructions.append(Instruction(operand));
+        }
+    }
+
+    if (!decoder.decodeCount(size))
+        return false;
+    m_identifiers.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        if (!decoder.decodeIdentifier(m_identifiers[i]))
+            return false;
+    }
+
+    if (!decoder.decodeCount(size))
+        return false;
+    m_constants.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        if (!decodeConstant(decoder, m_constants[i], 0) || m_constants[i].type == ConstantRegister)
+            return false;
+    }
+
+    if (!decoder.decodeCount(size))
+        return false;
+    m_functionDecls.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        if (!decodeFunction(decoder, m_functionDecls[i]))
+            return false;
+    }
+    if (!decoder.decodeCount(size))
+        return false;
+    m_functionExprs.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        if (!decodeFunction(decoder, m_functionExprs[i]))
+            return false;
+    }
+
+    Vector<unsigned>* offsetVectors[] = { &m_jumpTargets, &m_globalResolveInfos, &m_globalResolveInstructions, &m_propertyAccessInstructions };
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(offsetVectors); ++i) {
+        if (!decoder.decodeCount(size))
+            return false;
+        offsetVectors[i]->resize(size);
+        for (uint32_t j = 0; j < size; ++j) {
+            if (!decoder.decodeUnsigned(offsetVectors[i]->at(j)))
+                return false;
+        }
+    }
+
+    bool hasRareData;
+    if (!decoder.decodeBool(hasRareData))
+        return false;
+    if (hasRareData) {
+        if (!decoder.decodeCount(size))
+            return false;
+        m_exceptionHandlers.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            HandlerInfo& handler = m_exceptionHandlers[i];
+            if (!decoder.decodeUInt32(handler.start) || !decoder.decodeUInt32(handler.end) || !decoder.decodeUInt32(handler.target) || !decoder.decodeUInt32(handler.scopeDepth))
+                return false;
+        }
+
+        if (!decoder.decodeCount(size))
+            return false;
+        m_regExps.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!decoder.decodeUString(m_regExps[i].first) || m_regExps[i].first.isNull() || !decoder.decodeUnsigned(m_regExps[i].second) || m_regExps[i].second > InvalidFlags)
+                return false;
+        }
+
+        if (!decoder.decodeCount(size))
+            return false;
+        m_constantBuffers.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            uint32_t length;
+            if (!decoder.decodeCount(length))
+                return false;
+            m_constantBuffers[i].resize(length);
+            for (uint32_t j = 0; j < length; ++j) {
+                if (!decodeConstant(decoder, m_constantBuffers[i][j], m_constants.size()))
+                    return false;
+            }
+        }
+
+        if (!decoder.decodeCount(size))
+            return false;
+        m_immediateSwitchJumpTables.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!decodeSimpleJumpTable(decoder, m_immediateSwitchJumpTables[i]))
+                return false;
+        }
+        if (!decoder.decodeCount(size))
+            return false;
+        m_characterSwitchJumpTables.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!decodeSimpleJumpTable(decoder, m_characterSwitchJumpTables[i]))
+                return false;
+        }
+        if (!decoder.decodeCount(size))
+            return false;
+        m_stringSwitchJumpTables.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            uint32_t tableSize;
+            if (!decoder.decodeCount(tableSize))
+                return false;
+            m_stringSwitchJumpTables[i].resize(tableSize);
+            for (uint32_t j = 0; j < tableSize; ++j) {
+                StringJumpTableEntry& entry = m_stringSwitchJumpTables[i][j];
+                if (!decoder.decodeIdentifier(entry.string) || entry.string.isNull() || !decoder.decodeInt32(entry.branchOffset))
+                    return false;
+            }
+        }
+
+        if (!decoder.decodeCount(size))
+            return false;
+        m_expressionInfo.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            uint32_t instructionOffset;
+            uint32_t divotPoint;
+            uint32_t startOffset;
+            uint32_t endOffset;
+            if (!decoder.decodeUInt32(instructionOffset) || !decoder.decodeUInt32(divotPoint) || !decoder.decodeUInt32(startOffset) || !decoder.decodeUInt32(endOffset))
+                return false;
+            ExpressionRangeInfo& info = m_expressionInfo[i];
+            info.instructionOffset = instructionOffset;
+            info.divotPoint = divotPoint;
+            info.startOffset = startOffset;
+            info.endOffset = endOffset;
+        }
+
+        if (!decoder.decodeCount(size))
+            return false;
+        m_lineInfo.resize(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!decoder.decodeUInt32(m_lineInfo[i].instructionOffset) || !decoder.decodeInt32(m_lineInfo[i].lineNumber))
+                return false;
+        }
+    }
+
+    if (!decoder.decodeCount(size))
+        return false;
+    m_symbolTable.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        int index;
+        unsigned attributes;
+        if (!decoder.decodeIdentifier(m_symbolTable[i].first) || m_symbolTable[i].first.isNull() || !decoder.decodeInt(index) || !decoder.decodeUnsigned(attributes))
+            return false;
+        m_symbolTable[i].second = SymbolTableEntry(index, attributes);
+    }
+
+    return decoder.decodeInt(m_numCalleeRegisters)
+        && decoder.decodeInt(m_numVars)
+        && decoder.decodeInt(m_numCapturedVars)
+        && decoder.decodeInt(m_numParameters)
+        && decoder.decodeInt(m_thisRegister)
+        && decoder.decodeInt(m_argumentsRegister)
+        && decoder.decodeInt(m_activationRegister)
+        && decoder.decodeBool(m_needsFullScopeChain)
+        && decoder.decodeBool(m_isNumericCompareFunction)
+        && decoder.atEnd();
+}
+
+void CachedBytecode::fill(CodeBlock* codeBlock, ScopeChainNode* scopeChain)
+{
+    JSGlobalData& globalData = *scopeChain->globalData;
+    JSGlobalObject* globalObject = scopeChain->globalObject.get();
+    SourceProvider* provider = codeBlock->source();
+
+    codeBlock->setGlobalData(&globalData);
+    codeBlock->m_numCalleeRegisters = m_numCalleeRegisters;
+    codeBlock->m_numVars = m_numVars;
+    codeBlock->m_numCapturedVars = m_numCapturedVars;
+    codeBlock->m_numParameters = m_numParameters;
+    codeBlock->setThisRegister(m_thisRegister);
+    if (m_argumentsRegister != -1)
+        codeBlock->setArgumentsRegister(m_argumentsRegister);
+    codeBlock->setActivationRegister(m_activationRegister);
+    codeBlock->setNeedsFullScopeChain(m_needsFullScopeChain);
+    codeBlock->setIsNumericCompareFunction(m_isNumericCompareFunction);
+
+    // Whatever is allocated here is kept alive by the code block as soon as it is added to it.
+    codeBlock->m_instructions = m_instructions;
+    for (size_t i = 0; i < m_callFunctionOperands.size(); ++i)
+        codeBlock->m_instructions[m_callFunctionOperands[i]] = Instruction(globalData, codeBlock->ownerExecutable(), globalObject->callFunction());
+    for (size_t i = 0; i < m_applyFunctionOperands.size(); ++i)
+        codeBlock->m_instructions[m_applyFunctionOperands[i]] = Instruction(globalData, codeBlock->ownerExecutable(), globalObject->applyFunction());
+#ifndef NDEBUG
+    codeBlock->setInstructionCount(m_instructions.size());
+#endif
+
+    for (size_t i = 0; i < m_identifiers.size(); ++i)
+        codeBlock->addIdentifier(m_identifiers[i]);
+    for (size_t i = 0; i < m_constants.size(); ++i)
+        codeBlock->addConstant(createConstant(globalData, globalObject, codeBlock, m_constants[i]));
+    for (size_t i = 0; i < m_functionDecls.size(); ++i)
+        codeBlock->addFunctionDecl(createFunction(globalData, provider, m_functionDecls[i]));
+    for (size_t i = 0; i < m_functionExprs.size(); ++i)
+        codeBlock->addFunctionExpr(createFunction(globalData, provider, m_functionExprs[i]));
+
+    for (size_t i = 0; i < m_jumpTargets.size(); ++i)
+        codeBlock->addJumpTarget(m_jumpTargets[i]);
+#if ENABLE(JIT)
+    for (size_t i = 0; i < m_globalResolveInfos.size(); ++i)
+        codeBlock->addGlobalResolveInfo(m_globalResolveInfos[i]);
+#endif
+#if ENABLE(INTERPRETER)
+    for (size_t i = 0; i < m_globalResolveInstructions.size(); ++i)
+        codeBlock->addGlobalResolveInstruction(m_globalResolveInstructions[i]);
+    for (size_t i = 0; i < m_propertyAccessInstructions.size(); ++i)
+        codeBlock->addPropertyAccessInstruction(m_propertyAccessInstructions[i]);
+#endif
+
+    for (size_t i = 0; i < m_exceptionHandlers.size(); ++i)
+        codeBlock->addExceptionHandler(m_exceptionHandlers[i]);
+    for (size_t i = 0; i < m_regExps.size(); ++i)
+        codeBlock->addRegExp(RegExp::create(globalData, m_regExps[i].first, static_cast<RegExpFlags>(m_regExps[i].second)));
+    for (size_t i = 0; i < m_constantBuffers.size(); ++i) {
+        const Vector<Constant>& constants = m_constantBuffers[i];
+        JSValue* buffer = codeBlock->constantBuffer(codeBlock->addConstantBuffer(constants.size()));
+        for (size_t j = 0; j < constants.size(); ++j)
+            buffer[j] = createConstant(globalData, globalObject, codeBlock, constants[j]);
+    }
+    for (size_t i = 0; i < m_immediateSwitchJumpTables.size(); ++i)
+        codeBlock->addImmediateSwitchJumpTable() = m_immediateSwitchJumpTables[i];
+    for (size_t i = 0; i < m_characterSwitchJumpTables.size(); ++i)
+        codeBlock->addCharacterSwitchJumpTable() = m_characterSwitchJumpTables[i];
+    for (size_t i = 0; i < m_stringSwitchJumpTables.size(); ++i) {
+        StringJumpTable& table = codeBlock->addStringSwitchJumpTable();
+        const Vector<StringJumpTableEntry>& entries = m_stringSwitchJumpTables[i];
+        for (size_t j = 0; j < entries.size(); ++j) {
+            OffsetLocation location;
+            location.branchOffset = entries[j].branchOffset;
+            table.offsetTable.add(entries[j].string.impl(), location);
+        }
+    }
+    for (size_t i = 0; i < m_expressionInfo.size(); ++i)
+        codeBlock->addExpressionInfo(m_expressionInfo[i]);
+    for (size_t i = 0; i < m_lineInfo.size(); ++i)
+        codeBlock->addLineInfo(m_lineInfo[i].instructionOffset, m_lineInfo[i].lineNumber);
+
+    for (size_t i = 0; i < m_symbolTable.size(); ++i)
+        codeBlock->symbolTable()->add(m_symbolTable[i].first.impl(), m_symbolTable[i].second);
+
+    codeBlock->shrinkToFit();
+}
+
+// An entry is a checksum of its data, then the flags it was generated with,
+// what the parser recorded, the declarations of program code, the scope
+// chain record and the code block.
+PassOwnPtr<CachedBytecode> BytecodeCache::find(ScriptExecutable* executable, EntryKind kind, ScopeChainNode* scopeChain, bool declaresGlobals)
+{
+    const SourceCode& source = executable->source();
+    SourceFile* file = sourceFile(source.provider());
+    const uint8_t* data;
+    size_t size;
+    if (!file || !file->find(kind, source.startOffset(), source.endOffset(), data, size) || size < checksumSize)
+        return PassOwnPtr<CachedBytecode>();
+
+    Vector<uint8_t, 20> checksum;
+    computeChecksum(data + checksumSize, size - checksumSize, checksum);
+    if (memcmp(checksum.data(), data, checksumSize))
+        return PassOwnPtr<CachedBytecode>();
+
+    BytecodeDecoder decoder(scopeChain->globalData, data + checksumSize, size - checksumSize);
+    OwnPtr<CachedBytecode> cached = adoptPtr(new CachedBytecode);
+    uint32_t flags;
+    uint32_t features;
+    if (!decoder.decodeUInt32(flags) || flags != entryFlags(executable, kind != ProgramEntry, scopeChain)
+        || !decoder.decodeUInt32(features)
+        || !decoder.decodeBool(cached->hasCapturedVariables)
+        || !decoder.decodeInt(cached->lineNo)
+        || !decoder.decodeInt(cached->lastLine))
+        return PassOwnPtr<CachedBytecode>();
+    cached->features = features;
+
+    if (kind == ProgramEntry) {
+        uint32_t size;
+        if (!decoder.decodeCount(size))
+            return PassOwnPtr<CachedBytecode>();
+        Vector<CachedBytecode::Function> functions(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!CachedBytecode::decodeFunction(decoder, functions[i]))
+                return PassOwnPtr<CachedBytecode>();
+        }
+        if (!decoder.decodeCount(size))
+            return PassOwnPtr<CachedBytecode>();
+        Vector<std::pair<Identifier, bool> > vars(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!decoder.decodeIdentifier(vars[i].first) || vars[i].first.isNull() || !decoder.decodeBool(vars[i].second))
+                return PassOwnPtr<CachedBytecode>();
+        }
+
+        // The generator resolved names to the globals the program declares,
+        // so they have to be in place before the scope chain is checked. If
+        // the check fails, generating the bytecode declares them again, which
+        // is harmless.
+        if (declaresGlobals) {
+            JSGlobalData& globalData = *scopeChain->globalData;
+            JSGlobalObject* globalObject = scopeChain->globalObject.get();
+            ExecState* exec = globalObject->globalExec();
+            SymbolTable& symbolTable = globalObject->symbolTable();
+
+            BatchedTransitionOptimizer optimizer(globalData, globalObject);
+            if (size_t newGlobals = vars.size() + functions.size()) {
+                globalObject->resizeRegisters(symbolTable.size() + newGlobals);
+                for (size_t i = 0; i < functions.size(); ++i)
+                    BytecodeGenerator::declareGlobalFunction(exec, scopeChain, symbolTable, CachedBytecode::createFunction(globalData, source.provider(), functions[i]));
+                for (size_t i = 0; i < vars.size(); ++i)
+                    BytecodeGenerator::declareGlobalVariable(exec, scopeChain, symbolTable, vars[i].first, vars[i].second);
+            }
+        }
+    }
+
+    if (!scopeChainMatches(decoder, scopeChain) || !cached->decode(decoder, scopeChain->globalData->interpreter))
+        return PassOwnPtr<CachedBytecode>();
+    return cached.release();
+}
+
+void BytecodeCache::store(ScriptExecutable* executable, EntryKind kind, ScopeNode* node, CodeBlock* codeBlock, const BytecodeGenerator& generator, ScopeChainNode* scopeChain)
+{
+    const SourceCode& source = executable->source();
+    SourceFile* file = sourceFile(source.provider());
+    if (!file)
+        return;
+
+    BytecodeEncoder encoder;
+    encoder.encodeUInt32(entryFlags(executable, kind != ProgramEntry, scopeChain));
+    encoder.encodeUInt32(node->features());
+    encoder.encodeBool(node->hasCapturedVariables());
+    encoder.encodeInt32(node->lineNo());
+    encoder.encodeInt32(node->lastLine());
+
+    if (kind == ProgramEntry) {
+        ProgramNode* programNode = static_cast<ProgramNode*>(node);
+        const DeclarationStacks::FunctionStack& functionStack = programNode->functionStack();
+        encoder.encodeUInt32(functionStack.size());
+        for (size_t i = 0; i < functionStack.size(); ++i)
+            encodeFunction(encoder, functionStack[i]);
+        const DeclarationStacks::VarStack& varStack = programNode->varStack();
+        encoder.encodeUInt32(varStack.size());
+        for (size_t i = 0; i < varStack.size(); ++i) {
+            encoder.encodeIdentifier(*varStack[i].first);
+            encoder.encodeBool(varStack[i].second & DeclarationStacks::IsConstant);
+        }
+    }
+
+    encodeScopeChain(encoder, scopeChain, generator.scopedNames());
+    if (!CachedBytecode::encode(encoder, codeBlock))
+        return;
+
+    Vector<uint8_t, 20> checksum;
+    computeChecksum(encoder.buffer().data(), encoder.buffer().size(), checksum);
+    Vector<uint8_t> entry;
+    entry.reserveInitialCapacity(checksumSize + encoder.buffer().size());
+    entry.append(checksum.data(), checksumSize);
+    entry.append(encoder.buffer().data(), encoder.buffer().size());
+    file->add(kind, source.startOffset(), source.endOffset(), entry);
+}
+
+PassOwnPtr<CachedBytecode> BytecodeCache::findProgram(ProgramExecutable* executable, ScopeChainNode* scopeChain, bool declaresGlobals)
+{
+    return find(executable, ProgramEntry, scopeChain, declaresGlobals);
+}
+
+PassOwnPtr<CachedBytecode> BytecodeCache::findFunction(FunctionExecutable* executable, CodeSpecializationKind kind, ScopeChainNode* scopeChain)
+{
+    return find(executable, kind == CodeForCall ? FunctionCallEntry : FunctionConstructEntry, scopeChain, false);
+}
+
+void BytecodeCache::storeProgram(ProgramExecutable* executable, ProgramNode* programNode, ProgramCodeBlock* codeBlock, const BytecodeGenerator& generator, ScopeChainNode* scopeChain)
+{
+    store(executable, ProgramEntry, programNode, codeBlock, generator, scopeChain);
+}
+
+void BytecodeCache::storeFunction(FunctionExecutable* executable, CodeSpecializationKind kind, FunctionBodyNode* body, FunctionCodeBlock* codeBlock, const BytecodeGenerator& generator, ScopeChainNode* scopeChain)
+{
+    store(executable, kind == CodeForCall ? FunctionCallEntry : FunctionConstructEntry, body, codeBlock, generator, scopeChain);
+}
+
+} // namespace JSC
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BytecodeCache_h
+#define BytecodeCache_h
+
+#include "CodeBlock.h"
+#include "Executable.h"
+#include "Identifier.h"
+#include "Instruction.h"
+#include "JumpTable.h"
+#include "Nodes.h"
+#include "UString.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace JSC {
+
+    class BytecodeDecoder;
+    class BytecodeEncoder;
+    class BytecodeGenerator;
+    class ScopeChainNode;
+
+    // The bytecode of one executable, as read back from the cache. Holds no
+    // cells, so a CachedBytecode may be kept across garbage collections; fill()
+    // creates the constants, functions and regular expressions it refers to.
+    class CachedBytecode {
+        WTF_MAKE_NONCOPYABLE(CachedBytecode); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        CachedBytecode() { }
+
+        // What the parser would have recorded on the executable.
+        CodeFeatures features;
+        bool hasCapturedVariables;
+        int lineNo;
+        int lastLine;
+
+        // Fills in a freshly constructed code block, as BytecodeGenerator::generate() would.
+        void fill(CodeBlock*, ScopeChainNode*);
+
+    private:
+        friend class BytecodeCache;
+
+        enum ConstantType { ConstantInt32, ConstantDouble, ConstantBoolean, ConstantNull, ConstantUndefined, ConstantEmpty, ConstantString, ConstantGlobalObject, ConstantRegister };
+        struct Constant {
+            ConstantType type;
+            double number;
+            UString string;
+        };
+
+        struct Function {
+            Identifier name;
+            int startOffset;
+            int endOffset;
+            int firstLine;
+            int lineNo;
+            int lastLine;
+            bool forceUsesArguments;
+            bool isStrictMode;
+            RefPtr<FunctionParameters> parameters;
+        };
+
+        struct StringJumpTableEntry {
+            Identifier string;
+            int32_t branchOffset;
+        };
+
+        static bool encode(BytecodeEncoder&, CodeBlock*);
+        bool decode(BytecodeDecoder&, Interpreter*);
+
+        static bool encodeConstant(BytecodeEncoder&, JSValue, CodeBlock*, const HashMap<JSCell*, unsigned>* constantRegisters);
+        static bool decodeConstant(BytecodeDecoder&, Constant&, size_t numberOfConstantRegisters);
+        static bool decodeFunction(BytecodeDecoder&, Function&);
+        static FunctionExecutable* createFunction(JSGlobalData&, SourceProvider*, const Function&);
+        static JSValue createConstant(JSGlobalData&, JSGlobalObject*, CodeBlock*, const Constant&);
+
+        // Positions of the op_jneq_ptr operands that held Function.prototype.call or apply.
+        Vector<unsigned> m_callFunctionOperands;
+        Vector<unsigned> m_applyFunctionOperands;
+
+        Vector<Instruction> m_instructions;
+        Vector<Identifier> m_identifiers;
+        Vector<Constant> m_constants;
+        Vector<Vector<Constant> > m_constantBuffers;
+        Vector<std::pair<UString, unsigned> > m_regExps;
+        Vector<Function> m_functionDecls;
+        Vector<Function> m_functionExprs;
+        Vector<HandlerInfo> m_exceptionHandlers;
+        Vector<SimpleJumpTable> m_immediateSwitchJumpTables;
+        Vector<SimpleJumpTable> m_characterSwitchJumpTables;
+        Vector<Vector<StringJumpTableEntry> > m_stringSwitchJumpTables;
+        Vector<ExpressionRangeInfo> m_expressionInfo;
+        Vector<LineInfo> m_lineInfo;
+        Vector<unsigned> m_jumpTargets;
+        Vector<unsigned> m_globalResolveInfos;
+        Vector<unsigned> m_globalResolveInstructions;
+        Vector<unsigned> m_propertyAccessInstructions;
+        Vector<std::pair<Identifier, SymbolTableEntry> > m_symbolTable;
+
+        int m_numCalleeRegisters;
+        int m_numVars;
+        int m_numCapturedVars;
+        int m_numParameters;
+        int m_thisRegister;
+        int m_argumentsRegister;
+        int m_activationRegister;
+        bool m_needsFullScopeChain;
+        bool m_isNumericCompareFunction;
+    };
+
+    // Keeps the bytecode generated for program and function code on disk, so
+    // that later runs of the same scripts can skip parsing and bytecode
+    // generation. Each source gets a file of its own in the cache directory,
+    // named after a SHA-1 hash of the source text. A file holds an index of
+    // the code blocks generated for the source, by the range of the source
+    // they came from, followed by the encoded code blocks. Files are mapped
+    // into memory where the platform allows, and a code block is only
+    // decoded when its executable is compiled, on its first call.
+    //
+    // Bytecode depends on more than the source: the generator resolves names
+    // on the scope chain it compiles in to registers and global variables. So
+    // every entry records the shape of the scope chain it was generated in,
+    // and what each name the generator looked up resolved to; it is only
+    // reused while they still resolve the same way. Eval code, and sources
+    // that were not loaded from a URL, are not cached.
+    class BytecodeCache {
+        WTF_MAKE_NONCOPYABLE(BytecodeCache); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        static PassOwnPtr<BytecodeCache> create(const UString& directory)
+        {
+            return adoptPtr(new BytecodeCache(directory));
+        }
+        ~BytecodeCache();
+
+        // Returns the cache that code compiled in this scope chain may use.
+        // Code compiled for a debugger or profiler has hooks that cached code
+        // lacks, so none is returned for global objects that have one.
+        static BytecodeCache* forScopeChain(ScopeChainNode*);
+
+        // Return 0 if there is no bytecode that may be reused in this scope
+        // chain. The program's functions and vars are declared on the global
+        // object first if declaresGlobals is set, as BytecodeGenerator does.
+        PassOwnPtr<CachedBytecode> findProgram(ProgramExecutable*, ScopeChainNode*, bool declaresGlobals);
+        PassOwnPtr<CachedBytecode> findFunction(FunctionExecutable*, CodeSpecializationKind, ScopeChainNode*);
+
+        // Record a code block that the generator has just filled in, before
+        // the JIT gets to discard its bytecode.
+        void storeProgram(ProgramExecutable*, ProgramNode*, ProgramCodeBlock*, const BytecodeGenerator&, ScopeChainNode*);
+        void storeFunction(FunctionExecutable*, CodeSpecializationKind, FunctionBodyNode*, FunctionCodeBlock*, const BytecodeGenerator&, ScopeChainNode*);
+
+        // Writes out the files of sources with new entries. Also done on destruction.
+        void flush();
+
+    private:
+        class SourceFile;
+        enum EntryKind { ProgramEntry, FunctionCallEntry, FunctionConstructEntry, NumberOfEntryKinds };
+
+        BytecodeCache(const UString& directory);
+
+        SourceFile* sourceFile(SourceProvider*);
+        PassOwnPtr<CachedBytecode> find(ScriptExecutable*, EntryKind, ScopeChainNode*, bool declaresGlobals);
+        void store(ScriptExecutable*, EntryKind, ScopeNode*, CodeBlock*, const BytecodeGenerator&, ScopeChainNode*);
+
+        UString m_directory;
+        HashMap<String, SourceFile*> m_sourceFiles;
+    };
+
+} // namespace JSC
+
+#endif // BytecodeCache_h
@@ -260,6 +260,9 @@ static void printStructureStubInfo(const StructureStubInfo& stubInfo, unsigned i
     case access_put_by_id_replace:
         printf("  [%4d] %s: %s\n", instructionOffset, "put_by_id_replace", pointerToSourceString(stubInfo.u.putByIdReplace.baseObjectStructure).utf8().data());
         return;
+    case access_put_by_id_list:
+        printf("  [%4d] %s: %s (%d)\n", instructionOffset, "op_put_by_id_list", pointerToSourceString(stubInfo.u.putByIdList.structureList).utf8().data(), stubInfo.u.putByIdList.listSize);
+        return;
     case access_unset:
         printf("  [%4d] %s\n", instructionOffset, "unset");
         return;
@@ -1429,6 +1432,11 @@ CodeBlock::CodeBlock(ScriptExecutable* ownerExecutable, CodeType codeType, JSGlo
     , m_symbolTable(symTab)
     , m_alternative(alternative)
     , m_optimizationDelayCounter(0)
+#if ENABLE(DFG_JIT)
+    , m_numberOfNodesEliminatedByCSE(0)
+    , m_osrExitCounter(0)
+    , m_reoptimizationRetryCounter(0)
+#endif
 {
     ASSERT(m_source);
     
@@ -1536,8 +1544,25 @@ void CodeBlock::visitAggregate(SlotVisitor& visitor)
         WriteBarrier<RegExp>* regexps = m_rareData->m_regexps.data();
         for (size_t i = 0; i < regExpCount; i++)
             visitor.append(regexps + i);
+#if ENABLE(DFG_JIT)
+        // OSR exit and frame reconstruction refer to the inlined functions'
+        // baseline code, so their executables must stay alive with us.
+        for (size_t i = 0; i < m_rareData->m_inlineCallFrames.size(); ++i) {
+            InlineCallFrame& inlineCallFrame = m_rareData->m_inlineCallFrames[i];
+            visitor.append(&inlineCallFrame.executable);
+            visitor.append(&inlineCallFrame.callee);
+        }
+#endif
     }
     visitor.appendValues(m_constantRegisters.data(), m_constantRegisters.size());
+#if ENABLE(JIT)
+    // Both JITs build the constants into the machine code.
+    for (size_t i = 0; i < m_constantRegisters.size(); ++i) {
+        JSValue constant = m_constantRegisters[i].get();
+        if (constant.isCell())
+            Heap::pin(constant.asCell());
+    }
+#endif
     for (size_t i = 0; i < m_functionExprs.size(); ++i)
         visitor.append(&m_functionExprs[i]);
     for (size_t i = 0; i < m_functionDecls.size(); ++i)
@@ -1614,8 +1639,11 @@ void CodeBlock::visitWeakReferences(SlotVisitor&)
                     continue;
                 
                 JSCell* cell = value.asCell();
-                if (Heap::isMarked(cell))
+                if (Heap::isMarked(cell)) {
+                    // The collector cannot update the pointer here.
+                    Heap::pin(cell);
                     continue;
+                }
                 
                 profile->m_buckets[index] = JSValue::encode(JSValue());
                 profile->m_weakBuckets[index] = cell->structure();
@@ -1919,6 +1947,60 @@ JSObject* FunctionCodeBlock::compileOptimized(ExecState* exec, ScopeChainNode* s
     return error;
 }
 
+#if ENABLE(DFG_JIT)
+void ProgramCodeBlock::jettison()
+{
+    ASSERT(getJITType() == JITCode::DFGJIT);
+    static_cast<ProgramExecutable*>(ownerExecutable())->jettisonOptimizedCode(*globalData());
+}
+
+void EvalCodeBlock::jettison()
+{
+    ASSERT(getJITType() == JITCode::DFGJIT);
+    static_cast<EvalExecutable*>(ownerExecutable())->jettisonOptimizedCode(*globalData());
+}
+
+void FunctionCodeBlock::jettison()
+{
+    ASSERT(getJITType() == JITCode::DFGJIT);
+    static_cast<FunctionExecutable*>(ownerExecutable())->jettisonOptimizedCodeFor(*globalData(), m_isConstructor ? CodeForConstruct : CodeForCall);
+}
+
+// Past this, code that keeps exiting is left to wait for as long as the
+// execute counter allows before it is optimized again.
+static const uint8_t maximumReoptimizationRetryCounter = 16;
+
+void CodeBlock::reoptimize()
+{
+    ASSERT(getJITType() == JITCode::BaselineJIT);
+    CodeBlock* optimizedCodeBlock = replacement();
+    ASSERT(optimizedCodeBlock->getJITType() == JITCode::DFGJIT);
+    
+    if (optimizedCodeBlock->m_rareData) {
+        SegmentedVector<DFG::OSRExitCounter, 8>& counters = optimizedCodeBlock->m_rareData->m_osrExitCounters;
+        for (size_t i = 0; i < counters.size(); ++i) {
+            if (counters[i].count() < Options::osrExitCountForFrequentExitSite || counters[i].site().kind() == DFG::Uncountable)
+                continue;
+#if ENABLE(JIT_VERBOSE_OSR)
+            printf("    %u exits at bc#%u (%s)\n", counters[i].count(), counters[i].site().bytecodeOffset(), DFG::exitKindToString(counters[i].site().kind()));
+#endif
+            m_exitProfile.add(counters[i].site());
+        }
+    }
+    
+#if ENABLE(JIT_VERBOSE_OSR)
+    printf("Reoptimizing %p after %u OSR exits from %p.\n", this, optimizedCodeBlock->osrExitCounter(), optimizedCodeBlock);
+#endif
+    
+    optimizedCodeBlock->jettison();
+    ASSERT(replacement() == this);
+    
+    if (m_reoptimizationRetryCounter < maximumReoptimizationRetryCounter)
+        ++m_reoptimizationRetryCounter;
+    optimizeAfterWarmUp();
+}
+#endif
+
 bool ProgramCodeBlock::canCompileWithDFG()
 {
     return DFG::canCompileProgram(this);
@@ -1948,7 +2030,7 @@ bool CodeBlock::shouldOptimizeNow()
     dumpValueProfiles();
 #endif
 
-    if (m_optimizationDelayCounter >= 5)
+    if (m_optimizationDelayCounter >= Options::maximumOptimizationDelay)
         return true;
     
     unsigned numberOfNonArgumentValueProfiles = 0;
@@ -2005,4 +2087,13 @@ void CodeBlock::dumpValueProfiles()
 }
 #endif
 
+#if ENABLE(DFG_JIT)
+CodeBlock* baselineCodeBlockForInlineCallFrame(InlineCallFrame* inlineCallFrame)
+{
+    ASSERT(inlineCallFrame);
+    FunctionExecutable* executable = static_cast<FunctionExecutable*>(inlineCallFrame->executable.get());
+    return executable->generatedBytecodeForCall().baselineVersion();
+}
+#endif
+
 } // namespace JSC
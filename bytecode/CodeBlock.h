@@ -30,7 +30,9 @@
 #ifndef CodeBlock_h
 #define CodeBlock_h
 
+#include "CodeOrigin.h"
 #include "CompactJITCodeMap.h"
+#include "DFGExitProfile.h"
 #include "EvalCodeCache.h"
 #include "Instruction.h"
 #include "JITCode.h"
@@ -38,6 +40,7 @@
 #include "JSGlobalObject.h"
 #include "JumpTable.h"
 #include "Nodes.h"
+#include "Options.h"
 #include "PredictionTracker.h"
 #include "RegExpObject.h"
 #include "UString.h"
@@ -119,6 +122,7 @@ namespace JSC {
         CodeLocationDataLabelPtr hotPathBegin;
         CodeLocationNearCall hotPathOther;
         JITWriteBarrier<JSFunction> callee;
+        unsigned bytecodeIndex;
         bool hasSeenShouldRepatch : 1;
         bool isCall : 1;
         bool isDFG : 1;
@@ -202,6 +206,11 @@ namespace JSC {
         return callLinkInfo->callReturnLocation.executableAddress();
     }
 
+    inline unsigned getCallLinkInfoBytecodeIndex(CallLinkInfo* callLinkInfo)
+    {
+        return callLinkInfo->bytecodeIndex;
+    }
+
     inline void* getMethodCallLinkInfoReturnLocation(MethodCallLinkInfo* methodCallLinkInfo)
     {
         return methodCallLinkInfo->callReturnLocation.executableAddress();
@@ -215,6 +224,7 @@ namespace JSC {
 
     class CodeBlock: public WeakReferenceHarvester {
         WTF_MAKE_FAST_ALLOCATED;
+        friend class CachedBytecode;
         friend class JIT;
     protected:
         CodeBlock(ScriptExecutable* ownerExecutable, CodeType, JSGlobalObject*, PassRefPtr<SourceProvider>, unsigned sourceOffset, SymbolTable*, bool isConstructor, PassOwnPtr<CodeBlock> alternative);
@@ -228,9 +238,50 @@ namespace JSC {
         CodeBlock* alternative() { return m_alternative.get(); }
         PassOwnPtr<CodeBlock> releaseAlternative() { return m_alternative.release(); }
         
+        // The end of the alternative() chain; for optimized code, this is the
+        // baseline code that it exits to.
+        CodeBlock* baselineVersion()
+        {
+            CodeBlock* result = this;
+            while (result->alternative())
+                result = result->alternative();
+            return result;
+        }
+        
         void setPredictions(PassOwnPtr<PredictionTracker> predictions) { m_predictions = predictions; }
         PredictionTracker* predictions() const { return m_predictions.get(); }
 
+#if ENABLE(DFG_JIT)
+        // For optimized code, the number of nodes the DFG's common subexpression
+        // elimination removed while compiling it.
+        unsigned numberOfNodesEliminatedByCSE() const { return m_numberOfNodesEliminatedByCSE; }
+        void setNumberOfNodesEliminatedByCSE(unsigned count) { m_numberOfNodesEliminatedByCSE = count; }
+        
+        // For baseline code, the sites at which the optimized code that it
+        // replaced kept failing its speculation.
+        DFG::ExitProfile& exitProfile() { return m_exitProfile; }
+        
+        // Optimized code counts how often each of its OSR exits is taken, and
+        // how often any of them is. Once the total reaches
+        // osrExitCountForReoptimization(), the baseline code reoptimizes.
+        DFG::OSRExitCounter& addOSRExitCounter(unsigned bytecodeOffset, DFG::ExitKind kind)
+        {
+            createRareDataIfNecessary();
+            m_rareData->m_osrExitCounters.append(DFG::OSRExitCounter(bytecodeOffset, kind));
+            return m_rareData->m_osrExitCounters.last();
+        }
+        uint32_t* addressOfOSRExitCounter() { return &m_osrExitCounter; }
+        uint32_t osrExitCounter() const { return m_osrExitCounter; }
+        
+        // Each time a function is reoptimized, its next optimized code may exit
+        // twice as often before it is thrown away too.
+        uint32_t osrExitCountForReoptimization()
+        {
+            return Options::osrExitCountForReoptimization << baselineVersion()->m_reoptimizationRetryCounter;
+        }
+        bool shouldReoptimizeNow() { return m_osrExitCounter >= osrExitCountForReoptimization(); }
+#endif
+
         void visitAggregate(SlotVisitor&);
         void visitWeakReferences(SlotVisitor&);
 
@@ -276,6 +327,13 @@ namespace JSC {
             return *(binarySearch<CallLinkInfo, void*, getCallLinkInfoReturnLocation>(m_callLinkInfos.begin(), m_callLinkInfos.size(), returnAddress.value()));
         }
 
+        // Only meaningful for baseline code, which links its calls in bytecode order.
+        CallLinkInfo& getCallLinkInfo(unsigned bytecodeIndex)
+        {
+            ASSERT(getJITType() == JITCode::BaselineJIT);
+            return *(binarySearch<CallLinkInfo, unsigned, getCallLinkInfoBytecodeIndex>(m_callLinkInfos.begin(), m_callLinkInfos.size(), bytecodeIndex));
+        }
+
         MethodCallLinkInfo& getMethodCallLinkInfo(ReturnAddressPtr returnAddress)
         {
             return *(binarySearch<MethodCallLinkInfo, void*, getMethodCallLinkInfoReturnLocation>(m_methodCallLinkInfos.begin(), m_methodCallLinkInfos.size(), returnAddress.value()));
@@ -283,6 +341,11 @@ namespace JSC {
 
         unsigned bytecodeOffset(ReturnAddressPtr returnAddress)
         {
+#if ENABLE(DFG_JIT)
+            // Frames reconstructed for inlined calls return into the baseline code of their caller.
+            if (getJITType() == JITCode::DFGJIT && !getJITCode().containsReturnAddress(returnAddress.value()))
+                return baselineVersion()->bytecodeOffset(returnAddress);
+#endif
             if (!m_rareData)
                 return 1;
             Vector<CallReturnOffsetToBytecodeOffset>& callIndices = m_rareData->m_callReturnIndexVector;
@@ -339,6 +402,7 @@ namespace JSC {
             m_jitCodeWithArityCheck = codeWithArityCheck;
         }
         JITCode& getJITCode() { return m_jitCode; }
+        MacroAssemblerCodePtr getJITCodeWithArityCheck() { return m_jitCodeWithArityCheck; }
         JITCode::JITType getJITType() { return m_jitCode.jitType(); }
         ExecutableMemoryHandle* executableMemory() { return getJITCode().getExecutableMemory(); }
         virtual JSObject* compileOptimized(ExecState*, ScopeChainNode*) = 0;
@@ -358,6 +422,16 @@ namespace JSC {
 #endif
             return result;
         }
+#if ENABLE(DFG_JIT)
+        // Called on optimized code: hands its executable back the baseline
+        // code, and leaves the optimized code to the heap to delete once no
+        // call frame is running it anymore.
+        virtual void jettison() = 0;
+        // Called on baseline code whose optimized replacement exits too often:
+        // records where it did in our exitProfile(), jettisons it, and lets
+        // the baseline code warm up again before it is optimized once more.
+        void reoptimize();
+#endif
 #else
         JITCode::JITType getJITType() { return JITCode::BaselineJIT; }
 #endif
@@ -518,6 +592,66 @@ namespace JSC {
         }
 #endif
 
+#if ENABLE(DFG_JIT)
+        // The calls that the DFG inlined into this code block. These need stable
+        // addresses, since CodeOrigins point at them.
+        SegmentedVector<InlineCallFrame, 4>& inlineCallFrames()
+        {
+            createRareDataIfNecessary();
+            return m_rareData->m_inlineCallFrames;
+        }
+        
+        bool hasInlineCallFrames() { return m_rareData && !m_rareData->m_inlineCallFrames.isEmpty(); }
+        
+        // The lowest register that any inlined frame uses, arguments included.
+        unsigned firstInlinedRegister()
+        {
+            unsigned result = std::numeric_limits<unsigned>::max();
+            if (!hasInlineCallFrames())
+                return result;
+            SegmentedVector<InlineCallFrame, 4>& inlineCallFrames = m_rareData->m_inlineCallFrames;
+            for (size_t i = 0; i < inlineCallFrames.size(); ++i) {
+                InlineCallFrame& inlineCallFrame = inlineCallFrames[i];
+                result = std::min<unsigned>(result, inlineCallFrame.stackOffset - RegisterFile::CallFrameHeaderSize - inlineCallFrame.argumentCountIncludingThis);
+            }
+            return result;
+        }
+        
+        // Maps the return addresses of calls made from inlined code back to
+        // where in the inlined function they were made.
+        Vector<CodeOriginAtCallReturnOffset>& codeOrigins()
+        {
+            createRareDataIfNecessary();
+            return m_rareData->m_codeOrigins;
+        }
+        
+        // Returns false if the call at returnAddress was not made from inlined code.
+        bool codeOriginForReturn(ReturnAddressPtr returnAddress, CodeOrigin& codeOrigin)
+        {
+            if (!hasInlineCallFrames())
+                return false;
+            if (!getJITCode().containsReturnAddress(returnAddress.value()))
+                return false;
+            Vector<CodeOriginAtCallReturnOffset>& codeOrigins = m_rareData->m_codeOrigins;
+            unsigned callReturnOffset = getJITCode().offsetOf(returnAddress.value());
+            // Calls made from the machine code block itself are not recorded, so this is
+            // a lookup that may fail rather than a binarySearch.
+            size_t low = 0;
+            size_t high = codeOrigins.size();
+            while (low < high) {
+                size_t middle = (low + high) / 2;
+                if (codeOrigins[middle].callReturnOffset < callReturnOffset)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            if (low == codeOrigins.size() || codeOrigins[low].callReturnOffset != callReturnOffset)
+                return false;
+            codeOrigin = codeOrigins[low].codeOrigin;
+            return true;
+        }
+#endif
+
         // Constant Pool
 
         size_t numberOfIdentifiers() const { return m_identifiers.size(); }
@@ -629,7 +763,7 @@ namespace JSC {
         // optimizeAfterWarmUp() from JIT-generated code.
         int32_t counterValueForOptimizeAfterWarmUp()
         {
-            return -1000;
+            return Options::executionCounterValueForOptimizeAfterWarmUp;
         }
         
         int32_t* addressOfExecuteCounter()
@@ -686,7 +820,7 @@ namespace JSC {
         // in the baseline code.
         void optimizeSoon()
         {
-            m_executeCounter = -100;
+            m_executeCounter = Options::executionCounterValueForOptimizeSoon;
         }
         
         // The amount by which the JIT will increment m_executeCounter.
@@ -790,6 +924,12 @@ namespace JSC {
 
         int32_t m_executeCounter;
         uint8_t m_optimizationDelayCounter;
+#if ENABLE(DFG_JIT)
+        unsigned m_numberOfNodesEliminatedByCSE;
+        uint32_t m_osrExitCounter;
+        uint8_t m_reoptimizationRetryCounter;
+        DFG::ExitProfile m_exitProfile;
+#endif
 
         struct RareData {
            WTF_MAKE_FAST_ALLOCATED;
@@ -815,6 +955,11 @@ namespace JSC {
             Vector<LineInfo> m_lineInfo;
 #if ENABLE(JIT)
             Vector<CallReturnOffsetToBytecodeOffset> m_callReturnIndexVector;
+#endif
+#if ENABLE(DFG_JIT)
+            SegmentedVector<InlineCallFrame, 4> m_inlineCallFrames;
+            Vector<CodeOriginAtCallReturnOffset> m_codeOrigins;
+            SegmentedVector<DFG::OSRExitCounter, 8> m_osrExitCounters;
 #endif
         };
 #if COMPILER(MSVC)
@@ -848,6 +993,9 @@ namespace JSC {
     protected:
         virtual JSObject* compileOptimized(ExecState*, ScopeChainNode*);
         virtual CodeBlock* replacement();
+#if ENABLE(DFG_JIT)
+        virtual void jettison();
+#endif
         virtual bool canCompileWithDFG();
 #endif
     };
@@ -874,6 +1022,9 @@ namespace JSC {
     protected:
         virtual JSObject* compileOptimized(ExecState*, ScopeChainNode*);
         virtual CodeBlock* replacement();
+#if ENABLE(DFG_JIT)
+        virtual void jettison();
+#endif
         virtual bool canCompileWithDFG();
 #endif
 
@@ -901,6 +1052,9 @@ namespace JSC {
     protected:
         virtual JSObject* compileOptimized(ExecState*, ScopeChainNode*);
         virtual CodeBlock* replacement();
+#if ENABLE(DFG_JIT)
+        virtual void jettison();
+#endif
         virtual bool canCompileWithDFG();
 #endif
     };
@@ -919,6 +1073,12 @@ namespace JSC {
         return this[index];
     }
     
+#if ENABLE(DFG_JIT)
+    // The baseline code of a function that the DFG inlined; this is what we
+    // exit to, and what describes the inlined frame to the rest of the runtime.
+    CodeBlock* baselineCodeBlockForInlineCallFrame(InlineCallFrame*);
+#endif
+    
 } // namespace JSC
 
 #endif // CodeBlock_h
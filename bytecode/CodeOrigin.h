@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CodeOrigin_h
+#define CodeOrigin_h
+
+#include "WriteBarrier.h"
+#include <limits>
+
+namespace JSC {
+
+class JSFunction;
+class ScriptExecutable;
+struct InlineCallFrame;
+
+// Information used to map back from an exception to any handler/source information,
+// and to implement OSR. Code that the DFG inlined into its caller records the
+// frame it was inlined as, alongside the bytecode index into the callee.
+class CodeOrigin {
+public:
+    CodeOrigin()
+        : m_bytecodeIndex(std::numeric_limits<uint32_t>::max())
+        , m_inlineCallFrame(0)
+    {
+    }
+    
+    explicit CodeOrigin(uint32_t bytecodeIndex, InlineCallFrame* inlineCallFrame = 0)
+        : m_bytecodeIndex(bytecodeIndex)
+        , m_inlineCallFrame(inlineCallFrame)
+    {
+    }
+    
+    bool isSet() const { return m_bytecodeIndex != std::numeric_limits<uint32_t>::max(); }
+    
+    uint32_t bytecodeIndex() const
+    {
+        ASSERT(isSet());
+        return m_bytecodeIndex;
+    }
+    
+    // Null if this code belongs to the machine code block itself.
+    InlineCallFrame* inlineCallFrame() const { return m_inlineCallFrame; }
+    
+    // The bytecode index in the machine code block; for inlined code, this is
+    // the index of the outermost call that the code was inlined through.
+    inline uint32_t bytecodeIndexInMachineCodeBlock() const;
+    
+    // The number of functions that were inlined to reach this code.
+    inline unsigned inlineDepth() const;
+    
+    bool operator==(const CodeOrigin& other) const
+    {
+        return m_bytecodeIndex == other.m_bytecodeIndex
+            && m_inlineCallFrame == other.m_inlineCallFrame;
+    }
+    
+    bool operator!=(const CodeOrigin& other) const { return !(*this == other); }
+    
+private:
+    uint32_t m_bytecodeIndex;
+    InlineCallFrame* m_inlineCallFrame;
+};
+
+// Describes a call that the DFG inlined. The callee's registers occupy the
+// caller's frame starting at stackOffset, exactly where the callee's own frame
+// would have been, so reconstructing the frame only requires writing its header.
+struct InlineCallFrame {
+    WriteBarrier<ScriptExecutable> executable;
+    WriteBarrier<JSFunction> callee;
+    CodeOrigin caller;
+    int stackOffset;
+    unsigned argumentCountIncludingThis;
+};
+
+struct CodeOriginAtCallReturnOffset {
+    CodeOrigin codeOrigin;
+    unsigned callReturnOffset;
+};
+
+inline uint32_t CodeOrigin::bytecodeIndexInMachineCodeBlock() const
+{
+    const CodeOrigin* codeOrigin = this;
+    while (codeOrigin->inlineCallFrame())
+        codeOrigin = &codeOrigin->inlineCallFrame()->caller;
+    return codeOrigin->bytecodeIndex();
+}
+
+inline unsigned CodeOrigin::inlineDepth() const
+{
+    unsigned result = 0;
+    for (InlineCallFrame* inlineCallFrame = m_inlineCallFrame; inlineCallFrame; inlineCallFrame = inlineCallFrame->caller.inlineCallFrame())
+        ++result;
+    return result;
+}
+
+} // namespace JSC
+
+#endif // CodeOrigin_h
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "DFGExitProfile.h"
+
+#if ENABLE(DFG_JIT)
+
+#include <wtf/PassOwnPtr.h>
+
+namespace JSC { namespace DFG {
+
+const char* exitKindToString(ExitKind kind)
+{
+    switch (kind) {
+    case BadType:
+        return "BadType";
+    case Overflow:
+        return "Overflow";
+    case NegativeZero:
+        return "NegativeZero";
+    case OutOfBounds:
+        return "OutOfBounds";
+    case Uncountable:
+        return "Uncountable";
+    }
+    ASSERT_NOT_REACHED();
+    return "Unknown";
+}
+
+ExitProfile::ExitProfile()
+{
+}
+
+ExitProfile::~ExitProfile()
+{
+}
+
+bool ExitProfile::add(const FrequentExitSite& site)
+{
+    if (!m_frequentExitSites)
+        m_frequentExitSites = adoptPtr(new Vector<FrequentExitSite>());
+    else if (hasExitSite(site))
+        return false;
+    m_frequentExitSites->append(site);
+    return true;
+}
+
+bool ExitProfile::hasExitSite(const FrequentExitSite& site) const
+{
+    if (!m_frequentExitSites)
+        return false;
+    for (size_t i = 0; i < m_frequentExitSites->size(); ++i) {
+        if (m_frequentExitSites->at(i) == site)
+            return true;
+    }
+    return false;
+}
+
+bool ExitProfile::hasExitSite(unsigned bytecodeOffset) const
+{
+    if (!m_frequentExitSites)
+        return false;
+    for (size_t i = 0; i < m_frequentExitSites->size(); ++i) {
+        if (m_frequentExitSites->at(i).bytecodeOffset() == bytecodeOffset)
+            return true;
+    }
+    return false;
+}
+
+bool ExitProfile::hasExitSite(ExitKind kind) const
+{
+    if (!m_frequentExitSites)
+        return false;
+    for (size_t i = 0; i < m_frequentExitSites->size(); ++i) {
+        if (m_frequentExitSites->at(i).kind() == kind)
+            return true;
+    }
+    return false;
+}
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(DFG_JIT)
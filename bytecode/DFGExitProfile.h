@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef DFGExitProfile_h
+#define DFGExitProfile_h
+
+#include <wtf/Platform.h>
+
+#if ENABLE(DFG_JIT)
+
+#include <wtf/OwnPtr.h>
+#include <wtf/Vector.h>
+
+namespace JSC { namespace DFG {
+
+// Why a speculation check of optimized code failed.
+enum ExitKind {
+    BadType, // A value was not of the type that the code was specialized for.
+    Overflow, // Integer arithmetic overflowed.
+    NegativeZero, // Integer arithmetic would have produced -0.
+    OutOfBounds, // An array access fell outside of the array's storage.
+    Uncountable // Anything else; recompiling would not avoid it.
+};
+
+const char* exitKindToString(ExitKind);
+
+// An OSR exit that optimized code took often enough to be worth avoiding.
+// Exits from inlined code are attributed to the outermost call that the code
+// was inlined through.
+class FrequentExitSite {
+public:
+    FrequentExitSite(unsigned bytecodeOffset, ExitKind kind)
+        : m_bytecodeOffset(bytecodeOffset)
+        , m_kind(kind)
+    {
+    }
+    
+    unsigned bytecodeOffset() const { return m_bytecodeOffset; }
+    ExitKind kind() const { return m_kind; }
+    
+    bool operator==(const FrequentExitSite& other) const
+    {
+        return m_bytecodeOffset == other.m_bytecodeOffset
+            && m_kind == other.m_kind;
+    }
+    
+private:
+    unsigned m_bytecodeOffset;
+    ExitKind m_kind;
+};
+
+// Counts how often one OSR exit of optimized code is taken. Generated code
+// increments the count in place.
+class OSRExitCounter {
+public:
+    OSRExitCounter(unsigned bytecodeOffset, ExitKind kind)
+        : m_site(bytecodeOffset, kind)
+        , m_count(0)
+    {
+    }
+    
+    const FrequentExitSite& site() const { return m_site; }
+    uint32_t count() const { return m_count; }
+    uint32_t* addressOfCount() { return &m_count; }
+    
+private:
+    FrequentExitSite m_site;
+    uint32_t m_count;
+};
+
+// The frequent exit sites of all the optimized code that a baseline CodeBlock
+// has thrown away. The DFG does not repeat the speculations that failed at
+// these sites when it compiles the code again.
+class ExitProfile {
+public:
+    ExitProfile();
+    ~ExitProfile();
+    
+    // Returns false if the site was already known.
+    bool add(const FrequentExitSite&);
+    
+    bool hasExitSite(const FrequentExitSite&) const;
+    bool hasExitSite(unsigned bytecodeOffset) const;
+    bool hasExitSite(ExitKind) const;
+    
+private:
+    // Most code never gets here, so the sites are allocated lazily.
+    OwnPtr<Vector<FrequentExitSite> > m_frequentExitSites;
+};
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(DFG_JIT)
+
+#endif // DFGExitProfile_h
@@ -61,6 +61,9 @@ const char* predictionToString(PredictedType value)
     if (value & PredictArray)
         ptr.strcat("Array");
     
+    if (value & PredictByteArray)
+        ptr.strcat("Bytearray");
+    
     if (value & PredictString)
         ptr.strcat("String");
     
@@ -97,6 +100,9 @@ PredictedType predictionFromValue(JSValue value)
         if (classInfo == &JSArray::s_info)
             return PredictArray;
         
+        if (classInfo->isSubClassOf(&JSByteArray::s_defaultInfo))
+            return PredictByteArray;
+        
         if (classInfo == &JSString::s_info)
             return PredictString;
         
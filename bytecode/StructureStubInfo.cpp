@@ -45,6 +45,11 @@ void StructureStubInfo::deref()
         delete polymorphicStructures;
         return;
     }
+    case access_put_by_id_list: {
+        PolymorphicAccessStructureList* polymorphicStructures = u.putByIdList.structureList;
+        delete polymorphicStructures;
+        return;
+    }
     case access_get_by_id_self:
     case access_get_by_id_proto:
     case access_get_by_id_chain:
@@ -86,6 +91,11 @@ void StructureStubInfo::visitAggregate(SlotVisitor& visitor)
         polymorphicStructures->visitAggregate(visitor, u.getByIdProtoList.listSize);
         return;
     }
+    case access_put_by_id_list: {
+        PolymorphicAccessStructureList* polymorphicStructures = u.putByIdList.structureList;
+        polymorphicStructures->visitAggregate(visitor, u.putByIdList.listSize);
+        return;
+    }
     case access_put_by_id_transition:
         visitor.append(&u.putByIdTransition.previousStructure);
         visitor.append(&u.putByIdTransition.structure);
@@ -105,6 +115,60 @@ void StructureStubInfo::visitAggregate(SlotVisitor& visitor)
         ASSERT_NOT_REACHED();
     }
 }
+
+int StructureStubInfo::numberOfCachedStructures() const
+{
+    switch (accessType) {
+    case access_get_by_id_self:
+    case access_get_by_id_proto:
+    case access_get_by_id_chain:
+    case access_put_by_id_transition:
+    case access_put_by_id_replace:
+        return 1;
+    case access_get_by_id_self_list:
+        return u.getByIdSelfList.listSize;
+    case access_get_by_id_proto_list:
+        return u.getByIdProtoList.listSize;
+    case access_put_by_id_list:
+        return u.putByIdList.listSize;
+    default:
+        return 0;
+    }
+}
+
+const char* StructureStubInfo::accessTypeName(AccessType accessType)
+{
+    switch (accessType) {
+    case access_get_by_id_self:
+        return "get_by_id_self";
+    case access_get_by_id_proto:
+        return "get_by_id_proto";
+    case access_get_by_id_chain:
+        return "get_by_id_chain";
+    case access_get_by_id_self_list:
+        return "get_by_id_self_list";
+    case access_get_by_id_proto_list:
+        return "get_by_id_proto_list";
+    case access_put_by_id_transition:
+        return "put_by_id_transition";
+    case access_put_by_id_replace:
+        return "put_by_id_replace";
+    case access_put_by_id_list:
+        return "put_by_id_list";
+    case access_unset:
+        return "unset";
+    case access_get_by_id_generic:
+        return "get_by_id_generic";
+    case access_put_by_id_generic:
+        return "put_by_id_generic";
+    case access_get_array_length:
+        return "get_array_length";
+    case access_get_string_length:
+        return "get_string_length";
+    }
+    ASSERT_NOT_REACHED();
+    return 0;
+}
 #endif
 
 } // namespace JSC
@@ -43,6 +43,7 @@ namespace JSC {
         access_get_by_id_proto_list,
         access_put_by_id_transition,
         access_put_by_id_replace,
+        access_put_by_id_list,
         access_unset,
         access_get_by_id_generic,
         access_put_by_id_generic,
@@ -114,9 +115,21 @@ namespace JSC {
             u.putByIdReplace.baseObjectStructure.set(globalData, owner, baseObjectStructure);
         }
 
+        void initPutByIdList(PolymorphicAccessStructureList* structureList, int listSize)
+        {
+            accessType = access_put_by_id_list;
+
+            u.putByIdList.structureList = structureList;
+            u.putByIdList.listSize = listSize;
+        }
+
         void deref();
         void visitAggregate(SlotVisitor&);
 
+        // The number of structures the site's cache has been specialized for.
+        int numberOfCachedStructures() const;
+        static const char* accessTypeName(AccessType);
+
         bool seenOnce()
         {
             return seen;
@@ -171,6 +184,10 @@ namespace JSC {
             struct {
                 WriteBarrierBase<Structure> baseObjectStructure;
             } putByIdReplace;
+            struct {
+                PolymorphicAccessStructureList* structureList;
+                int listSize;
+            } putByIdList;
         } u;
 
         MacroAssemblerCodeRef stubRoutine;
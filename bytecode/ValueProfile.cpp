@@ -48,6 +48,12 @@ void ValueProfile::computeStatistics(const ClassInfo* classInfo, Statistics& sta
         return;
     }
     
+    if (classInfo->isSubClassOf(&JSByteArray::s_defaultInfo)) {
+        statistics.byteArrays++;
+        statistics.objects++;
+        return;
+    }
+    
     if (classInfo == &JSString::s_info) {
         statistics.strings++;
         return;
@@ -101,6 +107,8 @@ PredictedType ValueProfile::computeUpdatedPrediction()
         prediction = StrongPredictionTag | PredictNumber;
     else if (statistics.arrays == statistics.samples)
         prediction = StrongPredictionTag | PredictArray;
+    else if (statistics.byteArrays == statistics.samples)
+        prediction = StrongPredictionTag | PredictByteArray;
     else if (statistics.finalObjects == statistics.samples)
         prediction = StrongPredictionTag | PredictFinalObject;
     else if (statistics.strings == statistics.samples)
@@ -30,6 +30,7 @@
 #define ValueProfile_h
 
 #include "JSArray.h"
+#include "JSByteArray.h"
 #include "PredictedType.h"
 #include "Structure.h"
 #include "WriteBarrier.h"
@@ -263,6 +264,7 @@ struct ValueProfile {
         unsigned objects;
         unsigned finalObjects;
         unsigned arrays;
+        unsigned byteArrays;
         unsigned strings;
         unsigned booleans;
         
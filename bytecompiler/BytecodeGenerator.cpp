@@ -175,16 +175,34 @@ bool BytecodeGenerator::addVar(const Identifier& ident, bool isConstant, Registe
     return true;
 }
 
-int BytecodeGenerator::addGlobalVar(const Identifier& ident, bool isConstant)
+int BytecodeGenerator::addGlobalVar(SymbolTable& symbolTable, const Identifier& ident, bool isConstant)
 {
-    int index = symbolTable().size();
+    int index = symbolTable.size();
     SymbolTableEntry newEntry(index, isConstant ? ReadOnly : 0);
-    pair<SymbolTable::iterator, bool> result = symbolTable().add(ident.impl(), newEntry);
+    pair<SymbolTable::iterator, bool> result = symbolTable.add(ident.impl(), newEntry);
     if (!result.second)
         index = result.first->second.getIndex();
     return index;
 }
 
+void BytecodeGenerator::declareGlobalFunction(ExecState* exec, ScopeChainNode* scopeChain, SymbolTable& symbolTable, FunctionExecutable* function)
+{
+    JSGlobalObject* globalObject = scopeChain->globalObject.get();
+    JSGlobalData& globalData = exec->globalData();
+    globalObject->removeDirect(globalData, function->name()); // Newly declared functions overwrite existing properties.
+
+    JSValue value = JSFunction::create(exec, function, scopeChain);
+    int index = addGlobalVar(symbolTable, function->name(), false);
+    globalObject->registerAt(index).set(globalData, globalObject, value);
+}
+
+void BytecodeGenerator::declareGlobalVariable(ExecState* exec, ScopeChainNode* scopeChain, SymbolTable& symbolTable, const Identifier& ident, bool isConstant)
+{
+    if (scopeChain->globalObject->hasProperty(exec, ident))
+        return;
+    addGlobalVar(symbolTable, ident, isConstant);
+}
+
 void BytecodeGenerator::preserveLastVar()
 {
     if ((m_firstConstantIndex = m_calleeRegisters.size()) != 0)
@@ -245,20 +263,11 @@ BytecodeGenerator::BytecodeGenerator(ProgramNode* programNode, ScopeChainNode* s
         return;
     globalObject->resizeRegisters(symbolTable->size() + newGlobals);
 
-    for (size_t i = 0; i < functionStack.size(); ++i) {
-        FunctionBodyNode* function = functionStack[i];
-        globalObject->removeDirect(*m_globalData, function->ident()); // Newly declared functions overwrite existing properties.
-
-        JSValue value = JSFunction::create(exec, makeFunction(exec, function), scopeChain);
-        int index = addGlobalVar(function->ident(), false);
-        globalObject->registerAt(index).set(*m_globalData, globalObject, value);
-    }
+    for (size_t i = 0; i < functionStack.size(); ++i)
+        declareGlobalFunction(exec, scopeChain, *symbolTable, makeFunction(exec, functionStack[i]));
 
-    for (size_t i = 0; i < varStack.size(); ++i) {
-        if (globalObject->hasProperty(exec, *varStack[i].first))
-            continue;
-        addGlobalVar(*varStack[i].first, varStack[i].second & DeclarationStacks::IsConstant);
-    }
+    for (size_t i = 0; i < varStack.size(); ++i)
+        declareGlobalVariable(exec, scopeChain, *symbolTable, *varStack[i].first, varStack[i].second & DeclarationStacks::IsConstant);
 }
 
 BytecodeGenerator::BytecodeGenerator(FunctionBodyNode* functionBody, ScopeChainNode* scopeChain, SymbolTable* symbolTable, CodeBlock* codeBlock, CompilationKind)
@@ -1173,7 +1182,7 @@ bool BytecodeGenerator::findScopedProperty(const Identifier& property, int& inde
         if (!currentScope->isVariableObject())
             break;
         JSVariableObject* currentVariableObject = static_cast<JSVariableObject*>(currentScope);
-        SymbolTableEntry entry = currentVariableObject->symbolTable().get(property.impl());
+        SymbolTableEntry entry = scopedSymbolFor(currentVariableObject, property);
 
         // Found the property
         if (!entry.isNull()) {
@@ -1204,6 +1213,13 @@ bool BytecodeGenerator::findScopedProperty(const Identifier& property, int& inde
     return true;
 }
 
+SymbolTableEntry BytecodeGenerator::scopedSymbolFor(JSVariableObject* variableObject, const Identifier& property)
+{
+    if (m_globalData->bytecodeCache)
+        m_scopedNames.add(property.impl());
+    return variableObject->symbolTable().get(property.impl());
+}
+
 void BytecodeGenerator::emitCheckHasInstance(RegisterID* base)
 { 
     emitOpcode(op_check_has_instance);
@@ -47,6 +47,7 @@
 namespace JSC {
 
     class Identifier;
+    class JSVariableObject;
     class ScopeChainNode;
 
     class CallArguments {
@@ -130,6 +131,18 @@ namespace JSC {
         // lookup must begin.
         bool findScopedProperty(const Identifier&, int& index, size_t& depth, bool forWriting, bool& includesDynamicScopes, JSObject*& globalObject);
 
+        // Looks the property up in the symbol table of a variable object on
+        // the scope chain. Every name looked up is noted for the bytecode
+        // cache, which only reuses the bytecode while the names still resolve
+        // the same way.
+        SymbolTableEntry scopedSymbolFor(JSVariableObject*, const Identifier&);
+        const HashSet<RefPtr<StringImpl>, IdentifierRepHash>& scopedNames() const { return m_scopedNames; }
+
+        // Declare the functions and vars of program code on the global object,
+        // which happens before the program's bytecode is generated.
+        static void declareGlobalFunction(ExecState*, ScopeChainNode*, SymbolTable&, FunctionExecutable*);
+        static void declareGlobalVariable(ExecState*, ScopeChainNode*, SymbolTable&, const Identifier&, bool isConstant);
+
         // Returns the register storing "this"
         RegisterID* thisRegister() { return &m_thisRegister; }
 
@@ -453,7 +466,8 @@ namespace JSC {
         }
 
         // Returns the index of the added var.
-        int addGlobalVar(const Identifier&, bool isConstant);
+        int addGlobalVar(const Identifier& ident, bool isConstant) { return addGlobalVar(symbolTable(), ident, isConstant); }
+        static int addGlobalVar(SymbolTable&, const Identifier&, bool isConstant);
 
         void addParameter(const Identifier&, int parameterIndex);
         
@@ -544,6 +558,7 @@ namespace JSC {
         // Some of these objects keep pointers to one another. They are arranged
         // to ensure a sane destruction order that avoids references to freed memory.
         HashSet<RefPtr<StringImpl>, IdentifierRepHash> m_functions;
+        HashSet<RefPtr<StringImpl>, IdentifierRepHash> m_scopedNames;
         RegisterID m_ignoredResultRegister;
         RegisterID m_thisRegister;
         RegisterID* m_activationRegister;
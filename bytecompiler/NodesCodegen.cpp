@@ -1304,7 +1304,7 @@ RegisterID* ConstDeclNode::emitCodeSingle(BytecodeGenerator& generator)
         if (!currentScope->isVariableObject())
             continue;
         JSVariableObject* currentVariableObject = static_cast<JSVariableObject*>(currentScope);
-        SymbolTableEntry entry = currentVariableObject->symbolTable().get(m_ident.impl());
+        SymbolTableEntry entry = generator.scopedSymbolFor(currentVariableObject, m_ident);
         if (entry.isNull())
             continue;
 
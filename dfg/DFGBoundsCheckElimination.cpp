@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "DFGBoundsCheckElimination.h"
+
+#if ENABLE(DFG_JIT) && ENABLE(DFG_OSR_EXIT)
+
+#include "DFGLoopAnalysis.h"
+#include "JSGlobalData.h"
+
+namespace JSC { namespace DFG {
+
+// The pattern we look for is what the bytecode generator emits for
+//
+//     for (i = 0; i < a.length; ++i) ... a[i] ...
+//
+// which is a test block ending in Branch(CompareLess(GetLocal(i), a.length)),
+// whose taken successor is the loop body. If the body has no other way in, then
+// on entry to it i is below the length, and if i can never be negative and the
+// length does not exceed the vector length, then any a[i] that comes before
+// anything that could resize a is within the vector.
+//
+// Only the SpeculativeJIT consumes the facts recorded here, which is why this
+// requires OSR exit.
+class BoundsCheckElimination {
+public:
+    BoundsCheckElimination(Graph& graph, JSGlobalData& globalData, CodeBlock* codeBlock)
+        : m_graph(graph)
+        , m_globalData(globalData)
+        , m_codeBlock(codeBlock)
+    {
+        m_localIsNeverNegative.fill(Unknown, m_graph.predictions().numberOfVariables());
+    }
+
+    void run()
+    {
+        convertArrayLengthLoads();
+        
+        LoopAnalysis loops(m_graph);
+        for (BlockIndex block = 0; block < m_graph.m_blocks.size(); ++block)
+            eliminateBoundsChecks(loops, block);
+    }
+
+private:
+    enum TriState { Unknown, No, Yes };
+    
+    bool isArrayLocal(NodeIndex nodeIndex)
+    {
+        Node& node = m_graph[nodeIndex];
+        return node.op == GetLocal && isArrayPrediction(m_graph.getPrediction(node.local()));
+    }
+    
+    bool isKnownInt32(NodeIndex nodeIndex)
+    {
+        Node& node = m_graph[nodeIndex];
+        if (node.hasInt32Result() || node.isInt32Constant(m_codeBlock))
+            return true;
+        return node.op == GetLocal && isInt32Prediction(m_graph.getPrediction(node.local()));
+    }
+    
+    // The speculative JIT adds values that are not known integers as doubles
+    // if it predicts, or has no prediction for, both being numbers.
+    bool isSpeculatedNumber(NodeIndex nodeIndex)
+    {
+        Node& node = m_graph[nodeIndex];
+        if (node.hasInt32Result() || node.hasNumberResult() || node.isNumberConstant(m_codeBlock))
+            return true;
+        PredictedType prediction = m_graph.getPrediction(node);
+        return isNumberPrediction(prediction) || prediction == PredictNone;
+    }
+    
+    void convertArrayLengthLoads()
+    {
+        for (BlockIndex block = 0; block < m_graph.m_blocks.size(); ++block) {
+            BasicBlock& basicBlock = *m_graph.m_blocks[block];
+            for (NodeIndex nodeIndex = basicBlock.begin; nodeIndex < basicBlock.end; ++nodeIndex) {
+                Node& node = m_graph[nodeIndex];
+                if (node.op != GetById || !node.shouldGenerate())
+                    continue;
+                if (m_codeBlock->identifier(node.identifierNumber()) != m_globalData.propertyNames->length)
+                    continue;
+                if (!isArrayLocal(node.child1()))
+                    continue;
+#if ENABLE(DFG_DEBUG_VERBOSE)
+                printf("Bounds check elimination: @%u -> GetArrayLength\n", nodeIndex);
+#endif
+                node.convertToGetArrayLength();
+            }
+        }
+    }
+    
+    // Anything not listed may call out to arbitrary code, or store to an array
+    // directly, either of which may change an array's length or vector.
+    bool mayResizeArrays(Node& node)
+    {
+        switch (node.op) {
+        case JSConstant:
+        case GetLocal:
+        case SetLocal:
+        case Phi:
+        case BitAnd:
+        case BitOr:
+        case BitXor:
+        case BitLShift:
+        case BitRShift:
+        case BitURShift:
+        case ValueToInt32:
+        case UInt32ToNumber:
+        case ArithAdd:
+        case ArithSub:
+        case ArithMul:
+        case ArithDiv:
+        case ArithMod:
+        case ValueToNumber:
+        case ValueToDouble:
+        case CompareStrictEq:
+        case LogicalNot:
+        case GetByVal:
+        case GetArrayLength:
+        case GetGlobalVar:
+        case PutGlobalVar:
+        case CheckFunction:
+        case Jump:
+        case Branch:
+        case Return:
+            return false;
+        case ValueAdd:
+            return !isSpeculatedNumber(node.child1()) || !isSpeculatedNumber(node.child2());
+        case CompareLess:
+        case CompareLessEq:
+        case CompareGreater:
+        case CompareGreaterEq:
+        case CompareEq:
+            // A compare of two integers never calls out.
+            return !isKnownInt32(node.child1()) || !isKnownInt32(node.child2());
+        default:
+            return true;
+        }
+    }
+    
+    bool setsLocal(BasicBlock& block, VirtualRegister local)
+    {
+        for (NodeIndex nodeIndex = block.begin; nodeIndex < block.end; ++nodeIndex) {
+            Node& node = m_graph[nodeIndex];
+            if (node.op == SetLocal && node.local() == local)
+                return true;
+        }
+        return false;
+    }
+    
+    bool isLocalInBlock(NodeIndex nodeIndex, VirtualRegister local, BasicBlock& block)
+    {
+        if (nodeIndex < block.begin || nodeIndex >= block.end)
+            return false;
+        Node& node = m_graph[nodeIndex];
+        return node.op == GetLocal && node.local() == local;
+    }
+    
+    // Whether the value is the local, or a previous such value, plus a
+    // non-negative constant.
+    bool isNonNegativeStep(NodeIndex nodeIndex, VirtualRegister local)
+    {
+        Node& node = m_graph[nodeIndex];
+        switch (node.op) {
+        case GetLocal:
+            return node.local() == local;
+        case ValueToNumber:
+        case ValueToInt32:
+            return isNonNegativeStep(node.child1(), local);
+        case ArithAdd:
+        case ValueAdd:
+            if (isNonNegativeInt32Constant(node.child2()))
+                return isNonNegativeStep(node.child1(), local);
+            if (isNonNegativeInt32Constant(node.child1()))
+                return isNonNegativeStep(node.child2(), local);
+            return false;
+        default:
+            return false;
+        }
+    }
+    
+    bool isNonNegativeInt32Constant(NodeIndex nodeIndex)
+    {
+        Node& node = m_graph[nodeIndex];
+        return node.isInt32Constant(m_codeBlock) && node.valueOfInt32Constant(m_codeBlock) >= 0;
+    }
+    
+    // An int32 local can never be negative if all that is ever stored to it is
+    // a non-negative constant, or the local plus a non-negative constant. We
+    // also accept constants that are not numbers, but that a later increment
+    // would convert to a non-negative number or NaN; the SetLocal refuses to
+    // store those anyway. This holds of the baseline code as much as it does
+    // of ours, so it holds on OSR entry too.
+    bool localIsNeverNegative(VirtualRegister local)
+    {
+        if (operandIsArgument(local) || !isInt32Prediction(m_graph.getPrediction(local)))
+            return false;
+        
+        TriState& result = m_localIsNeverNegative[local];
+        if (result != Unknown)
+            return result == Yes;
+        
+        result = Yes;
+        for (NodeIndex nodeIndex = 0; nodeIndex < m_graph.m_blocks.last()->end; ++nodeIndex) {
+            Node& node = m_graph[nodeIndex];
+            if (node.op != SetLocal || node.local() != local)
+                continue;
+            Node& value = m_graph[node.child1()];
+            if (value.isConstant()) {
+                JSValue constant = value.valueOfJSConstant(m_codeBlock);
+                if (constant.isInt32() ? constant.asInt32() >= 0 : (constant.isUndefinedOrNull() || constant.isBoolean()))
+                    continue;
+            } else if (isNonNegativeStep(node.child1(), local))
+                continue;
+            result = No;
+            break;
+        }
+        return result == Yes;
+    }
+    
+    void appendUnique(Vector<VirtualRegister, 1>& checks, VirtualRegister local)
+    {
+        for (size_t i = 0; i < checks.size(); ++i) {
+            if (checks[i] == local)
+                return;
+        }
+        checks.append(local);
+    }
+    
+    // The loop the check that the array's length is within its vector may be
+    // hoisted out of: one with a preheader to put the check in, in which the
+    // variable is not assigned and nothing may resize an array. We pick the
+    // outermost such loop.
+    NaturalLoop* findHoistingLoop(LoopAnalysis& loops, BlockIndex test, BlockIndex body, VirtualRegister arrayLocal)
+    {
+        NaturalLoop* result = 0;
+        for (size_t i = 0; i < loops.numberOfLoops(); ++i) {
+            NaturalLoop& loop = loops.loop(i);
+            if (loop.preheader == NoBlock || !loop.contains(test) || !loop.contains(body))
+                continue;
+            if (result && result->blocks.size() >= loop.blocks.size())
+                continue;
+            bool invariant = true;
+            for (size_t j = 0; j < loop.blocks.size() && invariant; ++j) {
+                BasicBlock& block = *m_graph.m_blocks[loop.blocks[j]];
+                for (NodeIndex nodeIndex = block.begin; nodeIndex < block.end; ++nodeIndex) {
+                    Node& node = m_graph[nodeIndex];
+                    if ((node.shouldGenerate() && mayResizeArrays(node)) || (node.op == SetLocal && node.local() == arrayLocal)) {
+                        invariant = false;
+                        break;
+                    }
+                }
+            }
+            if (invariant)
+                result = &loop;
+        }
+        return result;
+    }
+    
+    void eliminateBoundsChecks(LoopAnalysis& loops, BlockIndex bodyIndex)
+    {
+        BasicBlock& body = *m_graph.m_blocks[bodyIndex];
+        if (body.m_predecessors.size() != 1)
+            return;
+        BlockIndex testIndex = body.m_predecessors[0];
+        BasicBlock& test = *m_graph.m_blocks[testIndex];
+        Node& branch = m_graph[test.end - 1];
+        if (branch.op != Branch
+            || m_graph.blockIndexForBytecodeOffset(branch.takenBytecodeOffset()) != bodyIndex
+            || m_graph.blockIndexForBytecodeOffset(branch.notTakenBytecodeOffset()) == bodyIndex)
+            return;
+        
+        Node& compare = m_graph[branch.child1()];
+        if (compare.op != CompareLess)
+            return;
+        NodeIndex lengthIndex = compare.child2();
+        Node& index = m_graph[compare.child1()];
+        Node& length = m_graph[lengthIndex];
+        if (index.op != GetLocal || length.op != GetArrayLength)
+            return;
+        VirtualRegister indexLocal = index.local();
+        VirtualRegister arrayLocal = m_graph[length.child1()].local();
+        if (!localIsNeverNegative(indexLocal))
+            return;
+        
+        // The body must see the values the test compared.
+        if (setsLocal(test, indexLocal) || setsLocal(test, arrayLocal))
+            return;
+        
+        NaturalLoop* hoistingLoop = findHoistingLoop(loops, testIndex, bodyIndex, arrayLocal);
+        if (!hoistingLoop) {
+            // The length will be checked where it is loaded, so the array must
+            // not change between there and the body.
+            for (NodeIndex nodeIndex = lengthIndex + 1; nodeIndex < test.end; ++nodeIndex) {
+                Node& node = m_graph[nodeIndex];
+                if (node.shouldGenerate() && mayResizeArrays(node))
+                    return;
+            }
+        }
+        
+        bool eliminated = false;
+        for (NodeIndex nodeIndex = body.begin; nodeIndex < body.end; ++nodeIndex) {
+            Node& node = m_graph[nodeIndex];
+            if (!node.shouldGenerate())
+                continue;
+            if ((node.op == GetByVal || node.op == PutByVal)
+                && isLocalInBlock(node.child1(), arrayLocal, body)
+                && isLocalInBlock(node.child2(), indexLocal, body)) {
+#if ENABLE(DFG_DEBUG_VERBOSE)
+                printf("Bounds check elimination: @%u is within the vector of r%d\n", nodeIndex, arrayLocal);
+#endif
+                node.setIndexIsWithinVector();
+                eliminated = true;
+            }
+            if (mayResizeArrays(node))
+                break;
+        }
+        if (!eliminated)
+            return;
+        
+        // OSR entry into the body skips the test, but the baseline code took the
+        // same branch to get there, so only the vector length needs checking.
+        if (hoistingLoop) {
+            appendUnique(m_graph.m_blocks[hoistingLoop->preheader]->hoistedArrayChecks, arrayLocal);
+            for (size_t i = 0; i < hoistingLoop->blocks.size(); ++i) {
+                BasicBlock& block = *m_graph.m_blocks[hoistingLoop->blocks[i]];
+                if (block.isOSRTarget)
+                    appendUnique(block.osrEntryArrayChecks, arrayLocal);
+            }
+        } else {
+            length.setLengthMustBeWithinVector();
+            if (body.isOSRTarget)
+                appendUnique(body.osrEntryArrayChecks, arrayLocal);
+        }
+    }
+    
+    Graph& m_graph;
+    JSGlobalData& m_globalData;
+    CodeBlock* m_codeBlock;
+    Vector<TriState, 16> m_localIsNeverNegative;
+};
+
+void performBoundsCheckElimination(Graph& graph, JSGlobalData* globalData, CodeBlock* codeBlock)
+{
+    // If the checks this phase hoisted kept failing in earlier optimized code,
+    // keep them where the bytecode put them this time around.
+    ASSERT(codeBlock->alternative());
+    if (codeBlock->alternative()->exitProfile().hasExitSite(OutOfBounds))
+        return;
+    
+    BoundsCheckElimination(graph, *globalData, codeBlock).run();
+}
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(DFG_JIT) && ENABLE(DFG_OSR_EXIT)
@@ -29,9 +29,11 @@
 #if ENABLE(DFG_JIT)
 
 #include "DFGAliasTracker.h"
+#include "DFGCSE.h"
 #include "DFGCapabilities.h"
 #include "DFGScoreBoard.h"
 #include "CodeBlock.h"
+#include "Executable.h"
 
 namespace JSC { namespace DFG {
 
@@ -70,6 +72,12 @@ public:
 #if ENABLE(DYNAMIC_OPTIMIZATION)
         ASSERT(m_profiledBlock);
 #endif
+        m_inlineStack.append(InlineStackEntry(codeBlock, profiledBlock, 0, 0));
+        InlineStackEntry& entry = m_inlineStack.last();
+        for (unsigned i = 0; i < codeBlock->numberOfConstantRegisters(); ++i)
+            entry.m_constantRemap.append(i);
+        for (unsigned i = 0; i < codeBlock->numberOfIdentifiers(); ++i)
+            entry.m_identifierRemap.append(i);
     }
 
     // Parse a full CodeBlock of bytecode.
@@ -89,16 +97,23 @@ private:
     void processPhiStack();
     // Add spill locations to nodes.
     void allocateVirtualRegisters();
+    // Try to parse the callee of an op_call in place of the call.
+    bool handleInlining(Instruction* currentInstruction);
+    // Finish parsing an inlined function, resuming the caller.
+    void handleInlinedReturn(Interpreter*, NodeIndex returnValue);
 
-    // Get/Set the operands/result of a bytecode instruction.
+    // Get/Set the operands/result of a bytecode instruction. The operand
+    // is relative to the function being parsed, which may have been inlined.
     NodeIndex get(int operand)
     {
         // Is this a constant?
         if (operand >= FirstConstantRegisterIndex) {
-            unsigned constant = operand - FirstConstantRegisterIndex;
+            unsigned constant = inlineStackTop().m_constantRemap[operand - FirstConstantRegisterIndex];
             ASSERT(constant < m_constants.size());
             return getJSConstant(constant);
         }
+        
+        operand += inlineStackTop().m_stackOffset;
 
         // Is this an argument?
         if (operandIsArgument(operand))
@@ -109,6 +124,8 @@ private:
     }
     void set(int operand, NodeIndex value, PredictedType weakPrediction = PredictNone)
     {
+        operand += inlineStackTop().m_stackOffset;
+        
         m_graph.predict(operand, weakPrediction, WeakPrediction);
 
         // Is this an argument?
@@ -242,11 +259,17 @@ private:
     // Helper functions to get/set the this value.
     NodeIndex getThis()
     {
-        return getArgument(m_codeBlock->thisRegister());
+        return get(inlineStackTop().m_codeBlock->thisRegister());
     }
     void setThis(NodeIndex value)
     {
-        setArgument(m_codeBlock->thisRegister(), value);
+        set(inlineStackTop().m_codeBlock->thisRegister(), value);
+    }
+    
+    // Identifiers in the instruction stream index into the CodeBlock being parsed.
+    unsigned identifierForOperand(int operand)
+    {
+        return inlineStackTop().m_identifierRemap[operand];
     }
 
     // Convenience methods for checking nodes for constants.
@@ -368,9 +391,37 @@ private:
         return getJSConstant(m_constant1);
     }
     
+    // Find or add a constant in the machine code block's constant pool.
+    unsigned constantForValue(JSValue value)
+    {
+        unsigned numberOfConstants = m_codeBlock->numberOfConstantRegisters();
+        for (unsigned constant = 0; constant < numberOfConstants; ++constant) {
+            if (JSValue::encode(m_codeBlock->getConstant(FirstConstantRegisterIndex + constant)) == JSValue::encode(value))
+                return constant;
+        }
+        
+        ASSERT(m_constants.size() == numberOfConstants);
+        m_codeBlock->addConstant(value);
+        m_constants.append(ConstantRecord());
+        ASSERT(m_constants.size() == m_codeBlock->numberOfConstantRegisters());
+        return numberOfConstants;
+    }
+    
+    // Find or add an identifier in the machine code block.
+    unsigned identifierForValue(const Identifier& identifier)
+    {
+        unsigned numberOfIdentifiers = m_codeBlock->numberOfIdentifiers();
+        for (unsigned index = 0; index < numberOfIdentifiers; ++index) {
+            if (m_codeBlock->identifier(index) == identifier)
+                return index;
+        }
+        m_codeBlock->addIdentifier(identifier);
+        return numberOfIdentifiers;
+    }
+    
     CodeOrigin currentCodeOrigin()
     {
-        return CodeOrigin(m_currentIndex);
+        return CodeOrigin(m_currentIndex, inlineStackTop().m_inlineCallFrame);
     }
 
     // These methods create a node and add it to the graph. If nodes of this type are
@@ -477,7 +528,7 @@ private:
     void stronglyPredict(NodeIndex nodeIndex, unsigned bytecodeIndex)
     {
 #if ENABLE(DYNAMIC_OPTIMIZATION)
-        ValueProfile* profile = m_profiledBlock->valueProfileForBytecodeOffset(bytecodeIndex);
+        ValueProfile* profile = inlineStackTop().m_profiledBlock->valueProfileForBytecodeOffset(bytecodeIndex);
         ASSERT(profile);
         m_graph[nodeIndex].predict(profile->computeUpdatedPrediction() & ~PredictionTagMask, StrongPrediction);
 #if ENABLE(DFG_DEBUG_VERBOSE)
@@ -546,7 +597,8 @@ private:
     // The number of slots (in units of sizeof(Register)) that we need to
     // preallocate for calls emanating from this frame. This includes the
     // size of the CallFrame, only if this is not a leaf function.  (I.e.
-    // this is 0 if and only if this function is a leaf.)
+    // this is 0 if and only if this function is a leaf.) NewArray also
+    // passes its elements to the allocation in these slots.
     unsigned m_parameterSlots;
     // The number of var args passed to the next var arg node.
     unsigned m_numPassedVarArgs;
@@ -567,6 +619,34 @@ private:
     Vector<PhiStackEntry, 16> m_localPhiStack;
     
     Vector<Node*, 16> m_reusableNodeStack;
+    
+    // One entry for the function being compiled, and one more for each call
+    // that we are in the middle of inlining.
+    struct InlineStackEntry {
+        InlineStackEntry(CodeBlock* codeBlock, CodeBlock* profiledBlock, InlineCallFrame* inlineCallFrame, int stackOffset)
+            : m_codeBlock(codeBlock)
+            , m_profiledBlock(profiledBlock)
+            , m_inlineCallFrame(inlineCallFrame)
+            , m_stackOffset(stackOffset)
+        {
+        }
+        
+        // The CodeBlock whose bytecode we are parsing, and the one that holds
+        // its value profiles. For inlined functions these are both the
+        // callee's baseline CodeBlock.
+        CodeBlock* m_codeBlock;
+        CodeBlock* m_profiledBlock;
+        InlineCallFrame* m_inlineCallFrame;
+        // Where the function's registers start in the machine code block's frame.
+        int m_stackOffset;
+        // Map the function's constants and identifiers to the machine code block's.
+        Vector<unsigned, 16> m_constantRemap;
+        Vector<unsigned, 16> m_identifierRemap;
+    };
+    
+    InlineStackEntry& inlineStackTop() { return m_inlineStack.last(); }
+    
+    Vector<InlineStackEntry, 4> m_inlineStack;
 };
 
 #define NEXT_OPCODE(name) \
@@ -588,11 +668,12 @@ bool ByteCodeParser::parseBlock(unsigned limit)
     AliasTracker aliases(m_graph);
 
     Interpreter* interpreter = m_globalData->interpreter;
-    Instruction* instructionsBegin = m_codeBlock->instructions().begin();
+    Instruction* instructionsBegin = inlineStackTop().m_codeBlock->instructions().begin();
     unsigned blockBegin = m_currentIndex;
     while (true) {
-        // Don't extend over jump destinations.
-        if (m_currentIndex == limit) {
+        // Don't extend over jump destinations. Inlined functions have none, and
+        // their bytecode indices are not comparable to the limit.
+        if (m_currentIndex == limit && m_inlineStack.size() == 1) {
             addToGraph(Jump, OpInfo(m_currentIndex));
             return !m_parseFailed;
         }
@@ -606,7 +687,7 @@ bool ByteCodeParser::parseBlock(unsigned limit)
 
         case op_enter:
             // Initialize all locals to undefined.
-            for (int i = 0; i < m_codeBlock->m_numVars; ++i)
+            for (int i = 0; i < inlineStackTop().m_codeBlock->m_numVars; ++i)
                 set(i, constantUndefined());
             NEXT_OPCODE(op_enter);
 
@@ -931,7 +1012,7 @@ bool ByteCodeParser::parseBlock(unsigned limit)
             weaklyPredictInt32(property);
 
             NodeIndex aliasedGet = aliases.lookupGetByVal(base, property);
-            NodeIndex putByVal = addToGraph(aliasedGet != NoNode ? PutByValAlias : PutByVal, base, property, value);
+            NodeIndex putByVal = addToGraph(aliasedGet != NoNode ? PutByValAlias : PutByVal, OpInfo(0), base, property, value);
             aliases.recordPutByVal(putByVal);
 
             NEXT_OPCODE(op_put_by_val);
@@ -943,7 +1024,7 @@ bool ByteCodeParser::parseBlock(unsigned limit)
             ASSERT(interpreter->getOpcodeID(getInstruction->u.opcode) == op_get_by_id);
             
             NodeIndex base = get(getInstruction[2].u.operand);
-            unsigned identifier = getInstruction[3].u.operand;
+            unsigned identifier = identifierForOperand(getInstruction[3].u.operand);
             
             NodeIndex getMethod = addToGraph(GetMethod, OpInfo(identifier), OpInfo(PredictNone), base);
             set(getInstruction[1].u.operand, getMethod);
@@ -957,7 +1038,7 @@ bool ByteCodeParser::parseBlock(unsigned limit)
         case op_get_by_id: {
             PROPERTY_ACCESS_OP();
             NodeIndex base = get(currentInstruction[2].u.operand);
-            unsigned identifier = currentInstruction[3].u.operand;
+            unsigned identifier = identifierForOperand(currentInstruction[3].u.operand);
             
             NodeIndex getById = addToGraph(GetById, OpInfo(identifier), OpInfo(PredictNone), base);
             set(currentInstruction[1].u.operand, getById);
@@ -971,7 +1052,7 @@ bool ByteCodeParser::parseBlock(unsigned limit)
             PROPERTY_ACCESS_OP();
             NodeIndex value = get(currentInstruction[3].u.operand);
             NodeIndex base = get(currentInstruction[1].u.operand);
-            unsigned identifier = currentInstruction[2].u.operand;
+            unsigned identifier = identifierForOperand(currentInstruction[2].u.operand);
             bool direct = currentInstruction[8].u.operand;
 
             if (direct) {
@@ -997,6 +1078,39 @@ bool ByteCodeParser::parseBlock(unsigned limit)
             NEXT_OPCODE(op_put_global_var);
         }
 
+        // === Allocations ===
+
+        case op_new_object: {
+            set(currentInstruction[1].u.operand, addToGraph(NewObject));
+            NEXT_OPCODE(op_new_object);
+        }
+
+        case op_new_array: {
+            int startOperand = currentInstruction[2].u.operand;
+            int numOperands = currentInstruction[3].u.operand;
+            for (int operandIdx = startOperand; operandIdx < startOperand + numOperands; ++operandIdx)
+                addVarArgChild(get(operandIdx));
+            set(currentInstruction[1].u.operand, addToGraph(Node::VarArg, NewArray, OpInfo(0), OpInfo(0)));
+            if ((unsigned)numOperands > m_parameterSlots)
+                m_parameterSlots = numOperands;
+            NEXT_OPCODE(op_new_array);
+        }
+
+        case op_new_array_buffer: {
+            unsigned startConstant = currentInstruction[2].u.operand;
+            int numConstants = currentInstruction[3].u.operand;
+            // The machine code block's constant buffers are not the inlined
+            // function's, so give it a copy. The strings in the buffer are
+            // among the constants that inlining already copied.
+            if (inlineStackTop().m_inlineCallFrame) {
+                JSValue* buffer = inlineStackTop().m_codeBlock->constantBuffer(startConstant);
+                startConstant = m_codeBlock->addConstantBuffer(numConstants);
+                std::copy(buffer, buffer + numConstants, m_codeBlock->constantBuffer(startConstant));
+            }
+            set(currentInstruction[1].u.operand, addToGraph(NewArrayBuffer, OpInfo(startConstant), OpInfo(numConstants)));
+            NEXT_OPCODE(op_new_array_buffer);
+        }
+
         // === Block terminators. ===
 
         case op_jmp: {
@@ -1164,6 +1278,11 @@ bool ByteCodeParser::parseBlock(unsigned limit)
         }
 
         case op_ret:
+            if (m_inlineStack.size() > 1) {
+                handleInlinedReturn(interpreter, get(currentInstruction[1].u.operand));
+                instructionsBegin = inlineStackTop().m_codeBlock->instructions().begin();
+                continue;
+            }
             addToGraph(Return, get(currentInstruction[1].u.operand));
             LAST_OPCODE(op_ret);
             
@@ -1172,6 +1291,10 @@ bool ByteCodeParser::parseBlock(unsigned limit)
             LAST_OPCODE(op_end);
             
         case op_call: {
+            if (handleInlining(currentInstruction)) {
+                instructionsBegin = inlineStackTop().m_codeBlock->instructions().begin();
+                continue;
+            }
             NodeIndex call = addCall(interpreter, currentInstruction, Call);
             aliases.recordCall(call);
             NEXT_OPCODE(op_call);
@@ -1188,7 +1311,7 @@ bool ByteCodeParser::parseBlock(unsigned limit)
 
         case op_resolve: {
             PROPERTY_ACCESS_OP();
-            unsigned identifier = currentInstruction[2].u.operand;
+            unsigned identifier = identifierForOperand(currentInstruction[2].u.operand);
 
             NodeIndex resolve = addToGraph(Resolve, OpInfo(identifier));
             set(currentInstruction[1].u.operand, resolve);
@@ -1199,7 +1322,7 @@ bool ByteCodeParser::parseBlock(unsigned limit)
 
         case op_resolve_base: {
             PROPERTY_ACCESS_OP();
-            unsigned identifier = currentInstruction[2].u.operand;
+            unsigned identifier = identifierForOperand(currentInstruction[2].u.operand);
 
             NodeIndex resolve = addToGraph(currentInstruction[3].u.operand ? ResolveBaseStrictPut : ResolveBase, OpInfo(identifier));
             set(currentInstruction[1].u.operand, resolve);
@@ -1229,6 +1352,111 @@ bool ByteCodeParser::parseBlock(unsigned limit)
     }
 }
 
+bool ByteCodeParser::handleInlining(Instruction* currentInstruction)
+{
+#if ENABLE(DFG_OSR_EXIT) && ENABLE(DYNAMIC_OPTIMIZATION)
+    // We find the callee in the baseline call's CallLinkInfo, and rely on OSR
+    // exit to leave the inlined code when a different function shows up.
+    if (m_inlineStack.size() > Options::maximumInliningDepth)
+        return false;
+    
+    // Exits taken anywhere in inlined code are charged to the outermost call
+    // site. If earlier optimized code kept exiting there, leave the call be.
+    if (m_inlineStack.size() == 1 && m_profiledBlock->exitProfile().hasExitSite(m_currentIndex))
+        return false;
+    
+    CallLinkInfo& callLinkInfo = inlineStackTop().m_profiledBlock->getCallLinkInfo(m_currentIndex);
+    if (!callLinkInfo.isLinked())
+        return false;
+    JSFunction* callee = callLinkInfo.callee.get();
+    if (callee->isHostFunction())
+        return false;
+    FunctionExecutable* executable = callee->jsExecutable();
+    if (!executable->isGeneratedForCall())
+        return false;
+    for (size_t i = 0; i < m_inlineStack.size(); ++i) {
+        if (m_inlineStack[i].m_codeBlock->ownerExecutable() == executable)
+            return false;
+    }
+    
+    CodeBlock* calleeCodeBlock = executable->generatedBytecodeForCall().baselineVersion();
+    int argumentCountIncludingThis = currentInstruction[2].u.operand;
+    if (calleeCodeBlock->getJITType() != JITCode::BaselineJIT
+        || !calleeCodeBlock->jitCodeMap()
+        || calleeCodeBlock->globalObject() != m_codeBlock->globalObject()
+        || calleeCodeBlock->m_numParameters != argumentCountIncludingThis
+        || calleeCodeBlock->needsFullScopeChain()
+        || calleeCodeBlock->usesArguments()
+        || calleeCodeBlock->usesEval()
+        || calleeCodeBlock->numberOfExceptionHandlers()
+        || !canInlineFunctionForCall(calleeCodeBlock))
+        return false;
+    
+#if ENABLE(DFG_DEBUG_VERBOSE)
+    printf("Inlining %p at bc#%u, depth %u\n", calleeCodeBlock, m_currentIndex, (unsigned)m_inlineStack.size());
+#endif
+    
+    addToGraph(CheckFunction, OpInfo(constantForValue(callee)), get(currentInstruction[1].u.operand));
+    
+    // The callee's registers go exactly where its call frame would have been.
+    int stackOffset = inlineStackTop().m_stackOffset + currentInstruction[3].u.operand;
+    
+    // Stack walks read the inlined frame's arguments from the register file, so
+    // make sure any set in this block are actually stored there.
+    for (int i = 0; i < argumentCountIncludingThis; ++i) {
+        unsigned operand = stackOffset - RegisterFile::CallFrameHeaderSize - argumentCountIncludingThis + i;
+        NodeIndex nodeIndex = m_currentBlock->m_locals[operand].value;
+        if (nodeIndex != NoNode && m_graph[nodeIndex].op == SetLocal)
+            m_graph.ref(nodeIndex);
+    }
+    
+    m_codeBlock->inlineCallFrames().append(InlineCallFrame());
+    InlineCallFrame* inlineCallFrame = &m_codeBlock->inlineCallFrames().last();
+    inlineCallFrame->executable.set(*m_globalData, m_codeBlock->ownerExecutable(), executable);
+    inlineCallFrame->callee.set(*m_globalData, m_codeBlock->ownerExecutable(), callee);
+    inlineCallFrame->caller = currentCodeOrigin();
+    inlineCallFrame->stackOffset = stackOffset;
+    inlineCallFrame->argumentCountIncludingThis = argumentCountIncludingThis;
+    m_graph.m_baselineCodeBlocksForInlineCallFrames.add(inlineCallFrame, calleeCodeBlock);
+    
+    // Keep the whole inlined frame, header included, out of the way of the
+    // temporaries we allocate, so that it can be reconstructed in place.
+    unsigned calleeEnd = stackOffset + calleeCodeBlock->m_numCalleeRegisters;
+    m_preservedVars = std::max(m_preservedVars, calleeEnd);
+    if (calleeEnd > m_numLocals) {
+        m_numLocals = calleeEnd;
+        m_currentBlock->m_locals.resize(m_numLocals);
+    }
+    
+    m_inlineStack.append(InlineStackEntry(calleeCodeBlock, calleeCodeBlock, inlineCallFrame, stackOffset));
+    InlineStackEntry& entry = inlineStackTop();
+    for (unsigned i = 0; i < calleeCodeBlock->numberOfConstantRegisters(); ++i)
+        entry.m_constantRemap.append(constantForValue(calleeCodeBlock->getConstant(FirstConstantRegisterIndex + i)));
+    for (unsigned i = 0; i < calleeCodeBlock->numberOfIdentifiers(); ++i)
+        entry.m_identifierRemap.append(identifierForValue(calleeCodeBlock->identifier(i)));
+    
+    m_currentIndex = 0;
+    return true;
+#else
+    UNUSED_PARAM(currentInstruction);
+    return false;
+#endif
+}
+
+void ByteCodeParser::handleInlinedReturn(Interpreter* interpreter, NodeIndex returnValue)
+{
+    ASSERT(m_inlineStack.size() > 1);
+    unsigned callIndex = inlineStackTop().m_inlineCallFrame->caller.bytecodeIndex();
+    m_inlineStack.removeLast();
+    
+    // Carry on from the op_call_put_result, so that exiting while storing the
+    // result resumes the baseline code after the call rather than repeating it.
+    m_currentIndex = callIndex + OPCODE_LENGTH(op_call);
+    Instruction* putInstruction = inlineStackTop().m_codeBlock->instructions().begin() + m_currentIndex;
+    if (interpreter->getOpcodeID(putInstruction->u.opcode) == op_call_put_result)
+        set(putInstruction[1].u.operand, returnValue);
+}
+
 template<ByteCodeParser::PhiStackType stackType>
 void ByteCodeParser::processPhiStack()
 {
@@ -1379,11 +1607,20 @@ bool ByteCodeParser::parse()
 
     // Should have reached the end of the instructions.
     ASSERT(m_currentIndex == m_codeBlock->instructions().size());
+    ASSERT(m_inlineStack.size() == 1);
+    
+    // Inlining grows the register file; blocks created before then need to
+    // cover it too.
+    for (BlockIndex index = 0; index < m_graph.m_blocks.size(); ++index)
+        m_graph.m_blocks[index]->m_locals.resize(m_numLocals);
 
     setupPredecessors();
     processPhiStack<LocalPhiStack>();
     processPhiStack<ArgumentPhiStack>();
 
+    m_codeBlock->setNumberOfNodesEliminatedByCSE(performCSE(m_graph));
+
+    m_graph.m_firstInlinedRegister = std::min<unsigned>(m_codeBlock->m_numCalleeRegisters, m_codeBlock->firstInlinedRegister());
     allocateVirtualRegisters();
 
 #if ENABLE(DFG_DEBUG_VERBOSE)
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "DFGCSE.h"
+
+#if ENABLE(DFG_JIT)
+
+namespace JSC { namespace DFG {
+
+// Values only live within the basic block that computes them; anything that
+// crosses a block boundary goes through a SetLocal and a GetLocal. So this
+// works a block at a time, and a node can only be replaced by an earlier node
+// of its own block.
+class CSE {
+public:
+    CSE(Graph& graph)
+        : m_graph(graph)
+        , m_replacements(graph.size())
+        , m_numberOfEliminatedNodes(0)
+    {
+        for (unsigned i = 0; i < m_replacements.size(); ++i)
+            m_replacements[i] = NoNode;
+    }
+    
+    unsigned run()
+    {
+        for (BlockIndex block = 0; block < m_graph.m_blocks.size(); ++block)
+            performBlockCSE(*m_graph.m_blocks[block]);
+        return m_numberOfEliminatedNodes;
+    }
+    
+private:
+    // Nodes whose result depends only on their children and immediates. Some of
+    // these contain speculation checks, which are then also redundant.
+    static bool isPure(NodeType op)
+    {
+        switch (op) {
+        case JSConstant:
+        case ConvertThis:
+        case BitAnd:
+        case BitOr:
+        case BitXor:
+        case BitLShift:
+        case BitRShift:
+        case BitURShift:
+        case ValueToInt32:
+        case UInt32ToNumber:
+        case ArithAdd:
+        case ArithSub:
+        case ArithMul:
+        case ArithDiv:
+        case ArithMod:
+        case ValueToNumber:
+        case ValueToDouble:
+        case CompareStrictEq:
+        case LogicalNot:
+        case CheckFunction:
+            return true;
+        default:
+            return false;
+        }
+    }
+    
+    // Nodes that read the heap, and so are only redundant if nothing in between
+    // could have written to what they read.
+    static bool isLoad(NodeType op)
+    {
+        return op == GetGlobalVar || op == GetByVal;
+    }
+    
+    // Anything that is not listed here may call out to arbitrary code (getters,
+    // setters, valueOf, or just a call), and so kills every load.
+    bool clobbersLoad(Node& node, Node& load)
+    {
+        if (isPure(node.op) || isLoad(node.op))
+            return false;
+        switch (node.op) {
+        case GetLocal:
+        case SetLocal:
+        case Phi:
+            return false;
+        case PutGlobalVar:
+            return load.op == GetGlobalVar && node.varNumber() == load.varNumber();
+        default:
+            return true;
+        }
+    }
+    
+    bool immediatesAreEqual(Node& a, Node& b)
+    {
+        switch (a.op) {
+        case JSConstant:
+            return a.constantNumber() == b.constantNumber();
+        case CheckFunction:
+            return a.functionConstantNumber() == b.functionConstantNumber();
+        case GetGlobalVar:
+            return a.varNumber() == b.varNumber();
+        case GetByVal:
+            // Keep speculating the way both were going to.
+            return a.getPrediction() == b.getPrediction();
+        default:
+            return true;
+        }
+    }
+    
+    bool childrenAreEqual(Node& a, Node& b)
+    {
+        // A GetByVal's third child is only an alias hint.
+        if (a.op == GetByVal)
+            return a.child1() == b.child1() && a.child2() == b.child2();
+        return a.child1() == b.child1() && a.child2() == b.child2() && a.child3() == b.child3();
+    }
+    
+    NodeIndex findEquivalent(BasicBlock& block, NodeIndex nodeIndex)
+    {
+        Node& node = m_graph[nodeIndex];
+        bool load = isLoad(node.op);
+        for (NodeIndex index = nodeIndex; index-- > block.begin;) {
+            Node& candidate = m_graph[index];
+            if (!candidate.shouldGenerate() || m_replacements[index] != NoNode)
+                continue;
+            if (candidate.op == node.op && immediatesAreEqual(candidate, node) && childrenAreEqual(candidate, node))
+                return index;
+            if (load && clobbersLoad(candidate, node))
+                return NoNode;
+        }
+        return NoNode;
+    }
+    
+    void replaceChild(Node& node, NodeIndex& child)
+    {
+        if (child == NoNode)
+            return;
+        NodeIndex replacement = m_replacements[child];
+        if (replacement == NoNode)
+            return;
+        // Nodes that are not generated, such as SetLocals that only serve as
+        // hints for OSR exit, still need to see the replacement, but hold no
+        // references.
+        if (node.shouldGenerate()) {
+            m_graph.ref(replacement);
+            m_graph.deref(child);
+        }
+        child = replacement;
+    }
+    
+    void replaceChildren(Node& node)
+    {
+        if (node.op & NodeHasVarArgs) {
+            for (unsigned childIdx = node.firstChild(); childIdx < node.firstChild() + node.numChildren(); childIdx++)
+                replaceChild(node, m_graph.m_varArgChildren[childIdx]);
+            return;
+        }
+        replaceChild(node, node.children.fixed.child1);
+        replaceChild(node, node.children.fixed.child2);
+        replaceChild(node, node.children.fixed.child3);
+    }
+    
+    void performBlockCSE(BasicBlock& block)
+    {
+        for (NodeIndex nodeIndex = block.begin; nodeIndex < block.end; ++nodeIndex) {
+            Node& node = m_graph[nodeIndex];
+            replaceChildren(node);
+            
+            if (!node.shouldGenerate() || !(isPure(node.op) || isLoad(node.op)))
+                continue;
+            
+            NodeIndex replacement = findEquivalent(block, nodeIndex);
+            if (replacement == NoNode)
+                continue;
+            
+#if ENABLE(DFG_DEBUG_VERBOSE)
+            printf("CSE: @%u -> @%u\n", nodeIndex, replacement);
+#endif
+            m_replacements[nodeIndex] = replacement;
+            ++m_numberOfEliminatedNodes;
+            // The node's remaining references belong to its users, each of which
+            // moves to the replacement as it is visited.
+            if (node.mustGenerate())
+                m_graph.deref(nodeIndex);
+        }
+    }
+    
+    Graph& m_graph;
+    Vector<NodeIndex, 16> m_replacements;
+    unsigned m_numberOfEliminatedNodes;
+};
+
+unsigned performCSE(Graph& graph)
+{
+    return CSE(graph).run();
+}
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(DFG_JIT)
@@ -28,6 +28,7 @@
 
 #include "CodeBlock.h"
 #include "Interpreter.h"
+#include "Options.h"
 
 namespace JSC { namespace DFG {
 
@@ -58,6 +59,50 @@ bool canCompileOpcodes(CodeBlock* codeBlock)
     return true;
 }
 
+bool mightInlineFunctionForCall(CodeBlock* codeBlock)
+{
+    // Functions too big to inline have their bytecode discarded once they
+    // have been compiled, so there is nothing left to parse.
+    unsigned instructionCount = codeBlock->instructions().size();
+    if (!instructionCount || instructionCount > Options::maximumInliningInstructionCount)
+        return false;
+
+    // Looking up a function's caller or arguments starts from the frame that
+    // does the lookup, and an inlined function has none of its own.
+    CommonIdentifiers* propertyNames = codeBlock->globalData()->propertyNames;
+    for (size_t i = 0; i < codeBlock->numberOfIdentifiers(); ++i) {
+        const Identifier& identifier = codeBlock->identifier(i);
+        if (identifier == propertyNames->caller || identifier == propertyNames->arguments)
+            return false;
+    }
+    return true;
+}
+
+bool canInlineOpcodes(CodeBlock* codeBlock)
+{
+    Interpreter* interpreter = codeBlock->globalData()->interpreter;
+    Instruction* instructionsBegin = codeBlock->instructions().begin();
+    unsigned instructionCount = codeBlock->instructions().size();
+    
+    for (unsigned bytecodeOffset = 0; bytecodeOffset < instructionCount; ) {
+        switch (interpreter->getOpcodeID(instructionsBegin[bytecodeOffset].u.opcode)) {
+#define DEFINE_OP(opcode, length)           \
+        case opcode:                        \
+            if (!canInlineOpcode(opcode))   \
+                return false;               \
+            bytecodeOffset += length;       \
+            break;
+            FOR_EACH_OPCODE_ID(DEFINE_OP)
+#undef DEFINE_OP
+        default:
+            ASSERT_NOT_REACHED();
+            break;
+        }
+    }
+    
+    return true;
+}
+
 #endif
 
 } } // namespace JSC::DFG
@@ -38,6 +38,7 @@ inline bool mightCompileEval(CodeBlock*) { return true; }
 inline bool mightCompileProgram(CodeBlock*) { return true; }
 inline bool mightCompileFunctionForCall(CodeBlock*) { return true; }
 inline bool mightCompileFunctionForConstruct(CodeBlock*) { return false; }
+bool mightInlineFunctionForCall(CodeBlock*);
 
 // Opcode checking.
 inline bool canCompileOpcode(OpcodeID opcodeID)
@@ -84,6 +85,9 @@ inline bool canCompileOpcode(OpcodeID opcodeID)
     case op_put_by_id:
     case op_get_global_var:
     case op_put_global_var:
+    case op_new_object:
+    case op_new_array:
+    case op_new_array_buffer:
     case op_jmp:
     case op_loop:
     case op_jtrue:
@@ -118,14 +122,53 @@ inline bool canCompileOpcode(OpcodeID opcodeID)
     }
 }
 
+// Inlined code runs in its caller's frame, so it cannot rely on having its own
+// scope chain, and we only inline functions that are a single basic block.
+inline bool canInlineOpcode(OpcodeID opcodeID)
+{
+    switch (opcodeID) {
+    case op_jmp:
+    case op_loop:
+    case op_jtrue:
+    case op_jfalse:
+    case op_loop_if_true:
+    case op_loop_if_false:
+    case op_jeq_null:
+    case op_jneq_null:
+    case op_jless:
+    case op_jlesseq:
+    case op_jgreater:
+    case op_jgreatereq:
+    case op_jnless:
+    case op_jnlesseq:
+    case op_jngreater:
+    case op_jngreatereq:
+    case op_loop_hint:
+    case op_loop_if_less:
+    case op_loop_if_lesseq:
+    case op_loop_if_greater:
+    case op_loop_if_greatereq:
+    case op_end:
+    case op_resolve:
+    case op_resolve_base:
+        return false;
+    default:
+        return canCompileOpcode(opcodeID);
+    }
+}
+
 bool canCompileOpcodes(CodeBlock*);
+bool canInlineOpcodes(CodeBlock*);
 #else // ENABLE(DFG_JIT)
 inline bool mightCompileEval(CodeBlock*) { return false; }
 inline bool mightCompileProgram(CodeBlock*) { return false; }
 inline bool mightCompileFunctionForCall(CodeBlock*) { return false; }
 inline bool mightCompileFunctionForConstruct(CodeBlock*) { return false; }
+inline bool mightInlineFunctionForCall(CodeBlock*) { return false; }
 inline bool canCompileOpcode(OpcodeID) { return false; }
 inline bool canCompileOpcodes(CodeBlock*) { return false; }
+inline bool canInlineOpcode(OpcodeID) { return false; }
+inline bool canInlineOpcodes(CodeBlock*) { return false; }
 #endif // ENABLE(DFG_JIT)
 
 inline bool canCompileEval(CodeBlock* codeBlock)
@@ -148,6 +191,11 @@ inline bool canCompileFunctionForConstruct(CodeBlock* codeBlock)
     return mightCompileFunctionForConstruct(codeBlock) && canCompileOpcodes(codeBlock);
 }
 
+inline bool canInlineFunctionForCall(CodeBlock* codeBlock)
+{
+    return mightInlineFunctionForCall(codeBlock) && canInlineOpcodes(codeBlock);
+}
+
 } } // namespace JSC::DFG
 
 #endif // DFGCapabilities_h
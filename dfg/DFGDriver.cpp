@@ -28,9 +28,11 @@
 
 #if ENABLE(DFG_JIT)
 
+#include "DFGBoundsCheckElimination.h"
 #include "DFGByteCodeParser.h"
 #include "DFGJITCompiler.h"
 #include "DFGPropagator.h"
+#include "DFGWorklist.h"
 
 namespace JSC { namespace DFG {
 
@@ -46,6 +48,7 @@ inline bool compile(CompileMode compileMode, ExecState* exec, ExecState* calleeA
         dfg.predictArgumentTypes(calleeArgsExec, codeBlock);
     
     propagate(dfg, globalData, codeBlock);
+    performBoundsCheckElimination(dfg, globalData, codeBlock);
     
 #if ENABLE(DYNAMIC_OPTIMIZATION)
     // Save the predictions we've made, so that OSR entry can verify them. Predictions
@@ -82,6 +85,21 @@ bool tryCompileFunction(ExecState* exec, ExecState* calleeArgsExec, CodeBlock* c
     return compile(CompileFunction, exec, calleeArgsExec, codeBlock, jitCode, &jitCodeWithArityCheck);
 }
 
+#if ENABLE(CONCURRENT_JIT)
+bool enqueueFunctionCompilation(ExecState* exec, ExecState* calleeArgsExec, FunctionExecutable* executable, PassOwnPtr<CodeBlock> codeBlock)
+{
+    JSGlobalData* globalData = &exec->globalData();
+    RefPtr<Plan> plan = Plan::create(globalData, executable, codeBlock);
+    if (!plan->parse(calleeArgsExec))
+        return false;
+
+    if (!globalData->dfgWorklist)
+        globalData->dfgWorklist = adoptPtr(new Worklist());
+    globalData->dfgWorklist->enqueue(plan.release());
+    return true;
+}
+#endif
+
 } } // namespace JSC::DFG
 
 #endif // ENABLE(DFG_JIT)
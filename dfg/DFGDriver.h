@@ -26,12 +26,14 @@
 #ifndef DFGDriver_h
 #define DFGDriver_h
 
+#include <wtf/PassOwnPtr.h>
 #include <wtf/Platform.h>
 
 namespace JSC {
 
 class ExecState;
 class CodeBlock;
+class FunctionExecutable;
 class JITCode;
 class MacroAssemblerCodePtr;
 
@@ -45,6 +47,13 @@ inline bool tryCompile(ExecState*, CodeBlock*, JITCode&) { return false; }
 inline bool tryCompileFunction(ExecState*, ExecState*, CodeBlock*, JITCode&, MacroAssemblerCodePtr&) { return false; }
 #endif
 
+#if ENABLE(CONCURRENT_JIT)
+// Parses the function now, against the value profiles as they stand, and
+// leaves the rest of the compilation to the DFG's compilation thread. The
+// executable keeps running the CodeBlock's alternative in the meantime.
+bool enqueueFunctionCompilation(ExecState*, ExecState* calleeArgsExec, FunctionExecutable*, PassOwnPtr<CodeBlock>);
+#endif
+
 } } // namespace JSC::DFG
 
 #endif
@@ -128,6 +128,16 @@ void Graph::dump(NodeIndex nodeIndex, CodeBlock* codeBlock)
         }
         hasPrinted = true;
     }
+    if (node.hasFunctionCheckData()) {
+        printf("%sfunction $%u", hasPrinted ? ", " : "", node.functionConstantNumber());
+        if (codeBlock)
+            printf(" = %s", node.function(codeBlock).description());
+        hasPrinted = true;
+    }
+    if (node.hasConstantBuffer()) {
+        printf("%sbuffer %u, %u constants", hasPrinted ? ", " : "", node.startConstant(), node.numConstants());
+        hasPrinted = true;
+    }
     if  (node.isBranch() || node.isJump()) {
         printf("%sT:#%u", hasPrinted ? ", " : "", blockIndexForBytecodeOffset(node.takenBytecodeOffset()));
         hasPrinted = true;
@@ -136,9 +146,20 @@ void Graph::dump(NodeIndex nodeIndex, CodeBlock* codeBlock)
         printf("%sF:#%u", hasPrinted ? ", " : "", blockIndexForBytecodeOffset(node.notTakenBytecodeOffset()));
         hasPrinted = true;
     }
+    if ((op == GetByVal || op == PutByVal) && node.indexIsWithinVector()) {
+        printf("%sin vector", hasPrinted ? ", " : "");
+        hasPrinted = true;
+    }
+    if (op == GetArrayLength && node.lengthMustBeWithinVector()) {
+        printf("%schecks vector", hasPrinted ? ", " : "");
+        hasPrinted = true;
+    }
     (void)hasPrinted;
     
     printf(")");
+    
+    if (node.codeOrigin.inlineCallFrame())
+        printf("  inlined bc#%u at depth %u", node.codeOrigin.bytecodeIndex(), node.codeOrigin.inlineDepth());
 
     if (!skipped) {
         if (node.hasLocal())
@@ -193,6 +214,26 @@ void Graph::refChildren(NodeIndex op)
     }
 }
 
+void Graph::derefChildren(NodeIndex op)
+{
+    Node& node = at(op);
+
+    if (node.op & NodeHasVarArgs) {
+        for (unsigned childIdx = node.firstChild(); childIdx < node.firstChild() + node.numChildren(); childIdx++)
+            deref(m_varArgChildren[childIdx]);
+    } else {
+        if (node.child1() == NoNode)
+            return;
+        deref(node.child1());
+        if (node.child2() == NoNode)
+            return;
+        deref(node.child2());
+        if (node.child3() == NoNode)
+            return;
+        deref(node.child3());
+    }
+}
+
 void Graph::predictArgumentTypes(ExecState* exec, CodeBlock* codeBlock)
 {
     if (exec) {
@@ -209,7 +250,7 @@ void Graph::predictArgumentTypes(ExecState* exec, CodeBlock* codeBlock)
     
 #if ENABLE(DYNAMIC_OPTIMIZATION)
     ASSERT(codeBlock);
-    ASSERT(codeBlock->alternative);
+    ASSERT(codeBlock->alternative());
 
     CodeBlock* profiledCodeBlock = codeBlock->alternative();
     ASSERT(codeBlock->m_numParameters >= 1);
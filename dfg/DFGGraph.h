@@ -44,6 +44,7 @@ class ExecState;
 namespace DFG {
 
 typedef uint32_t BlockIndex;
+static const BlockIndex NoBlock = UINT_MAX;
 
 // For every local variable we track any existing get or set of the value.
 // We track the get so that these may be shared, and we track the set to
@@ -80,6 +81,12 @@ struct BasicBlock {
     NodeIndex end;
     bool isOSRTarget;
 
+    // Array variables whose length bounds check elimination relies on not
+    // exceeding their vector length. The first are checked just before the
+    // block's terminal (the block is a loop preheader), the second on OSR entry.
+    Vector<VirtualRegister, 1> hoistedArrayChecks;
+    Vector<VirtualRegister, 1> osrEntryArrayChecks;
+
     PredecessorList m_predecessors;
     Vector <VariableRecord, 8> m_arguments;
     Vector <VariableRecord, 16> m_locals;
@@ -94,7 +101,8 @@ struct BasicBlock {
 class Graph : public Vector<Node, 64> {
 public:
     Graph(unsigned numArguments, unsigned numVariables)
-        : m_predictions(numArguments, numVariables)
+        : m_firstInlinedRegister(0)
+        , m_predictions(numArguments, numVariables)
     {
     }
 
@@ -107,6 +115,15 @@ public:
             refChildren(nodeIndex);
     }
 
+    // Drop a reference to a node.
+    void deref(NodeIndex nodeIndex)
+    {
+        Node& node = at(nodeIndex);
+        // If the value (after decrementing) is at refCount zero then we need to deref its children.
+        if (node.deref())
+            derefChildren(nodeIndex);
+    }
+
 #ifndef NDEBUG
     // CodeBlock is optional, but may allow additional information to be dumped (e.g. Identifier names).
     void dump(CodeBlock* = 0);
@@ -171,6 +188,23 @@ public:
         return m_predictions.getGlobalVarPrediction(varNumber);
     }
     
+    // Is this local kept in the register file as an unboxed double? Only the
+    // registers of the machine frame qualify; stack walks may read the arguments
+    // and locals of inlined frames, so those always hold JSValues.
+    bool isUnboxedDoubleLocal(int operand)
+    {
+#if ENABLE(DFG_OSR_EXIT)
+        if (operandIsArgument(operand) || static_cast<unsigned>(operand) >= m_firstInlinedRegister)
+            return false;
+        return isUnboxedDoublePrediction(getPrediction(operand));
+#else
+        // Speculation failures resume in the non-speculative JIT, which expects
+        // every local to be boxed.
+        UNUSED_PARAM(operand);
+        return false;
+#endif
+    }
+    
     PredictedType getPrediction(Node& node)
     {
         Node* nodePtr = &node;
@@ -246,12 +280,36 @@ public:
 
     void predictArgumentTypes(ExecState*, CodeBlock*);
 
+    CodeBlock* baselineCodeBlockFor(InlineCallFrame* inlineCallFrame)
+    {
+        ASSERT(m_baselineCodeBlocksForInlineCallFrames.contains(inlineCallFrame));
+        return m_baselineCodeBlocksForInlineCallFrames.get(inlineCallFrame);
+    }
+
+    // Has the optimized code previously compiled for this node's bytecode
+    // kept exiting for the given reason? Only the machine code block's own
+    // exits are attributed to its bytecode; those in inlined code are charged
+    // to the call site that inlined them.
+    bool hasFrequentExitSite(CodeBlock* profiledBlock, Node& node, ExitKind kind)
+    {
+        if (node.codeOrigin.inlineCallFrame())
+            return false;
+        return profiledBlock->exitProfile().hasExitSite(FrequentExitSite(node.codeOrigin.bytecodeIndex(), kind));
+    }
+
     Vector< OwnPtr<BasicBlock> , 8> m_blocks;
     Vector<NodeIndex, 16> m_varArgChildren;
+    // The baseline code of each inlined function, as the parser found it. Code
+    // generation may run on a compilation thread, so it cannot go back to the
+    // function's executable, which the mutator may be recompiling meanwhile.
+    HashMap<InlineCallFrame*, CodeBlock*> m_baselineCodeBlocksForInlineCallFrames;
+    // Registers from here on may belong to inlined frames, arguments included.
+    unsigned m_firstInlinedRegister;
 private:
 
     // When a node's refCount goes from 0 to 1, it must (logically) recursively ref all of its children, and vice versa.
     void refChildren(NodeIndex);
+    void derefChildren(NodeIndex);
 
     PredictionTracker m_predictions;
 };
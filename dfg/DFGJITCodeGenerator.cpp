@@ -401,8 +401,10 @@ bool JITCodeGenerator::isKnownNotNumber(NodeIndex nodeIndex)
     VirtualRegister virtualRegister = node.virtualRegister();
     GenerationInfo& info = m_generationInfo[virtualRegister];
     
-    return (!info.isJSDouble() && !info.isJSInteger())
-        || (node.isConstant() && !isNumberConstant(nodeIndex));
+    // A value in DataFormatJS may well be a number; only cells and booleans are known not to be.
+    if (node.isConstant())
+        return !isNumberConstant(nodeIndex);
+    return info.isJSCell() || info.isJSBoolean();
 }
 
 bool JITCodeGenerator::isKnownBoolean(NodeIndex nodeIndex)
@@ -495,6 +497,18 @@ void JITCodeGenerator::writeBarrier(MacroAssembler& jit, GPRReg owner, GPRReg sc
 #if ENABLE(WRITE_BARRIER_PROFILING)
     JITCompiler::emitCount(jit, WriteBarrierCounters::jitCounterFor(useKind));
 #endif
+
+#if ENABLE(GGC)
+    // Mark the owner's card without a second scratch register; see JIT::emitWriteBarrier().
+    jit.move(owner, scratch);
+    jit.andPtr(MacroAssembler::TrustedImm32(MarkedBlock::blockSize - 1), scratch);
+    jit.add32(MacroAssembler::TrustedImm32(1), scratch);
+    jit.mul32(MacroAssembler::TrustedImm32(MarkedBlock::bytesPerCard - 1), scratch, scratch);
+    jit.urshift32(MacroAssembler::TrustedImm32(MarkedBlock::log2BytesPerCard), scratch);
+    jit.subPtr(scratch, owner);
+    jit.store8(MacroAssembler::TrustedImm32(1), MacroAssembler::Address(owner, MarkedBlock::offsetOfCards()));
+    jit.addPtr(scratch, owner);
+#endif
 }
 
 void JITCodeGenerator::cachedPutById(GPRReg baseGPR, GPRReg valueGPR, GPRReg scratchGPR, unsigned identifierNumber, PutKind putKind, JITCompiler::Jump slowPathTarget)
@@ -1009,7 +1023,7 @@ void JITCodeGenerator::emitBranch(Node& node)
         }
         
         if (m_isSpeculative && predictBoolean) {
-            speculationCheck(m_jit.jump());
+            speculationCheck(BadType, m_jit.jump());
             value.use();
         } else {
             addBranch(m_jit.branchPtr(MacroAssembler::Equal, valueGPR, MacroAssembler::ImmPtr(JSValue::encode(jsNumber(0)))), notTaken);
@@ -1151,10 +1165,80 @@ void JITCodeGenerator::emitCall(Node& node)
     m_jit.addJSCall(fastCall, slowCall, targetToCheck, isCall, m_jit.graph()[m_compileIndex].codeOrigin);
 }
 
-void JITCodeGenerator::speculationCheck(MacroAssembler::Jump jumpToFail)
+void JITCodeGenerator::emitNewObject(Node&)
+{
+    GPRTemporary result(this);
+    GPRTemporary scratch(this);
+    
+    GPRReg resultGPR = result.gpr();
+    GPRReg scratchGPR = scratch.gpr();
+    
+    // Take the cell off the head of its size class's free list, as the old
+    // JIT does; an empty free list calls out to the heap to refill it.
+    NewSpace::SizeClass* sizeClass = &m_jit.globalData()->heap.sizeClassFor(sizeof(JSFinalObject));
+    m_jit.loadPtr(&sizeClass->firstFreeCell, resultGPR);
+    MacroAssembler::Jump slowPath = m_jit.branchTestPtr(MacroAssembler::Zero, resultGPR);
+    
+    m_jit.loadPtr(MacroAssembler::Address(resultGPR), scratchGPR);
+    m_jit.storePtr(scratchGPR, &sizeClass->firstFreeCell);
+    
+    m_jit.storePtr(MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsFinalObjectVPtr), MacroAssembler::Address(resultGPR));
+    m_jit.storePtr(MacroAssembler::TrustedImmPtr(m_jit.codeBlock()->globalObject()->emptyObjectStructure()), MacroAssembler::Address(resultGPR, JSCell::structureOffset()));
+    m_jit.storePtr(MacroAssembler::TrustedImmPtr(0), MacroAssembler::Address(resultGPR, JSObject::offsetOfInheritorID()));
+    m_jit.addPtr(MacroAssembler::TrustedImm32(sizeof(JSObject)), resultGPR, scratchGPR);
+    m_jit.storePtr(scratchGPR, MacroAssembler::Address(resultGPR, JSFinalObject::offsetOfPropertyStorage()));
+    
+    MacroAssembler::Jump done = m_jit.jump();
+    
+    slowPath.link(&m_jit);
+    
+    silentSpillAllRegisters(resultGPR);
+    m_jit.move(GPRInfo::callFrameRegister, GPRInfo::argumentGPR0);
+    appendCallWithExceptionCheck(operationNewObject);
+    m_jit.move(GPRInfo::returnValueGPR, resultGPR);
+    silentFillAllRegisters(resultGPR);
+    
+    done.link(&m_jit);
+    
+    cellResult(resultGPR, m_compileIndex);
+}
+
+void JITCodeGenerator::emitNewArray(Node& node)
+{
+    // The elements go in the slots at the top of our frame, where the
+    // collector will find them while the array is being allocated.
+    int numElements = node.numChildren();
+    for (int elementIdx = 0; elementIdx < numElements; ++elementIdx) {
+        NodeIndex elementNodeIndex = m_jit.graph().m_varArgChildren[node.firstChild() + elementIdx];
+        JSValueOperand element(this, elementNodeIndex);
+        GPRReg elementGPR = element.gpr();
+        use(elementNodeIndex);
+        
+        m_jit.storePtr(elementGPR, addressOfCallData(-numElements + elementIdx));
+    }
+    
+    flushRegisters();
+    
+    GPRResult result(this);
+    callOperation(operationNewArray, result.gpr(), addressOfCallData(-numElements), numElements);
+    
+    cellResult(result.gpr(), m_compileIndex, UseChildrenCalledExplicitly);
+}
+
+void JITCodeGenerator::emitNewArrayBuffer(Node& node)
+{
+    flushRegisters();
+    
+    GPRResult result(this);
+    callOperation(operationNewArrayBuffer, result.gpr(), node.startConstant(), node.numConstants());
+    
+    cellResult(result.gpr(), m_compileIndex);
+}
+
+void JITCodeGenerator::speculationCheck(ExitKind kind, MacroAssembler::Jump jumpToFail)
 {
     ASSERT(m_isSpeculative);
-    static_cast<SpeculativeJIT*>(this)->speculationCheck(jumpToFail);
+    static_cast<SpeculativeJIT*>(this)->speculationCheck(kind, jumpToFail);
 }
 
 #ifndef NDEBUG
@@ -588,7 +588,11 @@ protected:
     
     void emitCall(Node&);
     
-    void speculationCheck(MacroAssembler::Jump jumpToFail);
+    void emitNewObject(Node&);
+    void emitNewArray(Node&);
+    void emitNewArrayBuffer(Node&);
+    
+    void speculationCheck(ExitKind, MacroAssembler::Jump jumpToFail);
 
     // Called once a node has completed code generation but prior to setting
     // its result, to free up its children. (This must happen prior to setting
@@ -808,6 +812,15 @@ protected:
     }
 
     // These methods add calls to C++ helper functions.
+    void callOperation(J_DFGOperation_E operation, GPRReg result)
+    {
+        ASSERT(isFlushed());
+
+        m_jit.move(GPRInfo::callFrameRegister, GPRInfo::argumentGPR0);
+
+        appendCallWithExceptionCheck(operation);
+        m_jit.move(GPRInfo::returnValueGPR, result);
+    }
     void callOperation(J_DFGOperation_EP operation, GPRReg result, void* pointer)
     {
         ASSERT(isFlushed());
@@ -837,6 +850,28 @@ protected:
     {
         callOperation((J_DFGOperation_EJP)operation, result, arg1, identifier);
     }
+    void callOperation(J_DFGOperation_EPS operation, GPRReg result, MacroAssembler::Address buffer, size_t size)
+    {
+        ASSERT(isFlushed());
+
+        m_jit.addPtr(MacroAssembler::TrustedImm32(buffer.offset), buffer.base, GPRInfo::argumentGPR1);
+        m_jit.move(MacroAssembler::TrustedImm32(size), GPRInfo::argumentGPR2);
+        m_jit.move(GPRInfo::callFrameRegister, GPRInfo::argumentGPR0);
+
+        appendCallWithExceptionCheck(operation);
+        m_jit.move(GPRInfo::returnValueGPR, result);
+    }
+    void callOperation(J_DFGOperation_ESS operation, GPRReg result, size_t arg1, size_t arg2)
+    {
+        ASSERT(isFlushed());
+
+        m_jit.move(MacroAssembler::TrustedImm32(arg1), GPRInfo::argumentGPR1);
+        m_jit.move(MacroAssembler::TrustedImm32(arg2), GPRInfo::argumentGPR2);
+        m_jit.move(GPRInfo::callFrameRegister, GPRInfo::argumentGPR0);
+
+        appendCallWithExceptionCheck(operation);
+        m_jit.move(GPRInfo::returnValueGPR, result);
+    }
     void callOperation(J_DFGOperation_EJ operation, GPRReg result, GPRReg arg1)
     {
         ASSERT(isFlushed());
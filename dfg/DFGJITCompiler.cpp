@@ -107,7 +107,7 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
     exit.m_check.link(this);
 
 #if ENABLE(DFG_DEBUG_VERBOSE)
-    fprintf(stderr, "OSR exit for Node @%d (bc#%u) at JIT offset 0x%x   ", (int)exit.m_nodeIndex, exit.m_bytecodeIndex, debugOffset());
+    fprintf(stderr, "OSR exit for Node @%d (bc#%u, inline depth %u) at JIT offset 0x%x   ", (int)exit.m_nodeIndex, exit.m_codeOrigin.bytecodeIndex(), exit.m_codeOrigin.inlineDepth(), debugOffset());
     exit.dump(stderr);
 #endif
 #if ENABLE(DFG_JIT_BREAK_ON_SPECULATION_FAILURE)
@@ -153,7 +153,8 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
     //    whose destination is now occupied by a DFG virtual register, and we need
     //    one for every displaced virtual register if there are more than
     //    GPRInfo::numberOfRegisters of them. Also see if there are any constants,
-    //    any undefined slots, any FPR slots, and any unboxed ints.
+    //    any undefined slots, any FPR slots, any unboxed ints, and any unboxed
+    //    doubles in the register file.
             
     Vector<bool> poisonedVirtualRegisters(exit.m_variables.size());
     for (unsigned i = 0; i < poisonedVirtualRegisters.size(); ++i)
@@ -167,6 +168,7 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
     // expect most of them to be jsUndefined(); if that's true then we handle that
     // specially to minimize code size and execution time.
     bool haveUnboxedInt32s = false;
+    bool haveUnboxedDoubles = false;
     bool haveFPRs = false;
     bool haveConstants = false;
     bool haveUndefined = false;
@@ -205,6 +207,10 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
             haveUnboxedInt32s = true;
             break;
             
+        case AlreadyInRegisterFileAsUnboxedDouble:
+            haveUnboxedDoubles = true;
+            break;
+            
         case InFPR:
             haveFPRs = true;
             break;
@@ -287,7 +293,23 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
     
     ASSERT(scratchIndex == numberOfPoisonedVirtualRegisters);
     
-    // 8) Reshuffle displaced virtual registers. Optimize for the case that
+    // 8) Box the doubles that the DFG kept unboxed in their own slots in the
+    //    register file. Nothing gets displaced into these slots, so this can be
+    //    done in place.
+    
+    if (haveUnboxedDoubles) {
+        for (int index = 0; index < exit.numberOfRecoveries(); ++index) {
+            const ValueRecovery& recovery = exit.valueRecovery(index);
+            if (recovery.technique() != AlreadyInRegisterFileAsUnboxedDouble)
+                continue;
+            Address address = addressFor((VirtualRegister)exit.operandForIndex(index));
+            loadDouble(address, FPRInfo::fpRegT0);
+            boxDouble(FPRInfo::fpRegT0, GPRInfo::regT0);
+            storePtr(GPRInfo::regT0, address);
+        }
+    }
+    
+    // 9) Reshuffle displaced virtual registers. Optimize for the case that
     //    the number of displaced virtual registers is not more than the number
     //    of available physical registers.
     
@@ -350,7 +372,7 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
         }
     }
     
-    // 9) Dump all poisoned virtual registers.
+    // 10) Dump all poisoned virtual registers.
     
     scratchIndex = 0;
     if (numberOfPoisonedVirtualRegisters) {
@@ -374,7 +396,7 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
     }
     ASSERT(scratchIndex == numberOfPoisonedVirtualRegisters);
     
-    // 10) Dump all constants. Optimize for Undefined, since that's a constant we see
+    // 11) Dump all constants. Optimize for Undefined, since that's a constant we see
     //     often.
 
     if (haveConstants) {
@@ -392,11 +414,15 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
         }
     }
     
-    // 11) Adjust the old JIT's execute counter. Since we are exiting OSR, we know
-    //     that all new calls into this code will go to the new JIT, so the execute
-    //     counter only affects call frames that performed OSR exit and call frames
-    //     that were still executing the old JIT at the time of another call frame's
-    //     OSR exit. We want to ensure that the following is true:
+    // 12) Count the exit, both for its own site, so that a later compilation
+    //     knows which speculation to avoid, and in total, so that we notice when
+    //     this code has become more trouble than it is worth.
+    //
+    //     Then adjust the old JIT's execute counter. Since we are exiting OSR, we
+    //     know that all new calls into this code will go to the new JIT, so the
+    //     execute counter only affects call frames that performed OSR exit and
+    //     call frames that were still executing the old JIT at the time of another
+    //     call frame's OSR exit. We want to ensure that the following is true:
     //
     //     (a) Code the performs an OSR exit gets a chance to reenter optimized
     //         code eventually, since optimized code is faster. But we don't
@@ -410,39 +436,76 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
     //         entry, since both forms of OSR are expensive. OSR entry is
     //         particularly expensive.
     //
-    //     To ensure (c), we'd like to set the execute counter to
-    //     counterValueForOptimizeAfterWarmUp(). This seems like it would endanger
-    //     (a) and (b), since then every OSR exit would delay the opportunity for
-    //     every call frame to perform OSR entry. Essentially, if OSR exit happens
-    //     frequently and the function has few loops, then the counter will never
-    //     become non-negative and OSR entry will never be triggered. OSR entry
-    //     will only happen if a loop gets hot in the old JIT, which does a pretty
-    //     good job of ensuring (a) and (b). This heuristic may need to be
-    //     rethought in the future, particularly if we support reoptimizing code
-    //     with new value profiles gathered from code that did OSR exit.
-    
+    //     (d) Optimized code that exits frequently is thrown away, and the
+    //         function reoptimized with what its exits taught us, before it
+    //         wastes much more time.
+    //
+    //     To ensure (c), we set the execute counter to
+    //     counterValueForOptimizeAfterWarmUp(). OSR entry will then only happen
+    //     if a loop gets hot in the old JIT, which does a pretty good job of
+    //     ensuring (a) and (b). To ensure (d), once the exit count reaches
+    //     osrExitCountForReoptimization() we instead make the next optimization
+    //     trigger fire right away; it will find that the optimized code should
+    //     be reoptimized.
+    
+    add32(TrustedImm32(1), AbsoluteAddress(codeBlock()->addOSRExitCounter(exit.m_codeOrigin.bytecodeIndexInMachineCodeBlock(), exit.m_kind).addressOfCount()));
+    
+    move(TrustedImmPtr(codeBlock()->addressOfOSRExitCounter()), GPRInfo::regT1);
+    load32(GPRInfo::regT1, GPRInfo::regT0);
+    add32(TrustedImm32(1), GPRInfo::regT0);
+    store32(GPRInfo::regT0, GPRInfo::regT1);
+    
+    Jump fewFails = branch32(BelowOrEqual, GPRInfo::regT0, Imm32(codeBlock()->osrExitCountForReoptimization()));
+    store32(Imm32(0), codeBlock()->alternative()->addressOfExecuteCounter());
+    Jump doneAdjusting = jump();
+    
+    fewFails.link(this);
     store32(Imm32(codeBlock()->alternative()->counterValueForOptimizeAfterWarmUp()), codeBlock()->alternative()->addressOfExecuteCounter());
     
-    // 12) Load the result of the last bytecode operation into regT0.
+    doneAdjusting.link(this);
+    
+    // 13) Load the result of the last bytecode operation into regT0.
     
     if (exit.m_lastSetOperand != std::numeric_limits<int>::max())
         loadPtr(addressFor((VirtualRegister)exit.m_lastSetOperand), GPRInfo::cachedResultRegister);
     
-    // 13) Fix call frame.
+    // 14) Fix call frame(s).
     
     ASSERT(codeBlock()->alternative()->getJITType() == JITCode::BaselineJIT);
     storePtr(TrustedImmPtr(codeBlock()->alternative()), addressFor((VirtualRegister)RegisterFile::CodeBlock));
     
-    // 14) Jump into the corresponding baseline JIT code.
+    // If we are exiting from inlined code, the baseline code expects every
+    // inlined call to have its own call frame, returning into the baseline
+    // code of its caller. Their registers are already in place.
     
-    BytecodeAndMachineOffset* mapping = binarySearch<BytecodeAndMachineOffset, unsigned, BytecodeAndMachineOffset::getBytecodeIndex>(decodedCodeMap.begin(), decodedCodeMap.size(), exit.m_bytecodeIndex);
+    ASSERT(GPRInfo::regT1 != GPRInfo::cachedResultRegister);
+    ASSERT(GPRInfo::regT2 != GPRInfo::cachedResultRegister);
     
-    ASSERT(mapping);
-    ASSERT(mapping->m_bytecodeIndex == exit.m_bytecodeIndex);
+    for (InlineCallFrame* inlineCallFrame = exit.m_codeOrigin.inlineCallFrame(); inlineCallFrame; inlineCallFrame = inlineCallFrame->caller.inlineCallFrame())
+        reifyInlinedCallFrame(inlineCallFrame);
     
-    void* jumpTarget = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(codeBlock()->alternative()->getJITCode().start()) + mapping->m_machineCodeOffset);
+    CodeBlock* baselineCodeBlock = codeBlock()->alternative();
+    if (InlineCallFrame* inlineCallFrame = exit.m_codeOrigin.inlineCallFrame()) {
+        baselineCodeBlock = m_graph.baselineCodeBlockFor(inlineCallFrame);
+        addPtr(Imm32(inlineCallFrame->stackOffset * sizeof(Register)), GPRInfo::callFrameRegister);
+    }
     
-    ASSERT(GPRInfo::regT1 != GPRInfo::cachedResultRegister);
+    // 15) Jump into the corresponding baseline JIT code.
+    
+    Vector<BytecodeAndMachineOffset> inlinedCodeMap;
+    Vector<BytecodeAndMachineOffset>* codeMap = &decodedCodeMap;
+    if (baselineCodeBlock != codeBlock()->alternative()) {
+        ASSERT(baselineCodeBlock->jitCodeMap());
+        baselineCodeBlock->jitCodeMap()->decode(inlinedCodeMap);
+        codeMap = &inlinedCodeMap;
+    }
+    
+    BytecodeAndMachineOffset* mapping = binarySearch<BytecodeAndMachineOffset, unsigned, BytecodeAndMachineOffset::getBytecodeIndex>(codeMap->begin(), codeMap->size(), exit.m_codeOrigin.bytecodeIndex());
+    
+    ASSERT(mapping);
+    ASSERT(mapping->m_bytecodeIndex == exit.m_codeOrigin.bytecodeIndex());
+    
+    void* jumpTarget = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(baselineCodeBlock->getJITCode().start()) + mapping->m_machineCodeOffset);
     
     move(TrustedImmPtr(jumpTarget), GPRInfo::regT1);
     jump(GPRInfo::regT1);
@@ -452,6 +515,25 @@ void JITCompiler::exitSpeculativeWithOSR(const OSRExit& exit, SpeculationRecover
 #endif
 }
 
+void JITCompiler::reifyInlinedCallFrame(InlineCallFrame* inlineCallFrame)
+{
+    CodeBlock* baselineCodeBlock = m_graph.baselineCodeBlockFor(inlineCallFrame);
+    CodeBlock* callerBaselineCodeBlock = inlineCallFrame->caller.inlineCallFrame() ? m_graph.baselineCodeBlockFor(inlineCallFrame->caller.inlineCallFrame()) : codeBlock()->alternative();
+    JSFunction* callee = inlineCallFrame->callee.get();
+    
+    // The callee returns to where the baseline call would have returned to.
+    void* returnPC = callerBaselineCodeBlock->getCallLinkInfo(inlineCallFrame->caller.bytecodeIndex()).hotPathOther.executableAddress();
+    int callerStackOffset = inlineCallFrame->caller.inlineCallFrame() ? inlineCallFrame->caller.inlineCallFrame()->stackOffset : 0;
+    
+    storePtr(TrustedImmPtr(baselineCodeBlock), addressFor((VirtualRegister)(inlineCallFrame->stackOffset + RegisterFile::CodeBlock)));
+    storePtr(TrustedImmPtr(callee->scope()), addressFor((VirtualRegister)(inlineCallFrame->stackOffset + RegisterFile::ScopeChain)));
+    addPtr(Imm32(callerStackOffset * sizeof(Register)), GPRInfo::callFrameRegister, GPRInfo::regT2);
+    storePtr(GPRInfo::regT2, addressFor((VirtualRegister)(inlineCallFrame->stackOffset + RegisterFile::CallerFrame)));
+    storePtr(TrustedImmPtr(returnPC), addressFor((VirtualRegister)(inlineCallFrame->stackOffset + RegisterFile::ReturnPC)));
+    storePtr(TrustedImmPtr(JSValue::encode(jsNumber(inlineCallFrame->argumentCountIncludingThis))), addressFor((VirtualRegister)(inlineCallFrame->stackOffset + RegisterFile::ArgumentCount)));
+    storePtr(TrustedImmPtr(callee), addressFor((VirtualRegister)(inlineCallFrame->stackOffset + RegisterFile::Callee)));
+}
+
 void JITCompiler::linkOSRExits(SpeculativeJIT& speculative)
 {
     Vector<BytecodeAndMachineOffset> decodedCodeMap;
@@ -1297,11 +1379,24 @@ void JITCompiler::link(LinkBuffer& linkBuffer)
         for (unsigned i = 0; i < m_calls.size(); ++i) {
             if (m_calls[i].m_handlesExceptions) {
                 unsigned returnAddressOffset = linkBuffer.returnAddressOffset(m_calls[i].m_call);
-                unsigned exceptionInfo = m_calls[i].m_codeOrigin.bytecodeIndex();
+                unsigned exceptionInfo = m_calls[i].m_codeOrigin.bytecodeIndexInMachineCodeBlock();
                 m_codeBlock->callReturnIndexVector().append(CallReturnOffsetToBytecodeOffset(returnAddressOffset, exceptionInfo));
             }
         }
     }
+    
+    // Calls made from inlined code need to know which inlined frame they were
+    // made from, both to find exception handlers and to walk the stack.
+    if (m_codeBlock->hasInlineCallFrames()) {
+        for (unsigned i = 0; i < m_calls.size(); ++i) {
+            if (!m_calls[i].m_handlesExceptions || !m_calls[i].m_codeOrigin.inlineCallFrame())
+                continue;
+            CodeOriginAtCallReturnOffset record;
+            record.codeOrigin = m_calls[i].m_codeOrigin;
+            record.callReturnOffset = linkBuffer.returnAddressOffset(m_calls[i].m_call);
+            m_codeBlock->codeOrigins().append(record);
+        }
+    }
 
     m_codeBlock->setNumberOfStructureStubInfos(m_propertyAccesses.size());
     for (unsigned i = 0; i < m_propertyAccesses.size(); ++i) {
@@ -1322,6 +1417,7 @@ void JITCompiler::link(LinkBuffer& linkBuffer)
         CallLinkInfo& info = m_codeBlock->callLinkInfo(i);
         info.isCall = m_jsCalls[i].m_isCall;
         info.isDFG = true;
+        info.bytecodeIndex = m_jsCalls[i].m_codeOrigin.bytecodeIndexInMachineCodeBlock();
         info.callReturnLocation = CodeLocationLabel(linkBuffer.locationOf(m_jsCalls[i].m_slowCall));
         info.hotPathBegin = linkBuffer.locationOf(m_jsCalls[i].m_targetToCheck);
         info.hotPathOther = linkBuffer.locationOfNearCall(m_jsCalls[i].m_fastCall);
@@ -1351,6 +1447,12 @@ void JITCompiler::compile(JITCode& entry)
 }
 
 void JITCompiler::compileFunction(JITCode& entry, MacroAssemblerCodePtr& entryWithArityCheck)
+{
+    generateFunction();
+    linkFunction(entry, entryWithArityCheck);
+}
+
+void JITCompiler::generateFunction()
 {
     compileEntry();
 
@@ -1383,7 +1485,7 @@ void JITCompiler::compileFunction(JITCode& entry, MacroAssemblerCodePtr& entryWi
     registerFileCheck.link(this);
     move(stackPointerRegister, GPRInfo::argumentGPR0);
     poke(GPRInfo::callFrameRegister, OBJECT_OFFSETOF(struct JITStackFrame, callFrame) / sizeof(void*));
-    Call callRegisterFileCheck = call();
+    m_callRegisterFileCheck = call();
     jump(fromRegisterFileCheck);
     
     // The fast entry point into a function does not check the correct number of arguments
@@ -1391,26 +1493,28 @@ void JITCompiler::compileFunction(JITCode& entry, MacroAssemblerCodePtr& entryWi
     // determine the correct number of arguments have been passed, or have already checked).
     // In cases where an arity check is necessary, we enter here.
     // FIXME: change this from a cti call to a DFG style operation (normal C calling conventions).
-    Label arityCheck = label();
+    m_arityCheck = label();
     preserveReturnAddressAfterCall(GPRInfo::regT2);
     emitPutToCallFrameHeader(GPRInfo::regT2, RegisterFile::ReturnPC);
     branch32(Equal, GPRInfo::regT1, Imm32(m_codeBlock->m_numParameters)).linkTo(fromArityCheck, this);
     move(stackPointerRegister, GPRInfo::argumentGPR0);
     poke(GPRInfo::callFrameRegister, OBJECT_OFFSETOF(struct JITStackFrame, callFrame) / sizeof(void*));
-    Call callArityCheck = call();
+    m_callArityCheck = call();
     move(GPRInfo::regT0, GPRInfo::callFrameRegister);
     jump(fromArityCheck);
+}
 
-
+void JITCompiler::linkFunction(JITCode& entry, MacroAssemblerCodePtr& entryWithArityCheck)
+{
     // === Link ===
     LinkBuffer linkBuffer(*m_globalData, this);
     link(linkBuffer);
     
     // FIXME: switch the register file check & arity check over to DFGOpertaion style calls, not JIT stubs.
-    linkBuffer.link(callRegisterFileCheck, cti_register_file_check);
-    linkBuffer.link(callArityCheck, m_codeBlock->m_isConstructor ? cti_op_construct_arityCheck : cti_op_call_arityCheck);
+    linkBuffer.link(m_callRegisterFileCheck, cti_register_file_check);
+    linkBuffer.link(m_callArityCheck, m_codeBlock->m_isConstructor ? cti_op_construct_arityCheck : cti_op_call_arityCheck);
 
-    entryWithArityCheck = linkBuffer.locationOf(arityCheck);
+    entryWithArityCheck = linkBuffer.locationOf(m_arityCheck);
     entry = JITCode(linkBuffer.finalizeCode(), JITCode::DFGJIT);
 }
 
@@ -130,6 +130,13 @@ public:
     void compile(JITCode& entry);
     void compileFunction(JITCode& entry, MacroAssemblerCodePtr& entryWithArityCheck);
 
+    // compileFunction() in two steps. generateFunction() only reads the graph
+    // and the CodeBlock being compiled, so it may run on a compilation thread;
+    // linkFunction() copies the code into executable memory and fills in the
+    // CodeBlock, on the thread running JavaScript.
+    void generateFunction();
+    void linkFunction(JITCode& entry, MacroAssemblerCodePtr& entryWithArityCheck);
+
     // Accessors for properties.
     Graph& graph() { return m_graph; }
     CodeBlock* codeBlock() { return m_codeBlock; }
@@ -336,6 +343,7 @@ private:
     
 #if ENABLE(DFG_OSR_EXIT)
     void exitSpeculativeWithOSR(const OSRExit&, SpeculationRecovery*, Vector<BytecodeAndMachineOffset>& decodedCodeMap);
+    void reifyInlinedCallFrame(InlineCallFrame*);
     void linkOSRExits(SpeculativeJIT&);
 #else
     void jumpFromSpeculativeToNonSpeculative(const SpeculationCheck&, const EntryLocation&, SpeculationRecovery*, NodeToRegisterMap& checkNodeToRegisterMap, NodeToRegisterMap& entryNodeToRegisterMap);
@@ -360,6 +368,11 @@ private:
     Label m_startOfCode;
     CompactJITCodeMap::Encoder m_jitCodeMapEncoder;
 
+    // The function footer, recorded by generateFunction() for linkFunction().
+    Label m_arityCheck;
+    Call m_callRegisterFileCheck;
+    Call m_callArityCheck;
+
     struct PropertyAccessRecord {
         PropertyAccessRecord(Call functionCall, int16_t deltaCheckImmToCall, int16_t deltaCallToStructCheck, int16_t deltaCallToLoadOrStore, int16_t deltaCallToSlowCase, int16_t deltaCallToDone, int8_t baseGPR, int8_t valueGPR, int8_t scratchGPR)
             : m_functionCall(functionCall)
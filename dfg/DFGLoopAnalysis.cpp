@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "DFGLoopAnalysis.h"
+
+#if ENABLE(DFG_JIT)
+
+namespace JSC { namespace DFG {
+
+LoopAnalysis::LoopAnalysis(Graph& graph)
+    : m_graph(graph)
+{
+    computeDominators();
+    computeLoops();
+}
+
+unsigned LoopAnalysis::numberOfSuccessors(Graph& graph, BasicBlock& block)
+{
+    Node& terminal = graph[block.end - 1];
+    ASSERT(terminal.isTerminal());
+    if (terminal.isJump())
+        return 1;
+    if (terminal.isBranch())
+        return 2;
+    return 0;
+}
+
+BlockIndex LoopAnalysis::successor(Graph& graph, BasicBlock& block, unsigned index)
+{
+    Node& terminal = graph[block.end - 1];
+    ASSERT(index < numberOfSuccessors(graph, block));
+    if (!index)
+        return graph.blockIndexForBytecodeOffset(terminal.takenBytecodeOffset());
+    return graph.blockIndexForBytecodeOffset(terminal.notTakenBytecodeOffset());
+}
+
+bool LoopAnalysis::dominates(BlockIndex dominator, BlockIndex block)
+{
+    if (m_immediateDominator[block] == NoBlock)
+        return false;
+    while (block != dominator) {
+        if (!block)
+            return false;
+        block = m_immediateDominator[block];
+    }
+    return true;
+}
+
+BlockIndex LoopAnalysis::intersect(BlockIndex a, BlockIndex b)
+{
+    while (a != b) {
+        while (m_postOrderNumber[a] < m_postOrderNumber[b])
+            a = m_immediateDominator[a];
+        while (m_postOrderNumber[b] < m_postOrderNumber[a])
+            b = m_immediateDominator[b];
+    }
+    return a;
+}
+
+// This is the iterative algorithm of Cooper, Harvey and Kennedy, "A Simple, Fast
+// Dominance Algorithm". Our graphs are small and mostly reducible, so it settles
+// in a couple of passes.
+void LoopAnalysis::computeDominators()
+{
+    size_t numberOfBlocks = m_graph.m_blocks.size();
+    m_postOrderNumber.fill(UINT_MAX, numberOfBlocks);
+    m_immediateDominator.fill(NoBlock, numberOfBlocks);
+
+    // Number the reachable blocks in post order, with an explicit stack of
+    // blocks and the index of the next successor to visit.
+    Vector<bool, 16> visited;
+    visited.fill(false, numberOfBlocks);
+    Vector<std::pair<BlockIndex, unsigned>, 16> stack;
+    Vector<BlockIndex, 16> postOrder;
+    stack.append(std::make_pair(static_cast<BlockIndex>(0), 0u));
+    visited[0] = true;
+    while (!stack.isEmpty()) {
+        BlockIndex block = stack.last().first;
+        unsigned successorIndex = stack.last().second;
+        if (successorIndex < numberOfSuccessors(m_graph, *m_graph.m_blocks[block])) {
+            ++stack.last().second;
+            BlockIndex next = successor(m_graph, *m_graph.m_blocks[block], successorIndex);
+            if (!visited[next]) {
+                visited[next] = true;
+                stack.append(std::make_pair(next, 0u));
+            }
+            continue;
+        }
+        m_postOrderNumber[block] = postOrder.size();
+        postOrder.append(block);
+        stack.removeLast();
+    }
+    for (size_t i = postOrder.size(); i--;)
+        m_reversePostOrder.append(postOrder[i]);
+
+    m_immediateDominator[0] = 0;
+    bool changed;
+    do {
+        changed = false;
+        for (size_t i = 1; i < m_reversePostOrder.size(); ++i) {
+            BlockIndex block = m_reversePostOrder[i];
+            PredecessorList& predecessors = m_graph.m_blocks[block]->m_predecessors;
+            BlockIndex newImmediateDominator = NoBlock;
+            for (size_t j = 0; j < predecessors.size(); ++j) {
+                BlockIndex predecessor = predecessors[j];
+                if (m_immediateDominator[predecessor] == NoBlock)
+                    continue;
+                if (newImmediateDominator == NoBlock)
+                    newImmediateDominator = predecessor;
+                else
+                    newImmediateDominator = intersect(predecessor, newImmediateDominator);
+            }
+            if (m_immediateDominator[block] != newImmediateDominator) {
+                m_immediateDominator[block] = newImmediateDominator;
+                changed = true;
+            }
+        }
+    } while (changed);
+}
+
+void LoopAnalysis::computeLoops()
+{
+    for (size_t i = 0; i < m_reversePostOrder.size(); ++i) {
+        BlockIndex tail = m_reversePostOrder[i];
+        BasicBlock& tailBlock = *m_graph.m_blocks[tail];
+        for (unsigned s = 0; s < numberOfSuccessors(m_graph, tailBlock); ++s) {
+            BlockIndex header = successor(m_graph, tailBlock, s);
+            if (!dominates(header, tail))
+                continue;
+
+            NaturalLoop* loop = 0;
+            for (size_t j = 0; j < m_loops.size(); ++j) {
+                if (m_loops[j].header == header)
+                    loop = &m_loops[j];
+            }
+            if (!loop) {
+                m_loops.append(NaturalLoop(header));
+                loop = &m_loops.last();
+                loop->blocks.append(header);
+            }
+
+            // Everything that reaches the back edge without going through the
+            // header is in the loop.
+            Vector<BlockIndex, 16> worklist;
+            worklist.append(tail);
+            while (!worklist.isEmpty()) {
+                BlockIndex block = worklist.last();
+                worklist.removeLast();
+                if (loop->contains(block))
+                    continue;
+                loop->blocks.append(block);
+                PredecessorList& predecessors = m_graph.m_blocks[block]->m_predecessors;
+                for (size_t j = 0; j < predecessors.size(); ++j) {
+                    if (m_immediateDominator[predecessors[j]] != NoBlock)
+                        worklist.append(predecessors[j]);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_loops.size(); ++i) {
+        NaturalLoop& loop = m_loops[i];
+        PredecessorList& predecessors = m_graph.m_blocks[loop.header]->m_predecessors;
+        BlockIndex entry = NoBlock;
+        bool singleEntry = true;
+        for (size_t j = 0; j < predecessors.size(); ++j) {
+            BlockIndex predecessor = predecessors[j];
+            if (loop.contains(predecessor) || m_immediateDominator[predecessor] == NoBlock)
+                continue;
+            if (entry != NoBlock && entry != predecessor)
+                singleEntry = false;
+            entry = predecessor;
+        }
+        if (singleEntry && entry != NoBlock && numberOfSuccessors(m_graph, *m_graph.m_blocks[entry]) == 1)
+            loop.preheader = entry;
+    }
+}
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(DFG_JIT)
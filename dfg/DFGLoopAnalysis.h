@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef DFGLoopAnalysis_h
+#define DFGLoopAnalysis_h
+
+#if ENABLE(DFG_JIT)
+
+#include <dfg/DFGGraph.h>
+
+namespace JSC { namespace DFG {
+
+// A loop in the control flow graph with a single entry, its header. Back edges
+// that share a header are merged into one loop.
+struct NaturalLoop {
+    NaturalLoop(BlockIndex header)
+        : header(header)
+        , preheader(NoBlock)
+    {
+    }
+
+    bool contains(BlockIndex block) const
+    {
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            if (blocks[i] == block)
+                return true;
+        }
+        return false;
+    }
+
+    BlockIndex header;
+    // The only block outside the loop that enters it, provided it does nothing
+    // but fall into the header; otherwise NoBlock.
+    BlockIndex preheader;
+    // All blocks in the loop, including the header.
+    Vector<BlockIndex, 8> blocks;
+};
+
+// Computes the dominator tree of the graph's blocks, and from it the natural
+// loops. Blocks that cannot be reached from the entry block are in no loop, and
+// dominate nothing.
+class LoopAnalysis {
+public:
+    LoopAnalysis(Graph&);
+
+    bool dominates(BlockIndex dominator, BlockIndex block);
+
+    size_t numberOfLoops() const { return m_loops.size(); }
+    NaturalLoop& loop(size_t index) { return m_loops[index]; }
+
+    static unsigned numberOfSuccessors(Graph&, BasicBlock&);
+    static BlockIndex successor(Graph&, BasicBlock&, unsigned index);
+
+private:
+    void computeDominators();
+    void computeLoops();
+    BlockIndex intersect(BlockIndex, BlockIndex);
+
+    Graph& m_graph;
+    Vector<BlockIndex, 16> m_reversePostOrder;
+    Vector<unsigned, 16> m_postOrderNumber;
+    Vector<BlockIndex, 16> m_immediateDominator;
+    Vector<NaturalLoop> m_loops;
+};
+
+} } // namespace JSC::DFG
+
+#endif
+#endif
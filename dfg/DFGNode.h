@@ -66,6 +66,7 @@
 #if ENABLE(DFG_JIT)
 
 #include "CodeBlock.h"
+#include "CodeOrigin.h"
 #include "JSValue.h"
 #include "PredictedType.h"
 #include "ValueProfile.h"
@@ -82,32 +83,13 @@ COMPILE_ASSERT(sizeof(VirtualRegister) == sizeof(int), VirtualRegister_is_32bit)
 typedef uint32_t NodeIndex;
 static const NodeIndex NoNode = UINT_MAX;
 
-// Information used to map back from an exception to any handler/source information,
-// and to implement OSR.
-// (Presently implemented as a bytecode index).
-class CodeOrigin {
-public:
-    CodeOrigin()
-        : m_bytecodeIndex(std::numeric_limits<uint32_t>::max())
-    {
-    }
-    
-    explicit CodeOrigin(uint32_t bytecodeIndex)
-        : m_bytecodeIndex(bytecodeIndex)
-    {
-    }
-    
-    bool isSet() const { return m_bytecodeIndex != std::numeric_limits<uint32_t>::max(); }
-    
-    uint32_t bytecodeIndex() const
-    {
-        ASSERT(isSet());
-        return m_bytecodeIndex;
-    }
-    
-private:
-    uint32_t m_bytecodeIndex;
-};
+// Locals predicted to only ever hold numbers, some of which were doubles, are kept
+// in the register file as unboxed doubles by the speculative JIT. Loads and stores
+// of these never box, and OSR entry and exit convert them to and from JSValues.
+inline bool isUnboxedDoublePrediction(PredictedType prediction)
+{
+    return isNumberPrediction(prediction) && (prediction & PredictDouble);
+}
 
 // Entries in the NodeType enum (below) are composed of an id, a result type (possibly none)
 // and some additional informative flags (must generate, is constant, etc).
@@ -172,12 +154,20 @@ private:
     macro(PutByVal, NodeMustGenerate) \
     macro(PutByValAlias, NodeMustGenerate) \
     macro(GetById, NodeResultJS | NodeMustGenerate) \
+    /* A GetById of 'length' on a variable predicted to hold a JSArray. */\
+    macro(GetArrayLength, NodeResultInt32 | NodeMustGenerate) \
     macro(PutById, NodeMustGenerate) \
     macro(PutByIdDirect, NodeMustGenerate) \
     macro(GetMethod, NodeResultJS | NodeMustGenerate) \
     macro(GetGlobalVar, NodeResultJS | NodeMustGenerate) \
     macro(PutGlobalVar, NodeMustGenerate) \
     \
+    /* Allocations. A NewArray's children are its elements; a NewArrayBuffer */\
+    /* takes its elements from one of the CodeBlock's constant buffers. */\
+    macro(NewObject, NodeResultJS) \
+    macro(NewArray, NodeResultJS | NodeHasVarArgs) \
+    macro(NewArrayBuffer, NodeResultJS) \
+    \
     /* Nodes for comparison operations. */\
     macro(CompareLess, NodeResultBoolean | NodeMustGenerate) \
     macro(CompareLessEq, NodeResultBoolean | NodeMustGenerate) \
@@ -198,6 +188,8 @@ private:
     /* Nodes for misc operations. */\
     macro(Breakpoint, NodeMustGenerate) \
     macro(CheckHasInstance, NodeMustGenerate) \
+    /* Guards a call that was inlined; the callee must be the function we inlined. */\
+    macro(CheckFunction, NodeMustGenerate) \
     macro(InstanceOf, NodeResultBoolean) \
     macro(LogicalNot, NodeResultBoolean) \
     \
@@ -383,6 +375,23 @@ struct Node {
         return m_opInfo;
     }
 
+    bool hasFunctionCheckData()
+    {
+        return op == CheckFunction;
+    }
+
+    // CheckFunction keeps the function it expects in the CodeBlock's constant pool.
+    unsigned functionConstantNumber()
+    {
+        ASSERT(hasFunctionCheckData());
+        return m_opInfo;
+    }
+    
+    JSValue function(CodeBlock* codeBlock)
+    {
+        return codeBlock->constantRegister(FirstConstantRegisterIndex + functionConstantNumber()).get();
+    }
+
     bool hasVarNumber()
     {
         return op == GetGlobalVar || op == PutGlobalVar;
@@ -394,6 +403,23 @@ struct Node {
         return m_opInfo;
     }
 
+    bool hasConstantBuffer()
+    {
+        return op == NewArrayBuffer;
+    }
+    
+    unsigned startConstant()
+    {
+        ASSERT(hasConstantBuffer());
+        return m_opInfo;
+    }
+    
+    unsigned numConstants()
+    {
+        ASSERT(hasConstantBuffer());
+        return m_opInfo2;
+    }
+
     bool hasResult()
     {
         return op & NodeResultMask;
@@ -446,6 +472,42 @@ struct Node {
         return m_opInfo2;
     }
     
+    // Only valid for a GetById of 'length' whose base is known to be a JSArray.
+    void convertToGetArrayLength()
+    {
+        ASSERT(op == GetById);
+        op = GetArrayLength;
+        m_opInfo = false;
+    }
+
+    // Bounds check elimination may find a GetByVal's or PutByVal's index to be
+    // within the array's vector: a loop test compared it against the array's
+    // length, and something checks that the length is within the vector. That
+    // may be the GetArrayLength the test used.
+    bool indexIsWithinVector()
+    {
+        ASSERT(op == GetByVal || op == PutByVal);
+        return m_opInfo;
+    }
+
+    void setIndexIsWithinVector()
+    {
+        ASSERT(op == GetByVal || op == PutByVal);
+        m_opInfo = true;
+    }
+
+    bool lengthMustBeWithinVector()
+    {
+        ASSERT(op == GetArrayLength);
+        return m_opInfo;
+    }
+
+    void setLengthMustBeWithinVector()
+    {
+        ASSERT(op == GetArrayLength);
+        m_opInfo = true;
+    }
+    
     bool hasPrediction()
     {
         switch (op) {
@@ -514,6 +576,13 @@ struct Node {
         return !m_refCount++;
     }
 
+    // returns true when ref count passes from 1 to 0.
+    bool deref()
+    {
+        ASSERT(m_refCount);
+        return !--m_refCount;
+    }
+
     unsigned adjustedRefCount()
     {
         return mustGenerate() ? m_refCount - 1 : m_refCount;
@@ -763,7 +763,7 @@ void NonSpeculativeJIT::compile(SpeculationCheckIndexIterator& checkIterator, No
         if (!isKnownInteger(node.child1()) || !isKnownInteger(node.child2())) {
             silentSpillAllRegisters(X86Registers::edx);
             setupTwoStubArgs<FPRInfo::argumentFPR0, FPRInfo::argumentFPR1>(op1FPR, op2FPR);
-            m_jit.appendCall(fmod);
+            m_jit.appendCall(static_cast<double (*)(double, double)>(fmod));
             boxDouble(FPRInfo::returnValueFPR, X86Registers::edx);
             silentFillAllRegisters(X86Registers::edx);
         }
@@ -1188,6 +1188,17 @@ void NonSpeculativeJIT::compile(SpeculationCheckIndexIterator& checkIterator, No
     case Phi:
         ASSERT_NOT_REACHED();
 
+    case GetArrayLength:
+        // Only introduced by bounds check elimination, which requires OSR exit.
+        ASSERT_NOT_REACHED();
+        break;
+
+    case CheckFunction:
+        // Calls are only inlined when we can OSR exit, and then we never fall
+        // back on the non-speculative JIT.
+        ASSERT_NOT_REACHED();
+        break;
+
     case Breakpoint:
 #if ENABLE(DEBUG_WITH_BREAKPOINT)
         m_jit.breakpoint();
@@ -1201,6 +1212,18 @@ void NonSpeculativeJIT::compile(SpeculationCheckIndexIterator& checkIterator, No
         emitCall(node);
         break;
 
+    case NewObject:
+        emitNewObject(node);
+        break;
+
+    case NewArray:
+        emitNewArray(node);
+        break;
+
+    case NewArrayBuffer:
+        emitNewArrayBuffer(node);
+        break;
+
     case Resolve: {
         flushRegisters();
         GPRResult result(this);
@@ -49,6 +49,9 @@ inline bool predictionIsValid(JSGlobalData* globalData, JSValue value, Predicted
     if (isBooleanPrediction(type))
         return value.isBoolean();
     
+    if (isUnboxedDoublePrediction(type))
+        return value.isNumber();
+    
     return true;
 }
 
@@ -125,7 +128,10 @@ void* prepareOSREntry(ExecState* exec, CodeBlock* codeBlock, unsigned bytecodeIn
     // FIXME: we need to know if at an OSR entry, a variable is live. If it isn't
     // then we shouldn't try to verify its prediction.
     
-    for (unsigned i = 0; i < predictions->numberOfVariables(); ++i) {
+    // Variables past the baseline frame belong to inlined callees, which are not
+    // live at a loop header of the machine code block.
+    size_t numberOfVariables = std::min<size_t>(predictions->numberOfVariables(), baselineCodeBlock->m_numCalleeRegisters);
+    for (unsigned i = 0; i < numberOfVariables; ++i) {
         if (!predictionIsValid(globalData, exec->registers()[i].jsValue(), predictions->getPrediction(i))) {
 #if ENABLE(JIT_VERBOSE_OSR)
             printf("    OSR failed because variable %u is %s, expected %s.\n", i, exec->registers()[i].jsValue().description(), predictionToString(predictions->getPrediction(i)));
@@ -152,10 +158,18 @@ void* prepareOSREntry(ExecState* exec, CodeBlock* codeBlock, unsigned bytecodeIn
     printf("    OSR should succeed.\n");
 #endif
     
-    // 4) Fix the call frame.
+    // 4) Fix the call frame, and unbox the variables that the DFG keeps as raw
+    //    doubles. Those were all verified to be numbers above.
     
     exec->setCodeBlock(codeBlock);
     
+    size_t numberOfUnboxableVariables = std::min<size_t>(numberOfVariables, codeBlock->firstInlinedRegister());
+    for (unsigned i = 0; i < numberOfUnboxableVariables; ++i) {
+        if (!isUnboxedDoublePrediction(predictions->getPrediction(i)))
+            continue;
+        exec->registers()[i] = JSValue::decode(bitwise_cast<EncodedJSValue>(exec->registers()[i].jsValue().uncheckedGetNumber()));
+    }
+    
     // 5) Find and return the destination machine code address. The DFG stores
     //    the machine code offsets of OSR targets in a CompactJITCodeMap.
     //    Decoding it is not super efficient, but we expect that OSR entry
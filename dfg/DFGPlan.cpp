@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "DFGPlan.h"
+
+#if ENABLE(CONCURRENT_JIT)
+
+#include "CodeBlock.h"
+#include "DFGBoundsCheckElimination.h"
+#include "DFGByteCodeParser.h"
+#include "DFGPropagator.h"
+#include "Executable.h"
+#include "SlotVisitor.h"
+#include <wtf/CurrentTime.h>
+
+namespace JSC { namespace DFG {
+
+Plan::Plan(JSGlobalData* globalData, FunctionExecutable* executable, PassOwnPtr<CodeBlock> codeBlock)
+    : enqueueTime(0)
+    , compileTime(0)
+    , m_globalData(globalData)
+    , m_executable(executable)
+    , m_baselineCodeBlock(codeBlock->alternative())
+    , m_codeBlock(codeBlock)
+    , m_graph(m_codeBlock->m_numParameters, m_codeBlock->m_numVars)
+{
+    ASSERT(m_baselineCodeBlock);
+    ASSERT(m_baselineCodeBlock->getJITType() == JITCode::BaselineJIT);
+}
+
+Plan::~Plan()
+{
+    // The executable still owns the baseline CodeBlock.
+    if (m_codeBlock)
+        m_codeBlock->releaseAlternative().leakPtr();
+}
+
+bool Plan::parse(ExecState* calleeArgsExec)
+{
+    if (!DFG::parse(m_graph, m_globalData, m_codeBlock.get()))
+        return false;
+    m_graph.predictArgumentTypes(calleeArgsExec, m_codeBlock.get());
+    return true;
+}
+
+void Plan::compile()
+{
+    double before = monotonicallyIncreasingTime();
+
+    propagate(m_graph, m_globalData, m_codeBlock.get());
+    performBoundsCheckElimination(m_graph, m_globalData, m_codeBlock.get());
+
+#if ENABLE(DYNAMIC_OPTIMIZATION)
+    // These go to the baseline CodeBlock for OSR entry to verify, but only once
+    // the code is installed; see finalize().
+    m_predictions = adoptPtr(new PredictionTracker());
+    *m_predictions = m_graph.predictions();
+#endif
+
+    m_jit = adoptPtr(new JITCompiler(m_globalData, m_graph, m_codeBlock.get()));
+    m_jit->generateFunction();
+
+    compileTime = monotonicallyIncreasingTime() - before;
+}
+
+void Plan::finalize()
+{
+    ASSERT(m_jit);
+    ASSERT(&m_executable->generatedBytecodeForCall() == m_baselineCodeBlock);
+
+    JITCode jitCode;
+    MacroAssemblerCodePtr jitCodeWithArityCheck;
+    m_jit->linkFunction(jitCode, jitCodeWithArityCheck);
+    m_jit.clear();
+
+#if ENABLE(DYNAMIC_OPTIMIZATION)
+    m_baselineCodeBlock->setPredictions(m_predictions.release());
+#endif
+
+    m_executable->installOptimizedCodeForCall(static_pointer_cast<FunctionCodeBlock>(m_codeBlock.release()), jitCode, jitCodeWithArityCheck);
+}
+
+void Plan::visitChildren(SlotVisitor& visitor)
+{
+    visitor.appendUnbarrieredPointer(&m_executable);
+    if (m_codeBlock)
+        m_codeBlock->visitAggregate(visitor);
+}
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(CONCURRENT_JIT)
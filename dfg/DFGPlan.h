@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef DFGPlan_h
+#define DFGPlan_h
+
+#include <wtf/Platform.h>
+
+#if ENABLE(CONCURRENT_JIT)
+
+#include "DFGGraph.h"
+#include "DFGJITCompiler.h"
+#include "JITCode.h"
+#include <wtf/OwnPtr.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefCounted.h>
+
+namespace JSC {
+
+class CodeBlock;
+class ExecState;
+class FunctionExecutable;
+class JSGlobalData;
+class SlotVisitor;
+
+namespace DFG {
+
+// An optimizing compilation of a function, done in three steps: parse() turns
+// the bytecode into the graph, which is all that the rest of the compilation
+// gets to see of the value profiles; compile() runs the remaining passes and
+// generates the code, on the Worklist's thread; and finalize() links the code
+// and installs it in the executable, back on the thread running JavaScript.
+// parse() and finalize() must run there because they touch the heap and the
+// baseline CodeBlock, which go on changing while compile() runs.
+//
+// Meanwhile the executable keeps running its baseline CodeBlock, which the
+// optimized CodeBlock already refers to as its alternative. The executable
+// still owns it, though: finalize() hands it over to the optimized CodeBlock,
+// and a plan that is dropped lets go of it without destroying it.
+class Plan : public RefCounted<Plan> {
+public:
+    static PassRefPtr<Plan> create(JSGlobalData* globalData, FunctionExecutable* executable, PassOwnPtr<CodeBlock> codeBlock)
+    {
+        return adoptRef(new Plan(globalData, executable, codeBlock));
+    }
+    ~Plan();
+
+    FunctionExecutable* executable() const { return m_executable; }
+    CodeBlock* baselineCodeBlock() const { return m_baselineCodeBlock; }
+
+    bool parse(ExecState* calleeArgsExec);
+    void compile();
+    void finalize();
+
+    void visitChildren(SlotVisitor&);
+
+    // When the plan was handed to the Worklist, and how long compile() took.
+    double enqueueTime;
+    double compileTime;
+
+private:
+    Plan(JSGlobalData*, FunctionExecutable*, PassOwnPtr<CodeBlock>);
+
+    JSGlobalData* m_globalData;
+    FunctionExecutable* m_executable;
+    CodeBlock* m_baselineCodeBlock;
+    OwnPtr<CodeBlock> m_codeBlock;
+    Graph m_graph;
+    OwnPtr<JITCompiler> m_jit;
+#if ENABLE(DYNAMIC_OPTIMIZATION)
+    OwnPtr<PredictionTracker> m_predictions;
+#endif
+};
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(CONCURRENT_JIT)
+
+#endif // DFGPlan_h
@@ -115,6 +115,17 @@ private:
         return JSC::mergePrediction(m_predictions[m_compileIndex], prediction);
     }
     
+    // Integer arithmetic that made earlier optimized code exit too often falls
+    // back to doubles when it overflows, so its result may be either.
+    PredictedType int32ArithmeticPrediction(Node& node)
+    {
+        if (m_graph.hasFrequentExitSite(m_profiledBlock, node, Overflow))
+            return PredictNumber;
+        if (node.op == ArithMul && m_graph.hasFrequentExitSite(m_profiledBlock, node, NegativeZero))
+            return PredictNumber;
+        return PredictInt32;
+    }
+    
     void propagateNode(Node& node)
     {
         if (!node.shouldGenerate())
@@ -183,7 +194,7 @@ private:
             if (isStrongPrediction(left) && isStrongPrediction(right)) {
                 if (isNumberPrediction(left) && isNumberPrediction(right)) {
                     if (isInt32Prediction(mergePredictions(left, right)))
-                        changed |= mergePrediction(makePrediction(PredictInt32, StrongPrediction));
+                        changed |= mergePrediction(makePrediction(int32ArithmeticPrediction(node), StrongPrediction));
                     else
                         changed |= mergePrediction(makePrediction(PredictDouble, StrongPrediction));
                 } else if (!(left & PredictNumber) || !(right & PredictNumber)) {
@@ -203,7 +214,7 @@ private:
             
             if (isStrongPrediction(left) && isStrongPrediction(right)) {
                 if (isInt32Prediction(mergePredictions(left, right)))
-                    changed |= mergePrediction(makePrediction(PredictInt32, StrongPrediction));
+                    changed |= mergePrediction(makePrediction(int32ArithmeticPrediction(node), StrongPrediction));
                 else
                     changed |= mergePrediction(makePrediction(PredictDouble, StrongPrediction));
             }
@@ -251,6 +262,17 @@ private:
             break;
         }
             
+        case NewObject: {
+            changed |= setPrediction(makePrediction(PredictFinalObject, StrongPrediction));
+            break;
+        }
+            
+        case NewArray:
+        case NewArrayBuffer: {
+            changed |= setPrediction(makePrediction(PredictArray, StrongPrediction));
+            break;
+        }
+            
         case GetGlobalVar: {
             changed |= m_variableUses.predictGlobalVar(node.varNumber(), m_uses[m_compileIndex] & ~PredictionTagMask, StrongPrediction);
             PredictedType prediction = m_graph.getGlobalVarPrediction(node.varNumber());
@@ -279,6 +301,7 @@ private:
         case Branch:
         case Return:
         case CheckHasInstance:
+        case CheckFunction:
         case Phi:
             break;
             
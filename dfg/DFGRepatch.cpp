@@ -126,8 +126,10 @@ static void generateProtoChainAccessStub(ExecState* exec, StructureStubInfo& stu
     
     if (protoObject->structure()->isUsingInlineStorage())
         stubJit.loadPtr(MacroAssembler::Address(scratchGPR, JSObject::offsetOfInlineStorage() + offset * sizeof(JSValue)), resultGPR);
-    else
-        stubJit.loadPtr(protoObject->addressOfPropertyAtOffset(offset), resultGPR);
+    else {
+        stubJit.loadPtr(MacroAssembler::Address(scratchGPR, JSObject::offsetOfPropertyStorage()), resultGPR);
+        stubJit.loadPtr(MacroAssembler::Address(resultGPR, offset * sizeof(JSValue)), resultGPR);
+    }
         
     MacroAssembler::Jump success, fail;
     
@@ -186,6 +188,7 @@ static bool tryCacheGetByID(ExecState* exec, JSValue baseValue, const Identifier
         repatchBuffer.relink(stubInfo.callReturnLocation.jumpAtOffset(stubInfo.deltaCallToStructCheck), CodeLocationLabel(stubInfo.stubRoutine.code()));
         repatchBuffer.relink(stubInfo.callReturnLocation, operationGetById);
         
+        stubInfo.accessType = access_get_array_length;
         return true;
     }
     
@@ -231,7 +234,7 @@ static bool tryCacheGetByID(ExecState* exec, JSValue baseValue, const Identifier
     
     RepatchBuffer repatchBuffer(codeBlock);
     repatchBuffer.relink(stubInfo.callReturnLocation.jumpAtOffset(stubInfo.deltaCallToStructCheck), CodeLocationLabel(stubInfo.stubRoutine.code()));
-    repatchBuffer.relink(stubInfo.callReturnLocation, operationGetByIdProtoBuildList);
+    repatchBuffer.relink(stubInfo.callReturnLocation, operationGetByIdBuildList);
     
     stubInfo.initGetByIdChain(*globalData, codeBlock->ownerExecutable(), structure, prototypeChain);
     return true;
@@ -240,8 +243,10 @@ static bool tryCacheGetByID(ExecState* exec, JSValue baseValue, const Identifier
 void dfgRepatchGetByID(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot, StructureStubInfo& stubInfo)
 {
     bool cached = tryCacheGetByID(exec, baseValue, propertyName, slot, stubInfo);
-    if (!cached)
+    if (!cached) {
         dfgRepatchCall(exec->codeBlock(), stubInfo.callReturnLocation, operationGetById);
+        stubInfo.accessType = access_get_by_id_generic;
+    }
 }
 
 static void dfgRepatchGetMethodFast(JSGlobalData* globalData, CodeBlock* codeBlock, MethodCallLinkInfo& methodInfo, JSObject* callee, Structure* structure, JSObject* slotBaseObject)
@@ -301,131 +306,109 @@ void dfgRepatchGetMethod(ExecState* exec, JSValue baseValue, const Identifier& p
         dfgRepatchCall(exec->codeBlock(), methodInfo.callReturnLocation, operationGetByIdOptimize);
 }
 
-static bool tryBuildGetByIDList(ExecState* exec, JSValue baseValue, const Identifier&, const PropertySlot& slot, StructureStubInfo& stubInfo)
+static void generateSelfAccessStub(ExecState* exec, StructureStubInfo& stubInfo, size_t offset, Structure* structure, CodeLocationLabel successLabel, CodeLocationLabel slowCaseLabel, MacroAssemblerCodeRef& stubRoutine)
 {
-    if (!baseValue.isCell()
-        || !slot.isCacheable()
-        || baseValue.asCell()->structure()->isUncacheableDictionary()
-        || slot.slotBase() != baseValue
-        || slot.cachedPropertyType() != PropertySlot::Value
-        || (slot.cachedOffset() * sizeof(JSValue)) > (unsigned)MacroAssembler::MaximumCompactPtrAlignedAddressOffset)
-        return false;
-    
-    CodeBlock* codeBlock = exec->codeBlock();
-    JSCell* baseCell = baseValue.asCell();
-    Structure* structure = baseCell->structure();
     JSGlobalData* globalData = &exec->globalData();
+
+    GPRReg baseGPR = static_cast<GPRReg>(stubInfo.baseGPR);
+    GPRReg resultGPR = static_cast<GPRReg>(stubInfo.valueGPR);
     
-    ASSERT(slot.slotBase().isObject());
+    MacroAssembler stubJit;
     
-    PolymorphicAccessStructureList* polymorphicStructureList;
-    int listIndex = 1;
+    MacroAssembler::Jump wrongStruct = stubJit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseGPR, JSCell::structureOffset()), MacroAssembler::TrustedImmPtr(structure));
     
-    if (stubInfo.accessType == access_get_by_id_self) {
-        ASSERT(!stubInfo.stubRoutine);
-        polymorphicStructureList = new PolymorphicAccessStructureList(*globalData, codeBlock->ownerExecutable(), MacroAssemblerCodeRef::createSelfManagedCodeRef(stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToSlowCase)), stubInfo.u.getByIdSelf.baseObjectStructure.get());
-        stubInfo.initGetByIdSelfList(polymorphicStructureList, 1);
-    } else {
-        polymorphicStructureList = stubInfo.u.getByIdSelfList.structureList;
-        listIndex = stubInfo.u.getByIdSelfList.listSize;
+    if (structure->isUsingInlineStorage())
+        stubJit.loadPtr(MacroAssembler::Address(baseGPR, JSObject::offsetOfInlineStorage() + offset * sizeof(JSValue)), resultGPR);
+    else {
+        stubJit.loadPtr(MacroAssembler::Address(baseGPR, JSObject::offsetOfPropertyStorage()), resultGPR);
+        stubJit.loadPtr(MacroAssembler::Address(resultGPR, offset * sizeof(JSValue)), resultGPR);
     }
     
-    if (listIndex < POLYMORPHIC_LIST_CACHE_SIZE) {
-        stubInfo.u.getByIdSelfList.listSize++;
-        
-        GPRReg baseGPR = static_cast<GPRReg>(stubInfo.baseGPR);
-        GPRReg resultGPR = static_cast<GPRReg>(stubInfo.valueGPR);
-        
-        MacroAssembler stubJit;
-        
-        MacroAssembler::Jump wrongStruct = stubJit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseGPR, JSCell::structureOffset()), MacroAssembler::TrustedImmPtr(structure));
-        
-        if (structure->isUsingInlineStorage())
-            stubJit.loadPtr(MacroAssembler::Address(baseGPR, JSObject::offsetOfInlineStorage() + slot.cachedOffset() * sizeof(JSValue)), resultGPR);
-        else {
-            stubJit.loadPtr(MacroAssembler::Address(baseGPR, JSObject::offsetOfPropertyStorage()), resultGPR);
-            stubJit.loadPtr(MacroAssembler::Address(resultGPR, slot.cachedOffset() * sizeof(JSValue)), resultGPR);
-        }
-        
-        MacroAssembler::Jump success = stubJit.jump();
-        
-        LinkBuffer patchBuffer(*globalData, &stubJit);
-        
-        CodeLocationLabel lastProtoBegin = CodeLocationLabel(polymorphicStructureList->list[listIndex - 1].stubRoutine.code());
-        ASSERT(!!lastProtoBegin);
-        
-        patchBuffer.link(wrongStruct, lastProtoBegin);
-        patchBuffer.link(success, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone));
-        
-        MacroAssemblerCodeRef stubRoutine = patchBuffer.finalizeCode();
-        
-        polymorphicStructureList->list[listIndex].set(*globalData, codeBlock->ownerExecutable(), stubRoutine, structure);
-        
-        CodeLocationJump jumpLocation = stubInfo.callReturnLocation.jumpAtOffset(stubInfo.deltaCallToStructCheck);
-        RepatchBuffer repatchBuffer(codeBlock);
-        repatchBuffer.relink(jumpLocation, CodeLocationLabel(stubRoutine.code()));
-        
-        if (listIndex < (POLYMORPHIC_LIST_CACHE_SIZE - 1))
-            return true;
-    }
+    MacroAssembler::Jump success = stubJit.jump();
     
-    return false;
-}
-
-void dfgBuildGetByIDList(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot, StructureStubInfo& stubInfo)
-{
-    bool dontChangeCall = tryBuildGetByIDList(exec, baseValue, propertyName, slot, stubInfo);
-    if (!dontChangeCall)
-        dfgRepatchCall(exec->codeBlock(), stubInfo.callReturnLocation, operationGetById);
+    LinkBuffer patchBuffer(*globalData, &stubJit);
+    
+    patchBuffer.link(wrongStruct, slowCaseLabel);
+    patchBuffer.link(success, successLabel);
+    
+    stubRoutine = patchBuffer.finalizeCode();
 }
 
-static bool tryBuildGetByIDProtoList(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot, StructureStubInfo& stubInfo)
+// Self and prototype accesses share one list of stubs, each falling through
+// to the one before it, so a site that sees both kinds stays cached. Once the
+// list is full the site is megamorphic and always calls operationGetById.
+static bool tryBuildGetByIDList(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot, StructureStubInfo& stubInfo)
 {
     if (!baseValue.isCell()
         || !slot.isCacheable()
-        || baseValue.asCell()->structure()->isDictionary()
-        || baseValue.asCell()->structure()->typeInfo().prohibitsPropertyCaching()
-        || slot.slotBase() == baseValue
+        || baseValue.asCell()->structure()->isUncacheableDictionary()
         || slot.cachedPropertyType() != PropertySlot::Value)
         return false;
     
+    CodeBlock* codeBlock = exec->codeBlock();
+    JSCell* baseCell = baseValue.asCell();
+    Structure* structure = baseCell->structure();
+    JSGlobalData* globalData = &exec->globalData();
+    
     ASSERT(slot.slotBase().isObject());
     
     size_t offset = slot.cachedOffset();
-    size_t count = normalizePrototypeChain(exec, baseValue, slot.slotBase(), propertyName, offset);
-    if (!count)
-        return false;
-
-    Structure* structure = baseValue.asCell()->structure();
-    StructureChain* prototypeChain = structure->prototypeChain(exec);
-    CodeBlock* codeBlock = exec->codeBlock();
-    JSGlobalData* globalData = &exec->globalData();
+    size_t count = 0;
+    StructureChain* prototypeChain = 0;
+    if (slot.slotBase() != baseValue) {
+        if (structure->isDictionary() || structure->typeInfo().prohibitsPropertyCaching())
+            return false;
+        
+        count = normalizePrototypeChain(exec, baseValue, slot.slotBase(), propertyName, offset);
+        if (!count)
+            return false;
+        
+        prototypeChain = structure->prototypeChain(exec);
+    }
     
     PolymorphicAccessStructureList* polymorphicStructureList;
     int listIndex = 1;
     
-    if (stubInfo.accessType == access_get_by_id_chain) {
+    switch (stubInfo.accessType) {
+    case access_get_by_id_self:
+        ASSERT(!stubInfo.stubRoutine);
+        polymorphicStructureList = new PolymorphicAccessStructureList(*globalData, codeBlock->ownerExecutable(), MacroAssemblerCodeRef::createSelfManagedCodeRef(stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToSlowCase)), stubInfo.u.getByIdSelf.baseObjectStructure.get());
+        stubInfo.initGetByIdSelfList(polymorphicStructureList, 1);
+        break;
+    case access_get_by_id_chain:
         ASSERT(!!stubInfo.stubRoutine);
         polymorphicStructureList = new PolymorphicAccessStructureList(*globalData, codeBlock->ownerExecutable(), stubInfo.stubRoutine, stubInfo.u.getByIdChain.baseObjectStructure.get(), stubInfo.u.getByIdChain.chain.get());
         stubInfo.stubRoutine = MacroAssemblerCodeRef();
         stubInfo.initGetByIdProtoList(polymorphicStructureList, 1);
-    } else {
-        ASSERT(stubInfo.accessType = access_get_by_id_proto_list);
+        break;
+    case access_get_by_id_self_list:
+        polymorphicStructureList = stubInfo.u.getByIdSelfList.structureList;
+        listIndex = stubInfo.u.getByIdSelfList.listSize;
+        break;
+    case access_get_by_id_proto_list:
         polymorphicStructureList = stubInfo.u.getByIdProtoList.structureList;
         listIndex = stubInfo.u.getByIdProtoList.listSize;
+        break;
+    default:
+        return false;
     }
     
     if (listIndex < POLYMORPHIC_LIST_CACHE_SIZE) {
+        // Both kinds of list keep their size in the same place.
         stubInfo.u.getByIdProtoList.listSize++;
         
         CodeLocationLabel lastProtoBegin = CodeLocationLabel(polymorphicStructureList->list[listIndex - 1].stubRoutine.code());
         ASSERT(!!lastProtoBegin);
-
-        MacroAssemblerCodeRef stubRoutine;
         
-        generateProtoChainAccessStub(exec, stubInfo, prototypeChain, count, offset, structure, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone), lastProtoBegin, stubRoutine);
+        MacroAssemblerCodeRef stubRoutine;
         
-        polymorphicStructureList->list[listIndex].set(*globalData, codeBlock->ownerExecutable(), stubRoutine, structure);
+        if (prototypeChain) {
+            generateProtoChainAccessStub(exec, stubInfo, prototypeChain, count, offset, structure, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone), lastProtoBegin, stubRoutine);
+            polymorphicStructureList->list[listIndex].set(*globalData, codeBlock->ownerExecutable(), stubRoutine, structure, prototypeChain);
+        } else {
+            generateSelfAccessStub(exec, stubInfo, offset, structure, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone), lastProtoBegin, stubRoutine);
+            polymorphicStructureList->list[listIndex].set(*globalData, codeBlock->ownerExecutable(), stubRoutine, structure);
+        }
         
         CodeLocationJump jumpLocation = stubInfo.callReturnLocation.jumpAtOffset(stubInfo.deltaCallToStructCheck);
         RepatchBuffer repatchBuffer(codeBlock);
@@ -438,9 +421,9 @@ static bool tryBuildGetByIDProtoList(ExecState* exec, JSValue baseValue, const I
     return false;
 }
 
-void dfgBuildGetByIDProtoList(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot, StructureStubInfo& stubInfo)
+void dfgBuildGetByIDList(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot, StructureStubInfo& stubInfo)
 {
-    bool dontChangeCall = tryBuildGetByIDProtoList(exec, baseValue, propertyName, slot, stubInfo);
+    bool dontChangeCall = tryBuildGetByIDList(exec, baseValue, propertyName, slot, stubInfo);
     if (!dontChangeCall)
         dfgRepatchCall(exec->codeBlock(), stubInfo.callReturnLocation, operationGetById);
 }
@@ -468,6 +451,110 @@ static void testPrototype(MacroAssembler &stubJit, GPRReg scratchGPR, JSValue pr
     failureCases.append(stubJit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(scratchGPR, JSCell::structureOffset()), MacroAssembler::TrustedImmPtr(prototype.asCell()->structure())));
 }
 
+static V_DFGOperation_EJJI appropriateListBuildingPutByIdFunction(const PutPropertySlot &slot, PutKind putKind)
+{
+    if (slot.isStrictMode()) {
+        if (putKind == Direct)
+            return operationPutByIdDirectStrictBuildList;
+        return operationPutByIdStrictBuildList;
+    }
+    if (putKind == Direct)
+        return operationPutByIdDirectNonStrictBuildList;
+    return operationPutByIdNonStrictBuildList;
+}
+
+static void generatePutReplaceStub(ExecState* exec, StructureStubInfo& stubInfo, size_t offset, Structure* structure, CodeLocationLabel successLabel, CodeLocationLabel slowCaseLabel, MacroAssemblerCodeRef& stubRoutine)
+{
+    JSGlobalData* globalData = &exec->globalData();
+    
+    GPRReg baseGPR = static_cast<GPRReg>(stubInfo.baseGPR);
+    GPRReg valueGPR = static_cast<GPRReg>(stubInfo.valueGPR);
+    GPRReg scratchGPR = static_cast<GPRReg>(stubInfo.scratchGPR);
+    bool needToRestoreScratch = false;
+    
+    MacroAssembler stubJit;
+    
+    if (scratchGPR == InvalidGPRReg) {
+        scratchGPR = JITCodeGenerator::selectScratchGPR(baseGPR, valueGPR);
+        stubJit.push(scratchGPR);
+        needToRestoreScratch = true;
+    }
+    
+    MacroAssembler::JumpList failureCases;
+    
+    failureCases.append(stubJit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseGPR, JSCell::structureOffset()), MacroAssembler::TrustedImmPtr(structure)));
+    
+    JITCodeGenerator::writeBarrier(stubJit, baseGPR, scratchGPR, WriteBarrierForPropertyAccess);
+    
+    if (structure->isUsingInlineStorage())
+        stubJit.storePtr(valueGPR, MacroAssembler::Address(baseGPR, JSObject::offsetOfInlineStorage() + offset * sizeof(JSValue)));
+    else {
+        stubJit.loadPtr(MacroAssembler::Address(baseGPR, JSObject::offsetOfPropertyStorage()), scratchGPR);
+        stubJit.storePtr(valueGPR, MacroAssembler::Address(scratchGPR, offset * sizeof(JSValue)));
+    }
+    
+    MacroAssembler::Jump success, fail;
+    
+    emitRestoreScratch(stubJit, needToRestoreScratch, scratchGPR, success, fail, failureCases);
+    
+    LinkBuffer patchBuffer(*globalData, &stubJit);
+    
+    linkRestoreScratch(patchBuffer, needToRestoreScratch, success, fail, failureCases, successLabel, slowCaseLabel);
+    
+    stubRoutine = patchBuffer.finalizeCode();
+}
+
+static void generatePutTransitionStub(ExecState* exec, StructureStubInfo& stubInfo, PutKind putKind, size_t offset, Structure* oldStructure, Structure* structure, StructureChain* prototypeChain, CodeLocationLabel successLabel, CodeLocationLabel slowCaseLabel, MacroAssemblerCodeRef& stubRoutine)
+{
+    JSGlobalData* globalData = &exec->globalData();
+    
+    GPRReg baseGPR = static_cast<GPRReg>(stubInfo.baseGPR);
+    GPRReg valueGPR = static_cast<GPRReg>(stubInfo.valueGPR);
+    GPRReg scratchGPR = static_cast<GPRReg>(stubInfo.scratchGPR);
+    bool needToRestoreScratch = false;
+    
+    ASSERT(scratchGPR != baseGPR);
+    
+    MacroAssembler stubJit;
+    
+    MacroAssembler::JumpList failureCases;
+    
+    if (scratchGPR == InvalidGPRReg) {
+        scratchGPR = JITCodeGenerator::selectScratchGPR(baseGPR, valueGPR);
+        stubJit.push(scratchGPR);
+        needToRestoreScratch = true;
+    }
+    
+    failureCases.append(stubJit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseGPR, JSCell::structureOffset()), MacroAssembler::TrustedImmPtr(oldStructure)));
+    
+    testPrototype(stubJit, scratchGPR, oldStructure->storedPrototype(), failureCases);
+    
+    if (putKind == NotDirect) {
+        for (WriteBarrier<Structure>* it = prototypeChain->head(); *it; ++it)
+            testPrototype(stubJit, scratchGPR, (*it)->storedPrototype(), failureCases);
+    }
+    
+    JITCodeGenerator::writeBarrier(stubJit, baseGPR, scratchGPR, WriteBarrierForPropertyAccess);
+    
+    stubJit.storePtr(MacroAssembler::TrustedImmPtr(structure), MacroAssembler::Address(baseGPR, JSCell::structureOffset()));
+    if (structure->isUsingInlineStorage())
+        stubJit.storePtr(valueGPR, MacroAssembler::Address(baseGPR, JSObject::offsetOfInlineStorage() + offset * sizeof(JSValue)));
+    else {
+        stubJit.loadPtr(MacroAssembler::Address(baseGPR, JSObject::offsetOfPropertyStorage()), scratchGPR);
+        stubJit.storePtr(valueGPR, MacroAssembler::Address(scratchGPR, offset * sizeof(JSValue)));
+    }
+    
+    MacroAssembler::Jump success, fail;
+    
+    emitRestoreScratch(stubJit, needToRestoreScratch, scratchGPR, success, fail, failureCases);
+    
+    LinkBuffer patchBuffer(*globalData, &stubJit);
+    
+    linkRestoreScratch(patchBuffer, needToRestoreScratch, success, fail, failureCases, successLabel, slowCaseLabel);
+    
+    stubRoutine = patchBuffer.finalizeCode();
+}
+
 static bool tryCachePutByID(ExecState* exec, JSValue baseValue, const Identifier&, const PutPropertySlot& slot, StructureStubInfo& stubInfo, PutKind putKind)
 {
     CodeBlock* codeBlock = exec->codeBlock();
@@ -498,74 +585,18 @@ static bool tryCachePutByID(ExecState* exec, JSValue baseValue, const Identifier
             
             StructureChain* prototypeChain = structure->prototypeChain(exec);
             
-            GPRReg baseGPR = static_cast<GPRReg>(stubInfo.baseGPR);
-            GPRReg valueGPR = static_cast<GPRReg>(stubInfo.valueGPR);
-            GPRReg scratchGPR = static_cast<GPRReg>(stubInfo.scratchGPR);
-            bool needToRestoreScratch = false;
-            
-            ASSERT(scratchGPR != baseGPR);
-            
-            MacroAssembler stubJit;
-            
-            MacroAssembler::JumpList failureCases;
-            
-            if (scratchGPR == InvalidGPRReg) {
-                scratchGPR = JITCodeGenerator::selectScratchGPR(baseGPR, valueGPR);
-                stubJit.push(scratchGPR);
-                needToRestoreScratch = true;
-            }
-            
-            failureCases.append(stubJit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseGPR, JSCell::structureOffset()), MacroAssembler::TrustedImmPtr(oldStructure)));
-            
-            testPrototype(stubJit, scratchGPR, oldStructure->storedPrototype(), failureCases);
-            
-            if (putKind == NotDirect) {
-                for (WriteBarrier<Structure>* it = prototypeChain->head(); *it; ++it)
-                    testPrototype(stubJit, scratchGPR, (*it)->storedPrototype(), failureCases);
-            }
-            
-            JITCodeGenerator::writeBarrier(stubJit, baseGPR, scratchGPR, WriteBarrierForPropertyAccess);
-            
-            stubJit.storePtr(MacroAssembler::TrustedImmPtr(structure), MacroAssembler::Address(baseGPR, JSCell::structureOffset()));
-            if (structure->isUsingInlineStorage())
-                stubJit.storePtr(valueGPR, MacroAssembler::Address(baseGPR, JSObject::offsetOfInlineStorage() + slot.cachedOffset() * sizeof(JSValue)));
-            else {
-                stubJit.loadPtr(MacroAssembler::Address(baseGPR, JSObject::offsetOfPropertyStorage()), scratchGPR);
-                stubJit.storePtr(valueGPR, MacroAssembler::Address(scratchGPR, slot.cachedOffset() * sizeof(JSValue)));
-            }
-            
-            MacroAssembler::Jump success;
-            MacroAssembler::Jump failure;
-            
-            if (needToRestoreScratch) {
-                stubJit.pop(scratchGPR);
-                success = stubJit.jump();
-
-                failureCases.link(&stubJit);
-                stubJit.pop(scratchGPR);
-                failure = stubJit.jump();
-            } else
-                success = stubJit.jump();
-            
-            LinkBuffer patchBuffer(*globalData, &stubJit);
-            patchBuffer.link(success, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone));
-            if (needToRestoreScratch)
-                patchBuffer.link(failure, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToSlowCase));
-            else
-                patchBuffer.link(failureCases, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToSlowCase));
-            
-            stubInfo.stubRoutine = patchBuffer.finalizeCode();
+            generatePutTransitionStub(exec, stubInfo, putKind, slot.cachedOffset(), oldStructure, structure, prototypeChain, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone), stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToSlowCase), stubInfo.stubRoutine);
             
             RepatchBuffer repatchBuffer(codeBlock);
             repatchBuffer.relink(stubInfo.callReturnLocation.jumpAtOffset(stubInfo.deltaCallToStructCheck), CodeLocationLabel(stubInfo.stubRoutine.code()));
-            repatchBuffer.relink(stubInfo.callReturnLocation, appropriatePutByIdFunction(slot, putKind));
+            repatchBuffer.relink(stubInfo.callReturnLocation, appropriateListBuildingPutByIdFunction(slot, putKind));
             
             stubInfo.initPutByIdTransition(*globalData, codeBlock->ownerExecutable(), oldStructure, structure, prototypeChain);
             
             return true;
         }
 
-        dfgRepatchByIdSelfAccess(codeBlock, stubInfo, structure, slot.cachedOffset(), appropriatePutByIdFunction(slot, putKind), false);
+        dfgRepatchByIdSelfAccess(codeBlock, stubInfo, structure, slot.cachedOffset(), appropriateListBuildingPutByIdFunction(slot, putKind), false);
         stubInfo.initPutByIdReplace(*globalData, codeBlock->ownerExecutable(), structure);
         return true;
     }
@@ -577,7 +608,100 @@ static bool tryCachePutByID(ExecState* exec, JSValue baseValue, const Identifier
 void dfgRepatchPutByID(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PutPropertySlot& slot, StructureStubInfo& stubInfo, PutKind putKind)
 {
     bool cached = tryCachePutByID(exec, baseValue, propertyName, slot, stubInfo, putKind);
-    if (!cached)
+    if (!cached) {
+        dfgRepatchCall(exec->codeBlock(), stubInfo.callReturnLocation, appropriatePutByIdFunction(slot, putKind));
+        stubInfo.accessType = access_put_by_id_generic;
+    }
+}
+
+// Replacements and transitions share one list, built like the get_by_id list.
+static bool tryBuildPutByIDList(ExecState* exec, JSValue baseValue, const Identifier&, const PutPropertySlot& slot, StructureStubInfo& stubInfo, PutKind putKind)
+{
+    CodeBlock* codeBlock = exec->codeBlock();
+    JSGlobalData* globalData = &exec->globalData();
+
+    if (!baseValue.isCell())
+        return false;
+    JSCell* baseCell = baseValue.asCell();
+    Structure* structure = baseCell->structure();
+    Structure* oldStructure = structure->previousID();
+    
+    if (!slot.isCacheable())
+        return false;
+    if (structure->isUncacheableDictionary())
+        return false;
+    if (slot.base() != baseValue)
+        return false;
+    
+    StructureChain* prototypeChain = 0;
+    if (slot.type() == PutPropertySlot::NewProperty) {
+        if (structure->isDictionary())
+            return false;
+        
+        // skip optimizing the case where we need a realloc
+        if (oldStructure->propertyStorageCapacity() != structure->propertyStorageCapacity())
+            return false;
+        
+        normalizePrototypeChain(exec, baseCell);
+        
+        prototypeChain = structure->prototypeChain(exec);
+    }
+    
+    PolymorphicAccessStructureList* polymorphicStructureList;
+    int listIndex = 1;
+    
+    switch (stubInfo.accessType) {
+    case access_put_by_id_replace:
+        ASSERT(!stubInfo.stubRoutine);
+        polymorphicStructureList = new PolymorphicAccessStructureList(*globalData, codeBlock->ownerExecutable(), MacroAssemblerCodeRef::createSelfManagedCodeRef(stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToSlowCase)), stubInfo.u.putByIdReplace.baseObjectStructure.get());
+        stubInfo.initPutByIdList(polymorphicStructureList, 1);
+        break;
+    case access_put_by_id_transition:
+        // The transition's new structure keeps the old one alive.
+        ASSERT(!!stubInfo.stubRoutine);
+        polymorphicStructureList = new PolymorphicAccessStructureList(*globalData, codeBlock->ownerExecutable(), stubInfo.stubRoutine, stubInfo.u.putByIdTransition.structure.get(), stubInfo.u.putByIdTransition.chain.get());
+        stubInfo.stubRoutine = MacroAssemblerCodeRef();
+        stubInfo.initPutByIdList(polymorphicStructureList, 1);
+        break;
+    case access_put_by_id_list:
+        polymorphicStructureList = stubInfo.u.putByIdList.structureList;
+        listIndex = stubInfo.u.putByIdList.listSize;
+        break;
+    default:
+        return false;
+    }
+    
+    if (listIndex < POLYMORPHIC_LIST_CACHE_SIZE) {
+        stubInfo.u.putByIdList.listSize++;
+        
+        CodeLocationLabel lastStubBegin = CodeLocationLabel(polymorphicStructureList->list[listIndex - 1].stubRoutine.code());
+        ASSERT(!!lastStubBegin);
+        
+        MacroAssemblerCodeRef stubRoutine;
+        
+        if (prototypeChain) {
+            generatePutTransitionStub(exec, stubInfo, putKind, slot.cachedOffset(), oldStructure, structure, prototypeChain, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone), lastStubBegin, stubRoutine);
+            polymorphicStructureList->list[listIndex].set(*globalData, codeBlock->ownerExecutable(), stubRoutine, structure, prototypeChain);
+        } else {
+            generatePutReplaceStub(exec, stubInfo, slot.cachedOffset(), structure, stubInfo.callReturnLocation.labelAtOffset(stubInfo.deltaCallToDone), lastStubBegin, stubRoutine);
+            polymorphicStructureList->list[listIndex].set(*globalData, codeBlock->ownerExecutable(), stubRoutine, structure);
+        }
+        
+        CodeLocationJump jumpLocation = stubInfo.callReturnLocation.jumpAtOffset(stubInfo.deltaCallToStructCheck);
+        RepatchBuffer repatchBuffer(codeBlock);
+        repatchBuffer.relink(jumpLocation, CodeLocationLabel(stubRoutine.code()));
+        
+        if (listIndex < (POLYMORPHIC_LIST_CACHE_SIZE - 1))
+            return true;
+    }
+    
+    return false;
+}
+
+void dfgBuildPutByIDList(ExecState* exec, JSValue baseValue, const Identifier& propertyName, const PutPropertySlot& slot, StructureStubInfo& stubInfo, PutKind putKind)
+{
+    bool dontChangeCall = tryBuildPutByIDList(exec, baseValue, propertyName, slot, stubInfo, putKind);
+    if (!dontChangeCall)
         dfgRepatchCall(exec->codeBlock(), stubInfo.callReturnLocation, appropriatePutByIdFunction(slot, putKind));
 }
 
@@ -28,6 +28,8 @@
 
 #if ENABLE(DFG_JIT)
 
+#include "JSByteArray.h"
+
 namespace JSC { namespace DFG {
 
 template<bool strict>
@@ -85,7 +87,7 @@ GPRReg SpeculativeJIT::fillSpeculateIntInternal(NodeIndex nodeIndex, DataFormat&
         // Check the value is an integer.
         GPRReg gpr = info.gpr();
         m_gprs.lock(gpr);
-        speculationCheck(m_jit.branchPtr(MacroAssembler::Below, gpr, GPRInfo::tagTypeNumberRegister));
+        speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::Below, gpr, GPRInfo::tagTypeNumberRegister));
         info.fillJSValue(gpr, DataFormatJSInteger);
         // If !strict we're done, return.
         if (!strict) {
@@ -176,7 +178,10 @@ SpeculationCheck::SpeculationCheck(MacroAssembler::Jump check, SpeculativeJIT* j
 #ifndef NDEBUG
 void ValueSource::dump(FILE* out) const
 {
-    fprintf(out, "Node(%d)", m_nodeIndex);
+    if (isUnboxedDoubleInRegisterFile())
+        fprintf(out, "Double");
+    else
+        fprintf(out, "Node(%d)", m_nodeIndex);
 }
 
 void ValueRecovery::dump(FILE* out) const
@@ -185,6 +190,9 @@ void ValueRecovery::dump(FILE* out) const
     case AlreadyInRegisterFile:
         fprintf(out, "-");
         break;
+    case AlreadyInRegisterFileAsUnboxedDouble:
+        fprintf(out, "double(-)");
+        break;
     case InGPR:
         fprintf(out, "%%%s", GPRInfo::debugName(gpr()));
         break;
@@ -211,16 +219,17 @@ void ValueRecovery::dump(FILE* out) const
 #endif
 
 #if ENABLE(DFG_OSR_EXIT)
-OSRExit::OSRExit(MacroAssembler::Jump check, SpeculativeJIT* jit, unsigned recoveryIndex)
+OSRExit::OSRExit(ExitKind kind, MacroAssembler::Jump check, SpeculativeJIT* jit, unsigned recoveryIndex)
     : m_check(check)
     , m_nodeIndex(jit->m_compileIndex)
-    , m_bytecodeIndex(jit->m_bytecodeIndexForOSR)
+    , m_codeOrigin(jit->m_codeOriginForOSR)
+    , m_kind(kind)
     , m_recoveryIndex(recoveryIndex)
     , m_arguments(jit->m_arguments.size())
     , m_variables(jit->m_variables.size())
     , m_lastSetOperand(jit->m_lastSetOperand)
 {
-    ASSERT(m_bytecodeIndex != std::numeric_limits<uint32_t>::max());
+    ASSERT(m_codeOrigin.isSet());
     for (unsigned argument = 0; argument < m_arguments.size(); ++argument)
         m_arguments[argument] = jit->computeValueRecoveryFor(jit->m_arguments[argument]);
     for (unsigned variable = 0; variable < m_variables.size(); ++variable)
@@ -310,7 +319,7 @@ FPRReg SpeculativeJIT::fillSpeculateDouble(NodeIndex nodeIndex)
 
         JITCompiler::Jump isInteger = m_jit.branchPtr(MacroAssembler::AboveOrEqual, jsValueGpr, GPRInfo::tagTypeNumberRegister);
 
-        speculationCheck(m_jit.branchTestPtr(MacroAssembler::Zero, jsValueGpr, GPRInfo::tagTypeNumberRegister));
+        speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::Zero, jsValueGpr, GPRInfo::tagTypeNumberRegister));
 
         // First, if we get here we have a double encoded as a JSValue
         m_jit.move(jsValueGpr, tempGpr);
@@ -399,7 +408,7 @@ GPRReg SpeculativeJIT::fillSpeculateCell(NodeIndex nodeIndex)
 
         info.fillJSValue(gpr, DataFormatJS);
         if (info.spillFormat() != DataFormatJSCell)
-            speculationCheck(m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, GPRInfo::tagMaskRegister));
+            speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, GPRInfo::tagMaskRegister));
         info.fillJSValue(gpr, DataFormatJSCell);
         return gpr;
     }
@@ -414,7 +423,7 @@ GPRReg SpeculativeJIT::fillSpeculateCell(NodeIndex nodeIndex)
     case DataFormatJS: {
         GPRReg gpr = info.gpr();
         m_gprs.lock(gpr);
-        speculationCheck(m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, GPRInfo::tagMaskRegister));
+        speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, GPRInfo::tagMaskRegister));
         info.fillJSValue(gpr, DataFormatJSCell);
         return gpr;
     }
@@ -462,7 +471,7 @@ GPRReg SpeculativeJIT::fillSpeculateBoolean(NodeIndex nodeIndex)
         info.fillJSValue(gpr, DataFormatJS);
         if (info.spillFormat() != DataFormatJSBoolean) {
             m_jit.xorPtr(TrustedImm32(static_cast<int32_t>(ValueFalse)), gpr);
-            speculationCheck(m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, TrustedImm32(static_cast<int32_t>(~1))), SpeculationRecovery(BooleanSpeculationCheck, gpr, InvalidGPRReg));
+            speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, TrustedImm32(static_cast<int32_t>(~1))), SpeculationRecovery(BooleanSpeculationCheck, gpr, InvalidGPRReg));
             m_jit.xorPtr(TrustedImm32(static_cast<int32_t>(ValueFalse)), gpr);
         }
         info.fillJSValue(gpr, DataFormatJSBoolean);
@@ -480,7 +489,7 @@ GPRReg SpeculativeJIT::fillSpeculateBoolean(NodeIndex nodeIndex)
         GPRReg gpr = info.gpr();
         m_gprs.lock(gpr);
         m_jit.xorPtr(TrustedImm32(static_cast<int32_t>(ValueFalse)), gpr);
-        speculationCheck(m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, TrustedImm32(static_cast<int32_t>(~1))), SpeculationRecovery(BooleanSpeculationCheck, gpr, InvalidGPRReg));
+        speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::NonZero, gpr, TrustedImm32(static_cast<int32_t>(~1))), SpeculationRecovery(BooleanSpeculationCheck, gpr, InvalidGPRReg));
         m_jit.xorPtr(TrustedImm32(static_cast<int32_t>(ValueFalse)), gpr);
         info.fillJSValue(gpr, DataFormatJSBoolean);
         return gpr;
@@ -676,6 +685,172 @@ bool SpeculativeJIT::compare(Node& node, MacroAssembler::RelationalCondition con
     return false;
 }
 
+// Integer arithmetic whose speculation kept failing: the result is an int32 when
+// it fits, and is recomputed in doubles when it does not, instead of exiting.
+// Either way it is boxed, so that uses see a number of either kind.
+void SpeculativeJIT::compileArithmeticWithDoubleFallback(Node& node)
+{
+    SpeculateIntegerOperand op1(this, node.child1());
+    SpeculateIntegerOperand op2(this, node.child2());
+    GPRTemporary result(this);
+    FPRTemporary temp1(this);
+    FPRTemporary temp2(this);
+    
+    GPRReg op1GPR = op1.gpr();
+    GPRReg op2GPR = op2.gpr();
+    GPRReg resultGPR = result.gpr();
+    FPRReg temp1FPR = temp1.fpr();
+    FPRReg temp2FPR = temp2.fpr();
+    
+    MacroAssembler::JumpList notInt32;
+    switch (node.op) {
+    case ValueAdd:
+    case ArithAdd:
+        notInt32.append(m_jit.branchAdd32(MacroAssembler::Overflow, op1GPR, op2GPR, resultGPR));
+        break;
+        
+    case ArithSub:
+        notInt32.append(m_jit.branchSub32(MacroAssembler::Overflow, op1GPR, op2GPR, resultGPR));
+        break;
+        
+    case ArithMul: {
+        notInt32.append(m_jit.branchMul32(MacroAssembler::Overflow, op1GPR, op2GPR, resultGPR));
+        MacroAssembler::Jump resultNonZero = m_jit.branchTest32(MacroAssembler::NonZero, resultGPR);
+        notInt32.append(m_jit.branch32(MacroAssembler::LessThan, op1GPR, TrustedImm32(0)));
+        notInt32.append(m_jit.branch32(MacroAssembler::LessThan, op2GPR, TrustedImm32(0)));
+        resultNonZero.link(&m_jit);
+        break;
+    }
+        
+    default:
+        ASSERT_NOT_REACHED();
+    }
+    
+    m_jit.orPtr(GPRInfo::tagTypeNumberRegister, resultGPR);
+    MacroAssembler::Jump done = m_jit.jump();
+    
+    notInt32.link(&m_jit);
+    m_jit.convertInt32ToDouble(op1GPR, temp1FPR);
+    m_jit.convertInt32ToDouble(op2GPR, temp2FPR);
+    switch (node.op) {
+    case ValueAdd:
+    case ArithAdd:
+        m_jit.addDouble(temp2FPR, temp1FPR);
+        break;
+    case ArithSub:
+        m_jit.subDouble(temp2FPR, temp1FPR);
+        break;
+    case ArithMul:
+        m_jit.mulDouble(temp2FPR, temp1FPR);
+        break;
+    default:
+        ASSERT_NOT_REACHED();
+    }
+    m_jit.boxDouble(temp1FPR, resultGPR);
+    
+    done.link(&m_jit);
+    jsValueResult(resultGPR, m_compileIndex);
+}
+
+void SpeculativeJIT::compileGetByValOnByteArray(Node& node)
+{
+    SpeculateCellOperand base(this, node.child1());
+    SpeculateStrictInt32Operand property(this, node.child2());
+    GPRTemporary storage(this);
+    
+    GPRReg baseReg = base.gpr();
+    GPRReg propertyReg = property.gpr();
+    GPRReg storageReg = storage.gpr();
+    
+    if (!m_compileOkay)
+        return;
+    
+    speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseReg), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsByteArrayVPtr)));
+    m_jit.loadPtr(MacroAssembler::Address(baseReg, JSByteArray::offsetOfStorage()), storageReg);
+    
+    // Beyond the end of the bytes, the access goes to the prototype chain.
+    speculationCheck(OutOfBounds, m_jit.branch32(MacroAssembler::AboveOrEqual, propertyReg, MacroAssembler::Address(storageReg, ByteArray::offsetOfSize())));
+    m_jit.load8(MacroAssembler::BaseIndex(storageReg, propertyReg, MacroAssembler::TimesOne, ByteArray::offsetOfData()), storageReg);
+    
+    integerResult(storageReg, m_compileIndex);
+}
+
+// Clamps as JSByteArray::setIndex(unsigned, double) does: NaN and anything
+// not above 0 becomes 0, and the rest is rounded and capped at 255.
+static void compileClampDoubleToByte(JITCompiler& jit, GPRReg result, FPRReg source, FPRReg scratch)
+{
+    static const double zero = 0;
+    static const double byteMax = 255;
+    static const double half = 0.5;
+    
+    jit.loadDouble(&zero, scratch);
+    MacroAssembler::Jump tooSmall = jit.branchDouble(MacroAssembler::DoubleLessThanOrEqualOrUnordered, source, scratch);
+    jit.loadDouble(&byteMax, scratch);
+    MacroAssembler::Jump tooBig = jit.branchDouble(MacroAssembler::DoubleGreaterThan, source, scratch);
+    
+    jit.loadDouble(&half, scratch);
+    jit.addDouble(source, scratch);
+    jit.truncateDoubleToInt32(scratch, result);
+    MacroAssembler::Jump truncated = jit.jump();
+    
+    tooSmall.link(&jit);
+    jit.move(MacroAssembler::TrustedImm32(0), result);
+    MacroAssembler::Jump zeroed = jit.jump();
+    
+    tooBig.link(&jit);
+    jit.move(MacroAssembler::TrustedImm32(255), result);
+    
+    truncated.link(&jit);
+    zeroed.link(&jit);
+}
+
+void SpeculativeJIT::compilePutByValForByteArray(Node& node)
+{
+    SpeculateCellOperand base(this, node.child1());
+    SpeculateStrictInt32Operand property(this, node.child2());
+    GPRTemporary value(this);
+    GPRTemporary storage(this);
+    
+    GPRReg baseReg = base.gpr();
+    GPRReg propertyReg = property.gpr();
+    GPRReg valueReg = value.gpr();
+    GPRReg storageReg = storage.gpr();
+    
+    if (shouldSpeculateInteger(node.child3())) {
+        SpeculateIntegerOperand valueOp(this, node.child3());
+        m_jit.move(valueOp.gpr(), valueReg);
+        
+        MacroAssembler::Jump inRange = m_jit.branch32(MacroAssembler::BelowOrEqual, valueReg, MacroAssembler::TrustedImm32(0xff));
+        MacroAssembler::Jump tooBig = m_jit.branch32(MacroAssembler::GreaterThan, valueReg, MacroAssembler::TrustedImm32(0xff));
+        m_jit.move(MacroAssembler::TrustedImm32(0), valueReg);
+        MacroAssembler::Jump clamped = m_jit.jump();
+        tooBig.link(&m_jit);
+        m_jit.move(MacroAssembler::TrustedImm32(0xff), valueReg);
+        clamped.link(&m_jit);
+        inRange.link(&m_jit);
+    } else {
+        // Anything but a number would have to be converted by calling out,
+        // which may have side effects; leave that to the baseline code.
+        SpeculateDoubleOperand valueOp(this, node.child3());
+        FPRTemporary scratch(this);
+        compileClampDoubleToByte(m_jit, valueReg, valueOp.fpr(), scratch.fpr());
+    }
+    
+    if (!m_compileOkay)
+        return;
+    
+    speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseReg), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsByteArrayVPtr)));
+    
+    m_jit.loadPtr(MacroAssembler::Address(baseReg, JSByteArray::offsetOfStorage()), storageReg);
+    
+    // Puts beyond the end of the bytes are dropped.
+    MacroAssembler::Jump outOfBounds = m_jit.branch32(MacroAssembler::AboveOrEqual, propertyReg, MacroAssembler::Address(storageReg, ByteArray::offsetOfSize()));
+    m_jit.store8(valueReg, MacroAssembler::BaseIndex(storageReg, propertyReg, MacroAssembler::TimesOne, ByteArray::offsetOfData()));
+    outOfBounds.link(&m_jit);
+    
+    noResult(m_compileIndex);
+}
+
 void SpeculativeJIT::compile(Node& node)
 {
     NodeType op = node.op;
@@ -686,8 +861,18 @@ void SpeculativeJIT::compile(Node& node)
         break;
 
     case GetLocal: {
-        GPRTemporary result(this);
         PredictedType prediction = m_jit.graph().getPrediction(node.local());
+        if (m_jit.graph().isUnboxedDoubleLocal(node.local())) {
+            FPRTemporary result(this);
+            m_jit.loadDouble(JITCompiler::addressFor(node.local()), result.fpr());
+
+            // Like doubleResult, but don't useChildren - our children are phi nodes,
+            // and don't represent values within this dataflow with virtual registers.
+            doubleResult(result.fpr(), m_compileIndex, UseChildrenCalledExplicitly);
+            break;
+        }
+
+        GPRTemporary result(this);
         if (isInt32Prediction(prediction)) {
             m_jit.load32(JITCompiler::payloadFor(node.local()), result.gpr());
 
@@ -728,7 +913,7 @@ void SpeculativeJIT::compile(Node& node)
         // to the *next* instruction, since we've already "executed" the
         // SetLocal and whatever other DFG Nodes are associated with the same
         // bytecode index as the SetLocal.
-        ASSERT(m_bytecodeIndexForOSR == node.codeOrigin.bytecodeIndex());
+        ASSERT(m_codeOriginForOSR == node.codeOrigin);
         Node& nextNode = m_jit.graph()[m_compileIndex+1];
         
         // This assertion will fail if we ever emit multiple SetLocal's for
@@ -743,26 +928,31 @@ void SpeculativeJIT::compile(Node& node)
         // occurs for SetLocal's generated at the top of the code block to
         // initialize locals to undefined. Ideally, we'd have a way of marking
         // in the CodeOrigin that a SetLocal is synthetic. This will make the
-        // assertion more sensible-looking. We should then also assert that
+        // assertion more sensible-looking. The same goes for the SetLocal's at the
+        // top of an inlined function. We should then also assert that
         // synthetic SetLocal's don't have speculation checks, since they
         // should only be dropping values that we statically know we are
         // allowed to drop into the variables. DFGPropagator will guarantee
         // this, since it should have at least an approximation (if not
         // exact knowledge) of the type of the SetLocal's child node, and
         // should merge that information into the local that is being set.
-        ASSERT(m_bytecodeIndexForOSR != nextNode.codeOrigin.bytecodeIndex()
-               || (!m_bytecodeIndexForOSR && !nextNode.codeOrigin.bytecodeIndex()));
-        m_bytecodeIndexForOSR = nextNode.codeOrigin.bytecodeIndex();
+        ASSERT(m_codeOriginForOSR != nextNode.codeOrigin
+               || (!m_codeOriginForOSR.bytecodeIndex() && !nextNode.codeOrigin.bytecodeIndex()));
+        m_codeOriginForOSR = nextNode.codeOrigin;
         
         PredictedType predictedType = m_jit.graph().getPrediction(node.local());
-        if (isInt32Prediction(predictedType)) {
+        if (m_jit.graph().isUnboxedDoubleLocal(node.local())) {
+            SpeculateDoubleOperand value(this, node.child1());
+            m_jit.storeDouble(value.fpr(), JITCompiler::addressFor(node.local()));
+            noResult(m_compileIndex);
+        } else if (isInt32Prediction(predictedType)) {
             SpeculateIntegerOperand value(this, node.child1());
             m_jit.store32(value.gpr(), JITCompiler::payloadFor(node.local()));
             noResult(m_compileIndex);
         } else if (isArrayPrediction(predictedType)) {
             SpeculateCellOperand cell(this, node.child1());
             GPRReg cellGPR = cell.gpr();
-            speculationCheck(m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(cellGPR), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
+            speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(cellGPR), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
             m_jit.storePtr(cellGPR, JITCompiler::addressFor(node.local()));
             noResult(m_compileIndex);
         } else if (isBooleanPrediction(predictedType)) {
@@ -777,7 +967,7 @@ void SpeculativeJIT::compile(Node& node)
         
         // Indicate that it's no longer necessary to retrieve the value of
         // this bytecode variable from registers or other locations in the register file.
-        valueSourceReferenceForOperand(node.local()) = ValueSource();
+        valueSourceReferenceForOperand(node.local()) = registerFileValueSourceForOperand(node.local());
         break;
     }
 
@@ -840,7 +1030,7 @@ void SpeculativeJIT::compile(Node& node)
         GPRTemporary result(this, op1);
 
         // Test the operand is positive.
-        speculationCheck(m_jit.branch32(MacroAssembler::LessThan, op1.gpr(), TrustedImm32(0)));
+        speculationCheck(Overflow, m_jit.branch32(MacroAssembler::LessThan, op1.gpr(), TrustedImm32(0)));
 
         m_jit.move(op1.gpr(), result.gpr());
         integerResult(result.gpr(), m_compileIndex, op1.format());
@@ -848,6 +1038,39 @@ void SpeculativeJIT::compile(Node& node)
     }
 
     case ValueToInt32: {
+        if (!shouldSpeculateInteger(node.child1())) {
+            // The operand may well be a double, for instance the result of
+            // arithmetic that falls back to doubles when it overflows.
+            JSValueOperand op1(this, node.child1());
+            GPRTemporary result(this);
+            FPRTemporary temp(this);
+            GPRReg valueGPR = op1.gpr();
+            GPRReg resultGPR = result.gpr();
+            FPRReg tempFPR = temp.fpr();
+            
+            JITCompiler::Jump isInteger = m_jit.branchPtr(MacroAssembler::AboveOrEqual, valueGPR, GPRInfo::tagTypeNumberRegister);
+            speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::Zero, valueGPR, GPRInfo::tagTypeNumberRegister));
+            
+            m_jit.move(valueGPR, resultGPR);
+            m_jit.unboxDouble(resultGPR, tempFPR);
+            JITCompiler::Jump truncatedToInteger = m_jit.branchTruncateDoubleToInt32(tempFPR, resultGPR, JITCompiler::BranchIfTruncateSuccessful);
+            
+            silentSpillAllRegisters(resultGPR);
+            m_jit.moveDouble(tempFPR, FPRInfo::argumentFPR0);
+            appendCallWithExceptionCheck(toInt32);
+            m_jit.zeroExtend32ToPtr(GPRInfo::returnValueGPR, resultGPR);
+            silentFillAllRegisters(resultGPR);
+            JITCompiler::Jump done = m_jit.jump();
+            
+            isInteger.link(&m_jit);
+            m_jit.zeroExtend32ToPtr(valueGPR, resultGPR);
+            
+            done.link(&m_jit);
+            truncatedToInteger.link(&m_jit);
+            integerResult(resultGPR, m_compileIndex);
+            break;
+        }
+        
         SpeculateIntegerOperand op1(this, node.child1());
         GPRTemporary result(this, op1);
         m_jit.move(op1.gpr(), result.gpr());
@@ -881,12 +1104,17 @@ void SpeculativeJIT::compile(Node& node)
     case ValueAdd:
     case ArithAdd: {
         if (shouldSpeculateInteger(node.child1(), node.child2())) {
+            if (arithmeticMayOverflow(node)) {
+                compileArithmeticWithDoubleFallback(node);
+                break;
+            }
+            
             if (isInt32Constant(node.child1())) {
                 int32_t imm1 = valueOfInt32Constant(node.child1());
                 SpeculateIntegerOperand op2(this, node.child2());
                 GPRTemporary result(this);
 
-                speculationCheck(m_jit.branchAdd32(MacroAssembler::Overflow, op2.gpr(), Imm32(imm1), result.gpr()));
+                speculationCheck(Overflow, m_jit.branchAdd32(MacroAssembler::Overflow, op2.gpr(), Imm32(imm1), result.gpr()));
 
                 integerResult(result.gpr(), m_compileIndex);
                 break;
@@ -897,7 +1125,7 @@ void SpeculativeJIT::compile(Node& node)
                 int32_t imm2 = valueOfInt32Constant(node.child2());
                 GPRTemporary result(this);
                 
-                speculationCheck(m_jit.branchAdd32(MacroAssembler::Overflow, op1.gpr(), Imm32(imm2), result.gpr()));
+                speculationCheck(Overflow, m_jit.branchAdd32(MacroAssembler::Overflow, op1.gpr(), Imm32(imm2), result.gpr()));
 
                 integerResult(result.gpr(), m_compileIndex);
                 break;
@@ -913,11 +1141,11 @@ void SpeculativeJIT::compile(Node& node)
             MacroAssembler::Jump check = m_jit.branchAdd32(MacroAssembler::Overflow, gpr1, gpr2, gprResult);
 
             if (gpr1 == gprResult)
-                speculationCheck(check, SpeculationRecovery(SpeculativeAdd, gprResult, gpr2));
+                speculationCheck(Overflow, check, SpeculationRecovery(SpeculativeAdd, gprResult, gpr2));
             else if (gpr2 == gprResult)
-                speculationCheck(check, SpeculationRecovery(SpeculativeAdd, gprResult, gpr1));
+                speculationCheck(Overflow, check, SpeculationRecovery(SpeculativeAdd, gprResult, gpr1));
             else
-                speculationCheck(check);
+                speculationCheck(Overflow, check);
 
             integerResult(gprResult, m_compileIndex);
             break;
@@ -958,12 +1186,17 @@ void SpeculativeJIT::compile(Node& node)
 
     case ArithSub: {
         if (shouldSpeculateInteger(node.child1(), node.child2())) {
+            if (arithmeticMayOverflow(node)) {
+                compileArithmeticWithDoubleFallback(node);
+                break;
+            }
+            
             if (isInt32Constant(node.child2())) {
                 SpeculateIntegerOperand op1(this, node.child1());
                 int32_t imm2 = valueOfInt32Constant(node.child2());
                 GPRTemporary result(this);
 
-                speculationCheck(m_jit.branchSub32(MacroAssembler::Overflow, op1.gpr(), Imm32(imm2), result.gpr()));
+                speculationCheck(Overflow, m_jit.branchSub32(MacroAssembler::Overflow, op1.gpr(), Imm32(imm2), result.gpr()));
 
                 integerResult(result.gpr(), m_compileIndex);
                 break;
@@ -973,7 +1206,7 @@ void SpeculativeJIT::compile(Node& node)
             SpeculateIntegerOperand op2(this, node.child2());
             GPRTemporary result(this);
 
-            speculationCheck(m_jit.branchSub32(MacroAssembler::Overflow, op1.gpr(), op2.gpr(), result.gpr()));
+            speculationCheck(Overflow, m_jit.branchSub32(MacroAssembler::Overflow, op1.gpr(), op2.gpr(), result.gpr()));
 
             integerResult(result.gpr(), m_compileIndex);
             break;
@@ -993,17 +1226,22 @@ void SpeculativeJIT::compile(Node& node)
 
     case ArithMul: {
         if (shouldSpeculateInteger(node.child1(), node.child2())) {
+            if (arithmeticMayOverflow(node)) {
+                compileArithmeticWithDoubleFallback(node);
+                break;
+            }
+            
             SpeculateIntegerOperand op1(this, node.child1());
             SpeculateIntegerOperand op2(this, node.child2());
             GPRTemporary result(this);
 
             GPRReg reg1 = op1.gpr();
             GPRReg reg2 = op2.gpr();
-            speculationCheck(m_jit.branchMul32(MacroAssembler::Overflow, reg1, reg2, result.gpr()));
+            speculationCheck(Overflow, m_jit.branchMul32(MacroAssembler::Overflow, reg1, reg2, result.gpr()));
 
             MacroAssembler::Jump resultNonZero = m_jit.branchTest32(MacroAssembler::NonZero, result.gpr());
-            speculationCheck(m_jit.branch32(MacroAssembler::LessThan, reg1, TrustedImm32(0)));
-            speculationCheck(m_jit.branch32(MacroAssembler::LessThan, reg2, TrustedImm32(0)));
+            speculationCheck(NegativeZero, m_jit.branch32(MacroAssembler::LessThan, reg1, TrustedImm32(0)));
+            speculationCheck(NegativeZero, m_jit.branch32(MacroAssembler::LessThan, reg2, TrustedImm32(0)));
             resultNonZero.link(&m_jit);
 
             integerResult(result.gpr(), m_compileIndex);
@@ -1044,7 +1282,7 @@ void SpeculativeJIT::compile(Node& node)
         GPRReg op1Gpr = op1.gpr();
         GPRReg op2Gpr = op2.gpr();
 
-        speculationCheck(m_jit.branchTest32(JITCompiler::Zero, op2Gpr));
+        speculationCheck(Uncountable, m_jit.branchTest32(JITCompiler::Zero, op2Gpr));
 
         GPRReg temp2 = InvalidGPRReg;
         if (op2Gpr == X86Registers::eax || op2Gpr == X86Registers::edx) {
@@ -1083,7 +1321,7 @@ void SpeculativeJIT::compile(Node& node)
             
             m_jit.move(value.gpr(), result.gpr());
             m_jit.xorPtr(TrustedImm32(static_cast<int32_t>(ValueFalse)), result.gpr());
-            speculationCheck(m_jit.branchTestPtr(JITCompiler::NonZero, result.gpr(), TrustedImm32(static_cast<int32_t>(~1))));
+            speculationCheck(BadType, m_jit.branchTestPtr(JITCompiler::NonZero, result.gpr(), TrustedImm32(static_cast<int32_t>(~1))));
             m_jit.xorPtr(TrustedImm32(static_cast<int32_t>(ValueTrue)), result.gpr());
             
             // If we add a DataFormatBool, we should use it here.
@@ -1147,6 +1385,11 @@ void SpeculativeJIT::compile(Node& node)
             break;
         }
 
+        if (isByteArrayPrediction(m_jit.graph().getPrediction(m_jit.graph()[node.child1()]))) {
+            compileGetByValOnByteArray(node);
+            break;
+        }
+
         SpeculateCellOperand base(this, node.child1());
         SpeculateStrictInt32Operand property(this, node.child2());
         GPRTemporary storage(this);
@@ -1166,21 +1409,27 @@ void SpeculativeJIT::compile(Node& node)
         // If we have predicted the base to be type array, we can skip the check.
         Node& baseNode = m_jit.graph()[node.child1()];
         if (baseNode.op != GetLocal || !isArrayPrediction(m_jit.graph().getPrediction(baseNode.local())))
-            speculationCheck(m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseReg), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
-        speculationCheck(m_jit.branch32(MacroAssembler::AboveOrEqual, propertyReg, MacroAssembler::Address(baseReg, JSArray::vectorLengthOffset())));
+            speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseReg), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
+        if (!node.indexIsWithinVector())
+            speculationCheck(OutOfBounds, m_jit.branch32(MacroAssembler::AboveOrEqual, propertyReg, MacroAssembler::Address(baseReg, JSArray::vectorLengthOffset())));
 
         // FIXME: In cases where there are subsequent by_val accesses to the same base it might help to cache
         // the storage pointer - especially if there happens to be another register free right now. If we do so,
         // then we'll need to allocate a new temporary for result.
         GPRTemporary& result = storage;
         m_jit.loadPtr(MacroAssembler::BaseIndex(storageReg, propertyReg, MacroAssembler::ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), result.gpr());
-        speculationCheck(m_jit.branchTestPtr(MacroAssembler::Zero, result.gpr()));
+        speculationCheck(OutOfBounds, m_jit.branchTestPtr(MacroAssembler::Zero, result.gpr()));
 
         jsValueResult(result.gpr(), m_compileIndex);
         break;
     }
 
     case PutByVal: {
+        if (isByteArrayPrediction(m_jit.graph().getPrediction(m_jit.graph()[node.child1()]))) {
+            compilePutByValForByteArray(node);
+            break;
+        }
+
         SpeculateCellOperand base(this, node.child1());
         SpeculateStrictInt32Operand property(this, node.child2());
         JSValueOperand value(this, node.child3());
@@ -1201,12 +1450,25 @@ void SpeculativeJIT::compile(Node& node)
         // If we have predicted the base to be type array, we can skip the check.
         Node& baseNode = m_jit.graph()[node.child1()];
         if (baseNode.op != GetLocal || !isArrayPrediction(m_jit.graph().getPrediction(baseNode.local())))
-            speculationCheck(m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseReg), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
+            speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(baseReg), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
 
         base.use();
         property.use();
         value.use();
         
+        if (node.indexIsWithinVector()) {
+            // The property is also below the array's length, so this can
+            // neither put beyond the vector nor grow the array.
+            GPRReg storageReg = scratchReg;
+            m_jit.loadPtr(MacroAssembler::Address(baseReg, JSArray::storageOffset()), storageReg);
+            MacroAssembler::Jump notHoleValue = m_jit.branchTestPtr(MacroAssembler::NonZero, MacroAssembler::BaseIndex(storageReg, propertyReg, MacroAssembler::ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
+            m_jit.add32(TrustedImm32(1), MacroAssembler::Address(storageReg, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+            notHoleValue.link(&m_jit);
+            m_jit.storePtr(valueReg, MacroAssembler::BaseIndex(storageReg, propertyReg, MacroAssembler::ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
+            noResult(m_compileIndex, UseChildrenCalledExplicitly);
+            break;
+        }
+        
         MacroAssembler::Jump withinArrayBounds = m_jit.branch32(MacroAssembler::Below, propertyReg, MacroAssembler::Address(baseReg, JSArray::vectorLengthOffset()));
 
         // Code to handle put beyond array bounds.
@@ -1246,6 +1508,13 @@ void SpeculativeJIT::compile(Node& node)
     }
 
     case PutByValAlias: {
+        // Byte array puts check the array and the index themselves, so
+        // there is nothing to gain from the alias.
+        if (isByteArrayPrediction(m_jit.graph().getPrediction(m_jit.graph()[node.child1()]))) {
+            compilePutByValForByteArray(node);
+            break;
+        }
+
         SpeculateCellOperand base(this, node.child1());
         SpeculateStrictInt32Operand property(this, node.child2());
         JSValueOperand value(this, node.child3());
@@ -1310,7 +1579,7 @@ void SpeculativeJIT::compile(Node& node)
     case ConvertThis: {
         SpeculateCellOperand thisValue(this, node.child1());
 
-        speculationCheck(m_jit.branchPtr(JITCompiler::Equal, JITCompiler::Address(thisValue.gpr()), JITCompiler::TrustedImmPtr(m_jit.globalData()->jsStringVPtr)));
+        speculationCheck(BadType, m_jit.branchPtr(JITCompiler::Equal, JITCompiler::Address(thisValue.gpr()), JITCompiler::TrustedImmPtr(m_jit.globalData()->jsStringVPtr)));
 
         cellResult(thisValue.gpr(), m_compileIndex);
         break;
@@ -1337,6 +1606,25 @@ void SpeculativeJIT::compile(Node& node)
         break;
     }
         
+    case GetArrayLength: {
+        SpeculateCellOperand base(this, node.child1());
+        GPRTemporary result(this);
+        
+        GPRReg baseGPR = base.gpr();
+        GPRReg resultGPR = result.gpr();
+        
+        m_jit.loadPtr(MacroAssembler::Address(baseGPR, JSArray::storageOffset()), resultGPR);
+        m_jit.load32(MacroAssembler::Address(resultGPR, OBJECT_OFFSETOF(ArrayStorage, m_length)), resultGPR);
+        
+        // Lengths that do not fit in an int32 are too rare to speculate on.
+        speculationCheck(Overflow, m_jit.branch32(MacroAssembler::LessThan, resultGPR, TrustedImm32(0)));
+        if (node.lengthMustBeWithinVector())
+            speculationCheck(OutOfBounds, m_jit.branch32(MacroAssembler::Above, resultGPR, MacroAssembler::Address(baseGPR, JSArray::vectorLengthOffset())));
+        
+        integerResult(resultGPR, m_compileIndex);
+        break;
+    }
+        
     case GetMethod: {
         SpeculateCellOperand base(this, node.child1());
         GPRTemporary result(this, base);
@@ -1430,12 +1718,19 @@ void SpeculativeJIT::compile(Node& node)
 
         // Speculate that base 'ImplementsDefaultHasInstance'.
         m_jit.loadPtr(MacroAssembler::Address(base.gpr(), JSCell::structureOffset()), structure.gpr());
-        speculationCheck(m_jit.branchTest8(MacroAssembler::Zero, MacroAssembler::Address(structure.gpr(), Structure::typeInfoFlagsOffset()), MacroAssembler::TrustedImm32(ImplementsDefaultHasInstance)));
+        speculationCheck(BadType, m_jit.branchTest8(MacroAssembler::Zero, MacroAssembler::Address(structure.gpr(), Structure::typeInfoFlagsOffset()), MacroAssembler::TrustedImm32(ImplementsDefaultHasInstance)));
 
         noResult(m_compileIndex);
         break;
     }
 
+    case CheckFunction: {
+        JSValueOperand function(this, node.child1());
+        speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, function.gpr(), MacroAssembler::TrustedImmPtr(JSValue::encode(node.function(m_jit.codeBlock())))));
+        noResult(m_compileIndex);
+        break;
+    }
+
     case InstanceOf: {
         SpeculateCellOperand value(this, node.child1());
         // Base unused since we speculate default InstanceOf behaviour in CheckHasInstance.
@@ -1449,7 +1744,7 @@ void SpeculativeJIT::compile(Node& node)
 
         // Check that prototype is an object.
         m_jit.loadPtr(MacroAssembler::Address(prototypeReg, JSCell::structureOffset()), scratchReg);
-        speculationCheck(m_jit.branchIfNotObject(scratchReg));
+        speculationCheck(BadType, m_jit.branchIfNotObject(scratchReg));
 
         // Initialize scratchReg with the value being checked.
         m_jit.move(valueReg, scratchReg);
@@ -1489,6 +1784,18 @@ void SpeculativeJIT::compile(Node& node)
         emitCall(node);
         break;
 
+    case NewObject:
+        emitNewObject(node);
+        break;
+
+    case NewArray:
+        emitNewArray(node);
+        break;
+
+    case NewArrayBuffer:
+        emitNewArrayBuffer(node);
+        break;
+
     case Resolve: {
         flushRegisters();
         GPRResult result(this);
@@ -1531,24 +1838,37 @@ void SpeculativeJIT::compile(BasicBlock& block)
     ASSERT(m_compileOkay);
     ASSERT(m_compileIndex == block.begin);
     
-    if (block.isOSRTarget)
-        m_jit.noticeOSREntry(block);
+    for (size_t i = 0; i < m_arguments.size(); ++i)
+        m_arguments[i] = ValueSource();
+    for (size_t i = 0; i < m_variables.size(); ++i)
+        m_variables[i] = registerFileValueSourceForOperand(i);
+    m_lastSetOperand = std::numeric_limits<int>::max();
+    m_codeOriginForOSR = CodeOrigin();
+    
+    if (block.isOSRTarget) {
+        if (block.osrEntryArrayChecks.isEmpty())
+            m_jit.noticeOSREntry(block);
+        else {
+            // Code that falls or branches into the block has already checked
+            // these; only OSR entry needs to.
+            MacroAssembler::Jump skipChecks = m_jit.jump();
+            m_jit.noticeOSREntry(block);
+            m_codeOriginForOSR = m_jit.graph()[block.begin].codeOrigin;
+            for (size_t i = 0; i < block.osrEntryArrayChecks.size(); ++i)
+                checkArrayLengthWithinVector(block.osrEntryArrayChecks[i]);
+            m_codeOriginForOSR = CodeOrigin();
+            skipChecks.link(&m_jit);
+        }
+    }
     
     m_blockHeads[m_block] = m_jit.label();
 #if ENABLE(DFG_JIT_BREAK_ON_EVERY_BLOCK)
     m_jit.breakpoint();
 #endif
-    
-    for (size_t i = 0; i < m_arguments.size(); ++i)
-        m_arguments[i] = ValueSource();
-    for (size_t i = 0; i < m_variables.size(); ++i)
-        m_variables[i] = ValueSource();
-    m_lastSetOperand = std::numeric_limits<int>::max();
-    m_bytecodeIndexForOSR = std::numeric_limits<uint32_t>::max();
 
     for (; m_compileIndex < block.end; ++m_compileIndex) {
         Node& node = m_jit.graph()[m_compileIndex];
-        m_bytecodeIndexForOSR = node.codeOrigin.bytecodeIndex();
+        m_codeOriginForOSR = node.codeOrigin;
         if (!node.shouldGenerate()) {
 #if ENABLE(DFG_DEBUG_VERBOSE)
             fprintf(stderr, "SpeculativeJIT skipping Node @%d (bc#%u) at JIT offset 0x%x     ", (int)m_compileIndex, node.codeOrigin.bytecodeIndex(), m_jit.debugOffset());
@@ -1564,6 +1884,10 @@ void SpeculativeJIT::compile(BasicBlock& block)
             m_jit.breakpoint();
 #endif
             checkConsistency();
+            if (node.isTerminal()) {
+                for (size_t i = 0; i < block.hoistedArrayChecks.size(); ++i)
+                    checkArrayLengthWithinVector(block.hoistedArrayChecks[i]);
+            }
             compile(node);
             if (!m_compileOkay) {
 #if ENABLE(DYNAMIC_TERMINATE_SPECULATION)
@@ -1609,22 +1933,40 @@ void SpeculativeJIT::compile(BasicBlock& block)
     }
 }
 
+// Bounds check elimination relies on an array variable's length not exceeding
+// its vector length; check that before the loop it hoisted the check out of,
+// or on OSR entry into it.
+void SpeculativeJIT::checkArrayLengthWithinVector(VirtualRegister operand)
+{
+    GPRTemporary array(this);
+    GPRTemporary length(this);
+    GPRReg arrayGPR = array.gpr();
+    GPRReg lengthGPR = length.gpr();
+    
+    m_jit.loadPtr(JITCompiler::addressFor(operand), arrayGPR);
+    speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::NonZero, arrayGPR, GPRInfo::tagMaskRegister));
+    speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(arrayGPR), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
+    m_jit.loadPtr(MacroAssembler::Address(arrayGPR, JSArray::storageOffset()), lengthGPR);
+    m_jit.load32(MacroAssembler::Address(lengthGPR, OBJECT_OFFSETOF(ArrayStorage, m_length)), lengthGPR);
+    speculationCheck(OutOfBounds, m_jit.branch32(MacroAssembler::Above, lengthGPR, MacroAssembler::Address(arrayGPR, JSArray::vectorLengthOffset())));
+}
+
 // If we are making type predictions about our arguments then
 // we need to check that they are correct on function entry.
 void SpeculativeJIT::checkArgumentTypes()
 {
     ASSERT(!m_compileIndex);
-    m_bytecodeIndexForOSR = 0;
+    m_codeOriginForOSR = CodeOrigin(0);
     for (int i = 0; i < m_jit.codeBlock()->m_numParameters; ++i) {
         VirtualRegister virtualRegister = (VirtualRegister)(m_jit.codeBlock()->thisRegister() + i);
         PredictedType predictedType = m_jit.graph().getPrediction(virtualRegister);
         if (isInt32Prediction(predictedType))
-            speculationCheck(m_jit.branchPtr(MacroAssembler::Below, JITCompiler::addressFor(virtualRegister), GPRInfo::tagTypeNumberRegister));
+            speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::Below, JITCompiler::addressFor(virtualRegister), GPRInfo::tagTypeNumberRegister));
         else if (isArrayPrediction(predictedType)) {
             GPRTemporary temp(this);
             m_jit.loadPtr(JITCompiler::addressFor(virtualRegister), temp.gpr());
-            speculationCheck(m_jit.branchTestPtr(MacroAssembler::NonZero, temp.gpr(), GPRInfo::tagMaskRegister));
-            speculationCheck(m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(temp.gpr()), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
+            speculationCheck(BadType, m_jit.branchTestPtr(MacroAssembler::NonZero, temp.gpr(), GPRInfo::tagMaskRegister));
+            speculationCheck(BadType, m_jit.branchPtr(MacroAssembler::NotEqual, MacroAssembler::Address(temp.gpr()), MacroAssembler::TrustedImmPtr(m_jit.globalData()->jsArrayVPtr)));
         }
     }
 }
@@ -1661,6 +2003,8 @@ bool SpeculativeJIT::compile()
 
 ValueRecovery SpeculativeJIT::computeValueRecoveryFor(const ValueSource& valueSource)
 {
+    if (valueSource.isUnboxedDoubleInRegisterFile())
+        return ValueRecovery::alreadyInRegisterFileAsUnboxedDouble();
     if (!valueSource.isSet())
         return ValueRecovery::alreadyInRegisterFile();
 
@@ -98,19 +98,34 @@ class ValueSource {
 public:
     ValueSource()
         : m_nodeIndex(NoNode)
+        , m_isUnboxedDouble(false)
     {
     }
     
     explicit ValueSource(NodeIndex nodeIndex)
         : m_nodeIndex(nodeIndex)
+        , m_isUnboxedDouble(false)
     {
     }
     
+    // The value is in the variable's own slot in the register file, as a raw double.
+    static ValueSource unboxedDoubleInRegisterFile()
+    {
+        ValueSource result;
+        result.m_isUnboxedDouble = true;
+        return result;
+    }
+    
     bool isSet() const
     {
         return m_nodeIndex != NoNode;
     }
     
+    bool isUnboxedDoubleInRegisterFile() const
+    {
+        return m_isUnboxedDouble;
+    }
+    
     NodeIndex nodeIndex() const
     {
         ASSERT(isSet());
@@ -123,6 +138,7 @@ public:
     
 private:
     NodeIndex m_nodeIndex;
+    bool m_isUnboxedDouble;
 };
     
 // Describes how to recover a given bytecode virtual register at a given
@@ -130,6 +146,8 @@ private:
 enum ValueRecoveryTechnique {
     // It's already in the register file at the right location.
     AlreadyInRegisterFile,
+    // It's already in the register file at the right location, but needs boxing.
+    AlreadyInRegisterFileAsUnboxedDouble,
     // It's in a register.
     InGPR,
     UnboxedInt32InGPR,
@@ -156,6 +174,13 @@ public:
         return result;
     }
     
+    static ValueRecovery alreadyInRegisterFileAsUnboxedDouble()
+    {
+        ValueRecovery result;
+        result.m_technique = AlreadyInRegisterFileAsUnboxedDouble;
+        return result;
+    }
+    
     static ValueRecovery inGPR(GPRReg gpr, DataFormat dataFormat)
     {
         ASSERT(dataFormat != DataFormatNone);
@@ -238,11 +263,12 @@ private:
 // This structure describes how to exit the speculative path by
 // going into baseline code.
 struct OSRExit {
-    OSRExit(MacroAssembler::Jump, SpeculativeJIT*, unsigned recoveryIndex = 0);
+    OSRExit(ExitKind, MacroAssembler::Jump, SpeculativeJIT*, unsigned recoveryIndex = 0);
     
     MacroAssembler::Jump m_check;
     NodeIndex m_nodeIndex;
-    unsigned m_bytecodeIndex;
+    CodeOrigin m_codeOrigin;
+    ExitKind m_kind;
     
     unsigned m_recoveryIndex;
     
@@ -337,6 +363,7 @@ private:
     void compile(BasicBlock&);
 
     void checkArgumentTypes();
+    void checkArrayLengthWithinVector(VirtualRegister);
     void initializeVariableTypes();
 
     bool isInteger(NodeIndex nodeIndex)
@@ -424,7 +451,15 @@ private:
         if (m_jit.graph().getPrediction(node) & PredictDouble)
             return true;
         
-        return false;
+        switch (node.op) {
+        case ValueAdd:
+        case ArithAdd:
+        case ArithSub:
+        case ArithMul:
+            return arithmeticMayOverflow(node);
+        default:
+            return false;
+        }
     }
     
     bool shouldSpeculateInteger(NodeIndex op1, NodeIndex op2)
@@ -436,34 +471,52 @@ private:
     {
         return shouldSpeculateNumber(op1) && shouldSpeculateNumber(op2);
     }
+    
+    // Has integer arithmetic at this node made earlier optimized code for this
+    // function exit too often? If so, it falls back to doubles instead.
+    bool arithmeticMayOverflow(Node& node)
+    {
+        CodeBlock* profiledBlock = m_jit.codeBlock()->alternative();
+        if (m_jit.graph().hasFrequentExitSite(profiledBlock, node, Overflow))
+            return true;
+        
+        return node.op == ArithMul && m_jit.graph().hasFrequentExitSite(profiledBlock, node, NegativeZero);
+    }
 
     bool compare(Node&, MacroAssembler::RelationalCondition, MacroAssembler::DoubleCondition, Z_DFGOperation_EJJ);
+    void compileArithmeticWithDoubleFallback(Node&);
+    void compileGetByValOnByteArray(Node&);
+    void compilePutByValForByteArray(Node&);
     void compilePeepHoleIntegerBranch(Node&, NodeIndex branchNodeIndex, JITCompiler::RelationalCondition);
     void compilePeepHoleDoubleBranch(Node&, NodeIndex branchNodeIndex, JITCompiler::DoubleCondition, Z_DFGOperation_EJJ);
     
     JITCompiler::Jump convertToDouble(GPRReg value, FPRReg result, GPRReg tmp);
 
-    // Add a speculation check without additional recovery.
-    void speculationCheck(MacroAssembler::Jump jumpToFail)
+    // Add a speculation check without additional recovery. The kind of
+    // check tells a later compilation which speculation to avoid, should
+    // this one fail too often.
+    void speculationCheck(ExitKind kind, MacroAssembler::Jump jumpToFail)
     {
         if (!m_compileOkay)
             return;
 #if !ENABLE(DFG_OSR_EXIT)
+        UNUSED_PARAM(kind);
         m_speculationChecks.append(SpeculationCheck(jumpToFail, this));
 #else
-        m_osrExits.append(OSRExit(jumpToFail, this));
+        m_osrExits.append(OSRExit(kind, jumpToFail, this));
 #endif
     }
     // Add a speculation check with additional recovery.
-    void speculationCheck(MacroAssembler::Jump jumpToFail, const SpeculationRecovery& recovery)
+    void speculationCheck(ExitKind kind, MacroAssembler::Jump jumpToFail, const SpeculationRecovery& recovery)
     {
         if (!m_compileOkay)
             return;
         m_speculationRecoveryList.append(recovery);
 #if !ENABLE(DFG_OSR_EXIT)
+        UNUSED_PARAM(kind);
         m_speculationChecks.append(SpeculationCheck(jumpToFail, this, m_speculationRecoveryList.size()));
 #else
-        m_osrExits.append(OSRExit(jumpToFail, this, m_speculationRecoveryList.size()));
+        m_osrExits.append(OSRExit(kind, jumpToFail, this, m_speculationRecoveryList.size()));
 #endif
     }
 
@@ -476,7 +529,7 @@ private:
 #if ENABLE(DYNAMIC_TERMINATE_SPECULATION)
         if (!m_compileOkay)
             return;
-        speculationCheck(m_jit.jump());
+        speculationCheck(Uncountable, m_jit.jump());
         m_compileOkay = false;
 #else
         // Under static speculation, it's more profitable to give up entirely at this
@@ -518,6 +571,14 @@ private:
         valueSourceReferenceForOperand(operand) = ValueSource(nodeIndex);
     }
     
+    // The source of a variable whose value is in its own slot in the register file.
+    ValueSource registerFileValueSourceForOperand(int operand)
+    {
+        if (m_jit.graph().isUnboxedDoubleLocal(operand))
+            return ValueSource::unboxedDoubleInRegisterFile();
+        return ValueSource();
+    }
+    
     // Call this with care, since it both returns a reference into an array
     // and potentially resizes the array. So it would not be right to call this
     // twice and then perform operands on both references, since the one from
@@ -538,7 +599,7 @@ private:
     Vector<ValueSource, 0> m_arguments;
     Vector<ValueSource, 0> m_variables;
     int m_lastSetOperand;
-    uint32_t m_bytecodeIndexForOSR;
+    CodeOrigin m_codeOriginForOSR;
     
     ValueRecovery computeValueRecoveryFor(const ValueSource&);
 
@@ -807,9 +868,11 @@ inline SpeculativeJIT::SpeculativeJIT(JITCompiler& jit)
     : JITCodeGenerator(jit, true)
     , m_compileOkay(true)
     , m_arguments(jit.codeBlock()->m_numParameters)
-    , m_variables(jit.codeBlock()->m_numVars)
+    // Cover every variable that may be an unboxed double, so that all OSR exits
+    // know to box them.
+    , m_variables(std::max<unsigned>(jit.codeBlock()->m_numVars, jit.graph().m_firstInlinedRegister))
     , m_lastSetOperand(std::numeric_limits<int>::max())
-    , m_bytecodeIndexForOSR(std::numeric_limits<uint32_t>::max())
+    , m_codeOriginForOSR()
 {
 }
 
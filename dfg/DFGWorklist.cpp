@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "DFGWorklist.h"
+
+#if ENABLE(CONCURRENT_JIT)
+
+#include "Options.h"
+#include <wtf/CurrentTime.h>
+
+namespace JSC { namespace DFG {
+
+Worklist::Worklist()
+    : m_planBeingCompiled(0)
+    , m_threadShouldQuit(false)
+{
+    m_thread = createThread(threadStartFunc, this, "JavaScriptCore::DFGCompiler");
+    ASSERT(m_thread);
+}
+
+Worklist::~Worklist()
+{
+    {
+        MutexLocker locker(m_lock);
+        m_threadShouldQuit = true;
+        m_condition.broadcast();
+    }
+    waitForThreadCompletion(m_thread, 0);
+}
+
+bool Worklist::isFull()
+{
+    MutexLocker locker(m_lock);
+    return m_plans.size() >= Options::maximumCompilationQueueDepth;
+}
+
+void Worklist::didRejectCompilation()
+{
+    MutexLocker locker(m_lock);
+    m_statistics.rejectedCount++;
+}
+
+void Worklist::enqueue(PassRefPtr<Plan> passedPlan)
+{
+    RefPtr<Plan> plan = passedPlan;
+    plan->enqueueTime = monotonicallyIncreasingTime();
+
+    MutexLocker locker(m_lock);
+    ASSERT(!m_plans.contains(plan->baselineCodeBlock()));
+    m_plans.add(plan->baselineCodeBlock(), plan);
+    m_queue.append(plan.release());
+    m_condition.broadcast();
+}
+
+bool Worklist::isCompiling(CodeBlock* baselineCodeBlock)
+{
+    MutexLocker locker(m_lock);
+    return m_plans.contains(baselineCodeBlock);
+}
+
+void Worklist::completeAllReadyPlans()
+{
+    while (true) {
+        RefPtr<Plan> plan;
+        {
+            MutexLocker locker(m_lock);
+            if (m_readyPlans.isEmpty())
+                return;
+            plan = m_readyPlans.last().release();
+            m_readyPlans.removeLast();
+        }
+
+        // Installing the code reports its cost to the heap, which may collect;
+        // the plan stays in m_plans until then so that it is still visited.
+        plan->finalize();
+        double latency = monotonicallyIncreasingTime() - plan->enqueueTime;
+
+        MutexLocker locker(m_lock);
+        m_plans.remove(plan->baselineCodeBlock());
+        m_statistics.compilationCount++;
+        m_statistics.totalCompileTime += plan->compileTime;
+        m_statistics.longestCompileTime = std::max(m_statistics.longestCompileTime, plan->compileTime);
+        m_statistics.totalLatency += latency;
+        m_statistics.longestLatency = std::max(m_statistics.longestLatency, latency);
+    }
+}
+
+void Worklist::removeAllPlans()
+{
+    MutexLocker locker(m_lock);
+    while (m_planBeingCompiled)
+        m_condition.wait(m_lock);
+    m_statistics.discardedCount += m_plans.size();
+    m_queue.clear();
+    m_readyPlans.clear();
+    m_plans.clear();
+}
+
+void Worklist::visitChildren(SlotVisitor& visitor)
+{
+    MutexLocker locker(m_lock);
+    HashMap<CodeBlock*, RefPtr<Plan> >::iterator end = m_plans.end();
+    for (HashMap<CodeBlock*, RefPtr<Plan> >::iterator iter = m_plans.begin(); iter != end; ++iter)
+        iter->second->visitChildren(visitor);
+}
+
+CompilationStatistics Worklist::statistics()
+{
+    MutexLocker locker(m_lock);
+    return m_statistics;
+}
+
+void* Worklist::threadStartFunc(void* worklist)
+{
+    static_cast<Worklist*>(worklist)->threadMain();
+    return 0;
+}
+
+void Worklist::threadMain()
+{
+    while (true) {
+        RefPtr<Plan> plan;
+        {
+            MutexLocker locker(m_lock);
+            while (m_queue.isEmpty() && !m_threadShouldQuit)
+                m_condition.wait(m_lock);
+            if (m_threadShouldQuit)
+                return;
+            plan = m_queue.takeFirst();
+            m_planBeingCompiled = plan.get();
+        }
+
+        plan->compile();
+
+        {
+            // The plan is only ever released on the thread that runs JavaScript.
+            MutexLocker locker(m_lock);
+            m_readyPlans.append(plan.release());
+            m_planBeingCompiled = 0;
+            m_condition.broadcast();
+        }
+    }
+}
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(CONCURRENT_JIT)
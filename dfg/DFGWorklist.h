@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef DFGWorklist_h
+#define DFGWorklist_h
+
+#include <wtf/Platform.h>
+
+#if ENABLE(CONCURRENT_JIT)
+
+#include "DFGPlan.h"
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+class CodeBlock;
+class SlotVisitor;
+
+namespace DFG {
+
+// For telemetry. Times are in seconds. The latency of a compilation runs
+// from the moment it was queued to the moment its code was installed, so it
+// includes the time spent waiting for the compilation thread and for the
+// baseline code to come back and pick the result up.
+struct CompilationStatistics {
+    CompilationStatistics()
+        : compilationCount(0)
+        , discardedCount(0)
+        , rejectedCount(0)
+        , totalCompileTime(0)
+        , longestCompileTime(0)
+        , totalLatency(0)
+        , longestLatency(0)
+    {
+    }
+
+    unsigned compilationCount; // Installed.
+    unsigned discardedCount; // Dropped before they could be installed.
+    unsigned rejectedCount; // Turned away because the queue was full.
+    double totalCompileTime;
+    double longestCompileTime;
+    double totalLatency;
+    double longestLatency;
+};
+
+// The optimizing compilations waiting for, or done on, the DFG's compilation
+// thread. Everything but the thread itself runs on the thread that runs
+// JavaScript, which installs finished code only when the baseline code asks
+// for it, in the tier-up checks.
+class Worklist {
+    WTF_MAKE_NONCOPYABLE(Worklist);
+public:
+    Worklist();
+    ~Worklist();
+
+    // Past Options::maximumCompilationQueueDepth, a CodeBlock that is hot
+    // enough to optimize keeps running its baseline code and tries again
+    // after another warm-up.
+    bool isFull();
+    void didRejectCompilation();
+
+    void enqueue(PassRefPtr<Plan>);
+    bool isCompiling(CodeBlock* baselineCodeBlock);
+
+    void completeAllReadyPlans();
+
+    // Waits for the plan being compiled, if any. Plans inline the bytecode of
+    // other functions and embed the addresses of cells, so this must be
+    // called before either is discarded or moved.
+    void removeAllPlans();
+
+    void visitChildren(SlotVisitor&);
+
+    CompilationStatistics statistics();
+
+private:
+    static void* threadStartFunc(void* worklist);
+    void threadMain();
+
+    // Keyed by the baseline CodeBlock, holding every plan until it is installed
+    // or removed, so that the collector sees all of them.
+    HashMap<CodeBlock*, RefPtr<Plan> > m_plans;
+    Deque<RefPtr<Plan> > m_queue;
+    Vector<RefPtr<Plan> > m_readyPlans;
+    Plan* m_planBeingCompiled;
+    CompilationStatistics m_statistics;
+
+    ThreadIdentifier m_thread;
+    Mutex m_lock;
+    ThreadCondition m_condition;
+    bool m_threadShouldQuit;
+};
+
+} } // namespace JSC::DFG
+
+#endif // ENABLE(CONCURRENT_JIT)
+
+#endif // DFGWorklist_h
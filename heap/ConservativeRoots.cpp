@@ -26,6 +26,8 @@
 #include "config.h"
 #include "ConservativeRoots.h"
 
+#include "CopiedSpace.h"
+
 namespace JSC {
 
 inline bool isPointerAligned(void* p)
@@ -46,6 +48,9 @@ void ConservativeRoots::grow()
 
 inline void ConservativeRoots::add(void* p, TinyBloomFilter filter)
 {
+    if (m_copiedSpace)
+        m_copiedSpace->pinIfNecessary(p);
+
     MarkedBlock* candidate = MarkedBlock::blockFor(p);
     if (filter.ruleOut(reinterpret_cast<Bits>(candidate))) {
         ASSERT(!candidate || !m_blocks->set().contains(candidate));
@@ -58,12 +63,19 @@ inline void ConservativeRoots::add(void* p, TinyBloomFilter filter)
     if (!m_blocks->set().contains(candidate))
         return;
 
-    // The conservative set inverts the typical meaning of mark bits: We only
-    // visit marked pointers, and our visit clears the mark bit. This efficiently
-    // sifts out pointers to dead objects and duplicate pointers.
-    if (!candidate->testAndClearMarked(p))
+    if (m_filter == MarkedCells) {
+        // The conservative set inverts the typical meaning of mark bits: We only
+        // visit marked pointers, and our visit clears the mark bit. This efficiently
+        // sifts out pointers to dead objects and duplicate pointers.
+        if (!candidate->testAndClearMarked(p))
+            return;
+    } else if (candidate->isMarked(p) || !candidate->wasLiveWhenMarkingBegan(p))
         return;
 
+    // A pointer that may not be one cannot be updated, so nothing in its
+    // block may move.
+    candidate->pin();
+
     if (m_size == m_capacity)
         grow();
 
@@ -82,4 +94,25 @@ void ConservativeRoots::add(void* begin, void* end)
         add(*it, filter);
 }
 
+#if ENABLE(DFG_JIT)
+void ConservativeRoots::add(void* begin, void* end, DFGCodeBlocks& dfgCodeBlocks)
+{
+    if (dfgCodeBlocks.isEmpty()) {
+        add(begin, end);
+        return;
+    }
+
+    ASSERT(begin <= end);
+    ASSERT((static_cast<char*>(end) - static_cast<char*>(begin)) < 0x1000000);
+    ASSERT(isPointerAligned(begin));
+    ASSERT(isPointerAligned(end));
+
+    TinyBloomFilter filter = m_blocks->filter();
+    for (char** it = static_cast<char**>(begin); it != static_cast<char**>(end); ++it) {
+        dfgCodeBlocks.mark(*it);
+        add(*it, filter);
+    }
+}
+#endif
+
 } // namespace JSC
@@ -32,15 +32,28 @@
 
 namespace JSC {
 
+class CopiedSpace;
+class DFGCodeBlocks;
 class JSCell;
 class Heap;
 
 class ConservativeRoots {
 public:
-    ConservativeRoots(const MarkedBlockSet*);
+    // Incremental marking cannot tell live cells by their mark bits when it
+    // rescans the roots at the end, so that scan checks the marks that blocks
+    // recorded when marking began instead, and skips cells marked since.
+    enum Filter { MarkedCells, UnmarkedCellsLiveWhenMarkingBegan };
+
+    // Pointers into the copied space, if one is given, pin the blocks they
+    // point into.
+    ConservativeRoots(const MarkedBlockSet*, CopiedSpace*, Filter = MarkedCells);
     ~ConservativeRoots();
 
     void add(void* begin, void* end);
+#if ENABLE(DFG_JIT)
+    // Also marks the jettisoned optimized code that the span refers to.
+    void add(void* begin, void* end, DFGCodeBlocks&);
+#endif
     
     size_t size();
     JSCell** roots();
@@ -56,14 +69,18 @@ private:
     size_t m_size;
     size_t m_capacity;
     const MarkedBlockSet* m_blocks;
+    CopiedSpace* m_copiedSpace;
+    Filter m_filter;
     JSCell* m_inlineRoots[inlineCapacity];
 };
 
-inline ConservativeRoots::ConservativeRoots(const MarkedBlockSet* blocks)
+inline ConservativeRoots::ConservativeRoots(const MarkedBlockSet* blocks, CopiedSpace* copiedSpace, Filter filter)
     : m_roots(m_inlineRoots)
     , m_size(0)
     , m_capacity(inlineCapacity)
     , m_blocks(blocks)
+    , m_copiedSpace(copiedSpace)
+    , m_filter(filter)
 {
 }
 
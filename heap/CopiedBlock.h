@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CopiedBlock_h
+#define CopiedBlock_h
+
+#include <wtf/DoublyLinkedList.h>
+#include <wtf/PageAllocationAligned.h>
+
+namespace JSC {
+
+    // A copied block is an aligned chunk of backing stores, carved out by
+    // bumping a pointer. Nothing in it is ever freed on its own: a collection
+    // either copies the live stores out of the block and frees all of it, or
+    // keeps the block as it is.
+    class CopiedBlock : public DoublyLinkedListNode<CopiedBlock> {
+        friend class WTF::DoublyLinkedListNode<CopiedBlock>;
+    public:
+        static const size_t blockSize = 64 * 1024;
+        static const size_t blockMask = ~(blockSize - 1); // blockSize must be a power of two.
+        static const size_t alignment = 8;
+
+        static CopiedBlock* create();
+        static void destroy(CopiedBlock*);
+
+        static CopiedBlock* blockFor(const void*);
+
+        void* allocate(size_t);
+        void reset(); // Throws away everything allocated in the block.
+
+        size_t size(); // Bytes handed out.
+        size_t capacity() { return blockSize; }
+
+        // A block the stack may point into cannot be evacuated.
+        bool isPinned() { return m_isPinned; }
+        void pin() { m_isPinned = true; }
+
+        // Set when the block is allocated into and when a collection finds
+        // storage in it that is still in use; a block without it is garbage.
+        bool hasLiveStorage() { return m_hasLiveStorage; }
+        void setHasLiveStorage() { m_hasLiveStorage = true; }
+        void clearLiveness();
+
+    private:
+        CopiedBlock(const PageAllocationAligned&);
+
+        static size_t headerSize() { return (sizeof(CopiedBlock) + 15) & ~static_cast<size_t>(15); }
+        char* payload() { return reinterpret_cast<char*>(this) + headerSize(); }
+        char* payloadEnd() { return reinterpret_cast<char*>(this) + blockSize; }
+
+        PageAllocationAligned m_allocation;
+        char* m_offset;
+        bool m_isPinned;
+        bool m_hasLiveStorage;
+        CopiedBlock* m_prev;
+        CopiedBlock* m_next;
+    };
+
+    inline CopiedBlock* CopiedBlock::blockFor(const void* p)
+    {
+        return reinterpret_cast<CopiedBlock*>(reinterpret_cast<uintptr_t>(p) & blockMask);
+    }
+
+    inline void* CopiedBlock::allocate(size_t bytes)
+    {
+        bytes = (bytes + alignment - 1) & ~(alignment - 1);
+        if (static_cast<size_t>(payloadEnd() - m_offset) < bytes)
+            return 0;
+        void* result = m_offset;
+        m_offset += bytes;
+        return result;
+    }
+
+    inline void CopiedBlock::reset()
+    {
+        m_offset = payload();
+    }
+
+    inline size_t CopiedBlock::size()
+    {
+        return m_offset - payload();
+    }
+
+    inline void CopiedBlock::clearLiveness()
+    {
+        m_isPinned = false;
+        m_hasLiveStorage = false;
+    }
+
+} // namespace JSC
+
+#endif // CopiedBlock_h
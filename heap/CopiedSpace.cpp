@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "CopiedSpace.h"
+
+#include "Heap.h"
+#include <new>
+
+namespace JSC {
+
+CopiedBlock::CopiedBlock(const PageAllocationAligned& allocation)
+    : m_allocation(allocation)
+    , m_isPinned(false)
+    , m_hasLiveStorage(true)
+{
+    reset();
+}
+
+CopiedBlock* CopiedBlock::create()
+{
+    PageAllocationAligned allocation = PageAllocationAligned::allocate(blockSize, blockSize, OSAllocator::JSGCHeapPages);
+    if (!static_cast<bool>(allocation))
+        return 0;
+    return new (allocation.base()) CopiedBlock(allocation);
+}
+
+void CopiedBlock::destroy(CopiedBlock* block)
+{
+    PageAllocationAligned allocation = block->m_allocation;
+    block->~CopiedBlock();
+    allocation.deallocate();
+}
+
+CopiedSpace::CopiedSpace(Heap* heap)
+    : m_heap(heap)
+    , m_currentBlock(0)
+    , m_isCollecting(false)
+    , m_isEvacuating(false)
+    , m_collectionNumber(0)
+{
+}
+
+CopiedSpace::~CopiedSpace()
+{
+    freeAllBlocks();
+}
+
+void* CopiedSpace::tryAllocateSlowCase(size_t bytes)
+{
+    CopiedBlock* block = tryAllocateBlock();
+    if (!block)
+        return 0;
+    addBlock(block);
+    m_currentBlock = block;
+
+    // Storage brings the next collection closer just as cells do.
+    m_heap->markedSpace().addToWaterMark(CopiedBlock::blockSize);
+
+    return block->allocate(bytes);
+}
+
+CopiedBlock* CopiedSpace::tryAllocateBlock()
+{
+    if (m_freeBlocks.isEmpty())
+        return CopiedBlock::create();
+
+    CopiedBlock* block = m_freeBlocks.last();
+    m_freeBlocks.removeLast();
+    block->reset();
+    block->clearLiveness();
+    block->setHasLiveStorage();
+    return block;
+}
+
+void CopiedSpace::addBlock(CopiedBlock* block)
+{
+    m_blocks.append(block);
+    m_blockSet.add(block);
+    m_filter.add(reinterpret_cast<Bits>(block));
+}
+
+void CopiedSpace::freeBlock(CopiedBlock* block)
+{
+    if (m_freeBlocks.size() < maximumNumberOfFreeBlocks) {
+        m_freeBlocks.append(block);
+        return;
+    }
+    CopiedBlock::destroy(block);
+}
+
+size_t CopiedSpace::size()
+{
+    size_t result = 0;
+    for (CopiedBlock* block = m_blocks.head(); block; block = block->next())
+        result += block->size();
+    return result;
+}
+
+size_t CopiedSpace::capacity()
+{
+    return m_blocks.size() * CopiedBlock::blockSize;
+}
+
+void CopiedSpace::startCollecting(EvacuationToggle evacuationToggle)
+{
+    ASSERT(!m_isCollecting);
+    ASSERT(m_toSpace.isEmpty());
+
+    // Stores allocated from here on go into new blocks, which are kept.
+    m_currentBlock = 0;
+    for (CopiedBlock* block = m_blocks.head(); block; block = block->next())
+        block->clearLiveness();
+
+    m_isCollecting = true;
+    m_isEvacuating = evacuationToggle == DoEvacuate;
+    m_collectionNumber++;
+}
+
+void* CopiedSpace::tryCopy(CopyAllocator& allocator, void* storage, size_t bytes)
+{
+    ASSERT(m_isEvacuating);
+
+    void* newStorage = 0;
+    if (allocator.block && allocator.collectionNumber == m_collectionNumber)
+        newStorage = allocator.block->allocate(bytes);
+
+    if (!newStorage) {
+        CopiedBlock* block;
+        {
+            MutexLocker locker(m_toSpaceLock);
+            block = tryAllocateBlock();
+            if (!block)
+                return 0;
+            m_toSpace.append(block);
+        }
+        allocator.block = block;
+        allocator.collectionNumber = m_collectionNumber;
+        newStorage = block->allocate(bytes);
+        ASSERT(newStorage);
+    }
+
+    memcpy(newStorage, storage, bytes);
+    return newStorage;
+}
+
+void CopiedSpace::doneCollecting()
+{
+    ASSERT(m_isCollecting);
+
+    bool didFreeBlocks = false;
+    CopiedBlock* next;
+    for (CopiedBlock* block = m_blocks.head(); block; block = next) {
+        next = block->next();
+        if (block->isPinned() || block->hasLiveStorage())
+            continue;
+        m_blocks.remove(block);
+        m_blockSet.remove(block);
+        freeBlock(block);
+        didFreeBlocks = true;
+    }
+
+    if (didFreeBlocks) {
+        TinyBloomFilter filter;
+        HashSet<CopiedBlock*>::iterator end = m_blockSet.end();
+        for (HashSet<CopiedBlock*>::iterator it = m_blockSet.begin(); it != end; ++it)
+            filter.add(reinterpret_cast<Bits>(*it));
+        m_filter = filter;
+    }
+
+    // The mutator picks up where the copying left off.
+    for (size_t i = 0; i < m_toSpace.size(); ++i)
+        addBlock(m_toSpace[i]);
+    if (!m_toSpace.isEmpty())
+        m_currentBlock = m_toSpace.last();
+    m_toSpace.clear();
+
+    m_isCollecting = false;
+    m_isEvacuating = false;
+}
+
+void CopiedSpace::freeAllBlocks()
+{
+    ASSERT(!m_isCollecting);
+
+    while (CopiedBlock* block = m_blocks.removeHead())
+        CopiedBlock::destroy(block);
+    m_blockSet.clear();
+    m_filter = TinyBloomFilter();
+    m_currentBlock = 0;
+
+    releaseFreeBlocks();
+}
+
+void CopiedSpace::releaseFreeBlocks()
+{
+    for (size_t i = 0; i < m_freeBlocks.size(); ++i)
+        CopiedBlock::destroy(m_freeBlocks[i]);
+    m_freeBlocks.clear();
+}
+
+} // namespace JSC
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CopiedSpace_h
+#define CopiedSpace_h
+
+#include "CopiedBlock.h"
+#include "TinyBloomFilter.h"
+#include <wtf/DoublyLinkedList.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class Heap;
+
+    // Backing stores smaller than a page are bump allocated out of copied
+    // blocks. Their owners do not free them: a full collection keeps the
+    // stores that live cells still point to, and gives back the blocks that
+    // hold none. When the world is stopped for the whole collection, it also
+    // evacuates, copying each live store into a fresh block as its owner is
+    // visited, so that every block it started with can be freed. Blocks that
+    // conservative roots point into are pinned, and kept where they are.
+    class CopiedSpace {
+        WTF_MAKE_NONCOPYABLE(CopiedSpace);
+    public:
+        enum EvacuationToggle { DoNotEvacuate, DoEvacuate };
+
+        // Where one marking thread copies the stores it evacuates.
+        struct CopyAllocator {
+            CopyAllocator()
+                : block(0)
+                , collectionNumber(0)
+            {
+            }
+
+            CopiedBlock* block;
+            unsigned collectionNumber;
+        };
+
+        CopiedSpace(Heap*);
+        ~CopiedSpace();
+
+        void* tryAllocate(size_t);
+
+        bool contains(const void*);
+        size_t size();
+        size_t capacity();
+
+        void startCollecting(EvacuationToggle);
+        void pinIfNecessary(const void*);
+        // Called by marking threads for each store that a live cell points
+        // to. Returns where the store is now, which the cell must point to.
+        void* visitStorage(CopyAllocator&, void* storage, size_t);
+        void doneCollecting();
+
+        void freeAllBlocks();
+        void releaseFreeBlocks();
+
+    private:
+        static const size_t maximumNumberOfFreeBlocks = 16;
+
+        bool contains(CopiedBlock*);
+        void* tryAllocateSlowCase(size_t);
+        void* tryCopy(CopyAllocator&, void* storage, size_t);
+        CopiedBlock* tryAllocateBlock();
+        void addBlock(CopiedBlock*);
+        void freeBlock(CopiedBlock*);
+
+        Heap* m_heap;
+        CopiedBlock* m_currentBlock;
+        DoublyLinkedList<CopiedBlock> m_blocks;
+        Vector<CopiedBlock*> m_freeBlocks;
+
+        TinyBloomFilter m_filter;
+        HashSet<CopiedBlock*> m_blockSet;
+
+        bool m_isCollecting;
+        bool m_isEvacuating;
+        unsigned m_collectionNumber;
+
+        // Blocks copied into are kept apart until the collection is done, so
+        // that they are neither taken for blocks being evacuated nor looked
+        // up in the block set while other marking threads read it.
+        Mutex m_toSpaceLock;
+        Vector<CopiedBlock*> m_toSpace;
+    };
+
+    inline bool CopiedSpace::contains(CopiedBlock* block)
+    {
+        if (m_filter.ruleOut(reinterpret_cast<Bits>(block)))
+            return false;
+        return m_blockSet.contains(block);
+    }
+
+    inline bool CopiedSpace::contains(const void* p)
+    {
+        return contains(CopiedBlock::blockFor(p));
+    }
+
+    inline void* CopiedSpace::tryAllocate(size_t bytes)
+    {
+        if (m_currentBlock) {
+            if (void* result = m_currentBlock->allocate(bytes))
+                return result;
+        }
+        return tryAllocateSlowCase(bytes);
+    }
+
+    inline void CopiedSpace::pinIfNecessary(const void* p)
+    {
+        if (!m_isCollecting)
+            return;
+
+        // A pointer just past the end of a store is still a pointer into it.
+        CopiedBlock* block = CopiedBlock::blockFor(p);
+        if (contains(block))
+            block->pin();
+        block = CopiedBlock::blockFor(static_cast<const char*>(p) - 1);
+        if (contains(block))
+            block->pin();
+    }
+
+    inline void* CopiedSpace::visitStorage(CopyAllocator& allocator, void* storage, size_t bytes)
+    {
+        if (!m_isCollecting)
+            return storage;
+
+        CopiedBlock* block = CopiedBlock::blockFor(storage);
+        if (!contains(block))
+            return storage;
+        if (m_isEvacuating && !block->isPinned()) {
+            if (void* newStorage = tryCopy(allocator, storage, bytes))
+                return newStorage;
+        }
+        block->setHasLiveStorage();
+        return storage;
+    }
+
+} // namespace JSC
+
+#endif // CopiedSpace_h
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "DFGCodeBlocks.h"
+
+#if ENABLE(DFG_JIT)
+
+#include "CodeBlock.h"
+#include "SlotVisitor.h"
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+DFGCodeBlocks::DFGCodeBlocks()
+{
+}
+
+DFGCodeBlocks::~DFGCodeBlocks()
+{
+    HashSet<CodeBlock*>::iterator end = m_set.end();
+    for (HashSet<CodeBlock*>::iterator iter = m_set.begin(); iter != end; ++iter)
+        deleteCodeBlock(*iter);
+}
+
+void DFGCodeBlocks::jettison(PassOwnPtr<CodeBlock> codeBlockPtr)
+{
+    CodeBlock* codeBlock = codeBlockPtr.leakPtr();
+    ASSERT(codeBlock);
+    ASSERT(codeBlock->getJITType() == JITCode::DFGJIT);
+    m_set.add(codeBlock);
+}
+
+void DFGCodeBlocks::clearMarks()
+{
+    m_mayBeExecuting.clear();
+}
+
+void DFGCodeBlocks::traceMarkedCodeBlocks(SlotVisitor& visitor)
+{
+    HashSet<CodeBlock*>::iterator end = m_mayBeExecuting.end();
+    for (HashSet<CodeBlock*>::iterator iter = m_mayBeExecuting.begin(); iter != end; ++iter)
+        (*iter)->visitAggregate(visitor);
+}
+
+void DFGCodeBlocks::deleteUnmarkedJettisonedCodeBlocks()
+{
+    Vector<CodeBlock*, 16> toRemove;
+    
+    HashSet<CodeBlock*>::iterator end = m_set.end();
+    for (HashSet<CodeBlock*>::iterator iter = m_set.begin(); iter != end; ++iter) {
+        if (!m_mayBeExecuting.contains(*iter))
+            toRemove.append(*iter);
+    }
+    
+    for (size_t i = 0; i < toRemove.size(); ++i) {
+        m_set.remove(toRemove[i]);
+        deleteCodeBlock(toRemove[i]);
+    }
+}
+
+void DFGCodeBlocks::deleteCodeBlock(CodeBlock* codeBlock)
+{
+    // The baseline code belongs to the executable again.
+    codeBlock->releaseAlternative().leakPtr();
+    delete codeBlock;
+}
+
+} // namespace JSC
+
+#endif // ENABLE(DFG_JIT)
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef DFGCodeBlocks_h
+#define DFGCodeBlocks_h
+
+#include <wtf/Platform.h>
+
+#if ENABLE(DFG_JIT)
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassOwnPtr.h>
+
+namespace JSC {
+
+class CodeBlock;
+class SlotVisitor;
+
+// Optimized code that has been thrown away, but that call frames in the
+// register file may still be running. A collection finds the frames that
+// refer to it, keeps the code that they run alive, and deletes the rest.
+class DFGCodeBlocks {
+    WTF_MAKE_FAST_ALLOCATED;
+    WTF_MAKE_NONCOPYABLE(DFGCodeBlocks);
+
+public:
+    DFGCodeBlocks();
+    ~DFGCodeBlocks();
+    
+    void jettison(PassOwnPtr<CodeBlock>);
+    
+    bool isEmpty() const { return m_set.isEmpty(); }
+    
+    // Called by the collector: clearMarks() before scanning the register file
+    // for candidate pointers, which mark() checks, then traceMarkedCodeBlocks()
+    // and deleteUnmarkedJettisonedCodeBlocks() once marking is done.
+    void clearMarks();
+    void mark(void* candidatePointer)
+    {
+        CodeBlock* candidateCodeBlock = static_cast<CodeBlock*>(candidatePointer);
+        // Any word of the register file may turn up here, including the hash
+        // table's own empty and deleted values.
+        if (!candidateCodeBlock || HashTraits<CodeBlock*>::isDeletedValue(candidateCodeBlock))
+            return;
+        if (m_set.contains(candidateCodeBlock))
+            m_mayBeExecuting.add(candidateCodeBlock);
+    }
+    void traceMarkedCodeBlocks(SlotVisitor&);
+    void deleteUnmarkedJettisonedCodeBlocks();
+    
+private:
+    void deleteCodeBlock(CodeBlock*);
+    
+    HashSet<CodeBlock*> m_set;
+    HashSet<CodeBlock*> m_mayBeExecuting;
+};
+
+} // namespace JSC
+
+#endif // ENABLE(DFG_JIT)
+
+#endif // DFGCodeBlocks_h
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef GCStatistics_h
+#define GCStatistics_h
+
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    // What one collection cost and what it found, for telemetry. Times are
+    // in seconds. Sizes are of the cells in the marked space, not of the
+    // backing stores they own.
+    struct GCStatistics {
+        // Marking the roots includes marking everything they reach.
+        // Sweeping is lazy, so all it does up front is reset the allocator,
+        // and shrinking gives back the blocks that are now empty.
+        enum Phase {
+            GatherConservativeRootsPhase,
+            MarkRootsPhase,
+            HarvestWeakReferencesPhase,
+            VisitWeakHandlesPhase,
+            FinalizeWeakHandlesPhase,
+            CompactPhase,
+            SweepPhase,
+            ShrinkPhase,
+            NumberOfPhases
+        };
+
+        struct SizeClass {
+            size_t cellSize;
+            size_t bytesAllocated; // Since the previous collection.
+            size_t bytesSurvived;
+        };
+
+        GCStatistics();
+
+        static const char* phaseName(Phase);
+
+        // Of the cells the collection looked at. An eden collection treats
+        // the old generation as live.
+        double survivorRatio() const { return sizeBefore ? static_cast<double>(sizeAfter) / sizeBefore : 1; }
+
+        unsigned collectionNumber; // Counting from 1.
+        bool isFullCollection;
+
+        // The pause that finished the collection. Marking that began
+        // incrementally took pauses of its own beforehand, one slice at a
+        // time.
+        double pauseTime;
+        double phaseTimes[NumberOfPhases];
+        unsigned incrementalMarkingSliceCount;
+        double incrementalMarkingTime;
+        double longestIncrementalMarkingSlice;
+
+        // Cells allocated while marking incrementally are not counted.
+        size_t bytesAllocated;
+        size_t extraMemoryCost;
+        size_t sizeBefore;
+        size_t sizeAfter;
+        Vector<SizeClass> sizeClasses;
+
+        // Over the life of the heap, counting incremental marking slices.
+        double totalPauseTime;
+        double longestPause;
+    };
+
+    // Told about each collection as it ends, while the heap is still busy,
+    // so it must not allocate or run JavaScript.
+    class GCStatisticsObserver {
+    public:
+        virtual ~GCStatisticsObserver() { }
+        virtual void didCollect(const GCStatistics&) = 0;
+    };
+
+    inline GCStatistics::GCStatistics()
+        : collectionNumber(0)
+        , isFullCollection(false)
+        , pauseTime(0)
+        , incrementalMarkingSliceCount(0)
+        , incrementalMarkingTime(0)
+        , longestIncrementalMarkingSlice(0)
+        , bytesAllocated(0)
+        , extraMemoryCost(0)
+        , sizeBefore(0)
+        , sizeAfter(0)
+        , totalPauseTime(0)
+        , longestPause(0)
+    {
+        for (size_t i = 0; i < NumberOfPhases; ++i)
+            phaseTimes[i] = 0;
+    }
+
+    inline const char* GCStatistics::phaseName(Phase phase)
+    {
+        switch (phase) {
+        case GatherConservativeRootsPhase:
+            return "gatherConservativeRoots";
+        case MarkRootsPhase:
+            return "markRoots";
+        case HarvestWeakReferencesPhase:
+            return "harvestWeakReferences";
+        case VisitWeakHandlesPhase:
+            return "visitWeakHandles";
+        case FinalizeWeakHandlesPhase:
+            return "finalizeWeakHandles";
+        case CompactPhase:
+            return "compact";
+        case SweepPhase:
+            return "sweep";
+        case ShrinkPhase:
+            return "shrink";
+        case NumberOfPhases:
+            break;
+        }
+        ASSERT_NOT_REACHED();
+        return 0;
+    }
+
+} // namespace JSC
+
+#endif // GCStatistics_h
@@ -98,6 +98,39 @@ void HandleHeap::visitWeakHandles(HeapRootVisitor& heapRootVisitor)
     }
 }
 
+// An eden collection does not revisit old objects, so the set of opaque roots
+// it gathers is incomplete. Rather than finalize a handle that an old object
+// may still be reaching through an opaque root, keep every owned handle alive
+// until the next full collection can decide.
+void HandleHeap::visitOwnedWeakHandles(HeapRootVisitor& heapRootVisitor)
+{
+    Node* end = m_weakList.end();
+    for (Node* node = m_weakList.begin(); node != end; node = node->next()) {
+#if ENABLE(GC_VALIDATION)
+        if (!isValidWeakNode(node))
+            CRASH();
+#endif
+        JSCell* cell = node->slot()->asCell();
+        if (Heap::isMarked(cell))
+            continue;
+
+        if (!node->weakOwner())
+            continue;
+
+        heapRootVisitor.visit(node->slot());
+    }
+}
+
+// Visits the weak handles that are left once finalization has cleared those
+// to dead cells, so that a compacting collection can update them.
+void HandleHeap::visitSurvivingWeakHandles(HeapRootVisitor& heapRootVisitor)
+{
+    ASSERT(!m_nextToFinalize);
+    Node* end = m_weakList.end();
+    for (Node* node = m_weakList.begin(); node != end; node = node->next())
+        heapRootVisitor.visit(node->slot());
+}
+
 void HandleHeap::finalizeWeakHandles()
 {
     Node* end = m_weakList.end();
@@ -63,6 +63,8 @@ public:
 
     void visitStrongHandles(HeapRootVisitor&);
     void visitWeakHandles(HeapRootVisitor&);
+    void visitOwnedWeakHandles(HeapRootVisitor&);
+    void visitSurvivingWeakHandles(HeapRootVisitor&);
     void finalizeWeakHandles();
 
     void writeBarrier(HandleSlot, const JSValue&);
@@ -24,8 +24,10 @@
 
 #include "CodeBlock.h"
 #include "ConservativeRoots.h"
+#include "DFGWorklist.h"
 #include "GCActivityCallback.h"
 #include "HeapRootVisitor.h"
+#include "HeapSnapshot.h"
 #include "Interpreter.h"
 #include "JSGlobalData.h"
 #include "JSGlobalObject.h"
@@ -33,6 +35,7 @@
 #include "JSONObject.h"
 #include "Tracing.h"
 #include <algorithm>
+#include <wtf/CurrentTime.h>
 
 //+EAWebKitChange
 //10/24/2011
@@ -42,6 +45,8 @@
 //-EAWebKitChange
 
 #define COLLECT_ON_EVERY_ALLOCATION 0
+#define GC_LOGGING 0
+#define VERIFY_MARKING 0
 
 using namespace std;
 using namespace JSC;
@@ -50,6 +55,76 @@ namespace JSC {
 
 namespace { 
 
+#if GC_LOGGING
+// Accumulates the time spent in one phase of collection over the lifetime of
+// the process, and reports it on exit.
+struct GCTimer {
+    GCTimer(const char* name)
+        : m_time(0)
+        , m_min(100000000)
+        , m_max(0)
+        , m_count(0)
+        , m_name(name)
+    {
+    }
+    ~GCTimer()
+    {
+        fprintf(stderr, "%s: %.2lfms (avg. %.2lf, min. %.2lf, max. %.2lf, markers %u)\n", m_name, m_time * 1000, m_time * 1000 / m_count, m_min * 1000, m_max * 1000, Options::numberOfGCMarkers);
+    }
+    double m_time;
+    double m_min;
+    double m_max;
+    size_t m_count;
+    const char* m_name;
+};
+
+struct GCTimerScope {
+    GCTimerScope(GCTimer* timer)
+        : m_timer(timer)
+        , m_start(WTF::currentTime())
+    {
+    }
+    ~GCTimerScope()
+    {
+        double delta = WTF::currentTime() - m_start;
+        if (delta < m_timer->m_min)
+            m_timer->m_min = delta;
+        if (delta > m_timer->m_max)
+            m_timer->m_max = delta;
+        m_timer->m_count++;
+        m_timer->m_time += delta;
+    }
+    GCTimer* m_timer;
+    double m_start;
+};
+
+#define GCPHASE(name) static GCTimer name##Timer(#name); GCTimerScope name##TimerScope(&name##Timer)
+#else
+#define GCPHASE(name) do { } while (false)
+#endif
+
+// Unlike GCTimer, which is for debugging, this times the phases of each
+// collection for Heap::lastCollectionStatistics().
+class GCStatisticsPhaseScope {
+public:
+    GCStatisticsPhaseScope(GCStatistics& statistics, GCStatistics::Phase phase)
+        : m_statistics(statistics)
+        , m_phase(phase)
+        , m_start(monotonicallyIncreasingTime())
+    {
+    }
+
+    ~GCStatisticsPhaseScope()
+    {
+        m_statistics.phaseTimes[m_phase] += monotonicallyIncreasingTime() - m_start;
+    }
+
+private:
+    GCStatistics& m_statistics;
+    GCStatistics::Phase m_phase;
+    double m_start;
+};
+
 static const size_t largeHeapSize = 16 * 1024 * 1024;
 static const size_t smallHeapSize = 512 * 1024;
 
@@ -139,15 +214,125 @@ inline void ClearMarks::operator()(MarkedBlock* block)
     block->notifyMayHaveFreshFreeCells();
 }
 
-struct Sweep : MarkedBlock::VoidFunctor {
+struct ClearYoungMarks : MarkedBlock::VoidFunctor {
+    void operator()(MarkedBlock*);
+};
+
+inline void ClearYoungMarks::operator()(MarkedBlock* block)
+{
+    block->clearYoungMarks();
+    block->notifyMayHaveFreshFreeCells();
+}
+
+struct ClearCards : MarkedBlock::VoidFunctor {
+    void operator()(MarkedBlock*);
+};
+
+inline void ClearCards::operator()(MarkedBlock* block)
+{
+    block->clearCards();
+}
+
+struct SnapshotMarks : MarkedBlock::VoidFunctor {
+    void operator()(MarkedBlock*);
+};
+
+inline void SnapshotMarks::operator()(MarkedBlock* block)
+{
+    block->snapshotMarks();
+}
+
+struct AgeMarkedCells : MarkedBlock::VoidFunctor {
+    void operator()(MarkedBlock*);
+};
+
+inline void AgeMarkedCells::operator()(MarkedBlock* block)
+{
+    block->ageMarkedCells();
+    block->clearCards();
+}
+
+class VisitRememberedCells : public MarkedBlock::VoidFunctor {
+public:
+    VisitRememberedCells(SlotVisitor&);
+    void operator()(MarkedBlock*);
+    void operator()(JSCell*);
+
+private:
+    SlotVisitor& m_visitor;
+};
+
+inline VisitRememberedCells::VisitRememberedCells(SlotVisitor& visitor)
+    : m_visitor(visitor)
+{
+}
+
+inline void VisitRememberedCells::operator()(MarkedBlock* block)
+{
+    block->forEachRememberedCell(*this);
+}
+
+inline void VisitRememberedCells::operator()(JSCell* cell)
+{
+    m_visitor.appendRememberedCell(cell);
+}
+
+class RevisitCells : public MarkedBlock::VoidFunctor {
+public:
+    RevisitCells(SlotVisitor&);
     void operator()(MarkedBlock*);
+    void operator()(JSCell*);
+
+private:
+    SlotVisitor& m_visitor;
 };
 
-inline void Sweep::operator()(MarkedBlock* block)
+inline RevisitCells::RevisitCells(SlotVisitor& visitor)
+    : m_visitor(visitor)
+{
+}
+
+inline void RevisitCells::operator()(MarkedBlock* block)
+{
+    block->forEachMarkedCellOnDirtyCard(*this);
+}
+
+inline void RevisitCells::operator()(JSCell* cell)
 {
-    block->sweep();
+    m_visitor.appendRememberedCell(cell);
 }
 
+#if VERIFY_MARKING
+class RecordLiveCells : public MarkedBlock::VoidFunctor {
+public:
+    void operator()(JSCell* cell) { m_cells.add(cell); }
+    HashSet<JSCell*>& cells() { return m_cells; }
+
+private:
+    HashSet<JSCell*> m_cells;
+};
+
+class CheckCellIsIn : public MarkedBlock::VoidFunctor {
+public:
+    CheckCellIsIn(HashSet<JSCell*>& cells)
+        : m_cells(cells)
+    {
+    }
+
+    void operator()(JSCell* cell)
+    {
+        if (m_cells.contains(cell))
+            return;
+        const ClassInfo* info = cell->classInfo();
+        fprintf(stderr, "Collection missed live cell %p (%s)\n", cell, info && info->className ? info->className : "[unknown]");
+        CRASH();
+    }
+
+private:
+    HashSet<JSCell*>& m_cells;
+};
+#endif
+
 struct MarkCount : CountFunctor {
     void operator()(MarkedBlock*);
 };
@@ -229,6 +414,256 @@ inline TakeIfEmpty::ReturnType TakeIfEmpty::returnValue()
     return m_empties.head();
 }
 
+struct Unpin : MarkedBlock::VoidFunctor {
+    void operator()(MarkedBlock*);
+};
+
+inline void Unpin::operator()(MarkedBlock* block)
+{
+    block->unpin();
+}
+
+class PinPrototypes : public MarkedBlock::VoidFunctor {
+public:
+    PinPrototypes(JSGlobalData*);
+    void operator()(JSCell*);
+
+private:
+    Structure* m_structureStructure;
+};
+
+inline PinPrototypes::PinPrototypes(JSGlobalData* globalData)
+    : m_structureStructure(globalData->structureStructure.get())
+{
+}
+
+inline void PinPrototypes::operator()(JSCell* cell)
+{
+    // The stubs that guard a structure may have its prototype built in.
+    if (cell->structure() != m_structureStructure)
+        return;
+    JSValue prototype = static_cast<Structure*>(cell)->storedPrototype();
+    if (prototype.isCell())
+        Heap::pin(prototype.asCell());
+}
+
+class HasOnlyMovableCells {
+public:
+    typedef bool ReturnType;
+
+    HasOnlyMovableCells();
+    void operator()(JSCell*);
+    ReturnType returnValue();
+
+private:
+    bool m_hasOnlyMovableCells;
+};
+
+inline HasOnlyMovableCells::HasOnlyMovableCells()
+    : m_hasOnlyMovableCells(true)
+{
+}
+
+inline void HasOnlyMovableCells::operator()(JSCell* cell)
+{
+    // Final objects point into themselves only through their property
+    // storage, and nothing outside of them points into them.
+    if (cell->vptr() != JSGlobalData::jsFinalObjectVPtr)
+        m_hasOnlyMovableCells = false;
+}
+
+inline HasOnlyMovableCells::ReturnType HasOnlyMovableCells::returnValue()
+{
+    return m_hasOnlyMovableCells;
+}
+
+class MoveCell : public MarkedBlock::VoidFunctor {
+public:
+    MoveCell(NewSpace&, NewSpace::SizeClass&);
+    void operator()(JSCell*);
+
+private:
+    NewSpace& m_newSpace;
+    NewSpace::SizeClass& m_sizeClass;
+};
+
+inline MoveCell::MoveCell(NewSpace& newSpace, NewSpace::SizeClass& sizeClass)
+    : m_newSpace(newSpace)
+    , m_sizeClass(sizeClass)
+{
+}
+
+inline void MoveCell::operator()(JSCell* cell)
+{
+    void* destination = m_newSpace.allocate(m_sizeClass);
+    ASSERT(destination); // The blocks to evacuate were chosen so that their cells fit.
+    memcpy(destination, cell, m_sizeClass.cellSize);
+    JSObject* object = static_cast<JSObject*>(destination);
+    object->didMoveFrom(asObject(cell));
+    MarkedBlock::blockFor(cell)->didMoveCell(cell, object);
+}
+
+static bool isSparserThan(MarkedBlock* a, MarkedBlock* b)
+{
+    return a->markCount() < b->markCount();
+}
+
+class EvacuateSparseBlocks {
+public:
+    EvacuateSparseBlocks(NewSpace&, DoublyLinkedList<MarkedBlock>& evacuatedBlocks);
+    void operator()(NewSpace::SizeClass&);
+
+private:
+    NewSpace& m_newSpace;
+    DoublyLinkedList<MarkedBlock>& m_evacuatedBlocks;
+};
+
+inline EvacuateSparseBlocks::EvacuateSparseBlocks(NewSpace& newSpace, DoublyLinkedList<MarkedBlock>& evacuatedBlocks)
+    : m_newSpace(newSpace)
+    , m_evacuatedBlocks(evacuatedBlocks)
+{
+}
+
+inline void EvacuateSparseBlocks::operator()(NewSpace::SizeClass& sizeClass)
+{
+    Vector<MarkedBlock*> candidates;
+    size_t freeCellCount = 0;
+    for (MarkedBlock* block = sizeClass.blockList.head(); block; block = block->next()) {
+        size_t cellCount = block->numberOfCells();
+        size_t liveCellCount = block->markCount();
+        freeCellCount += cellCount - liveCellCount;
+
+        if (!liveCellCount || block->isPinned())
+            continue;
+        if (liveCellCount >= Options::compactionOccupancyThreshold * cellCount)
+            continue;
+        HasOnlyMovableCells hasOnlyMovableCells;
+        block->forEachCell(hasOnlyMovableCells);
+        if (!hasOnlyMovableCells.returnValue())
+            continue;
+        candidates.append(block);
+    }
+
+    // Evacuate the sparsest blocks first, for as long as the blocks that stay
+    // have room for their cells.
+    std::sort(candidates.begin(), candidates.end(), isSparserThan);
+    size_t movedCellCount = 0;
+    size_t evacuatedBlockCount = 0;
+    for (; evacuatedBlockCount < candidates.size(); ++evacuatedBlockCount) {
+        MarkedBlock* block = candidates[evacuatedBlockCount];
+        size_t liveCellCount = block->markCount();
+        size_t blockFreeCellCount = block->numberOfCells() - liveCellCount;
+        if (movedCellCount + liveCellCount > freeCellCount - blockFreeCellCount)
+            break;
+        movedCellCount += liveCellCount;
+        freeCellCount -= blockFreeCellCount;
+    }
+    if (!evacuatedBlockCount)
+        return;
+
+    for (size_t i = 0; i < evacuatedBlockCount; ++i)
+        m_newSpace.removeBlock(candidates[i]);
+
+    // Allocate the copies the way the mutator would, out of the blocks that stay.
+    sizeClass.resetAllocator();
+    MoveCell moveCell(m_newSpace, sizeClass);
+    for (size_t i = 0; i < evacuatedBlockCount; ++i) {
+        candidates[i]->forEachCell(moveCell);
+        m_evacuatedBlocks.append(candidates[i]);
+    }
+    sizeClass.canonicalizeBlock();
+}
+
+// Every live cell is marked by the time references are updated, and a moved
+// cell is left unmarked, so an unmarked cell in a slot must be a MovedCell.
+class UpdateReferencesToMovedCells : public SlotObserver {
+public:
+    virtual void observeSlot(JSValue*);
+    virtual void observeSlot(JSCell**);
+};
+
+void UpdateReferencesToMovedCells::observeSlot(JSValue* slot)
+{
+    JSValue value = *slot;
+    if (!value || !value.isCell())
+        return;
+    JSCell* cell = value.asCell();
+    if (Heap::isMarked(cell))
+        return;
+    ASSERT(!cell->vptr());
+    *slot = reinterpret_cast<MarkedBlock::MovedCell*>(cell)->destination;
+}
+
+void UpdateReferencesToMovedCells::observeSlot(JSCell** slot)
+{
+    JSCell* cell = *slot;
+    if (!cell || Heap::isMarked(cell))
+        return;
+    ASSERT(!cell->vptr());
+    *slot = reinterpret_cast<MarkedBlock::MovedCell*>(cell)->destination;
+}
+
+class Revisit : public MarkedBlock::VoidFunctor {
+public:
+    Revisit(SlotVisitor&);
+    void operator()(JSCell*);
+
+private:
+    SlotVisitor& m_visitor;
+};
+
+inline Revisit::Revisit(SlotVisitor& visitor)
+    : m_visitor(visitor)
+{
+}
+
+inline void Revisit::operator()(JSCell* cell)
+{
+    m_visitor.revisit(cell);
+}
+
+class AddBlockToSnapshot : public MarkedBlock::VoidFunctor {
+public:
+    AddBlockToSnapshot(HeapSnapshotWriter&);
+    void operator()(MarkedBlock*);
+
+private:
+    HeapSnapshotWriter& m_writer;
+};
+
+inline AddBlockToSnapshot::AddBlockToSnapshot(HeapSnapshotWriter& writer)
+    : m_writer(writer)
+{
+}
+
+inline void AddBlockToSnapshot::operator()(MarkedBlock* block)
+{
+    m_writer.addBlock(block);
+}
+
+class AddCellToSnapshot : public MarkedBlock::VoidFunctor {
+public:
+    AddCellToSnapshot(HeapSnapshotWriter&, SlotVisitor&);
+    void operator()(JSCell*);
+
+private:
+    HeapSnapshotWriter& m_writer;
+    SlotVisitor& m_visitor;
+};
+
+inline AddCellToSnapshot::AddCellToSnapshot(HeapSnapshotWriter& writer, SlotVisitor& visitor)
+    : m_writer(writer)
+    , m_visitor(visitor)
+{
+}
+
+inline void AddCellToSnapshot::operator()(JSCell* cell)
+{
+    m_writer.beginCell(cell);
+    m_visitor.revisit(cell);
+    m_writer.endCell();
+}
+
 class RecordType {
 public:
     typedef PassOwnPtr<TypeCountSet> ReturnType;
@@ -272,11 +707,29 @@ Heap::Heap(JSGlobalData* globalData, HeapSize heapSize)
     , m_minBytesPerCycle(heapSizeForHint(heapSize))
     , m_operationInProgress(NoOperation)
     , m_newSpace(this)
+    , m_copiedSpace(this)
     , m_extraCost(0)
+    , m_sizeAfterLastCollection(0)
+    , m_sizeAfterLastFullCollection(0)
+#if ENABLE(INCREMENTAL_MARKING)
+    , m_isMarkingIncrementally(false)
+    , m_incrementalCollectionType(FullCollection)
+#endif
+#if ENABLE(CONCURRENT_SWEEPING)
+    , m_blockBeingSwept(0)
+    , m_isSweepingInBackground(false)
+    , m_sweeperThreadShouldQuit(false)
+#endif
+    , m_blocksSweptOnAllocation(0)
+    , m_blocksSweptInBackground(0)
+#if ENABLE(JSC_MULTIPLE_THREADS)
+    , m_allocatingThread(currentThread())
+#endif
     , m_markListSet(0)
     , m_activityCallback(DefaultGCActivityCallback::create(this))
     , m_machineThreads(this)
-    , m_slotVisitor(globalData->jsArrayVPtr)
+    , m_sharedData(globalData)
+    , m_slotVisitor(m_sharedData)
     , m_handleHeap(globalData)
     , m_isSafeToCollect(false)
     , m_globalData(globalData)
@@ -288,6 +741,10 @@ Heap::Heap(JSGlobalData* globalData, HeapSize heapSize)
     m_blockFreeingThread = createThread(blockFreeingThreadStartFunc, this, "JavaScriptCore::BlockFree");
     ASSERT(m_blockFreeingThread);
 #endif
+#if ENABLE(CONCURRENT_SWEEPING)
+    m_sweeperThread = createThread(sweeperThreadStartFunc, this, "JavaScriptCore::Sweeper");
+    ASSERT(m_sweeperThread);
+#endif
 }
 
 Heap::~Heap()
@@ -301,6 +758,14 @@ Heap::~Heap()
     }
     waitForThreadCompletion(m_blockFreeingThread, 0);
 #endif
+#if ENABLE(CONCURRENT_SWEEPING)
+    {
+        MutexLocker locker(m_sweeperLock);
+        m_sweeperThreadShouldQuit = true;
+        m_sweeperCondition.broadcast();
+    }
+    waitForThreadCompletion(m_sweeperThread, 0);
+#endif
     
     // The destroy function must already have been called, so assert this.
     ASSERT(!m_globalData);
@@ -320,24 +785,49 @@ void Heap::destroy()
     // (and thus the global data) before other objects that may use the global data.
     RefPtr<JSGlobalData> protect(m_globalData);
 
+#if ENABLE(INCREMENTAL_MARKING)
+    if (m_isMarkingIncrementally)
+        collect(DoNotSweep);
+#endif
+#if ENABLE(CONCURRENT_SWEEPING)
+    stopSweepingInBackground();
+#endif
+#if ENABLE(CONCURRENT_JIT)
+    m_globalData->dfgWorklist.clear();
+#endif
+
 #if ENABLE(JIT)
     m_globalData->jitStubs->clearHostFunctionStubs();
 #endif
+#if ENABLE(DFG_JIT)
+    // Jettisoned code must go before the code it calls, which sweeping deletes.
+    m_dfgCodeBlocks.clearMarks();
+    m_dfgCodeBlocks.deleteUnmarkedJettisonedCodeBlocks();
+#endif
 
     delete m_markListSet;
     m_markListSet = 0;
 
+#if ENABLE(JSC_MULTIPLE_THREADS)
+    deleteAllValues(m_allocationCaches);
+    m_allocationCaches.clear();
+#endif
+
     clearMarks();
     m_handleHeap.finalizeWeakHandles();
     m_globalData->smallStrings.finalizeSmallStrings();
 
     shrink();
+    m_copiedSpace.freeAllBlocks();
     ASSERT(!size());
     
 #if ENABLE(SIMPLE_HEAP_PROFILING)
     m_slotVisitor.m_visitedTypeCounts.dump(stderr, "Visited Type Counts");
     m_destroyedTypeCounts.dump(stderr, "Destroyed Type Counts");
 #endif
+#if GC_LOGGING
+    fprintf(stderr, "Blocks swept: %lu on allocation, %lu in background\n", static_cast<unsigned long>(m_blocksSweptOnAllocation), static_cast<unsigned long>(m_blocksSweptInBackground));
+#endif
     
 #if ENABLE(LAZY_BLOCK_FREEING)
     releaseFreeBlocks();
@@ -410,35 +900,167 @@ void Heap::blockFreeingThreadMain()
 }
 #endif // ENABLE(LAZY_BLOCK_FREEING)
 
-void Heap::reportExtraMemoryCostSlowCase(size_t cost)
+#if ENABLE(CONCURRENT_SWEEPING)
+void Heap::startSweepingInBackground()
 {
-    // Our frequency of garbage collection tries to balance memory use against speed
-    // by collecting based on the number of newly created values. However, for values
-    // that hold on to a great deal of memory that's not in the form of other JS values,
-    // that is not good enough - in some cases a lot of those objects can pile up and
-    // use crazy amounts of memory without a GC happening. So we track these extra
-    // memory costs. Only unusually large objects are noted, and we only keep track
-    // of this extra cost until the next GC. In garbage collected languages, most values
-    // are either very short lived temporaries, or have extremely long lifetimes. So
-    // if a large value survives one garbage collection, there is not much point to
-    // collecting more frequently as long as it stays alive.
-
-    if (m_extraCost > maxExtraCost && m_extraCost > m_newSpace.highWaterMark() / 2)
-        collectAllGarbage();
-    m_extraCost += cost;
+    ASSERT(!m_isSweepingInBackground);
+
+    MutexLocker locker(m_sweeperLock);
+    ASSERT(m_blocksToSweep.isEmpty());
+    BlockIterator end = m_blocks.set().end();
+    for (BlockIterator it = m_blocks.set().begin(); it != end; ++it) {
+        if ((*it)->needsSweep())
+            m_blocksToSweep.add(*it);
+    }
+    m_isSweepingInBackground = true;
+    m_sweeperCondition.broadcast();
 }
 
-inline void* Heap::tryAllocate(NewSpace::SizeClass& sizeClass)
+void Heap::stopSweepingInBackground()
 {
-    m_operationInProgress = Allocation;
-    void* result = m_newSpace.allocate(sizeClass);
-    m_operationInProgress = NoOperation;
-    return result;
+    if (!m_isSweepingInBackground)
+        return;
+
+    // Blocks the sweeper has not reached yet are left for the allocator.
+    MutexLocker locker(m_sweeperLock);
+    m_blocksToSweep.clear();
+    while (m_blockBeingSwept)
+        m_sweeperCondition.wait(m_sweeperLock);
+    m_isSweepingInBackground = false;
 }
 
-void* Heap::allocateSlowCase(NewSpace::SizeClass& sizeClass)
+void* Heap::sweeperThreadStartFunc(void* heap)
 {
-#if COLLECT_ON_EVERY_ALLOCATION
+    static_cast<Heap*>(heap)->sweeperThreadMain();
+    return 0;
+}
+
+void Heap::sweeperThreadMain()
+{
+    while (true) {
+        MarkedBlock* block;
+        {
+            MutexLocker locker(m_sweeperLock);
+            while (m_blocksToSweep.isEmpty() && !m_sweeperThreadShouldQuit)
+                m_sweeperCondition.wait(m_sweeperLock);
+            if (m_sweeperThreadShouldQuit)
+                return;
+            block = *m_blocksToSweep.begin();
+            m_blocksToSweep.remove(block);
+            m_blockBeingSwept = block;
+        }
+
+        bool didSweep = block->sweepConcurrently();
+
+        {
+            MutexLocker locker(m_sweeperLock);
+            if (didSweep)
+                m_blocksSweptInBackground++;
+            m_blockBeingSwept = 0;
+            m_sweeperCondition.broadcast();
+        }
+    }
+}
+#endif // ENABLE(CONCURRENT_SWEEPING)
+
+void Heap::willSweepForAllocation(MarkedBlock* block)
+{
+#if ENABLE(CONCURRENT_SWEEPING)
+    // Take the block away from the sweeper, or wait for it to finish with it.
+    if (m_isSweepingInBackground) {
+        MutexLocker locker(m_sweeperLock);
+        m_blocksToSweep.remove(block);
+        while (m_blockBeingSwept == block)
+            m_sweeperCondition.wait(m_sweeperLock);
+    }
+#endif
+    if (block->needsSweep())
+        m_blocksSweptOnAllocation++;
+}
+
+void* Heap::allocateStorage(const JSCell* owner, size_t size)
+{
+    void* result = tryAllocateStorage(owner, size);
+    if (!result)
+        CRASH();
+    return result;
+}
+
+void* Heap::tryAllocateStorage(const JSCell* owner, size_t size)
+{
+    if (size < LargeObjectSpace::minimumAllocationSize())
+        return m_copiedSpace.tryAllocate(size);
+
+    // Large storage brings the next collection closer just as cells do.
+    void* result = m_largeObjectSpace.tryAllocate(owner, size);
+    if (result)
+        m_newSpace.addToWaterMark(size);
+    return result;
+}
+
+bool Heap::tryReallocateStorage(const JSCell* owner, void*& storage, size_t usedBytes, size_t newSize)
+{
+    ASSERT(usedBytes <= newSize);
+
+    void* newStorage = tryAllocateStorage(owner, newSize);
+    if (!newStorage)
+        return false;
+    memcpy(newStorage, storage, usedBytes);
+    freeStorage(owner, storage);
+    storage = newStorage;
+    return true;
+}
+
+void Heap::freeStorage(const JSCell* owner, void* storage)
+{
+    // The storage of a dead cell may be in a copied block that is long gone,
+    // so anything the cell does not own is left alone.
+    if (m_largeObjectSpace.isOwnedBy(storage, owner))
+        m_largeObjectSpace.free(storage);
+}
+
+void Heap::didMoveStorage(void* storage, const JSCell* oldOwner, const JSCell* newOwner)
+{
+    if (m_largeObjectSpace.isOwnedBy(storage, oldOwner))
+        m_largeObjectSpace.setOwner(storage, newOwner);
+}
+
+#if ENABLE(DFG_JIT)
+void Heap::jettisonDFGCodeBlock(PassOwnPtr<CodeBlock> codeBlock)
+{
+    m_dfgCodeBlocks.jettison(codeBlock);
+}
+#endif
+
+void Heap::reportExtraMemoryCostSlowCase(size_t cost)
+{
+    // Our frequency of garbage collection tries to balance memory use against speed
+    // by collecting based on the number of newly created values. However, for values
+    // that hold on to a great deal of memory that's not in the form of other JS values,
+    // that is not good enough - in some cases a lot of those objects can pile up and
+    // use crazy amounts of memory without a GC happening. So we track these extra
+    // memory costs. Only unusually large objects are noted, and we only keep track
+    // of this extra cost until the next GC. In garbage collected languages, most values
+    // are either very short lived temporaries, or have extremely long lifetimes. So
+    // if a large value survives one garbage collection, there is not much point to
+    // collecting more frequently as long as it stays alive.
+
+    if (m_extraCost > maxExtraCost && m_extraCost > m_newSpace.highWaterMark() / 2)
+        collectAllGarbage();
+    m_extraCost += cost;
+}
+
+inline void* Heap::tryAllocate(NewSpace::SizeClass& sizeClass)
+{
+    m_operationInProgress = Allocation;
+    void* result = m_newSpace.allocate(sizeClass);
+    m_operationInProgress = NoOperation;
+    return result;
+}
+
+void* Heap::allocateSlowCase(NewSpace::SizeClass& sizeClass)
+{
+#if COLLECT_ON_EVERY_ALLOCATION
     collectAllGarbage();
     ASSERT(m_operationInProgress == NoOperation);
 #endif
@@ -448,6 +1070,11 @@ void* Heap::allocateSlowCase(NewSpace::SizeClass& sizeClass)
     if (LIKELY(result != 0))
         return result;
 
+#if ENABLE(INCREMENTAL_MARKING)
+    if (m_isMarkingIncrementally)
+        return allocateWhileMarkingIncrementally(sizeClass);
+#endif
+
     AllocationEffort allocationEffort;
     
     if (m_newSpace.waterMark() < m_newSpace.highWaterMark() || !m_isSafeToCollect)
@@ -463,6 +1090,13 @@ void* Heap::allocateSlowCase(NewSpace::SizeClass& sizeClass)
         return result;
     }
 
+#if ENABLE(INCREMENTAL_MARKING)
+    if (Options::incrementalMarkingPauseBudget > 0) {
+        beginIncrementalMarking(collectionTypeFor(DoNotSweep));
+        return allocateWhileMarkingIncrementally(sizeClass);
+    }
+#endif
+
     collect(DoNotSweep);
     
     result = tryAllocate(sizeClass);
@@ -479,6 +1113,150 @@ void* Heap::allocateSlowCase(NewSpace::SizeClass& sizeClass)
     return result;
 }
 
+#if ENABLE(INCREMENTAL_MARKING)
+void* Heap::allocateWhileMarkingIncrementally(NewSpace::SizeClass& sizeClass)
+{
+    // If the mutator allocates another high water mark's worth of blocks
+    // before marking catches up, stop it and finish marking in one go.
+    bool isFinished = markIncrementally();
+    if (isFinished || m_blocksAllocatedDuringMarking.size() * MarkedBlock::blockSize >= m_newSpace.highWaterMark()) {
+        collect(DoNotSweep);
+
+        void* result = tryAllocate(sizeClass);
+        if (result)
+            return result;
+
+        m_newSpace.addBlock(sizeClass, allocateBlock(sizeClass.cellSize, AllocationMustSucceed));
+
+        result = tryAllocate(sizeClass);
+        ASSERT(result);
+        return result;
+    }
+
+    MarkedBlock* block = allocateBlock(sizeClass.cellSize, AllocationMustSucceed);
+    m_blocksAllocatedDuringMarking.append(block);
+    m_newSpace.addBlock(sizeClass, block);
+
+    void* result = tryAllocate(sizeClass);
+    ASSERT(result);
+    return result;
+}
+
+void Heap::beginIncrementalMarking(CollectionType collectionType)
+{
+    ASSERT(isValidThreadState(m_globalData));
+    ASSERT(!m_isMarkingIncrementally);
+    if (m_operationInProgress != NoOperation)
+        CRASH();
+    m_operationInProgress = Collection;
+
+    GCPHASE(BeginIncrementalMarking);
+    double sliceStart = monotonicallyIncreasingTime();
+
+#if ENABLE(CONCURRENT_SWEEPING)
+    stopSweepingInBackground();
+#endif
+    canonicalizeBlocks();
+    beginCollectionStatistics(collectionType);
+    forEachBlock<SnapshotMarks>();
+
+    // The mutator runs between slices, so backing stores cannot be moved,
+    // only kept or found dead.
+    if (collectionType == FullCollection)
+        m_copiedSpace.startCollecting(CopiedSpace::DoNotEvacuate);
+
+    void* dummy;
+
+    // As in markRoots(), conservative roots are gathered before the mark bits are cleared.
+    ConservativeRoots machineThreadRoots(&m_blocks, &m_copiedSpace);
+    m_machineThreads.gatherConservativeRoots(machineThreadRoots, &dummy);
+    ConservativeRoots registerFileRoots(&m_blocks, &m_copiedSpace);
+    registerFile().gatherConservativeRoots(registerFileRoots);
+
+    if (collectionType == EdenCollection)
+        clearYoungMarks();
+    else
+        clearMarks();
+
+    SlotVisitor& visitor = m_slotVisitor;
+    HeapRootVisitor heapRootVisitor(visitor);
+
+    visitor.append(machineThreadRoots);
+    visitor.append(registerFileRoots);
+    markProtectedObjects(heapRootVisitor);
+    markTempSortVectors(heapRootVisitor);
+    if (m_markListSet && m_markListSet->size())
+        MarkedArgumentBuffer::markLists(heapRootVisitor, *m_markListSet);
+    if (m_globalData->exception)
+        heapRootVisitor.visit(&m_globalData->exception);
+    m_handleHeap.visitStrongHandles(heapRootVisitor);
+    m_handleStack.visit(heapRootVisitor);
+    if (collectionType == EdenCollection)
+        visitRememberedSet(visitor);
+
+    // From here on, the cards record the cells that the mutator writes to
+    // between slices of marking.
+    clearCards();
+    m_newSpace.skipExistingBlocks();
+
+    m_isMarkingIncrementally = true;
+    m_incrementalCollectionType = collectionType;
+
+    didMarkIncrementally(monotonicallyIncreasingTime() - sliceStart);
+    m_operationInProgress = NoOperation;
+}
+
+// Returns true when nothing is left to mark but what the mutator may have
+// changed since the last slice.
+bool Heap::markIncrementally()
+{
+    ASSERT(isValidThreadState(m_globalData));
+    ASSERT(m_isMarkingIncrementally);
+    if (m_operationInProgress != NoOperation)
+        CRASH();
+    m_operationInProgress = Collection;
+
+    bool isFinished;
+    {
+        GCPHASE(MarkIncrementally);
+        double sliceStart = monotonicallyIncreasingTime();
+        double deadline = sliceStart + Options::incrementalMarkingPauseBudget;
+        isFinished = m_slotVisitor.drainUntil(deadline, Options::maximumNumberOfCellsPerMarkingSlice);
+        didMarkIncrementally(monotonicallyIncreasingTime() - sliceStart);
+    }
+
+    m_operationInProgress = NoOperation;
+    return isFinished;
+}
+
+// Cells allocated during marking are born marked, but the code that
+// initializes them does not always go through a write barrier, so they are
+// all visited again. So are the marked cells that were written to.
+void Heap::revisitCellsMutatedDuringMarking(SlotVisitor& visitor)
+{
+    RevisitCells revisitCells(visitor);
+    Vector<MarkedBlock*>::iterator end = m_blocksAllocatedDuringMarking.end();
+    for (Vector<MarkedBlock*>::iterator it = m_blocksAllocatedDuringMarking.begin(); it != end; ++it) {
+        (*it)->forEachCell(revisitCells);
+        (*it)->clearCards();
+    }
+    forEachBlock(revisitCells);
+}
+
+void Heap::didMarkIncrementally(double sliceTime)
+{
+    GCStatistics& statistics = m_collectionStatistics;
+    statistics.incrementalMarkingSliceCount++;
+    statistics.incrementalMarkingTime += sliceTime;
+    statistics.longestIncrementalMarkingSlice = max(statistics.longestIncrementalMarkingSlice, sliceTime);
+}
+
+void Heap::shade(JSCell* cell)
+{
+    HeapRootVisitor(m_slotVisitor).visit(&cell);
+}
+#endif
+
 void Heap::protect(JSValue k)
 {
     ASSERT(k);
@@ -550,8 +1328,11 @@ void Heap::getConservativeRegisterRoots(HashSet<JSCell*>& roots)
     ASSERT(isValidThreadState(m_globalData));
     if (m_operationInProgress != NoOperation)
         CRASH();
+#if ENABLE(CONCURRENT_SWEEPING)
+    stopSweepingInBackground();
+#endif
     m_operationInProgress = Collection;
-    ConservativeRoots registerFileRoots(&m_blocks);
+    ConservativeRoots registerFileRoots(&m_blocks, 0);
     registerFile().gatherConservativeRoots(registerFileRoots);
     size_t registerFileRootCount = registerFileRoots.size();
     JSCell** registerRoots = registerFileRoots.roots();
@@ -562,65 +1343,187 @@ void Heap::getConservativeRegisterRoots(HashSet<JSCell*>& roots)
     m_operationInProgress = NoOperation;
 }
 
-void Heap::markRoots()
+void Heap::markRoots(CollectionType collectionType)
 {
     ASSERT(isValidThreadState(m_globalData));
     if (m_operationInProgress != NoOperation)
         CRASH();
     m_operationInProgress = Collection;
 
+    // Marking that began incrementally has already cleared the mark bits, and
+    // only has to catch up with what the mutator did between slices.
+#if ENABLE(INCREMENTAL_MARKING)
+    bool isFinishingIncrementalMarking = m_isMarkingIncrementally;
+#else
+    bool isFinishingIncrementalMarking = false;
+#endif
+    ConservativeRoots::Filter conservativeRootsFilter = isFinishingIncrementalMarking ? ConservativeRoots::UnmarkedCellsLiveWhenMarkingBegan : ConservativeRoots::MarkedCells;
+
+    // Only a full collection visits every owner of a backing store, and
+    // only one that stops the world throughout can move them.
+    if (collectionType == FullCollection && !isFinishingIncrementalMarking)
+        m_copiedSpace.startCollecting(CopiedSpace::DoEvacuate);
+
     void* dummy;
 
     // We gather conservative roots before clearing mark bits because conservative
     // gathering uses the mark bits to determine whether a reference is valid.
-    ConservativeRoots machineThreadRoots(&m_blocks);
-    m_machineThreads.gatherConservativeRoots(machineThreadRoots, &dummy);
+    ConservativeRoots machineThreadRoots(&m_blocks, &m_copiedSpace, conservativeRootsFilter);
+    {
+        GCPHASE(GatherConservativeRoots);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::GatherConservativeRootsPhase);
+        m_machineThreads.gatherConservativeRoots(machineThreadRoots, &dummy);
+    }
 
-    ConservativeRoots registerFileRoots(&m_blocks);
-    registerFile().gatherConservativeRoots(registerFileRoots);
+    ConservativeRoots registerFileRoots(&m_blocks, &m_copiedSpace, conservativeRootsFilter);
+#if ENABLE(DFG_JIT)
+    m_dfgCodeBlocks.clearMarks();
+#endif
+    {
+        GCPHASE(GatherRegisterFileRoots);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::GatherConservativeRootsPhase);
+#if ENABLE(DFG_JIT)
+        registerFile().gatherConservativeRoots(registerFileRoots, m_dfgCodeBlocks);
+#else
+        registerFile().gatherConservativeRoots(registerFileRoots);
+#endif
+    }
 
-    clearMarks();
+    if (isFinishingIncrementalMarking)
+        ASSERT(collectionType == m_incrementalCollectionType);
+    else if (collectionType == EdenCollection) {
+        GCPHASE(ClearYoungMarks);
+        clearYoungMarks();
+    } else {
+        GCPHASE(ClearMarks);
+        clearMarks();
+    }
+
+    m_sharedData.startMarkingThreadsIfNecessary();
 
     SlotVisitor& visitor = m_slotVisitor;
     HeapRootVisitor heapRootVisitor(visitor);
 
-    visitor.append(machineThreadRoots);
-    visitor.drain();
-
-    visitor.append(registerFileRoots);
-    visitor.drain();
-
-    markProtectedObjects(heapRootVisitor);
-    visitor.drain();
-    
-    markTempSortVectors(heapRootVisitor);
-    visitor.drain();
-
-    if (m_markListSet && m_markListSet->size())
-        MarkedArgumentBuffer::markLists(heapRootVisitor, *m_markListSet);
-    if (m_globalData->exception)
-        heapRootVisitor.visit(&m_globalData->exception);
-    visitor.drain();
-
-    m_handleHeap.visitStrongHandles(heapRootVisitor);
-    visitor.drain();
-
-    m_handleStack.visit(heapRootVisitor);
-    visitor.drain();
+    {
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::MarkRootsPhase);
+        ParallelModeEnabler enabler(visitor);
+        {
+            GCPHASE(VisitMachineRoots);
+            visitor.append(machineThreadRoots);
+            visitor.donateAndDrain();
+        }
+        {
+            GCPHASE(VisitRegisterFileRoots);
+            visitor.append(registerFileRoots);
+            visitor.donateAndDrain();
+        }
+#if ENABLE(DFG_JIT)
+        {
+            GCPHASE(VisitJettisonedDFGCodeBlocks);
+            m_dfgCodeBlocks.traceMarkedCodeBlocks(visitor);
+            visitor.donateAndDrain();
+        }
+#endif
+        {
+            GCPHASE(VisitProtectedObjects);
+            markProtectedObjects(heapRootVisitor);
+            visitor.donateAndDrain();
+        }
+        {
+            GCPHASE(VisitTempSortVectors);
+            markTempSortVectors(heapRootVisitor);
+            visitor.donateAndDrain();
+        }
+        {
+            GCPHASE(MarkingArgumentBuffers);
+            if (m_markListSet && m_markListSet->size())
+                MarkedArgumentBuffer::markLists(heapRootVisitor, *m_markListSet);
+            if (m_globalData->exception)
+                heapRootVisitor.visit(&m_globalData->exception);
+            visitor.donateAndDrain();
+        }
+        {
+            GCPHASE(VisitStrongHandles);
+            m_handleHeap.visitStrongHandles(heapRootVisitor);
+            visitor.donateAndDrain();
+        }
+        {
+            GCPHASE(VisitHandleStack);
+            m_handleStack.visit(heapRootVisitor);
+            visitor.donateAndDrain();
+        }
+#if ENABLE(CONCURRENT_JIT)
+        if (m_globalData->dfgWorklist) {
+            GCPHASE(VisitDFGWorklist);
+            m_globalData->dfgWorklist->visitChildren(visitor);
+            visitor.donateAndDrain();
+        }
+#endif
+        if (collectionType == EdenCollection && !isFinishingIncrementalMarking) {
+            GCPHASE(VisitRememberedSet);
+            visitRememberedSet(visitor);
+            visitor.donateAndDrain();
+        }
+#if ENABLE(INCREMENTAL_MARKING)
+        if (isFinishingIncrementalMarking) {
+            GCPHASE(RevisitMutatedCells);
+            revisitCellsMutatedDuringMarking(visitor);
+            visitor.donateAndDrain();
+        }
+#endif
+        {
+            GCPHASE(ConvergeParallelMarking);
+            visitor.drainFromShared(SlotVisitor::MasterDrain);
+        }
+    }
 
-    harvestWeakReferences();
+    {
+        GCPHASE(HarvestWeakReferences);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::HarvestWeakReferencesPhase);
+        harvestWeakReferences();
+    }
 
     // Weak handles must be marked last, because their owners use the set of
     // opaque roots to determine reachability.
-    int lastOpaqueRootCount;
-    do {
-        lastOpaqueRootCount = visitor.opaqueRootCount();
-        m_handleHeap.visitWeakHandles(heapRootVisitor);
-        visitor.drain();
-    // If the set of opaque roots has grown, more weak handles may have become reachable.
-    } while (lastOpaqueRootCount != visitor.opaqueRootCount());
+    {
+        GCPHASE(VisitingWeakHandles);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::VisitWeakHandlesPhase);
+        if (collectionType == EdenCollection)
+            m_handleHeap.visitOwnedWeakHandles(heapRootVisitor);
+        int lastOpaqueRootCount;
+        do {
+            lastOpaqueRootCount = visitor.opaqueRootCount();
+            m_handleHeap.visitWeakHandles(heapRootVisitor);
+            {
+                ParallelModeEnabler enabler(visitor);
+                visitor.donateAndDrain();
+                visitor.drainFromShared(SlotVisitor::MasterDrain);
+            }
+        // If the set of opaque roots has grown, more weak handles may have become reachable.
+        } while (lastOpaqueRootCount != visitor.opaqueRootCount());
+    }
+
+    if (collectionType == FullCollection) {
+        GCPHASE(FreeDeadCopiedBlocks);
+        m_copiedSpace.doneCollecting();
+    }
+
+#if ENABLE(DFG_JIT)
+    {
+        // Nothing is swept yet, so the code that is deleted can still
+        // unregister itself from the cells and code that it refers to.
+        GCPHASE(DeleteJettisonedDFGCodeBlocks);
+        m_dfgCodeBlocks.deleteUnmarkedJettisonedCodeBlocks();
+    }
+#endif
 
     visitor.reset();
+    m_sharedData.reset();
+
+#if ENABLE(INCREMENTAL_MARKING)
+    m_isMarkingIncrementally = false;
+    m_blocksAllocatedDuringMarking.clear();
+#endif
 
     m_operationInProgress = NoOperation;
 }
@@ -630,9 +1533,25 @@ void Heap::clearMarks()
     forEachBlock<ClearMarks>();
 }
 
-void Heap::sweep()
+void Heap::clearYoungMarks()
+{
+    forEachBlock<ClearYoungMarks>();
+}
+
+void Heap::visitRememberedSet(SlotVisitor& visitor)
+{
+    VisitRememberedCells visitRememberedCells(visitor);
+    forEachBlock(visitRememberedCells);
+}
+
+void Heap::clearCards()
+{
+    forEachBlock<ClearCards>();
+}
+
+void Heap::ageMarkedCells()
 {
-    forEachBlock<Sweep>();
+    forEachBlock<AgeMarkedCells>();
 }
 
 size_t Heap::objectCount()
@@ -642,12 +1561,12 @@ size_t Heap::objectCount()
 
 size_t Heap::size()
 {
-    return forEachBlock<Size>();
+    return forEachBlock<Size>() + m_largeObjectSpace.size() + m_copiedSpace.size();
 }
 
 size_t Heap::capacity()
 {
-    return forEachBlock<Capacity>();
+    return forEachBlock<Capacity>() + m_largeObjectSpace.capacity() + m_copiedSpace.capacity();
 }
 
 size_t Heap::protectedGlobalObjectCount()
@@ -675,34 +1594,105 @@ PassOwnPtr<TypeCountSet> Heap::objectTypeCounts()
     return forEachCell<RecordType>();
 }
 
-void Heap::collectAllGarbage()
+void Heap::collectAllGarbage(CompactionToggle compactionToggle)
 {
     if (!m_isSafeToCollect)
         return;
+#if ENABLE(INCREMENTAL_MARKING)
+    // Marking may have queued code blocks as weak reference harvesters, and
+    // recompiling would destroy them. An eden cycle would also not give back
+    // all the memory we can get.
+    if (m_isMarkingIncrementally)
+        collect(DoNotSweep);
+#endif
     if (!m_globalData->dynamicGlobalObject)
         m_globalData->recompileAllJSFunctions();
 
-    collect(DoSweep);
+    collect(DoSweep, compactionToggle);
 }
 
-void Heap::collect(SweepToggle sweepToggle)
+void Heap::collect(SweepToggle sweepToggle, CompactionToggle compactionToggle)
 {
     ASSERT(globalData()->identifierTable == wtfThreadData().currentIdentifierTable());
     ASSERT(m_isSafeToCollect);
     JAVASCRIPTCORE_GC_BEGIN();
     
-    canonicalizeBlocks();
-    
-    markRoots();
-    m_handleHeap.finalizeWeakHandles();
-    m_globalData->smallStrings.finalizeSmallStrings();
+    GCPHASE(Collect);
+    double pauseStart = monotonicallyIncreasingTime();
+
+#if ENABLE(CONCURRENT_SWEEPING)
+    stopSweepingInBackground();
+#endif
+
+    CollectionType collectionType = collectionTypeFor(sweepToggle);
+#if ENABLE(INCREMENTAL_MARKING)
+    if (m_isMarkingIncrementally) {
+        ASSERT(sweepToggle == DoNotSweep);
+        collectionType = m_incrementalCollectionType;
+    }
+    bool wasMarkingIncrementally = m_isMarkingIncrementally;
+#else
+    bool wasMarkingIncrementally = false;
+#endif
+
+    {
+        GCPHASE(Canonicalize);
+        canonicalizeBlocks();
+    }
+    if (!wasMarkingIncrementally)
+        beginCollectionStatistics(collectionType);
+
+    // Only what marking finds this time may pin a block.
+    if (compactionToggle == DoCompact) {
+        ASSERT(sweepToggle == DoSweep && collectionType == FullCollection);
+        forEachBlock<Unpin>();
+    }
+
+    {
+        GCPHASE(MarkRoots);
+        markRoots(collectionType);
+    }
+
+#if VERIFY_MARKING
+    if (collectionType == EdenCollection || wasMarkingIncrementally)
+        verifyMarking();
+#endif
+
+    {
+        GCPHASE(FinalizeWeakHandles);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::FinalizeWeakHandlesPhase);
+        m_handleHeap.finalizeWeakHandles();
+        m_globalData->smallStrings.finalizeSmallStrings();
+    }
+
+    if (compactionToggle == DoCompact) {
+        GCPHASE(Compact);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::CompactPhase);
+        compact();
+    }
+
+#if ENABLE(GGC)
+    {
+        GCPHASE(AgeMarkedCells);
+        ageMarkedCells();
+    }
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
+
+    countSurvivorsForStatistics();
     
-    resetAllocator();
+    {
+        GCPHASE(ResetAllocator);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::SweepPhase);
+        resetAllocator();
+    }
 
+    // Dead cells are destroyed lazily, by the allocator or the sweeper thread,
+    // so all a sweep has to do here is give back the blocks that are empty.
     if (sweepToggle == DoSweep) {
-        sweep();
+        GCPHASE(Shrink);
+        GCStatisticsPhaseScope statisticsScope(m_collectionStatistics, GCStatistics::ShrinkPhase);
         shrink();
     }
 
@@ -710,18 +1700,298 @@ void Heap::collect(SweepToggle sweepToggle)
     // water mark to be proportional to the current size of the heap. The exact
     // proportion is a bit arbitrary. A 2X multiplier gives a 1:1 (heap size :
     // new bytes allocated) proportion, and seems to work well in benchmarks.
-    size_t proportionalBytes = 2 * size();
+    m_sizeAfterLastCollection = size();
+    if (collectionType == FullCollection)
+        m_sizeAfterLastFullCollection = m_sizeAfterLastCollection;
+    size_t proportionalBytes = 2 * m_sizeAfterLastCollection;
     m_newSpace.setHighWaterMark(max(proportionalBytes, m_minBytesPerCycle));
-    m_newSpace.resetPropertyStorageNursery();
+#if ENABLE(CONCURRENT_SWEEPING)
+    startSweepingInBackground();
+#endif
+    endCollectionStatistics(monotonicallyIncreasingTime() - pauseStart);
     JAVASCRIPTCORE_GC_END();
 
     (*m_activityCallback)();
 }
 
+void Heap::beginCollectionStatistics(CollectionType collectionType)
+{
+    GCStatistics& statistics = m_collectionStatistics;
+    statistics = GCStatistics();
+    statistics.collectionNumber = m_lastCollectionStatistics.collectionNumber + 1;
+    statistics.isFullCollection = collectionType == FullCollection;
+
+    // The mark bits are the allocated bits too, so what a size class holds
+    // beyond what survived last time was allocated since.
+    Vector<NewSpace::SizeClassStatistics> sizeClasses;
+    m_newSpace.getSizeClassStatistics(sizeClasses);
+    const Vector<GCStatistics::SizeClass>& lastSizeClasses = m_lastCollectionStatistics.sizeClasses;
+    for (size_t i = 0; i < sizeClasses.size(); ++i) {
+        size_t bytes = sizeClasses[i].liveCellCount * sizeClasses[i].cellSize;
+        size_t bytesSurvivedLastTime = 0;
+        for (size_t j = 0; j < lastSizeClasses.size(); ++j) {
+            if (lastSizeClasses[j].cellSize == sizeClasses[i].cellSize)
+                bytesSurvivedLastTime = lastSizeClasses[j].bytesSurvived;
+        }
+
+        GCStatistics::SizeClass entry = { sizeClasses[i].cellSize, bytes > bytesSurvivedLastTime ? bytes - bytesSurvivedLastTime : 0, 0 };
+        statistics.sizeClasses.append(entry);
+        statistics.bytesAllocated += entry.bytesAllocated;
+        statistics.sizeBefore += bytes;
+    }
+}
+
+void Heap::countSurvivorsForStatistics()
+{
+    GCStatistics& statistics = m_collectionStatistics;
+    statistics.extraMemoryCost = m_extraCost;
+
+    Vector<NewSpace::SizeClassStatistics> sizeClasses;
+    m_newSpace.getSizeClassStatistics(sizeClasses);
+    for (size_t i = 0; i < sizeClasses.size(); ++i) {
+        size_t bytes = sizeClasses[i].liveCellCount * sizeClasses[i].cellSize;
+        statistics.sizeAfter += bytes;
+
+        // Marking incrementally may have given a size class its first blocks.
+        size_t j = 0;
+        while (j < statistics.sizeClasses.size() && statistics.sizeClasses[j].cellSize != sizeClasses[i].cellSize)
+            ++j;
+        if (j == statistics.sizeClasses.size()) {
+            GCStatistics::SizeClass entry = { sizeClasses[i].cellSize, 0, 0 };
+            statistics.sizeClasses.append(entry);
+        }
+        statistics.sizeClasses[j].bytesSurvived = bytes;
+    }
+}
+
+void Heap::endCollectionStatistics(double pauseTime)
+{
+    GCStatistics& statistics = m_collectionStatistics;
+    statistics.pauseTime = pauseTime;
+    statistics.totalPauseTime = m_lastCollectionStatistics.totalPauseTime + statistics.incrementalMarkingTime + pauseTime;
+    statistics.longestPause = max(m_lastCollectionStatistics.longestPause, max(statistics.longestIncrementalMarkingSlice, pauseTime));
+
+    m_lastCollectionStatistics = statistics;
+    if (m_statisticsObserver)
+        m_statisticsObserver->didCollect(m_lastCollectionStatistics);
+}
+
+// Moves the live cells out of the sparsest blocks, and into the free cells of
+// the other blocks of their size class, so that the evacuated blocks can be
+// given back. This happens once marking is done: the cells that moved leave
+// forwarding pointers behind, and every live cell and root is then revisited
+// to update the references to them. Anything that holds a pointer where it
+// cannot be updated must have pinned the block it points into by then.
+void Heap::compact()
+{
+    ASSERT(m_operationInProgress == NoOperation);
+    m_operationInProgress = Collection;
+
+#if ENABLE(CONCURRENT_JIT)
+    // Compilations in flight have the addresses of cells built into their code.
+    if (m_globalData->dfgWorklist)
+        m_globalData->dfgWorklist->removeAllPlans();
+#endif
+
+    {
+        GCPHASE(PinCellsThatCannotMove);
+        pinCellsThatCannotMove();
+    }
+
+    DoublyLinkedList<MarkedBlock> evacuatedBlocks;
+    {
+        GCPHASE(EvacuateSparseBlocks);
+        EvacuateSparseBlocks evacuateSparseBlocks(m_newSpace, evacuatedBlocks);
+        m_newSpace.forEachSizeClass(evacuateSparseBlocks);
+    }
+
+    if (!evacuatedBlocks.isEmpty()) {
+        {
+            GCPHASE(UpdateReferencesToMovedCells);
+            updateReferencesToMovedCells();
+        }
+        freeBlocks(evacuatedBlocks.head());
+    }
+
+    m_operationInProgress = NoOperation;
+}
+
+void Heap::pinCellsThatCannotMove()
+{
+    // Hash tables keyed on the cells.
+    ProtectCountSet::iterator protectedEnd = m_protectedValues.end();
+    for (ProtectCountSet::iterator it = m_protectedValues.begin(); it != protectedEnd; ++it)
+        pin(it->first);
+    HashSet<JSObject*>::iterator visitedEnd = m_globalData->stringRecursionCheckVisitedObjects.end();
+    for (HashSet<JSObject*>::iterator it = m_globalData->stringRecursionCheckVisitedObjects.begin(); it != visitedEnd; ++it)
+        pin(*it);
+
+    // Machine code.
+    PinPrototypes pinPrototypes(m_globalData);
+    forEachCell(pinPrototypes);
+}
+
+void Heap::updateReferencesToMovedCells()
+{
+    SlotVisitor& visitor = m_slotVisitor;
+    HeapRootVisitor heapRootVisitor(visitor);
+
+    // Conservative roots and protected cells pinned their blocks, so they
+    // are the only roots that need not be revisited.
+    UpdateReferencesToMovedCells updateReferencesToMovedCells;
+    visitor.beginObserving(&updateReferencesToMovedCells);
+    Revisit revisit(visitor);
+    forEachCell(revisit);
+    markTempSortVectors(heapRootVisitor);
+    if (m_markListSet && m_markListSet->size())
+        MarkedArgumentBuffer::markLists(heapRootVisitor, *m_markListSet);
+    if (m_globalData->exception)
+        heapRootVisitor.visit(&m_globalData->exception);
+    m_handleHeap.visitStrongHandles(heapRootVisitor);
+    m_handleHeap.visitSurvivingWeakHandles(heapRootVisitor);
+    m_handleStack.visit(heapRootVisitor);
+    visitor.endObserving();
+
+    visitor.reset();
+    m_sharedData.reset();
+}
+
+bool Heap::writeSnapshot(HeapSnapshotWriter& writer)
+{
+    ASSERT(m_operationInProgress == NoOperation);
+    if (!m_isSafeToCollect)
+        return false;
+
+    // Afterwards, the marked cells are exactly the live ones.
+    collectAllGarbage();
+
+    AddBlockToSnapshot addBlockToSnapshot(writer);
+    forEachBlock(addBlockToSnapshot);
+    writer.begin();
+
+    m_operationInProgress = Collection;
+
+    SlotVisitor& visitor = m_slotVisitor;
+    HeapRootVisitor heapRootVisitor(visitor);
+    visitor.beginObserving(&writer);
+
+    writer.beginRoots();
+    {
+        void* dummy;
+        ConservativeRoots machineThreadRoots(&m_blocks, &m_copiedSpace);
+        m_machineThreads.gatherConservativeRoots(machineThreadRoots, &dummy);
+        for (size_t i = 0; i < machineThreadRoots.size(); ++i)
+            writer.addRoot(machineThreadRoots.roots()[i]);
+        ConservativeRoots registerFileRoots(&m_blocks, &m_copiedSpace);
+        registerFile().gatherConservativeRoots(registerFileRoots);
+        for (size_t i = 0; i < registerFileRoots.size(); ++i)
+            writer.addRoot(registerFileRoots.roots()[i]);
+    }
+    markProtectedObjects(heapRootVisitor);
+    markTempSortVectors(heapRootVisitor);
+    if (m_markListSet && m_markListSet->size())
+        MarkedArgumentBuffer::markLists(heapRootVisitor, *m_markListSet);
+    if (m_globalData->exception)
+        heapRootVisitor.visit(&m_globalData->exception);
+    m_handleHeap.visitStrongHandles(heapRootVisitor);
+    m_handleStack.visit(heapRootVisitor);
+    writer.endRoots();
+
+    AddCellToSnapshot addCellToSnapshot(writer, visitor);
+    forEachCell(addCellToSnapshot);
+    visitor.endObserving();
+
+    visitor.reset();
+    m_sharedData.reset();
+
+    m_operationInProgress = NoOperation;
+    return writer.end();
+}
+
+void Heap::getSizeClassStatistics(Vector<NewSpace::SizeClassStatistics>& statistics)
+{
+    canonicalizeBlocks();
+    m_newSpace.getSizeClassStatistics(statistics);
+}
+
+Heap::CollectionType Heap::collectionTypeFor(SweepToggle sweepToggle)
+{
+#if ENABLE(GGC)
+    if (!Options::useGenerationalGC)
+        return FullCollection;
+
+    // A caller that asks for a sweep wants back all the memory it can get.
+    if (sweepToggle == DoSweep)
+        return FullCollection;
+
+    // Dead old cells are only reclaimed by full collections. Do one once the
+    // old generation has doubled since the last one, so that the garbage that
+    // eden collections leave behind stays proportional to the live heap.
+    if (m_sizeAfterLastCollection >= 2 * max(m_sizeAfterLastFullCollection, m_minBytesPerCycle))
+        return FullCollection;
+
+    return EdenCollection;
+#else
+    UNUSED_PARAM(sweepToggle);
+    return FullCollection;
+#endif
+}
+
+#if VERIFY_MARKING
+// Re-marks the heap from scratch and checks that every cell a full collection
+// finds live was also kept by the eden or incremental collection that just ran.
+// A missing cell was reachable only from a cell whose card was never marked,
+// which means that some store bypassed the write barrier.
+void Heap::verifyMarking()
+{
+    RecordLiveCells recordLiveCells;
+    forEachCell(recordLiveCells);
+    HashSet<JSCell*>& liveCells = recordLiveCells.cells();
+
+    markRoots(FullCollection);
+
+    CheckCellIsIn checkCellIsIn(liveCells);
+    forEachCell(checkCellIsIn);
+
+    // Leave the marks as the collection left them.
+    HashSet<JSCell*>::iterator end = liveCells.end();
+    for (HashSet<JSCell*>::iterator it = liveCells.begin(); it != end; ++it)
+        setMarked(*it);
+}
+#endif
+
 void Heap::canonicalizeBlocks()
 {
     m_newSpace.canonicalizeBlocks();
+
+#if ENABLE(JSC_MULTIPLE_THREADS)
+    // Collection makes every thread start over on the blocks it sweeps
+    // anyway, so there is no point keeping the caches beyond this.
+    AllocationCacheMap::iterator end = m_allocationCaches.end();
+    for (AllocationCacheMap::iterator it = m_allocationCaches.begin(); it != end; ++it)
+        m_newSpace.canonicalizeAllocationCache(*it->second);
+    deleteAllValues(m_allocationCaches);
+    m_allocationCaches.clear();
+#endif
+}
+
+#if ENABLE(JSC_MULTIPLE_THREADS)
+void Heap::switchAllocationCacheToCurrentThread()
+{
+    ThreadIdentifier thread = currentThread();
+    if (thread == m_allocatingThread)
+        return;
+
+    NewSpace::AllocationCache*& outgoing = m_allocationCaches.add(m_allocatingThread, 0).first->second;
+    if (!outgoing)
+        outgoing = new NewSpace::AllocationCache;
+    m_newSpace.saveAllocationCache(*outgoing);
+
+    if (NewSpace::AllocationCache* incoming = m_allocationCaches.get(thread))
+        m_newSpace.restoreAllocationCache(*incoming);
+    m_allocatingThread = thread;
 }
+#endif
 
 void Heap::resetAllocator()
 {
@@ -739,6 +2009,16 @@ GCActivityCallback* Heap::activityCallback()
     return m_activityCallback.get();
 }
 
+void Heap::setStatisticsObserver(PassOwnPtr<GCStatisticsObserver> statisticsObserver)
+{
+    m_statisticsObserver = statisticsObserver;
+}
+
+GCStatisticsObserver* Heap::statisticsObserver()
+{
+    return m_statisticsObserver.get();
+}
+
 bool Heap::isValidAllocation(size_t bytes)
 {
     if (!isValidThreadState(m_globalData))
@@ -808,6 +2088,7 @@ void Heap::shrink()
     // We record a temporary list of empties to avoid modifying m_blocks while iterating it.
     TakeIfEmpty takeIfEmpty(&m_newSpace);
     freeBlocks(forEachBlock(takeIfEmpty));
+    m_copiedSpace.releaseFreeBlocks();
 }
 
 #if ENABLE(LAZY_BLOCK_FREEING)
@@ -834,16 +2115,4 @@ void Heap::releaseFreeBlocks()
 }
 #endif
 
-#if ENABLE(GGC)
-void Heap::writeBarrierSlowCase(const JSCell* owner, JSCell* cell)
-{
-}
-
-#else
-
-void Heap::writeBarrierSlowCase(const JSCell*, JSCell*)
-{
-}
-#endif
-
 } // namespace JSC
@@ -22,8 +22,12 @@
 #ifndef Heap_h
 #define Heap_h
 
+#include "CopiedSpace.h"
+#include "DFGCodeBlocks.h"
+#include "GCStatistics.h"
 #include "HandleHeap.h"
 #include "HandleStack.h"
+#include "LargeObjectSpace.h"
 #include "MarkedBlock.h"
 #include "MarkedBlockSet.h"
 #include "NewSpace.h"
@@ -35,9 +39,11 @@
 
 namespace JSC {
 
+    class CodeBlock;
     class GCActivityCallback;
     class GlobalCodeBlock;
     class HeapRootVisitor;
+    class HeapSnapshotWriter;
     class JSCell;
     class JSGlobalData;
     class JSValue;
@@ -68,8 +74,13 @@ namespace JSC {
         static bool testAndClearMarked(const void*);
         static void setMarked(const void*);
 
+        // Keeps a compacting collection from moving the cell, because
+        // something points to it where the collector cannot update it.
+        static void pin(const JSCell*);
+
         static void writeBarrier(const JSCell*, JSValue);
         static void writeBarrier(const JSCell*, JSCell*);
+        static void writeBarrier(const JSCell*);
 
         Heap(JSGlobalData*, HeapSize);
         ~Heap();
@@ -77,25 +88,58 @@ namespace JSC {
 
         JSGlobalData* globalData() const { return m_globalData; }
         NewSpace& markedSpace() { return m_newSpace; }
+        CopiedSpace& copiedSpace() { return m_copiedSpace; }
         MachineThreads& machineThreads() { return m_machineThreads; }
 
         GCActivityCallback* activityCallback();
         void setActivityCallback(PassOwnPtr<GCActivityCallback>);
 
+        const GCStatistics& lastCollectionStatistics() const { return m_lastCollectionStatistics; }
+        GCStatisticsObserver* statisticsObserver();
+        void setStatisticsObserver(PassOwnPtr<GCStatisticsObserver>);
+
         // true if an allocation or collection is in progress
         inline bool isBusy();
 
         void* allocate(size_t);
         NewSpace::SizeClass& sizeClassFor(size_t);
         void* allocate(NewSpace::SizeClass&);
+#if ENABLE(JSC_MULTIPLE_THREADS)
+        // Called when a thread starts using the heap, to put aside the blocks
+        // the last thread was allocating out of and give back this thread's.
+        void switchAllocationCacheToCurrentThread();
+#endif
         void notifyIsSafeToCollect() { m_isSafeToCollect = true; }
-        void collectAllGarbage();
 
-        inline void* allocatePropertyStorage(size_t);
-        inline bool inPropertyStorageNursery(void*);
+        // A compacting collection also moves objects out of sparsely filled
+        // blocks, so that the blocks can be given back. Objects that anything
+        // but the heap, handles, protect() and the stack may point to stay
+        // put, but an embedder must not keep other pointers to objects across
+        // one.
+        enum CompactionToggle { DoNotCompact, DoCompact };
+        void collectAllGarbage(CompactionToggle = DoNotCompact);
+
+        // Backing stores for cells. Those of a page or more come from the
+        // large object space, and are freed by their owners. Smaller ones
+        // come from the copied space, where freeing does nothing: they stay
+        // put until a collection finds them dead, and a cell that holds one
+        // must pass it to SlotVisitor::visitStorage() when it is visited.
+        // Reallocation keeps the first usedBytes of the old storage. None of
+        // these can trigger a collection.
+        void* allocateStorage(const JSCell* owner, size_t);
+        void* tryAllocateStorage(const JSCell* owner, size_t);
+        bool tryReallocateStorage(const JSCell* owner, void*& storage, size_t usedBytes, size_t newSize);
+        void freeStorage(const JSCell* owner, void*);
+        void didMoveStorage(void*, const JSCell* oldOwner, const JSCell* newOwner);
 
         void reportExtraMemoryCost(size_t cost);
 
+#if ENABLE(DFG_JIT)
+        // Takes optimized code that its executable has thrown away, and
+        // deletes it after a collection finds no call frame running it.
+        void jettisonDFGCodeBlock(PassOwnPtr<CodeBlock>);
+#endif
+
         void protect(JSValue);
         bool unprotect(JSValue); // True when the protect count drops to 0.
 
@@ -108,6 +152,20 @@ namespace JSC {
         PassOwnPtr<TypeCountSet> protectedObjectTypeCounts();
         PassOwnPtr<TypeCountSet> objectTypeCounts();
 
+        // Blocks whose dead cells were destroyed when the allocator reached
+        // them, and blocks swept ahead of the allocator by the sweeper thread.
+        size_t blocksSweptOnAllocation() const { return m_blocksSweptOnAllocation; }
+        size_t blocksSweptInBackground() const { return m_blocksSweptInBackground; }
+
+        // One entry for each size class that has blocks, to tell how much a
+        // compacting collection could give back.
+        void getSizeClassStatistics(Vector<NewSpace::SizeClassStatistics>&);
+
+        // Collects all garbage, then writes every live cell and root to the
+        // writer. Returns false if the heap cannot be collected right now,
+        // or if writing failed.
+        bool writeSnapshot(HeapSnapshotWriter&);
+
         void pushTempSortVector(Vector<ValueStringPair>*);
         void popTempSortVector(Vector<ValueStringPair>*);
     
@@ -136,8 +194,16 @@ namespace JSC {
         
         enum AllocationEffort { AllocationMustSucceed, AllocationCanFail };
         
+        // An eden collection only traces cells allocated since the last
+        // collection, starting from the roots and the remembered set.
+        enum CollectionType { EdenCollection, FullCollection };
+
 #if ENABLE(GGC)
-        static void writeBarrierFastCase(const JSCell* owner, JSCell*);
+        static void writeBarrierFastCase(const JSCell* owner);
+#endif
+#if ENABLE(INCREMENTAL_MARKING)
+        static void shadeIfMarkingIncrementally(const JSCell* owner, JSCell*);
+        void shade(JSCell*);
 #endif
 
         bool isValidAllocation(size_t);
@@ -149,24 +215,60 @@ namespace JSC {
         void freeBlocks(MarkedBlock*);
 
         void clearMarks();
-        void markRoots();
+        void clearYoungMarks();
+        void markRoots(CollectionType);
+        void visitRememberedSet(SlotVisitor&);
+        void clearCards();
+        void ageMarkedCells();
+        void verifyMarking();
         void markProtectedObjects(HeapRootVisitor&);
         void markTempSortVectors(HeapRootVisitor&);
         void harvestWeakReferences();
 
         void* tryAllocate(NewSpace::SizeClass&);
         void* allocateSlowCase(NewSpace::SizeClass&);
+
+#if ENABLE(INCREMENTAL_MARKING)
+        // Marking may be spread over the allocations that follow the point
+        // where a collection is due. Each new block pays for one slice of
+        // marking, and collect() finishes the job in one last pause.
+        void beginIncrementalMarking(CollectionType);
+        bool markIncrementally();
+        void* allocateWhileMarkingIncrementally(NewSpace::SizeClass&);
+        void revisitCellsMutatedDuringMarking(SlotVisitor&);
+        void didMarkIncrementally(double sliceTime);
+#endif
         
         enum SweepToggle { DoNotSweep, DoSweep };
-        void collect(SweepToggle);
+        void collect(SweepToggle, CompactionToggle = DoNotCompact);
+        CollectionType collectionTypeFor(SweepToggle);
+        void compact();
+        void pinCellsThatCannotMove();
+        void updateReferencesToMovedCells();
         void shrink();
         void releaseFreeBlocks();
-        void sweep();
+        void willSweepForAllocation(MarkedBlock*);
+
+        // The size class statistics are taken once blocks are canonical, at
+        // the start of a collection, and again once marking and compaction
+        // are done.
+        void beginCollectionStatistics(CollectionType);
+        void countSurvivorsForStatistics();
+        void endCollectionStatistics(double pauseTime);
+
+#if ENABLE(CONCURRENT_SWEEPING)
+        // After a collection, the sweeper thread destroys dead cells ahead of
+        // the allocator, in blocks whose destructors are safe to run off the
+        // main thread. It must be stopped before anything reads or changes
+        // mark bits again.
+        void startSweepingInBackground();
+        void stopSweepingInBackground();
+        void sweeperThreadMain();
+        static void* sweeperThreadStartFunc(void* heap);
+#endif
 
         RegisterFile& registerFile();
 
-        static void writeBarrierSlowCase(const JSCell*, JSCell*);
-
 #if ENABLE(LAZY_BLOCK_FREEING)
         void waitForRelativeTimeWhileHoldingLock(double relative);
         void waitForRelativeTime(double relative);
@@ -180,6 +282,8 @@ namespace JSC {
         OperationInProgress m_operationInProgress;
         NewSpace m_newSpace;
         MarkedBlockSet m_blocks;
+        LargeObjectSpace m_largeObjectSpace;
+        CopiedSpace m_copiedSpace;
 
 #if ENABLE(LAZY_BLOCK_FREEING)
         DoublyLinkedList<MarkedBlock> m_freeBlocks;
@@ -191,22 +295,59 @@ namespace JSC {
         bool m_blockFreeingThreadShouldQuit;
 #endif
 
+#if ENABLE(CONCURRENT_SWEEPING)
+        HashSet<MarkedBlock*> m_blocksToSweep;
+        MarkedBlock* m_blockBeingSwept;
+        bool m_isSweepingInBackground;
+
+        ThreadIdentifier m_sweeperThread;
+        Mutex m_sweeperLock;
+        ThreadCondition m_sweeperCondition;
+        bool m_sweeperThreadShouldQuit;
+#endif
+        size_t m_blocksSweptOnAllocation;
+        size_t m_blocksSweptInBackground;
+
+#if ENABLE(JSC_MULTIPLE_THREADS)
+        typedef HashMap<ThreadIdentifier, NewSpace::AllocationCache*> AllocationCacheMap;
+        ThreadIdentifier m_allocatingThread;
+        AllocationCacheMap m_allocationCaches;
+#endif
+
 #if ENABLE(SIMPLE_HEAP_PROFILING)
         VTableSpectrum m_destroyedTypeCounts;
 #endif
 
         size_t m_extraCost;
 
+        size_t m_sizeAfterLastCollection;
+        size_t m_sizeAfterLastFullCollection;
+
+#if ENABLE(INCREMENTAL_MARKING)
+        bool m_isMarkingIncrementally;
+        CollectionType m_incrementalCollectionType;
+        Vector<MarkedBlock*> m_blocksAllocatedDuringMarking;
+#endif
+
         ProtectCountSet m_protectedValues;
         Vector<Vector<ValueStringPair>* > m_tempSortingVectors;
         HashSet<MarkedArgumentBuffer*>* m_markListSet;
 
         OwnPtr<GCActivityCallback> m_activityCallback;
+
+        GCStatistics m_collectionStatistics; // Of the collection in progress.
+        GCStatistics m_lastCollectionStatistics;
+        OwnPtr<GCStatisticsObserver> m_statisticsObserver;
         
         MachineThreads m_machineThreads;
+        
+        MarkStackThreadSharedData m_sharedData;
         SlotVisitor m_slotVisitor;
         HandleHeap m_handleHeap;
         HandleStack m_handleStack;
+#if ENABLE(DFG_JIT)
+        DFGCodeBlocks m_dfgCodeBlocks;
+#endif
         
         bool m_isSafeToCollect;
 
@@ -235,6 +376,11 @@ namespace JSC {
         return MarkedBlock::blockFor(cell)->isMarked(cell);
     }
 
+    inline void Heap::pin(const JSCell* cell)
+    {
+        MarkedBlock::blockFor(cell)->pin();
+    }
+
     inline bool Heap::testAndSetMarked(const void* cell)
     {
         return MarkedBlock::blockFor(cell)->testAndSetMarked(cell);
@@ -251,17 +397,34 @@ namespace JSC {
     }
 
 #if ENABLE(GGC)
-    inline void Heap::writeBarrierFastCase(const JSCell* owner, JSCell* cell)
+    inline void Heap::writeBarrierFastCase(const JSCell* owner)
     {
-        if (MarkedBlock::blockFor(owner)->inNewSpace())
-            return;
-        writeBarrierSlowCase(owner, cell);
+        MarkedBlock::blockFor(owner)->markCardFor(owner);
     }
 
+#if ENABLE(INCREMENTAL_MARKING)
+    // While marking is in progress, a cell that is stored into the heap gets
+    // marked right away (Dijkstra's insertion barrier), so that an owner that
+    // has already been visited is never left pointing at an unmarked cell.
+    // Stores made by JIT code only dirty the owner's card; finishing marking
+    // visits those owners again.
+    inline void Heap::shadeIfMarkingIncrementally(const JSCell* owner, JSCell* cell)
+    {
+        Heap* heap = MarkedBlock::blockFor(owner)->heap();
+        if (UNLIKELY(heap->m_isMarkingIncrementally))
+            heap->shade(cell);
+    }
+#endif
+
     inline void Heap::writeBarrier(const JSCell* owner, JSCell* cell)
     {
         WriteBarrierCounters::countWriteBarrier();
-        writeBarrierFastCase(owner, cell);
+        if (!cell)
+            return;
+        writeBarrierFastCase(owner);
+#if ENABLE(INCREMENTAL_MARKING)
+        shadeIfMarkingIncrementally(owner, cell);
+#endif
     }
 
     inline void Heap::writeBarrier(const JSCell* owner, JSValue value)
@@ -271,7 +434,18 @@ namespace JSC {
             return;
         if (!value.isCell())
             return;
-        writeBarrierFastCase(owner, value.asCell());
+        writeBarrierFastCase(owner);
+#if ENABLE(INCREMENTAL_MARKING)
+        shadeIfMarkingIncrementally(owner, value.asCell());
+#endif
+    }
+
+    // For mutations of an owner that are not stores through a barriered slot,
+    // such as handing it freshly generated code that refers to other cells.
+    inline void Heap::writeBarrier(const JSCell* owner)
+    {
+        WriteBarrierCounters::countWriteBarrier();
+        writeBarrierFastCase(owner);
     }
 #else
 
@@ -284,6 +458,11 @@ namespace JSC {
     {
         WriteBarrierCounters::countWriteBarrier();
     }
+
+    inline void Heap::writeBarrier(const JSCell*)
+    {
+        WriteBarrierCounters::countWriteBarrier();
+    }
 #endif
 
     inline void Heap::reportExtraMemoryCost(size_t cost)
@@ -362,22 +541,6 @@ namespace JSC {
         return allocate(sizeClass);
     }
 
-    inline void* Heap::allocatePropertyStorage(size_t bytes)
-    {
-        ASSERT(!(bytes % sizeof(JSValue)));
-        if (bytes >= NewSpace::PropertyStorageNurserySize)
-            return 0;
-        if (void* result = m_newSpace.allocatePropertyStorage(bytes))
-            return result;
-        collect(DoNotSweep);
-        return m_newSpace.allocatePropertyStorage(bytes);
-    }
-    
-    inline bool Heap::inPropertyStorageNursery(void* ptr)
-    {
-        return m_newSpace.inPropertyStorageNursery(ptr);
-    }
-
 } // namespace JSC
 
 #endif // Heap_h
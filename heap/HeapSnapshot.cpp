@@ -0,0 +1,604 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "HeapSnapshot.h"
+
+#include "ClassInfo.h"
+#include "JSCell.h"
+#include "Structure.h"
+#include <algorithm>
+#include <limits.h>
+#include <string.h>
+
+namespace JSC {
+
+namespace {
+
+const char magic[] = "JSCHEAP";
+const size_t magicLength = sizeof(magic) - 1;
+const size_t currentVersion = 1;
+
+enum SnapshotRecord { EndRecord, ClassRecord, CellRecord, RootsRecord };
+
+const char unknownClassName[] = "[unknown]";
+const char rootsClassName[] = "[roots]";
+
+const unsigned notFound = UINT_MAX;
+
+} // namespace
+
+HeapSnapshotWriter::HeapSnapshotWriter(WriteFunction writeFunction, void* context)
+    : m_writeFunction(writeFunction)
+    , m_context(context)
+    , m_failed(false)
+    , m_unknownClassIndex(notFound)
+    , m_cell(0)
+    , m_storageSize(0)
+    , m_bufferUsed(0)
+{
+}
+
+void HeapSnapshotWriter::addBlock(MarkedBlock* block)
+{
+    m_blockIndices.add(block, m_blockIndices.size());
+}
+
+void HeapSnapshotWriter::begin()
+{
+    writeBytes(magic, magicLength);
+    writeNumber(currentVersion);
+    writeNumber(MarkedBlock::atomsPerBlock);
+    writeNumber(m_blockIndices.size());
+}
+
+void HeapSnapshotWriter::beginRoots()
+{
+    ASSERT(!m_cell);
+    m_edges.shrink(0);
+}
+
+void HeapSnapshotWriter::addRoot(JSCell* cell)
+{
+    ASSERT(!m_cell);
+    addEdge(cell);
+}
+
+void HeapSnapshotWriter::endRoots()
+{
+    writeNumber(RootsRecord);
+    writeEdges(m_edges);
+}
+
+void HeapSnapshotWriter::beginCell(JSCell* cell)
+{
+    ASSERT(!m_cell);
+    m_cell = cell;
+    m_storageSize = 0;
+    m_edges.shrink(0); // Keeps the capacity, so that most cells do not allocate.
+}
+
+void HeapSnapshotWriter::endCell()
+{
+    ASSERT(m_cell);
+    unsigned id;
+    bool isInSnapshot = cellID(m_cell, id);
+    ASSERT_UNUSED(isInSnapshot, isInSnapshot);
+
+    // The class record has to come first.
+    unsigned index = classIndex(m_cell->classInfo());
+    writeNumber(CellRecord);
+    writeNumber(id);
+    writeNumber(index);
+    writeNumber(MarkedBlock::blockFor(m_cell)->cellSize() + m_storageSize);
+    writeEdges(m_edges);
+    m_cell = 0;
+}
+
+bool HeapSnapshotWriter::end()
+{
+    writeNumber(EndRecord);
+    flush();
+    return !m_failed;
+}
+
+void HeapSnapshotWriter::observeSlot(JSValue* slot)
+{
+    JSValue value = *slot;
+    if (value && value.isCell())
+        addEdge(value.asCell());
+}
+
+void HeapSnapshotWriter::observeSlot(JSCell** slot)
+{
+    if (*slot)
+        addEdge(*slot);
+}
+
+void HeapSnapshotWriter::observeStorage(void*, size_t bytes)
+{
+    if (m_cell)
+        m_storageSize += bytes;
+}
+
+void HeapSnapshotWriter::addEdge(JSCell* cell)
+{
+    unsigned id;
+    if (cellID(cell, id))
+        m_edges.append(id);
+}
+
+bool HeapSnapshotWriter::cellID(JSCell* cell, unsigned& id)
+{
+    MarkedBlock* block = MarkedBlock::blockFor(cell);
+    HashMap<MarkedBlock*, unsigned>::iterator it = m_blockIndices.find(block);
+    if (it == m_blockIndices.end())
+        return false;
+    size_t atom = (reinterpret_cast<char*>(cell) - reinterpret_cast<char*>(block)) / MarkedBlock::atomSize;
+    id = it->second * MarkedBlock::atomsPerBlock + atom;
+    return true;
+}
+
+unsigned HeapSnapshotWriter::classIndex(const ClassInfo* info)
+{
+    const char* name;
+    unsigned index;
+    if (info && info->className) {
+        HashMap<const ClassInfo*, unsigned>::iterator it = m_classIndices.find(info);
+        if (it != m_classIndices.end())
+            return it->second;
+        index = m_classIndices.size() + (m_unknownClassIndex != notFound);
+        m_classIndices.add(info, index);
+        name = info->className;
+    } else {
+        if (m_unknownClassIndex != notFound)
+            return m_unknownClassIndex;
+        index = m_unknownClassIndex = m_classIndices.size();
+        name = unknownClassName;
+    }
+
+    size_t length = strlen(name);
+    writeNumber(ClassRecord);
+    writeNumber(index);
+    writeNumber(length);
+    writeBytes(name, length);
+    return index;
+}
+
+void HeapSnapshotWriter::writeEdges(Vector<unsigned>& edges)
+{
+    std::sort(edges.begin(), edges.end());
+    size_t count = std::unique(edges.begin(), edges.end()) - edges.begin();
+    writeNumber(count);
+    unsigned previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        writeNumber(edges[i] - previous);
+        previous = edges[i];
+    }
+}
+
+void HeapSnapshotWriter::writeNumber(size_t number)
+{
+    char bytes[(sizeof(size_t) * 8 + 6) / 7];
+    size_t length = 0;
+    do {
+        char byte = number & 0x7f;
+        number >>= 7;
+        if (number)
+            byte |= 0x80;
+        bytes[length++] = byte;
+    } while (number);
+    writeBytes(bytes, length);
+}
+
+void HeapSnapshotWriter::writeBytes(const void* data, size_t length)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (length) {
+        if (m_bufferUsed == bufferSize)
+            flush();
+        size_t chunk = std::min(length, bufferSize - m_bufferUsed);
+        memcpy(m_buffer + m_bufferUsed, bytes, chunk);
+        m_bufferUsed += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+}
+
+void HeapSnapshotWriter::flush()
+{
+    if (m_bufferUsed && !m_failed && !m_writeFunction(m_buffer, m_bufferUsed, m_context))
+        m_failed = true;
+    m_bufferUsed = 0;
+}
+
+class HeapSnapshot::Reader {
+public:
+    Reader(ReadFunction readFunction, void* context)
+        : m_readFunction(readFunction)
+        , m_context(context)
+        , m_position(0)
+        , m_end(0)
+    {
+    }
+
+    bool readByte(unsigned char& byte)
+    {
+        if (m_position == m_end) {
+            m_position = 0;
+            m_end = m_readFunction(m_buffer, sizeof(m_buffer), m_context);
+            if (!m_end)
+                return false;
+        }
+        byte = m_buffer[m_position++];
+        return true;
+    }
+
+    bool readBytes(char* bytes, size_t length)
+    {
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char byte;
+            if (!readByte(byte))
+                return false;
+            bytes[i] = byte;
+        }
+        return true;
+    }
+
+    bool readNumber(size_t& number)
+    {
+        number = 0;
+        for (size_t shift = 0; shift < sizeof(size_t) * 8; shift += 7) {
+            unsigned char byte;
+            if (!readByte(byte))
+                return false;
+            number |= static_cast<size_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    ReadFunction m_readFunction;
+    void* m_context;
+    size_t m_position;
+    size_t m_end;
+    unsigned char m_buffer[16 * 1024];
+};
+
+HeapSnapshot::HeapSnapshot()
+{
+}
+
+unsigned HeapSnapshot::addNode(unsigned classIndex, size_t selfSize)
+{
+    m_classIndices.append(classIndex);
+    m_selfSizes.append(selfSize);
+    m_edgeOffsets.append(m_edges.size());
+    return m_classIndices.size() - 1;
+}
+
+bool HeapSnapshot::read(ReadFunction readFunction, void* context)
+{
+    Reader reader(readFunction, context);
+
+    char header[magicLength];
+    size_t version;
+    size_t atomsPerBlock;
+    size_t blockCount;
+    if (!reader.readBytes(header, magicLength) || memcmp(header, magic, magicLength))
+        return false;
+    if (!reader.readNumber(version) || version != currentVersion)
+        return false;
+    if (!reader.readNumber(atomsPerBlock) || !reader.readNumber(blockCount))
+        return false;
+    if (blockCount && atomsPerBlock > (notFound - 1) / blockCount)
+        return false;
+
+    m_classNames.clear();
+    m_classIndices.clear();
+    m_selfSizes.clear();
+    m_edgeOffsets.clear();
+    m_edges.clear();
+    m_dominators.clear();
+    m_retainedSizes.clear();
+
+    // The roots are node 0, and their class is class 0.
+    m_classNames.append(CString(rootsClassName));
+    addNode(0, 0);
+
+    Vector<unsigned> classForIndex;
+    Vector<unsigned> nodeForID;
+    nodeForID.fill(notFound, atomsPerBlock * blockCount);
+    Vector<unsigned> rootIDs;
+
+    while (true) {
+        size_t record;
+        if (!reader.readNumber(record))
+            return false;
+
+        if (record == EndRecord)
+            break;
+
+        if (record == ClassRecord) {
+            size_t index;
+            size_t length;
+            if (!reader.readNumber(index) || index != classForIndex.size() || !reader.readNumber(length))
+                return false;
+            char* name;
+            CString className = CString::newUninitialized(length, name);
+            if (!reader.readBytes(name, length))
+                return false;
+            // Distinct classes can share a name, as the functions do.
+            size_t existingClass = 1;
+            while (existingClass < m_classNames.size() && m_classNames[existingClass] != className)
+                ++existingClass;
+            if (existingClass == m_classNames.size())
+                m_classNames.append(className);
+            classForIndex.append(existingClass);
+            continue;
+        }
+
+        Vector<unsigned>* edges;
+        if (record == CellRecord) {
+            size_t id;
+            size_t index;
+            size_t size;
+            if (!reader.readNumber(id) || id >= nodeForID.size() || nodeForID[id] != notFound)
+                return false;
+            if (!reader.readNumber(index) || index >= classForIndex.size() || !reader.readNumber(size))
+                return false;
+            nodeForID[id] = addNode(classForIndex[index], size);
+            edges = &m_edges;
+        } else if (record == RootsRecord)
+            edges = &rootIDs;
+        else
+            return false;
+
+        size_t count;
+        if (!reader.readNumber(count))
+            return false;
+        size_t id = 0;
+        for (size_t i = 0; i < count; ++i) {
+            size_t delta;
+            if (!reader.readNumber(delta))
+                return false;
+            id += delta;
+            if (id >= nodeForID.size())
+                return false;
+            edges->append(id);
+        }
+    }
+
+    // Now that every cell has a node, edges can refer to nodes rather than
+    // ids. The roots' edges go first, since the roots are node 0.
+    Vector<unsigned> edges;
+    Vector<unsigned> edgeOffsets;
+    edges.reserveCapacity(rootIDs.size() + m_edges.size());
+    edgeOffsets.reserveCapacity(nodeCount() + 1);
+    edgeOffsets.append(0);
+    for (size_t i = 0; i < rootIDs.size(); ++i) {
+        if (nodeForID[rootIDs[i]] != notFound)
+            edges.append(nodeForID[rootIDs[i]]);
+    }
+    m_edgeOffsets.append(m_edges.size());
+    for (unsigned node = 1; node < nodeCount(); ++node) {
+        edgeOffsets.append(edges.size());
+        for (size_t i = m_edgeOffsets[node]; i < m_edgeOffsets[node + 1]; ++i) {
+            if (nodeForID[m_edges[i]] != notFound)
+                edges.append(nodeForID[m_edges[i]]);
+        }
+    }
+    edgeOffsets.append(edges.size());
+    m_edges.swap(edges);
+    m_edgeOffsets.swap(edgeOffsets);
+    return true;
+}
+
+void HeapSnapshot::computePostOrder(Vector<unsigned>& postOrder, Vector<unsigned>& postOrderIndex)
+{
+    unsigned count = nodeCount();
+    postOrder.shrink(0);
+    postOrder.reserveCapacity(count);
+    postOrderIndex.fill(notFound, count);
+
+    Vector<std::pair<unsigned, unsigned> > stack;
+    postOrderIndex[0] = 0; // Seen, numbered when it is finished.
+    stack.append(std::make_pair(0u, m_edgeOffsets[0]));
+    while (!stack.isEmpty()) {
+        unsigned node = stack.last().first;
+        unsigned nextEdge = stack.last().second;
+        if (nextEdge < m_edgeOffsets[node + 1]) {
+            stack.last().second++;
+            unsigned successor = m_edges[nextEdge];
+            if (postOrderIndex[successor] == notFound) {
+                postOrderIndex[successor] = 0;
+                stack.append(std::make_pair(successor, m_edgeOffsets[successor]));
+            }
+            continue;
+        }
+        postOrderIndex[node] = postOrder.size();
+        postOrder.append(node);
+        stack.removeLast();
+    }
+}
+
+static unsigned intersect(const Vector<unsigned>& dominators, const Vector<unsigned>& postOrderIndex, unsigned a, unsigned b)
+{
+    while (a != b) {
+        while (postOrderIndex[a] < postOrderIndex[b])
+            a = dominators[a];
+        while (postOrderIndex[b] < postOrderIndex[a])
+            b = dominators[b];
+    }
+    return a;
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm". Heap
+// graphs are shallow enough that it settles in a few passes.
+void HeapSnapshot::computeDominators()
+{
+    unsigned count = nodeCount();
+    Vector<unsigned> postOrder;
+    Vector<unsigned> postOrderIndex;
+    computePostOrder(postOrder, postOrderIndex);
+
+    if (postOrder.size() < count) {
+        // Whatever the roots do not reach is held by the roots directly.
+        Vector<unsigned> unreachable;
+        for (unsigned node = 1; node < count; ++node) {
+            if (postOrderIndex[node] == notFound)
+                unreachable.append(node);
+        }
+        Vector<unsigned> edges;
+        edges.reserveCapacity(m_edges.size() + unreachable.size());
+        edges.append(m_edges.data(), m_edgeOffsets[1]);
+        edges.append(unreachable.data(), unreachable.size());
+        edges.append(m_edges.data() + m_edgeOffsets[1], m_edges.size() - m_edgeOffsets[1]);
+        m_edges.swap(edges);
+        for (unsigned node = 1; node <= count; ++node)
+            m_edgeOffsets[node] += unreachable.size();
+        computePostOrder(postOrder, postOrderIndex);
+    }
+    ASSERT(postOrder.size() == count);
+    ASSERT(postOrder.last() == 0);
+
+    Vector<unsigned> predecessorOffsets;
+    predecessorOffsets.fill(0, count + 1);
+    for (size_t i = 0; i < m_edges.size(); ++i)
+        predecessorOffsets[m_edges[i] + 1]++;
+    for (unsigned node = 0; node < count; ++node)
+        predecessorOffsets[node + 1] += predecessorOffsets[node];
+    Vector<unsigned> predecessors;
+    predecessors.resize(m_edges.size());
+    {
+        Vector<unsigned> nextPredecessor;
+        nextPredecessor.append(predecessorOffsets.data(), count);
+        for (unsigned node = 0; node < count; ++node) {
+            for (size_t i = m_edgeOffsets[node]; i < m_edgeOffsets[node + 1]; ++i)
+                predecessors[nextPredecessor[m_edges[i]]++] = node;
+        }
+    }
+
+    m_dominators.fill(notFound, count);
+    m_dominators[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        // Reverse post order, leaving out the roots, which come last.
+        for (size_t i = count - 1; i--;) {
+            unsigned node = postOrder[i];
+            unsigned dominator = notFound;
+            for (size_t j = predecessorOffsets[node]; j < predecessorOffsets[node + 1]; ++j) {
+                unsigned predecessor = predecessors[j];
+                if (m_dominators[predecessor] == notFound)
+                    continue;
+                dominator = dominator == notFound ? predecessor : intersect(m_dominators, postOrderIndex, predecessor, dominator);
+            }
+            if (m_dominators[node] != dominator) {
+                m_dominators[node] = dominator;
+                changed = true;
+            }
+        }
+    }
+
+    // A node comes before its dominator in post order.
+    m_retainedSizes = m_selfSizes;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        unsigned node = postOrder[i];
+        m_retainedSizes[m_dominators[node]] += m_retainedSizes[node];
+    }
+}
+
+static bool hasLargerRetainedSize(const HeapSnapshot::ClassSummary& a, const HeapSnapshot::ClassSummary& b)
+{
+    return a.retainedSize > b.retainedSize;
+}
+
+void HeapSnapshot::summarizeByClass(Vector<ClassSummary>& result) const
+{
+    ASSERT(m_dominators.size() == nodeCount());
+    unsigned count = nodeCount();
+
+    Vector<ClassSummary> summaries;
+    summaries.resize(m_classNames.size());
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        summaries[i].className = m_classNames[i].data();
+        summaries[i].count = 0;
+        summaries[i].selfSize = 0;
+        summaries[i].retainedSize = 0;
+    }
+
+    // Walk the dominator tree, counting a cell's retained size towards its
+    // class only if no cell of the same class dominates it.
+    Vector<unsigned> childOffsets;
+    childOffsets.fill(0, count + 1);
+    for (unsigned node = 1; node < count; ++node)
+        childOffsets[m_dominators[node] + 1]++;
+    for (unsigned node = 0; node < count; ++node)
+        childOffsets[node + 1] += childOffsets[node];
+    Vector<unsigned> children;
+    children.resize(count ? count - 1 : 0);
+    {
+        Vector<unsigned> nextChild;
+        nextChild.append(childOffsets.data(), count);
+        for (unsigned node = 1; node < count; ++node)
+            children[nextChild[m_dominators[node]]++] = node;
+    }
+
+    Vector<unsigned> dominatingCellsOfClass;
+    dominatingCellsOfClass.fill(0, m_classNames.size());
+    Vector<std::pair<unsigned, unsigned> > stack;
+    stack.append(std::make_pair(0u, childOffsets[0]));
+    while (!stack.isEmpty()) {
+        unsigned node = stack.last().first;
+        unsigned nextChild = stack.last().second;
+        if (nextChild < childOffsets[node + 1]) {
+            stack.last().second++;
+            unsigned child = children[nextChild];
+            ClassSummary& summary = summaries[m_classIndices[child]];
+            summary.count++;
+            summary.selfSize += m_selfSizes[child];
+            if (!dominatingCellsOfClass[m_classIndices[child]]++)
+                summary.retainedSize += m_retainedSizes[child];
+            stack.append(std::make_pair(child, childOffsets[child]));
+            continue;
+        }
+        if (node)
+            dominatingCellsOfClass[m_classIndices[node]]--;
+        stack.removeLast();
+    }
+
+    result.clear();
+    for (size_t i = 1; i < summaries.size(); ++i) {
+        if (summaries[i].count)
+            result.append(summaries[i]);
+    }
+    std::sort(result.begin(), result.end(), hasLargerRetainedSize);
+}
+
+} // namespace JSC
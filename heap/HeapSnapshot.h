@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HeapSnapshot_h
+#define HeapSnapshot_h
+
+#include "MarkStack.h"
+#include "MarkedBlock.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include <wtf/text/CString.h>
+
+namespace JSC {
+
+    struct ClassInfo;
+
+    // A heap snapshot records every live cell: its class, its size including
+    // the backing stores it owns, and the cells it points to, plus the cells
+    // the roots point to. It is written record by record while the heap is
+    // walked, so taking one needs no more memory than the largest cell's
+    // list of edges. Analysing it happens offline, with HeapSnapshot.
+    //
+    // The format is a stream of unsigned LEB128 numbers. A cell's id is the
+    // index of its block in the snapshot times the atoms per block, plus its
+    // atom in the block, which keeps ids small. Edge lists are sorted and
+    // stored as deltas.
+    //
+    //   header: "JSCHEAP" version atomsPerBlock blockCount
+    //   ClassRecord: 1 classIndex nameLength nameBytes
+    //   CellRecord:  2 id classIndex size edgeCount edgeDelta*
+    //   RootsRecord: 3 rootCount rootDelta*
+    //   EndRecord:   0
+    //
+    // A class record comes before the first cell of its class.
+    class HeapSnapshotWriter : public SlotObserver {
+        WTF_MAKE_NONCOPYABLE(HeapSnapshotWriter);
+    public:
+        // Returns false if the data could not be written, which abandons
+        // the rest of the snapshot.
+        typedef bool (*WriteFunction)(const void* data, size_t, void* context);
+
+        HeapSnapshotWriter(WriteFunction, void* context);
+
+        // Driven by Heap::writeSnapshot(). Every block must be added before
+        // the snapshot begins.
+        void addBlock(MarkedBlock*);
+        void begin();
+        void beginRoots();
+        void addRoot(JSCell*);
+        void endRoots();
+        void beginCell(JSCell*);
+        void endCell();
+        bool end(); // False if writing failed.
+
+        virtual void observeSlot(JSValue*);
+        virtual void observeSlot(JSCell**);
+        virtual void observeStorage(void*, size_t);
+
+    private:
+        static const size_t bufferSize = 16 * 1024;
+
+        void addEdge(JSCell*);
+        bool cellID(JSCell*, unsigned& id);
+        unsigned classIndex(const ClassInfo*);
+        void writeEdges(Vector<unsigned>&);
+        void writeNumber(size_t);
+        void writeBytes(const void*, size_t);
+        void flush();
+
+        WriteFunction m_writeFunction;
+        void* m_context;
+        bool m_failed;
+
+        HashMap<MarkedBlock*, unsigned> m_blockIndices;
+        HashMap<const ClassInfo*, unsigned> m_classIndices;
+        unsigned m_unknownClassIndex; // For cells without a class name.
+
+        JSCell* m_cell; // 0 while visiting roots.
+        size_t m_storageSize;
+        Vector<unsigned> m_edges;
+
+        size_t m_bufferUsed;
+        char m_buffer[bufferSize];
+    };
+
+    // A snapshot read back for analysis, with each cell's immediate dominator
+    // and retained size: the memory that would be freed if nothing but its
+    // dominator pointed to it. Node 0 stands for the roots. Cells that only
+    // weak handles, opaque roots or other unrecorded roots keep alive are
+    // unreachable in the snapshot, and are counted as held by the roots.
+    class HeapSnapshot {
+        WTF_MAKE_NONCOPYABLE(HeapSnapshot);
+    public:
+        // Returns the number of bytes read, which is less than asked for
+        // only at the end of the data.
+        typedef size_t (*ReadFunction)(void* buffer, size_t, void* context);
+
+        HeapSnapshot();
+
+        bool read(ReadFunction, void* context); // False if the data is malformed.
+        void computeDominators();
+
+        unsigned nodeCount() const { return m_classIndices.size(); }
+        const char* className(unsigned node) const { return m_classNames[m_classIndices[node]].data(); }
+        size_t selfSize(unsigned node) const { return m_selfSizes[node]; }
+        size_t retainedSize(unsigned node) const { return m_retainedSizes[node]; }
+        unsigned dominator(unsigned node) const { return m_dominators[node]; }
+
+        struct ClassSummary {
+            const char* className;
+            size_t count;
+            size_t selfSize;
+            size_t retainedSize; // Of the cells no other cell of the class dominates.
+        };
+        void summarizeByClass(Vector<ClassSummary>&) const; // Largest retained size first.
+
+    private:
+        class Reader;
+
+        unsigned addNode(unsigned classIndex, size_t selfSize);
+        void computePostOrder(Vector<unsigned>& postOrder, Vector<unsigned>& postOrderIndex);
+
+        Vector<CString> m_classNames;
+        Vector<unsigned> m_classIndices;
+        Vector<size_t> m_selfSizes;
+        Vector<unsigned> m_edgeOffsets; // A node's edges end where the next node's begin.
+        Vector<unsigned> m_edges;
+        Vector<unsigned> m_dominators;
+        Vector<size_t> m_retainedSizes;
+    };
+
+} // namespace JSC
+
+#endif // HeapSnapshot_h
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "config.h"
+#include "LargeObjectSpace.h"
+
+#include <new>
+
+namespace JSC {
+
+LargeObjectSpace::Allocation* LargeObjectSpace::Allocation::create(const void* owner, size_t size)
+{
+    size_t capacity = (headerSize() + size + pageSize() - 1) & ~(pageSize() - 1);
+    PageAllocation pages = PageAllocation::allocate(capacity, OSAllocator::JSGCHeapPages);
+    if (!static_cast<bool>(pages))
+        return 0;
+    return new (pages.base()) Allocation(pages, owner, size);
+}
+
+void LargeObjectSpace::Allocation::destroy()
+{
+    PageAllocation pages = m_pages;
+    this->~Allocation();
+    pages.deallocate();
+}
+
+LargeObjectSpace::LargeObjectSpace()
+    : m_size(0)
+    , m_capacity(0)
+{
+}
+
+LargeObjectSpace::~LargeObjectSpace()
+{
+    HashSet<Allocation*>::iterator end = m_allocations.end();
+    for (HashSet<Allocation*>::iterator it = m_allocations.begin(); it != end; ++it)
+        (*it)->destroy();
+}
+
+void* LargeObjectSpace::tryAllocate(const void* owner, size_t size)
+{
+    ASSERT(size >= minimumAllocationSize());
+
+    Allocation* allocation = Allocation::create(owner, size);
+    if (!allocation)
+        return 0;
+
+    MutexLocker locker(m_lock);
+    m_allocations.add(allocation);
+    m_size += allocation->size();
+    m_capacity += allocation->capacity();
+    return allocation->payload();
+}
+
+void LargeObjectSpace::free(void* payload)
+{
+    Allocation* allocation = Allocation::from(payload);
+    {
+        MutexLocker locker(m_lock);
+        ASSERT(m_allocations.contains(allocation));
+        m_allocations.remove(allocation);
+        m_size -= allocation->size();
+        m_capacity -= allocation->capacity();
+    }
+    allocation->destroy();
+}
+
+bool LargeObjectSpace::isOwnedBy(const void* payload, const void* owner)
+{
+    // Storage from the copied space can only pass this check by starting a
+    // page plus a header in, which lets most frees skip the lock.
+    if (!mayContain(payload))
+        return false;
+
+    MutexLocker locker(m_lock);
+    Allocation* allocation = Allocation::from(payload);
+    return m_allocations.contains(allocation) && allocation->owner() == owner;
+}
+
+void LargeObjectSpace::setOwner(void* payload, const void* owner)
+{
+    MutexLocker locker(m_lock);
+    ASSERT(m_allocations.contains(Allocation::from(payload)));
+    Allocation::from(payload)->setOwner(owner);
+}
+
+size_t LargeObjectSpace::size()
+{
+    MutexLocker locker(m_lock);
+    return m_size;
+}
+
+size_t LargeObjectSpace::capacity()
+{
+    MutexLocker locker(m_lock);
+    return m_capacity;
+}
+
+} // namespace JSC
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef LargeObjectSpace_h
+#define LargeObjectSpace_h
+
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PageAllocation.h>
+#include <wtf/Threading.h>
+
+namespace JSC {
+
+    // Backing stores of a page or more are given pages of their own, rather
+    // than being malloced, so that they are returned to the system as soon as
+    // they are freed and counted in the heap's size. The owning cell frees its
+    // storage when it is destroyed, which may happen on the sweeper thread.
+    //
+    // A dead cell may still point into a copied block that a collection has
+    // given back to the system, and those pages may since have been handed
+    // out again for an allocation here. Each allocation therefore remembers
+    // its owner, and only the owner is allowed to free it.
+    class LargeObjectSpace {
+        WTF_MAKE_NONCOPYABLE(LargeObjectSpace);
+    public:
+        LargeObjectSpace();
+        ~LargeObjectSpace();
+
+        static size_t minimumAllocationSize() { return pageSize(); }
+
+        void* tryAllocate(const void* owner, size_t);
+        void free(void*);
+        bool isOwnedBy(const void* payload, const void* owner);
+        void setOwner(void* payload, const void* owner);
+
+        size_t size(); // Bytes asked for by live allocations.
+        size_t capacity(); // Bytes of pages held by live allocations.
+
+    private:
+        class Allocation {
+        public:
+            static Allocation* create(const void* owner, size_t);
+            void destroy();
+
+            static Allocation* from(const void* payload) { return reinterpret_cast<Allocation*>(static_cast<char*>(const_cast<void*>(payload)) - headerSize()); }
+            static size_t headerSize() { return (sizeof(Allocation) + 15) & ~static_cast<size_t>(15); }
+
+            void* payload() { return reinterpret_cast<char*>(this) + headerSize(); }
+            size_t size() { return m_size; }
+            size_t capacity() { return m_pages.size(); }
+            const void* owner() { return m_owner; }
+            void setOwner(const void* owner) { m_owner = owner; }
+
+        private:
+            Allocation(const PageAllocation& pages, const void* owner, size_t size)
+                : m_pages(pages)
+                , m_owner(owner)
+                , m_size(size)
+            {
+            }
+
+            PageAllocation m_pages;
+            const void* m_owner;
+            size_t m_size;
+        };
+
+        bool mayContain(const void* payload) { return (reinterpret_cast<uintptr_t>(payload) & (pageSize() - 1)) == Allocation::headerSize(); }
+
+        Mutex m_lock;
+        HashSet<Allocation*> m_allocations;
+        size_t m_size;
+        size_t m_capacity;
+    };
+
+} // namespace JSC
+
+#endif // LargeObjectSpace_h
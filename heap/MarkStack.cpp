@@ -31,19 +31,125 @@
 #include "Heap.h"
 #include "JSArray.h"
 #include "JSCell.h"
+#include "JSGlobalData.h"
 #include "JSObject.h"
 #include "ScopeChain.h"
 #include "Structure.h"
+#include <wtf/CurrentTime.h>
 
 namespace JSC {
 
+// Reading the clock is not free, so incremental marking only checks its
+// deadline after visiting this many cells.
+static const unsigned numberOfScansBetweenDeadlineChecks = 64;
+
+MarkStackThreadSharedData::MarkStackThreadSharedData(JSGlobalData* globalData)
+    : m_globalData(globalData)
+    , m_numberOfGCMarkers(1)
+#if ENABLE(PARALLEL_GC)
+    , m_markingThreadsStarted(false)
+    , m_numberOfActiveParallelMarkers(0)
+    , m_parallelMarkersShouldExit(false)
+#endif
+    , m_firstWeakReferenceHarvester(0)
+{
+}
+
+MarkStackThreadSharedData::~MarkStackThreadSharedData()
+{
+#if ENABLE(PARALLEL_GC)
+    // Destroy our marking threads.
+    {
+        MutexLocker locker(m_markingLock);
+        m_parallelMarkersShouldExit = true;
+        m_markingCondition.broadcast();
+    }
+    for (unsigned i = 0; i < m_markingThreads.size(); ++i)
+        waitForThreadCompletion(m_markingThreads[i], 0);
+#endif
+}
+
+void MarkStackThreadSharedData::startMarkingThreadsIfNecessary()
+{
+#if ENABLE(PARALLEL_GC)
+    if (m_markingThreadsStarted)
+        return;
+    m_markingThreadsStarted = true;
+
+    // The collecting thread is always one of the markers.
+    for (unsigned i = 1; i < Options::numberOfGCMarkers; ++i) {
+        ThreadIdentifier markingThread = createThread(markingThreadStartFunc, this, "JavaScriptCore::Marking");
+        if (!markingThread)
+            break;
+        m_markingThreads.append(markingThread);
+    }
+    m_numberOfGCMarkers = m_markingThreads.size() + 1;
+#endif
+}
+
+void MarkStackThreadSharedData::reset()
+{
+#if ENABLE(PARALLEL_GC)
+    ASSERT(m_sharedMarkStack.isEmpty());
+    ASSERT(!m_numberOfActiveParallelMarkers);
+    m_sharedMarkStack.shrinkAllocation(pageSize());
+    m_opaqueRoots.clear();
+#endif
+}
+
+#if ENABLE(PARALLEL_GC)
+void MarkStackThreadSharedData::markingThreadMain()
+{
+    SlotVisitor slotVisitor(*this);
+    ParallelModeEnabler enabler(slotVisitor);
+    slotVisitor.drainFromShared(SlotVisitor::SlaveDrain);
+}
+
+void* MarkStackThreadSharedData::markingThreadStartFunc(void* shared)
+{
+    static_cast<MarkStackThreadSharedData*>(shared)->markingThreadMain();
+    return 0;
+}
+#endif
+
+MarkStack::MarkStack(MarkStackThreadSharedData& shared)
+    : m_jsArrayVPtr(shared.m_globalData->jsArrayVPtr)
+    , m_shared(shared)
+    , m_isInParallelMode(false)
+    , m_slotObserver(0)
+#if !ASSERT_DISABLED
+    , m_isCheckingForDefaultMarkViolation(false)
+    , m_isDraining(false)
+#endif
+{
+}
+
 void MarkStack::reset()
 {
     m_values.shrinkAllocation(pageSize());
     m_markSets.shrinkAllocation(pageSize());
+#if ENABLE(PARALLEL_GC)
+    ASSERT(m_opaqueRoots.isEmpty()); // Should have merged by now.
+#else
     m_opaqueRoots.clear();
+#endif
 }
 
+#if ENABLE(PARALLEL_GC)
+void MarkStack::mergeOpaqueRoots()
+{
+    ASSERT(!m_opaqueRoots.isEmpty()); // Should only be called when opaque roots are non-empty.
+    {
+        MutexLocker locker(m_shared.m_opaqueRootsLock);
+        HashSet<void*>::iterator begin = m_opaqueRoots.begin();
+        HashSet<void*>::iterator end = m_opaqueRoots.end();
+        for (HashSet<void*>::iterator iter = begin; iter != end; ++iter)
+            m_shared.m_opaqueRoots.add(*iter);
+    }
+    m_opaqueRoots.clear();
+}
+#endif
+
 void MarkStack::append(ConservativeRoots& conservativeRoots)
 {
     JSCell** roots = conservativeRoots.roots();
@@ -133,6 +239,16 @@ void SlotVisitor::drain()
 
             visitChildren(cell);
         }
+#if ENABLE(PARALLEL_GC)
+        if (m_isInParallelMode) {
+            while (!m_values.isEmpty()) {
+                for (unsigned countdown = Options::minimumNumberOfScansBetweenRebalance; !m_values.isEmpty() && countdown--;)
+                    visitChildren(m_values.removeLast());
+                donate();
+            }
+            continue;
+        }
+#endif
         while (!m_values.isEmpty())
             visitChildren(m_values.removeLast());
     }
@@ -141,17 +257,189 @@ void SlotVisitor::drain()
 #endif
 }
 
+inline void SlotVisitor::appendMarkSet(const MarkSet& markSet)
+{
+    for (JSValue* value = markSet.m_values; value != markSet.m_end; ++value) {
+        if (*value)
+            internalAppend(*value);
+    }
+}
+
+bool SlotVisitor::drainUntil(double deadline, unsigned maximumNumberOfCells)
+{
+    ASSERT(!m_isInParallelMode);
+#if !ASSERT_DISABLED
+    ASSERT(!m_isDraining);
+    m_isDraining = true;
+#endif
+    unsigned numberOfCellsVisited = 0;
+    while (!m_markSets.isEmpty() || !m_values.isEmpty()) {
+        if (m_values.isEmpty())
+            appendMarkSet(m_markSets.removeLast());
+        for (unsigned countdown = numberOfScansBetweenDeadlineChecks; !m_values.isEmpty() && countdown--;) {
+            visitChildren(m_values.removeLast());
+            numberOfCellsVisited++;
+        }
+        if (maximumNumberOfCells && numberOfCellsVisited >= maximumNumberOfCells)
+            break;
+        if (monotonicallyIncreasingTime() >= deadline)
+            break;
+    }
+
+    // Mark sets point into storage that the mutator may reallocate before the
+    // next slice, so the cells in them have to be queued before we return.
+    while (!m_markSets.isEmpty())
+        appendMarkSet(m_markSets.removeLast());
+
+#if ENABLE(PARALLEL_GC)
+    if (!m_opaqueRoots.isEmpty())
+        mergeOpaqueRoots();
+#endif
+#if !ASSERT_DISABLED
+    m_isDraining = false;
+#endif
+    return m_values.isEmpty();
+}
+
+void SlotVisitor::donateSlow()
+{
+#if ENABLE(PARALLEL_GC)
+    // Refuse to donate if shared has more entries than I do.
+    if (m_shared.m_sharedMarkStack.size() > m_values.size())
+        return;
+    // Someone else is already balancing; keep marking rather than wait for them.
+    if (!m_shared.m_markingLock.tryLock())
+        return;
+    if (m_values.donateSomeCellsTo(m_shared.m_sharedMarkStack, Options::minimumNumberOfCellsToKeep)) {
+        // Only wake up threads if the shared stack is big enough; otherwise assume that
+        // it's more profitable for us to just scan this ourselves later.
+        if (m_shared.m_sharedMarkStack.size() >= Options::sharedStackWakeupThreshold)
+            m_shared.m_markingCondition.broadcast();
+    }
+    m_shared.m_markingLock.unlock();
+#endif
+}
+
+void SlotVisitor::drainFromShared(SharedDrainMode sharedDrainMode)
+{
+    ASSERT(m_isInParallelMode);
+
+#if ENABLE(PARALLEL_GC)
+    if (m_shared.m_numberOfGCMarkers == 1) {
+        drain();
+        return;
+    }
+
+    {
+        MutexLocker locker(m_shared.m_markingLock);
+        m_shared.m_numberOfActiveParallelMarkers++;
+    }
+    while (true) {
+        // Publish our opaque roots before admitting that we are out of work, so
+        // that they are all visible to the collecting thread once marking terminates.
+        if (!m_opaqueRoots.isEmpty())
+            mergeOpaqueRoots();
+
+        {
+            MutexLocker locker(m_shared.m_markingLock);
+            m_shared.m_numberOfActiveParallelMarkers--;
+
+            // How we wait differs depending on drain mode.
+            if (sharedDrainMode == MasterDrain) {
+                // Wait until either termination is reached, or until there is some work
+                // for us to do.
+                while (true) {
+                    // Did we reach termination?
+                    if (!m_shared.m_numberOfActiveParallelMarkers && m_shared.m_sharedMarkStack.isEmpty())
+                        return;
+
+                    // Is there work to be done?
+                    if (!m_shared.m_sharedMarkStack.isEmpty())
+                        break;
+
+                    // Otherwise wait.
+                    m_shared.m_markingCondition.wait(m_shared.m_markingLock);
+                }
+            } else {
+                ASSERT(sharedDrainMode == SlaveDrain);
+
+                // Did we detect termination? If so, let the master know.
+                if (!m_shared.m_numberOfActiveParallelMarkers && m_shared.m_sharedMarkStack.isEmpty())
+                    m_shared.m_markingCondition.broadcast();
+
+                while (m_shared.m_sharedMarkStack.isEmpty() && !m_shared.m_parallelMarkersShouldExit)
+                    m_shared.m_markingCondition.wait(m_shared.m_markingLock);
+
+                // Is the VM exiting? If so, exit this thread.
+                if (m_shared.m_parallelMarkersShouldExit)
+                    return;
+            }
+
+            size_t idleThreadCount = m_shared.m_numberOfGCMarkers - m_shared.m_numberOfActiveParallelMarkers;
+            m_values.stealSomeCellsFrom(m_shared.m_sharedMarkStack, idleThreadCount);
+            m_shared.m_numberOfActiveParallelMarkers++;
+        }
+
+        drain();
+    }
+#else
+    UNUSED_PARAM(sharedDrainMode);
+    drain();
+#endif
+}
+
 void SlotVisitor::harvestWeakReferences()
 {
-    while (m_firstWeakReferenceHarvester) {
-        WeakReferenceHarvester* current = m_firstWeakReferenceHarvester;
+    while (m_shared.m_firstWeakReferenceHarvester) {
+        WeakReferenceHarvester* current = m_shared.m_firstWeakReferenceHarvester;
         WeakReferenceHarvester* next = reinterpret_cast<WeakReferenceHarvester*>(current->m_nextAndFlag & ~1);
         current->m_nextAndFlag = 0;
-        m_firstWeakReferenceHarvester = next;
+        m_shared.m_firstWeakReferenceHarvester = next;
         current->visitWeakReferences(*this);
     }
 }
 
+void* SlotVisitor::visitStorage(void* storage, size_t bytes)
+{
+    if (UNLIKELY(m_slotObserver))
+        m_slotObserver->observeStorage(storage, bytes);
+    return m_shared.m_globalData->heap.copiedSpace().visitStorage(m_copyAllocator, storage, bytes);
+}
+
+void SlotVisitor::beginObserving(SlotObserver* observer)
+{
+    ASSERT(!m_isInParallelMode);
+    ASSERT(!m_slotObserver);
+    m_slotObserver = observer;
+}
+
+void SlotVisitor::revisit(JSCell* cell)
+{
+    ASSERT(m_slotObserver);
+    visitChildren(cell);
+
+    // Nothing is left to mark, so this only retires the mark sets the cell
+    // appended, before they pile up over a walk of the whole heap.
+    drain();
+    ASSERT(m_values.isEmpty());
+}
+
+void SlotVisitor::endObserving()
+{
+    ASSERT(m_slotObserver);
+
+    // Roots may have appended mark sets too, and weak reference harvesters
+    // were queued again.
+    drain();
+    ASSERT(m_values.isEmpty());
+    harvestWeakReferences();
+#if ENABLE(PARALLEL_GC)
+    if (!m_opaqueRoots.isEmpty())
+        mergeOpaqueRoots();
+#endif
+    m_slotObserver = 0;
+}
+
 #if ENABLE(GC_VALIDATION)
 void MarkStack::validateSet(JSValue* values, size_t count)
 {
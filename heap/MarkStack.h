@@ -29,6 +29,7 @@
 
 #include "HandleTypes.h"
 #include "JSValue.h"
+#include "Options.h"
 #include "Register.h"
 #include "VTableSpectrum.h"
 #include "WeakReferenceHarvester.h"
@@ -38,6 +39,7 @@
 #include <wtf/Noncopyable.h>
 #include <wtf/OSAllocator.h>
 #include <wtf/PageBlock.h>
+#include <wtf/Threading.h>
 
 namespace JSC {
 
@@ -45,9 +47,28 @@ namespace JSC {
     class JSGlobalData;
     class MarkStack;
     class Register;
+    class SlotVisitor;
     template<typename T> class WriteBarrierBase;
     template<typename T> class JITWriteBarrier;
     
+    // Passes that run after marking, such as updating references to moved
+    // cells or writing a heap snapshot, revisit cells with a SlotVisitor that
+    // shows every slot it is given to an observer. The observer may change
+    // the slot before the visitor looks at it.
+    class SlotObserver {
+    public:
+        virtual ~SlotObserver() { }
+        virtual void observeSlot(JSValue*) = 0;
+        virtual void observeSlot(JSCell**) = 0;
+        virtual void observeStorage(void*, size_t) { }
+
+        void observeSlots(JSValue* slots, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+                observeSlot(&slots[i]);
+        }
+    };
+
     struct MarkSet {
         MarkSet(JSValue* values, JSValue* end);
 
@@ -71,6 +92,9 @@ namespace JSC {
 
         void shrinkAllocation(size_t);
 
+        bool donateSomeCellsTo(MarkStackArray& other, size_t numberOfCellsToKeep);
+        void stealSomeCellsFrom(MarkStackArray& other, size_t idleThreadCount);
+
     private:
         size_t m_top;
         size_t m_allocated;
@@ -78,6 +102,53 @@ namespace JSC {
         T* m_data;
     };
 
+    // State shared by all of the SlotVisitors that take part in a collection:
+    // the marking threads, the shared pool of cells that they balance work
+    // through, and the opaque roots and weak reference harvesters that any of
+    // them may discover.
+    class MarkStackThreadSharedData {
+        WTF_MAKE_NONCOPYABLE(MarkStackThreadSharedData);
+    public:
+        MarkStackThreadSharedData(JSGlobalData*);
+        ~MarkStackThreadSharedData();
+
+        // Marking threads are created lazily so that embedders may choose the
+        // number of markers after the heap has been created.
+        void startMarkingThreadsIfNecessary();
+        void reset();
+
+        unsigned numberOfGCMarkers() const { return m_numberOfGCMarkers; }
+
+    private:
+        friend class MarkStack;
+        friend class SlotVisitor;
+
+#if ENABLE(PARALLEL_GC)
+        void markingThreadMain();
+        static void* markingThreadStartFunc(void* shared);
+#endif
+
+        JSGlobalData* m_globalData;
+        unsigned m_numberOfGCMarkers;
+
+#if ENABLE(PARALLEL_GC)
+        bool m_markingThreadsStarted;
+        Vector<ThreadIdentifier> m_markingThreads;
+
+        Mutex m_markingLock;
+        ThreadCondition m_markingCondition;
+        MarkStackArray<JSCell*> m_sharedMarkStack;
+        unsigned m_numberOfActiveParallelMarkers;
+        bool m_parallelMarkersShouldExit;
+
+        Mutex m_opaqueRootsLock;
+        HashSet<void*> m_opaqueRoots;
+
+        Mutex m_weakReferenceHarvesterLock;
+#endif
+        WeakReferenceHarvester* m_firstWeakReferenceHarvester;
+    };
+
     class MarkStack {
         WTF_MAKE_NONCOPYABLE(MarkStack);
         friend class HeapRootVisitor; // Allowed to mark a JSValue* or JSCell** directly.
@@ -86,7 +157,7 @@ namespace JSC {
         static void* allocateStack(size_t);
         static void releaseStack(void*, size_t);
 
-        MarkStack(void* jsArrayVPtr);
+        MarkStack(MarkStackThreadSharedData&);
         ~MarkStack();
 
         void append(ConservativeRoots&);
@@ -98,6 +169,10 @@ namespace JSC {
         template<typename T>
         inline void appendUnbarrieredPointer(T**);
         
+        // Old cells are already marked when an eden collection starts; this
+        // queues one that was written to so that its children get visited.
+        void appendRememberedCell(JSCell*);
+
         bool addOpaqueRoot(void*);
         bool containsOpaqueRoot(void*);
         int opaqueRootCount();
@@ -110,10 +185,13 @@ namespace JSC {
 
         void addWeakReferenceHarvester(WeakReferenceHarvester* weakReferenceHarvester)
         {
+#if ENABLE(PARALLEL_GC)
+            MutexLocker locker(m_shared.m_weakReferenceHarvesterLock);
+#endif
             if (weakReferenceHarvester->m_nextAndFlag & 1)
                 return;
-            weakReferenceHarvester->m_nextAndFlag = reinterpret_cast<uintptr_t>(m_firstWeakReferenceHarvester) | 1;
-            m_firstWeakReferenceHarvester = weakReferenceHarvester;
+            weakReferenceHarvester->m_nextAndFlag = reinterpret_cast<uintptr_t>(m_shared.m_firstWeakReferenceHarvester) | 1;
+            m_shared.m_firstWeakReferenceHarvester = weakReferenceHarvester;
         }
 
     protected:
@@ -129,11 +207,19 @@ namespace JSC {
         void internalAppend(JSCell*);
         void internalAppend(JSValue);
 
+#if ENABLE(PARALLEL_GC)
+        void mergeOpaqueRoots();
+        void mergeOpaqueRootsIfProfitable();
+#endif
+
         void* m_jsArrayVPtr;
         MarkStackArray<MarkSet> m_markSets;
         MarkStackArray<JSCell*> m_values;
         HashSet<void*> m_opaqueRoots; // Handle-owning data structures not visible to the garbage collector.
-        WeakReferenceHarvester* m_firstWeakReferenceHarvester;
+
+        MarkStackThreadSharedData& m_shared;
+        bool m_isInParallelMode;
+        SlotObserver* m_slotObserver;
         
 #if !ASSERT_DISABLED
     public:
@@ -142,16 +228,6 @@ namespace JSC {
 #endif
     };
 
-    inline MarkStack::MarkStack(void* jsArrayVPtr)
-        : m_jsArrayVPtr(jsArrayVPtr)
-        , m_firstWeakReferenceHarvester(0)
-#if !ASSERT_DISABLED
-        , m_isCheckingForDefaultMarkViolation(false)
-        , m_isDraining(false)
-#endif
-    {
-    }
-
     inline MarkStack::~MarkStack()
     {
         ASSERT(m_markSets.isEmpty());
@@ -160,19 +236,51 @@ namespace JSC {
 
     inline bool MarkStack::addOpaqueRoot(void* root)
     {
+#if ENABLE(PARALLEL_GC)
+        if (m_shared.m_numberOfGCMarkers == 1) {
+            // Put directly into the shared HashSet.
+            return m_shared.m_opaqueRoots.add(root).second;
+        }
+        // Put into the local set, but merge with the shared one every once in
+        // a while to make sure that the local sets don't grow too large.
+        mergeOpaqueRootsIfProfitable();
         return m_opaqueRoots.add(root).second;
+#else
+        return m_opaqueRoots.add(root).second;
+#endif
     }
 
     inline bool MarkStack::containsOpaqueRoot(void* root)
     {
+        ASSERT(!m_isInParallelMode);
+#if ENABLE(PARALLEL_GC)
+        ASSERT(m_opaqueRoots.isEmpty());
+        return m_shared.m_opaqueRoots.contains(root);
+#else
         return m_opaqueRoots.contains(root);
+#endif
     }
 
     inline int MarkStack::opaqueRootCount()
     {
+        ASSERT(!m_isInParallelMode);
+#if ENABLE(PARALLEL_GC)
+        ASSERT(m_opaqueRoots.isEmpty());
+        return m_shared.m_opaqueRoots.size();
+#else
         return m_opaqueRoots.size();
+#endif
     }
 
+#if ENABLE(PARALLEL_GC)
+    inline void MarkStack::mergeOpaqueRootsIfProfitable()
+    {
+        if (static_cast<unsigned>(m_opaqueRoots.size()) < Options::opaqueRootMergeThreshold)
+            return;
+        mergeOpaqueRoots();
+    }
+#endif
+
     inline MarkSet::MarkSet(JSValue* values, JSValue* end)
             : m_values(values)
             , m_end(end)
@@ -264,10 +372,45 @@ namespace JSC {
         m_capacity = m_allocated / sizeof(T);
     }
 
+    template <typename T> inline bool MarkStackArray<T>::donateSomeCellsTo(MarkStackArray<T>& other, size_t numberOfCellsToKeep)
+    {
+        if (m_top <= numberOfCellsToKeep)
+            return false;
+
+        // Hand over half of what we can spare from the bottom of the stack. Those
+        // cells were discovered first, so they tend to lead to the largest amount
+        // of further work for whoever picks them up.
+        size_t numberOfCellsToDonate = (m_top - numberOfCellsToKeep + 1) / 2;
+        while (other.m_capacity - other.m_top < numberOfCellsToDonate)
+            other.expand();
+        memcpy(other.m_data + other.m_top, m_data, numberOfCellsToDonate * sizeof(T));
+        other.m_top += numberOfCellsToDonate;
+        m_top -= numberOfCellsToDonate;
+        memmove(m_data, m_data + numberOfCellsToDonate, m_top * sizeof(T));
+        return true;
+    }
+
+    template <typename T> inline void MarkStackArray<T>::stealSomeCellsFrom(MarkStackArray<T>& other, size_t idleThreadCount)
+    {
+        ASSERT(idleThreadCount);
+        ASSERT(!other.isEmpty());
+
+        // Split the other stack evenly between the threads that are waiting for
+        // work, rounding up so that we always take at least one cell.
+        size_t numberOfCellsToSteal = (other.m_top + idleThreadCount - 1) / idleThreadCount;
+        while (m_capacity - m_top < numberOfCellsToSteal)
+            expand();
+        other.m_top -= numberOfCellsToSteal;
+        memcpy(m_data + m_top, other.m_data + other.m_top, numberOfCellsToSteal * sizeof(T));
+        m_top += numberOfCellsToSteal;
+    }
+
     inline void MarkStack::append(JSValue* slot, size_t count)
     {
         if (!count)
             return;
+        if (UNLIKELY(m_slotObserver))
+            m_slotObserver->observeSlots(slot, count);
 #if ENABLE(GC_VALIDATION)
         validateSet(slot, count);
 #endif
@@ -278,6 +421,8 @@ namespace JSC {
     inline void MarkStack::appendUnbarrieredPointer(T** slot)
     {
         ASSERT(slot);
+        if (UNLIKELY(m_slotObserver))
+            m_slotObserver->observeSlot(reinterpret_cast<JSCell**>(slot));
         JSCell* value = *slot;
         if (value)
             internalAppend(value);
@@ -286,12 +431,16 @@ namespace JSC {
     ALWAYS_INLINE void MarkStack::append(JSValue* value)
     {
         ASSERT(value);
+        if (UNLIKELY(m_slotObserver))
+            m_slotObserver->observeSlot(value);
         internalAppend(*value);
     }
 
     ALWAYS_INLINE void MarkStack::append(JSCell** value)
     {
         ASSERT(value);
+        if (UNLIKELY(m_slotObserver))
+            m_slotObserver->observeSlot(value);
         internalAppend(*value);
     }
 
@@ -305,8 +454,6 @@ namespace JSC {
             internalAppend(value.asCell());
     }
 
-    class SlotVisitor;
-
 } // namespace JSC
 
 #endif
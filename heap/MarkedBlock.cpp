@@ -57,6 +57,10 @@ void MarkedBlock::initForCellSize(size_t cellSize)
 {
     m_atomsPerCell = (cellSize + atomSize - 1) / atomSize;
     m_endAtom = atomsPerBlock - m_atomsPerCell + 1;
+    m_stickyMarks.clearAll();
+    m_marksWhenMarkingBegan.clearAll();
+    m_isPinned = false;
+    clearCards();
     setDestructorState(SomeFreeCellsStillHaveObjects);
 }
 
@@ -137,6 +141,26 @@ void MarkedBlock::sweep()
     }
 }
 
+bool MarkedBlock::sweepConcurrently()
+{
+    if (!needsSweep())
+        return false;
+
+    // Final objects and arrays only free memory that belongs to them when
+    // they die. Other destructors may touch shared state, such as the ref
+    // counts of strings, so blocks holding those are left for the allocator.
+    for (size_t i = firstAtom(); i < m_endAtom; i += m_atomsPerCell) {
+        if (m_marks.get(i))
+            continue;
+        void* vptr = reinterpret_cast<JSCell*>(&atoms()[i])->vptr();
+        if (vptr && vptr != JSGlobalData::jsFinalObjectVPtr && vptr != JSGlobalData::jsArrayVPtr)
+            return false;
+    }
+
+    sweep();
+    return true;
+}
+
 template<MarkedBlock::DestructorState specializedDestructorState>
 ALWAYS_INLINE MarkedBlock::FreeCell* MarkedBlock::produceFreeList()
 {
@@ -175,6 +199,8 @@ MarkedBlock::FreeCell* MarkedBlock::lazySweep()
     // order of the free list.
     
     HEAP_DEBUG_BLOCK(this);
+
+    m_heap->willSweepForAllocation(this);
     
     switch (destructorState()) {
     case FreeCellsDontHaveObjects:
@@ -67,7 +67,12 @@ namespace JSC {
         static const size_t blockSize = 16 * KB;
 
         static const size_t atomsPerBlock = blockSize / atomSize; // ~1.5% overhead
-        static const size_t ownerSetsPerBlock = 8; // ~2% overhead.
+
+        // The write barrier records stores into a cell by dirtying the card
+        // that holds the start of the cell.
+        static const size_t bytesPerCard = 512; // bytesPerCard must be a power of two.
+        static const size_t log2BytesPerCard = 9;
+        static const size_t cardsPerBlock = blockSize / bytesPerCard; // ~0.2% overhead
 
         struct FreeCell {
             FreeCell* next;
@@ -79,6 +84,15 @@ namespace JSC {
                 next = 0;
             }
         };
+
+        // What a compacting collection leaves behind in a cell whose contents
+        // it copied elsewhere, until every reference to the cell has been
+        // pointed at the copy. Like FreeCell, this relies on the first field
+        // falling where the vtable was, so that no destructor runs for it.
+        struct MovedCell {
+            void* noObject;
+            JSCell* destination;
+        };
         
         struct VoidFunctor {
             typedef void ReturnType;
@@ -99,6 +113,13 @@ namespace JSC {
 
         void* allocate();
         void sweep();
+
+        // True if there are dead cells whose destructors have not run yet.
+        bool needsSweep();
+
+        // Sweeps the block, unless one of its dead cells has a destructor that
+        // is unsafe to run off the main thread. Returns true if it swept.
+        bool sweepConcurrently();
         
         // This invokes destructors on all cells that are not marked, marks
         // them, and returns a linked list of those cells.
@@ -127,6 +148,7 @@ namespace JSC {
         size_t markCount();
 
         size_t cellSize();
+        size_t numberOfCells();
 
         size_t size();
         size_t capacity();
@@ -136,7 +158,37 @@ namespace JSC {
         bool testAndClearMarked(const void*);
         void setMarked(const void*);
 
+        // Unmarks a live cell that has been copied to destination, and leaves
+        // a MovedCell in its place.
+        void didMoveCell(JSCell*, JSCell* destination);
+
+        // A compacting collection moves no cell out of a pinned block. Blocks
+        // are pinned by conservative roots, and by anything else that holds a
+        // pointer to one of their cells where the collector cannot update it.
+        void pin();
+        void unpin();
+        bool isPinned();
+
+        // A cell is old if it survived the last collection. Eden collections
+        // keep every old cell alive, and only trace through the ones that
+        // have been written to since.
+        bool isOld(const void*);
+        void clearYoungMarks();
+        void ageMarkedCells();
+
+        void markCardFor(const void*);
+        void clearCards();
+        static ptrdiff_t offsetOfCards();
+
+        // Incremental marking clears the mark bits long before it finishes,
+        // so it keeps a copy of them to tell which cells were allocated when
+        // it rescans the roots at the end.
+        void snapshotMarks();
+        bool wasLiveWhenMarkingBegan(const void*);
+
         template <typename Functor> void forEachCell(Functor&);
+        template <typename Functor> void forEachRememberedCell(Functor&);
+        template <typename Functor> void forEachMarkedCellOnDirtyCard(Functor&);
 
     private:
         static const size_t blockMask = ~(blockSize - 1); // blockSize must be a power of two.
@@ -150,7 +202,9 @@ namespace JSC {
         Atom* atoms();
 
         size_t atomNumber(const void*);
-        size_t ownerSetNumber(const JSCell*);
+        size_t cardNumber(const void*);
+
+        template <typename Functor> void forEachCellOnDirtyCard(const WTF::Bitmap<atomsPerBlock>&, Functor&);
         
         template<DestructorState destructorState>
         void callDestructor(JSCell*, void* jsFinalObjectVPtr);
@@ -177,7 +231,11 @@ namespace JSC {
         size_t m_endAtom; // This is a fuzzy end. Always test for < m_endAtom.
         size_t m_atomsPerCell;
         WTF::Bitmap<blockSize / atomSize> m_marks;
+        WTF::Bitmap<blockSize / atomSize> m_stickyMarks;
+        WTF::Bitmap<blockSize / atomSize> m_marksWhenMarkingBegan;
+        uint8_t m_cards[cardsPerBlock];
         bool m_inNewSpace;
+        bool m_isPinned;
         int8_t m_destructorState; // use getters/setters for this, particularly since we may want to compact this (effectively log(3)/log(2)-bit) field into other fields
         PageAllocationAligned m_allocation;
         Heap* m_heap;
@@ -241,6 +299,11 @@ namespace JSC {
             setDestructorState(SomeFreeCellsStillHaveObjects);
     }
 
+    inline bool MarkedBlock::needsSweep()
+    {
+        return destructorState() != FreeCellsDontHaveObjects;
+    }
+
     inline bool MarkedBlock::isEmpty()
     {
         return m_marks.isEmpty();
@@ -261,6 +324,11 @@ namespace JSC {
         return m_atomsPerCell * atomSize;
     }
 
+    inline size_t MarkedBlock::numberOfCells()
+    {
+        return (m_endAtom - firstAtom() + m_atomsPerCell - 1) / m_atomsPerCell;
+    }
+
     inline size_t MarkedBlock::size()
     {
         return markCount() * cellSize();
@@ -283,7 +351,11 @@ namespace JSC {
 
     inline bool MarkedBlock::testAndSetMarked(const void* p)
     {
+#if ENABLE(PARALLEL_GC)
+        return m_marks.concurrentTestAndSet(atomNumber(p));
+#else
         return m_marks.testAndSet(atomNumber(p));
+#endif
     }
 
     inline bool MarkedBlock::testAndClearMarked(const void* p)
@@ -296,6 +368,78 @@ namespace JSC {
         m_marks.set(atomNumber(p));
     }
 
+    inline void MarkedBlock::didMoveCell(JSCell* cell, JSCell* destination)
+    {
+        m_marks.clear(atomNumber(cell));
+        MovedCell* movedCell = reinterpret_cast<MovedCell*>(cell);
+        movedCell->noObject = 0;
+        movedCell->destination = destination;
+
+        // The moved cell no longer has an object for the sweep to destroy.
+        if (destructorState() == AllFreeCellsHaveObjects)
+            setDestructorState(SomeFreeCellsStillHaveObjects);
+    }
+
+    inline void MarkedBlock::pin()
+    {
+        m_isPinned = true;
+    }
+
+    inline void MarkedBlock::unpin()
+    {
+        m_isPinned = false;
+    }
+
+    inline bool MarkedBlock::isPinned()
+    {
+        return m_isPinned;
+    }
+
+    inline bool MarkedBlock::isOld(const void* p)
+    {
+        return m_stickyMarks.get(atomNumber(p));
+    }
+
+    inline void MarkedBlock::clearYoungMarks()
+    {
+        m_marks = m_stickyMarks;
+    }
+
+    inline void MarkedBlock::ageMarkedCells()
+    {
+        m_stickyMarks = m_marks;
+    }
+
+    inline size_t MarkedBlock::cardNumber(const void* p)
+    {
+        return (reinterpret_cast<Bits>(p) - reinterpret_cast<Bits>(this)) >> log2BytesPerCard;
+    }
+
+    inline void MarkedBlock::markCardFor(const void* p)
+    {
+        m_cards[cardNumber(p)] = 1;
+    }
+
+    inline void MarkedBlock::clearCards()
+    {
+        memset(m_cards, 0, sizeof(m_cards));
+    }
+
+    inline ptrdiff_t MarkedBlock::offsetOfCards()
+    {
+        return OBJECT_OFFSETOF(MarkedBlock, m_cards);
+    }
+
+    inline void MarkedBlock::snapshotMarks()
+    {
+        m_marksWhenMarkingBegan = m_marks;
+    }
+
+    inline bool MarkedBlock::wasLiveWhenMarkingBegan(const void* p)
+    {
+        return m_marksWhenMarkingBegan.get(atomNumber(p));
+    }
+
     template <typename Functor> inline void MarkedBlock::forEachCell(Functor& functor)
     {
         for (size_t i = firstAtom(); i < m_endAtom; i += m_atomsPerCell) {
@@ -304,10 +448,40 @@ namespace JSC {
             functor(reinterpret_cast<JSCell*>(&atoms()[i]));
         }
     }
-    
-    inline size_t MarkedBlock::ownerSetNumber(const JSCell* cell)
+
+    template <typename Functor> inline void MarkedBlock::forEachRememberedCell(Functor& functor)
+    {
+        forEachCellOnDirtyCard(m_stickyMarks, functor);
+    }
+
+    template <typename Functor> inline void MarkedBlock::forEachMarkedCellOnDirtyCard(Functor& functor)
     {
-        return (reinterpret_cast<Bits>(cell) - reinterpret_cast<Bits>(this)) * ownerSetsPerBlock / blockSize;
+        forEachCellOnDirtyCard(m_marks, functor);
+    }
+
+    template <typename Functor> inline void MarkedBlock::forEachCellOnDirtyCard(const WTF::Bitmap<atomsPerBlock>& cells, Functor& functor)
+    {
+        static const size_t atomsPerCard = bytesPerCard / atomSize;
+
+        for (size_t card = 0; card < cardsPerBlock; ++card) {
+            if (!m_cards[card])
+                continue;
+
+            // Visit the cells that start in this card; the barrier marks the card
+            // holding the owner's header, no matter which of its fields was written.
+            size_t begin = card * atomsPerCard;
+            if (begin < firstAtom())
+                begin = firstAtom();
+            size_t end = (card + 1) * atomsPerCard;
+            if (end > m_endAtom)
+                end = m_endAtom;
+            size_t first = firstAtom() + (begin - firstAtom() + m_atomsPerCell - 1) / m_atomsPerCell * m_atomsPerCell;
+            for (size_t i = first; i < end; i += m_atomsPerCell) {
+                if (!cells.get(i))
+                    continue;
+                functor(reinterpret_cast<JSCell*>(&atoms()[i]));
+            }
+        }
     }
 
 } // namespace JSC
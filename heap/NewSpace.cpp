@@ -32,9 +32,7 @@ namespace JSC {
 class Structure;
 
 NewSpace::NewSpace(Heap* heap)
-    : m_propertyStorageNursery(static_cast<char*>(fastMalloc(PropertyStorageNurserySize)))
-    , m_propertyStorageAllocationPoint(m_propertyStorageNursery)
-    , m_waterMark(0)
+    : m_waterMark(0)
     , m_highWaterMark(0)
     , m_heap(heap)
 {
@@ -76,6 +74,15 @@ void NewSpace::resetAllocator()
         sizeClassFor(cellSize).resetAllocator();
 }
 
+void NewSpace::skipExistingBlocks()
+{
+    for (size_t cellSize = preciseStep; cellSize < preciseCutoff; cellSize += preciseStep)
+        sizeClassFor(cellSize).skipExistingBlocks();
+
+    for (size_t cellSize = impreciseStep; cellSize < impreciseCutoff; cellSize += impreciseStep)
+        sizeClassFor(cellSize).skipExistingBlocks();
+}
+
 void NewSpace::canonicalizeBlocks()
 {
     for (size_t cellSize = preciseStep; cellSize < preciseCutoff; cellSize += preciseStep)
@@ -85,4 +92,71 @@ void NewSpace::canonicalizeBlocks()
         sizeClassFor(cellSize).canonicalizeBlock();
 }
 
+void NewSpace::getSizeClassStatistics(Vector<SizeClassStatistics>& statistics)
+{
+    for (size_t i = 0; i < preciseCount + impreciseCount; ++i) {
+        SizeClass& sizeClass = i < preciseCount ? m_preciseSizeClasses[i] : m_impreciseSizeClasses[i - preciseCount];
+        if (sizeClass.blockList.isEmpty())
+            continue;
+
+        SizeClassStatistics entry = { sizeClass.cellSize, 0, 0, 0 };
+        for (MarkedBlock* block = sizeClass.blockList.head(); block; block = block->next()) {
+            entry.blockCount++;
+            entry.liveCellCount += block->markCount();
+            entry.cellCapacity += block->numberOfCells();
+        }
+        statistics.append(entry);
+    }
+}
+
+inline void NewSpace::saveAllocationCache(SizeClass& sizeClass, AllocationCache& cache)
+{
+    MarkedBlock* block = sizeClass.currentBlock;
+    if (!block)
+        return;
+
+    if (block == sizeClass.nextBlock) {
+        m_waterMark += block->capacity();
+        sizeClass.nextBlock = block->next();
+    }
+
+    if (sizeClass.firstFreeCell) {
+        AllocationCache::Entry entry = { &sizeClass, block, sizeClass.firstFreeCell };
+        cache.entries.append(entry);
+    }
+
+    sizeClass.currentBlock = 0;
+    sizeClass.firstFreeCell = 0;
+}
+
+void NewSpace::saveAllocationCache(AllocationCache& cache)
+{
+    ASSERT(cache.entries.isEmpty());
+
+    for (size_t cellSize = preciseStep; cellSize < preciseCutoff; cellSize += preciseStep)
+        saveAllocationCache(sizeClassFor(cellSize), cache);
+
+    for (size_t cellSize = impreciseStep; cellSize < impreciseCutoff; cellSize += impreciseStep)
+        saveAllocationCache(sizeClassFor(cellSize), cache);
+}
+
+void NewSpace::restoreAllocationCache(AllocationCache& cache)
+{
+    for (size_t i = 0; i < cache.entries.size(); ++i) {
+        AllocationCache::Entry& entry = cache.entries[i];
+        ASSERT(!entry.sizeClass->currentBlock);
+        ASSERT(!entry.sizeClass->firstFreeCell);
+        entry.sizeClass->currentBlock = entry.block;
+        entry.sizeClass->firstFreeCell = entry.firstFreeCell;
+    }
+    cache.entries.clear();
+}
+
+void NewSpace::canonicalizeAllocationCache(AllocationCache& cache)
+{
+    for (size_t i = 0; i < cache.entries.size(); ++i)
+        cache.entries[i].block->canonicalizeBlock(cache.entries[i].firstFreeCell);
+    cache.entries.clear();
+}
+
 } // namespace JSC
@@ -47,24 +47,11 @@ namespace JSC {
         WTF_MAKE_NONCOPYABLE(NewSpace);
     public:
         static const size_t maxCellSize = 1024;
-			
-		//+EAWebKitChange
-		//10/24/2011
-		// abaldeva: This looks like some unfinished code. This causes a 4 MB allocation and the NewSpace::allocatePropertyStorage
-		// code is not even called. This is because the code pasted below from the JSObject.cpp first tries to detect if the allocation
-		// came from the nursery and is the only source of allocation.
-		// Disabled this code for now.
-		//static const size_t PropertyStorageNurserySize = 4 * MB;
-		static const size_t PropertyStorageNurserySize = 0 * MB;
-		/* From JSObject.cpp
-		if (globalData.heap.inPropertyStorageNursery(m_propertyStorage.get())) {
-		newPropertyStorage = static_cast<PropertyStorage>(globalData.heap.allocatePropertyStorage(newSize * sizeof(WriteBarrierBase<Unknown>)));
-		*/
-		//-EAWebKitChange
 
         struct SizeClass {
             SizeClass();
             void resetAllocator();
+            void skipExistingBlocks();
             void canonicalizeBlock();
 
             MarkedBlock::FreeCell* firstFreeCell;
@@ -74,27 +61,60 @@ namespace JSC {
             size_t cellSize;
         };
 
+        // What one thread has left of the blocks it was allocating out of,
+        // kept aside while another thread that shares the heap allocates.
+        struct AllocationCache {
+            struct Entry {
+                SizeClass* sizeClass;
+                MarkedBlock* block;
+                MarkedBlock::FreeCell* firstFreeCell;
+            };
+            Vector<Entry> entries;
+        };
+
+        // How densely the blocks of one size class are filled. Blocks must
+        // be canonical for cells on free lists not to be counted as live.
+        struct SizeClassStatistics {
+            size_t cellSize;
+            size_t blockCount;
+            size_t liveCellCount;
+            size_t cellCapacity;
+        };
+
         NewSpace(Heap*);
 
         SizeClass& sizeClassFor(size_t);
         void* allocate(SizeClass&);
-        inline void* allocatePropertyStorage(size_t);
-        inline bool inPropertyStorageNursery(void* ptr);
-        inline void resetPropertyStorageNursery();
         
         void resetAllocator();
 
+        // While the heap is being marked incrementally, the mark bits of the
+        // existing blocks no longer tell free cells apart from live ones, so
+        // allocation has to move on to new blocks. Blocks must be canonical.
+        void skipExistingBlocks();
+
         void addBlock(SizeClass&, MarkedBlock*);
         void removeBlock(MarkedBlock*);
         
         void canonicalizeBlocks();
 
+        // Threads that share the heap each allocate out of blocks of their
+        // own. Saving takes the current blocks away from the allocator, and
+        // moves it past them, so that the next thread starts on fresh ones.
+        void saveAllocationCache(AllocationCache&);
+        void restoreAllocationCache(AllocationCache&);
+        void canonicalizeAllocationCache(AllocationCache&);
+
         size_t waterMark();
         size_t highWaterMark();
         void setHighWaterMark(size_t);
+        void addToWaterMark(size_t);
+
+        void getSizeClassStatistics(Vector<SizeClassStatistics>&);
 
         template<typename Functor> typename Functor::ReturnType forEachBlock(Functor&); // Safe to remove the current item while iterating.
         template<typename Functor> typename Functor::ReturnType forEachBlock();
+        template<typename Functor> void forEachSizeClass(Functor&);
 
     private:
         // [ 8, 16... 128 )
@@ -108,10 +128,10 @@ namespace JSC {
         static const size_t impreciseCutoff = maxCellSize;
         static const size_t impreciseCount = impreciseCutoff / impreciseStep - 1;
 
+        void saveAllocationCache(SizeClass&, AllocationCache&);
+
         SizeClass m_preciseSizeClasses[preciseCount];
         SizeClass m_impreciseSizeClasses[impreciseCount];
-        char* m_propertyStorageNursery;
-        char* m_propertyStorageAllocationPoint;
         size_t m_waterMark;
         size_t m_highWaterMark;
         Heap* m_heap;
@@ -132,6 +152,11 @@ namespace JSC {
         m_highWaterMark = highWaterMark;
     }
 
+    inline void NewSpace::addToWaterMark(size_t bytes)
+    {
+        m_waterMark += bytes;
+    }
+
     inline NewSpace::SizeClass& NewSpace::sizeClassFor(size_t bytes)
     {
         ASSERT(bytes && bytes < maxCellSize);
@@ -153,10 +178,13 @@ namespace JSC {
             //    should do a lazySweep for nextBlock. This also implies that
             //    currentBlock == 0.
             
+            // A block restored from an allocation cache has already been
+            // passed over by nextBlock, and counted towards the water mark.
             if (sizeClass.currentBlock) {
-                ASSERT(sizeClass.currentBlock == sizeClass.nextBlock);
-                m_waterMark += sizeClass.nextBlock->capacity();
-                sizeClass.nextBlock = sizeClass.nextBlock->next();
+                if (sizeClass.currentBlock == sizeClass.nextBlock) {
+                    m_waterMark += sizeClass.nextBlock->capacity();
+                    sizeClass.nextBlock = sizeClass.nextBlock->next();
+                }
                 sizeClass.currentBlock = 0;
             }
             
@@ -181,36 +209,6 @@ namespace JSC {
         return firstFreeCell;
     }
 
-    inline void NewSpace::resetPropertyStorageNursery()
-    {
-        m_propertyStorageAllocationPoint = m_propertyStorageNursery;
-    }
-    
-    inline void* NewSpace::allocatePropertyStorage(size_t size)
-    {
-		//+EAWebKitChange
-		//10/24/2011 - Added following to NewSpace::allocatePropertyStorage(size_t size) function as not expecting
-		// this code to be called.
-		ASSERT_NOT_REACHED();
-		//-EAWebKitChange
-
-		char* result = m_propertyStorageAllocationPoint;
-        if (size > PropertyStorageNurserySize)
-            CRASH();
-        m_propertyStorageAllocationPoint += size;
-        if (static_cast<size_t>(m_propertyStorageAllocationPoint - m_propertyStorageNursery) > PropertyStorageNurserySize) {
-            m_propertyStorageAllocationPoint = result;
-            return 0;
-        }
-        return result;
-    }
-
-    inline bool NewSpace::inPropertyStorageNursery(void* ptr)
-    {
-        char* addr = static_cast<char*>(ptr);
-        return static_cast<size_t>(addr - m_propertyStorageNursery) < PropertyStorageNurserySize;
-    }
-    
     template <typename Functor> inline typename Functor::ReturnType NewSpace::forEachBlock(Functor& functor)
     {
         for (size_t i = 0; i < preciseCount; ++i) {
@@ -240,6 +238,15 @@ namespace JSC {
         return forEachBlock(functor);
     }
 
+    template <typename Functor> inline void NewSpace::forEachSizeClass(Functor& functor)
+    {
+        for (size_t i = 0; i < preciseCount; ++i)
+            functor(m_preciseSizeClasses[i]);
+
+        for (size_t i = 0; i < impreciseCount; ++i)
+            functor(m_impreciseSizeClasses[i]);
+    }
+
     inline NewSpace::SizeClass::SizeClass()
         : firstFreeCell(0)
         , currentBlock(0)
@@ -253,6 +260,13 @@ namespace JSC {
         nextBlock = blockList.head();
     }
     
+    inline void NewSpace::SizeClass::skipExistingBlocks()
+    {
+        ASSERT(!currentBlock);
+        ASSERT(!firstFreeCell);
+        nextBlock = 0;
+    }
+    
     inline void NewSpace::SizeClass::canonicalizeBlock()
     {
         if (currentBlock) {
@@ -26,26 +26,102 @@
 #ifndef SlotVisitor_h
 #define SlotVisitor_h
 
+#include "CopiedSpace.h"
 #include "MarkStack.h"
 
 namespace JSC {
 
 class SlotVisitor : public MarkStack {
+    friend class ParallelModeEnabler;
 public:
-    SlotVisitor(void* jsArrayVPtr);
+    SlotVisitor(MarkStackThreadSharedData&);
 
+    void donate();
     void drain();
+    void donateAndDrain();
+    
+    enum SharedDrainMode { SlaveDrain, MasterDrain };
+    void drainFromShared(SharedDrainMode);
+
+    // Drains on this thread alone until the mark stack is empty, the deadline
+    // passes, or (if it is not 0) the given number of cells have been
+    // visited. Returns true if the mark stack was emptied.
+    bool drainUntil(double deadline, unsigned maximumNumberOfCells);
+
     void harvestWeakReferences();
+
+    // Visiting a backing store in the copied space may move it. The owner
+    // must then point to where it went.
+    void* visitStorage(void* storage, size_t);
+
+    // After marking, a pass that needs to see every reference revisits live
+    // cells and roots with the visitor in this mode. Each slot is shown to
+    // the observer, and nothing that was not already marked gets marked.
+    void beginObserving(SlotObserver*);
+    void revisit(JSCell*);
+    void endObserving();
     
 private:
     void visitChildren(JSCell*);
+    void appendMarkSet(const MarkSet&);
+
+    void donateKnownParallel();
+    void donateSlow();
+
+    CopiedSpace::CopyAllocator m_copyAllocator;
 };
 
-inline SlotVisitor::SlotVisitor(void* jsArrayVPtr)
-    : MarkStack(jsArrayVPtr)
+inline SlotVisitor::SlotVisitor(MarkStackThreadSharedData& shared)
+    : MarkStack(shared)
+{
+}
+
+inline void SlotVisitor::donate()
+{
+    ASSERT(m_isInParallelMode);
+#if ENABLE(PARALLEL_GC)
+    if (m_shared.m_numberOfGCMarkers == 1)
+        return;
+    donateKnownParallel();
+#endif
+}
+
+inline void SlotVisitor::donateKnownParallel()
+{
+#if ENABLE(PARALLEL_GC)
+    if (m_values.size() <= Options::minimumNumberOfCellsToKeep)
+        return;
+    donateSlow();
+#endif
+}
+
+inline void SlotVisitor::donateAndDrain()
 {
+    donate();
+    drain();
 }
 
+// Marks the visitor as taking part in a (possibly) parallel drain. While in
+// parallel mode the visitor donates work to the shared mark stack as it goes.
+class ParallelModeEnabler {
+public:
+    ParallelModeEnabler(SlotVisitor& stack)
+        : m_stack(stack)
+    {
+        ASSERT(!m_stack.m_isInParallelMode);
+        m_stack.m_isInParallelMode = true;
+    }
+    
+    ~ParallelModeEnabler()
+    {
+        ASSERT(m_stack.m_isInParallelMode);
+        m_stack.m_isInParallelMode = false;
+    }
+    
+private:
+    SlotVisitor& m_stack;
+};
+
 } // namespace JSC
 
 #endif // SlotVisitor_h
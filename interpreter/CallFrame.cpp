@@ -28,6 +28,7 @@
 
 #include "CodeBlock.h"
 #include "Interpreter.h"
+#include "JSFunction.h"
 
 namespace JSC {
 
@@ -50,4 +51,46 @@ RegisterFile* CallFrame::registerFile()
 
 #endif
 
+#if ENABLE(DFG_JIT)
+CallFrame* CallFrame::trueCallFrame(ReturnAddressPtr returnAddress)
+{
+    CodeBlock* machineCodeBlock = codeBlock();
+    if (!machineCodeBlock || machineCodeBlock->getJITType() != JITCode::DFGJIT)
+        return this;
+
+    CodeOrigin codeOrigin;
+    if (!machineCodeBlock->codeOriginForReturn(returnAddress, codeOrigin))
+        return this;
+
+    Vector<InlineCallFrame*, 4> inlineCallFrames;
+    for (InlineCallFrame* inlineCallFrame = codeOrigin.inlineCallFrame(); inlineCallFrame; inlineCallFrame = inlineCallFrame->caller.inlineCallFrame())
+        inlineCallFrames.append(inlineCallFrame);
+
+    // Build the frames outermost first. Each one looks like a baseline frame that
+    // was called from its caller's baseline code, which is also how OSR exit
+    // leaves them.
+    CallFrame* callerFrame = this;
+    CodeBlock* callerCodeBlock = machineCodeBlock->baselineVersion();
+    for (size_t i = inlineCallFrames.size(); i--;) {
+        InlineCallFrame* inlineCallFrame = inlineCallFrames[i];
+        CallFrame* inlinedFrame = this + inlineCallFrame->stackOffset;
+        CodeBlock* inlinedCodeBlock = baselineCodeBlockForInlineCallFrame(inlineCallFrame);
+        void* returnPC = callerCodeBlock->getCallLinkInfo(inlineCallFrame->caller.bytecodeIndex()).hotPathOther.executableAddress();
+        JSFunction* callee = inlineCallFrame->callee.get();
+        inlinedFrame->init(inlinedCodeBlock, static_cast<Instruction*>(returnPC), callee->scope(), callerFrame, inlineCallFrame->argumentCountIncludingThis, callee);
+        callerFrame = inlinedFrame;
+        callerCodeBlock = inlinedCodeBlock;
+    }
+    return callerFrame;
+}
+
+CallFrame* CallFrame::trueCallerFrame()
+{
+    CallFrame* machineCaller = callerFrame();
+    if (machineCaller->hasHostCallFrameFlag())
+        return machineCaller->removeHostCallFrameFlag();
+    return machineCaller->trueCallFrame(returnPC());
+}
+#endif
+
 }
@@ -108,6 +108,16 @@ namespace JSC  {
         Instruction* returnVPC() const { return this[RegisterFile::ReturnPC].vPC(); }
 #endif
 
+#if ENABLE(DFG_JIT)
+        // DFG code may have inlined calls that have no frames of their own. This
+        // writes the headers for any inlined frames live at the given return
+        // address and returns the innermost, or this frame if there are none.
+        CallFrame* trueCallFrame(ReturnAddressPtr);
+        CallFrame* trueCallerFrame();
+#else
+        CallFrame* trueCallerFrame() { return callerFrame()->removeHostCallFrameFlag(); }
+#endif
+
         void setCallerFrame(CallFrame* callerFrame) { static_cast<Register*>(this)[RegisterFile::CallerFrame] = callerFrame; }
         void setScopeChain(ScopeChainNode* scopeChain) { static_cast<Register*>(this)[RegisterFile::ScopeChain] = scopeChain; }
 
@@ -809,7 +809,7 @@ namespace
 
 			intptr_t sourceID;
 			callFrame->interpreter()->retrieveLastCaller(callFrame, signedLineNumber, sourceID, urlString, function);
-			callFrame = callFrame->callerFrame();
+			callFrame = callFrame->trueCallerFrame();
 		} while (function);
 
 		return true;
@@ -5295,6 +5295,20 @@ skip_id_custom_self:
 #endif // ENABLE(INTERPRETER)
 }
 
+#if ENABLE(DFG_JIT)
+// If callFrame was called from code that the DFG inlined, moves callerFrame to
+// the inlined frame that made the call.
+static bool getInlinedCallerInfo(CallFrame* callFrame, CallFrame*& callerFrame, unsigned& bytecodeOffset)
+{
+    CodeOrigin codeOrigin;
+    if (!callerFrame->codeBlock()->codeOriginForReturn(callFrame->returnPC(), codeOrigin))
+        return false;
+    callerFrame = callerFrame->trueCallFrame(callFrame->returnPC());
+    bytecodeOffset = codeOrigin.bytecodeIndex();
+    return true;
+}
+#endif
+
 JSValue Interpreter::retrieveArguments(CallFrame* callFrame, JSFunction* function) const
 {
     CallFrame* functionCallFrame = findFunctionCallFrame(callFrame, function);
@@ -5325,9 +5339,9 @@ JSValue Interpreter::retrieveCaller(CallFrame* callFrame, JSFunction* function)
     if (!functionCallFrame)
         return jsNull();
 
-    CallFrame* callerFrame = functionCallFrame->callerFrame();
-    if (callerFrame->hasHostCallFrameFlag())
+    if (functionCallFrame->callerFrame()->hasHostCallFrameFlag())
         return jsNull();
+    CallFrame* callerFrame = functionCallFrame->trueCallerFrame();
 
     JSValue caller = callerFrame->callee();
     if (!caller)
@@ -5359,6 +5373,10 @@ void Interpreter::retrieveLastCaller(CallFrame* callFrame, int& lineNumber, intp
 #endif
 #else
     bytecodeOffset = callerCodeBlock->bytecodeOffset(callFrame->returnPC());
+#endif
+#if ENABLE(DFG_JIT)
+    if (callerFrame->globalData().canUseJIT() && getInlinedCallerInfo(callFrame, callerFrame, bytecodeOffset))
+        callerCodeBlock = callerFrame->codeBlock();
 #endif
     lineNumber = callerCodeBlock->lineNumberForBytecodeOffset(bytecodeOffset - 1);
     sourceID = callerCodeBlock->ownerExecutable()->sourceID();
@@ -5368,7 +5386,7 @@ void Interpreter::retrieveLastCaller(CallFrame* callFrame, int& lineNumber, intp
 
 CallFrame* Interpreter::findFunctionCallFrame(CallFrame* callFrame, JSFunction* function)
 {
-    for (CallFrame* candidate = callFrame; candidate; candidate = candidate->callerFrame()->removeHostCallFrameFlag()) {
+    for (CallFrame* candidate = callFrame; candidate; candidate = candidate->trueCallerFrame()) {
         if (candidate->callee() == function)
             return candidate;
     }
@@ -38,6 +38,7 @@
 namespace JSC {
 
     class ConservativeRoots;
+    class DFGCodeBlocks;
 
     class RegisterFile {
         WTF_MAKE_NONCOPYABLE(RegisterFile);
@@ -64,6 +65,9 @@ namespace JSC {
         ~RegisterFile();
         
         void gatherConservativeRoots(ConservativeRoots&);
+#if ENABLE(DFG_JIT)
+        void gatherConservativeRoots(ConservativeRoots&, DFGCodeBlocks&);
+#endif
 
         Register* begin() const { return static_cast<Register*>(m_reservation.base()); }
         Register* end() const { return m_end; }
@@ -60,13 +60,32 @@ void ctiPatchNearCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr retu
 void ctiPatchCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr returnAddress, MacroAssemblerCodePtr newCalleeFunction)
 {
     RepatchBuffer repatchBuffer(codeblock);
-    repatchBuffer.relinkCallerToTrampoline(returnAddress, newCalleeFunction);
+    ctiRelinkStubCall(repatchBuffer, returnAddress, CodeLocationLabel(newCalleeFunction));
 }
 
 void ctiPatchCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr returnAddress, FunctionPtr newCalleeFunction)
 {
     RepatchBuffer repatchBuffer(codeblock);
-    repatchBuffer.relinkCallerToFunction(returnAddress, newCalleeFunction);
+    ctiRelinkStubCall(repatchBuffer, codeblock->globalData(), returnAddress, newCalleeFunction);
+}
+
+void ctiRelinkStubCall(RepatchBuffer& repatchBuffer, JSGlobalData* globalData, ReturnAddressPtr returnAddress, FunctionPtr newStub)
+{
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+    repatchBuffer.relinkNearCallerToTrampoline(returnAddress, globalData->jitStubs->ctiStubCallThunk(globalData, newStub));
+#else
+    UNUSED_PARAM(globalData);
+    repatchBuffer.relinkCallerToFunction(returnAddress, newStub);
+#endif
+}
+
+void ctiRelinkStubCall(RepatchBuffer& repatchBuffer, ReturnAddressPtr returnAddress, CodeLocationLabel newTrampoline)
+{
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+    repatchBuffer.relinkNearCallerToTrampoline(returnAddress, newTrampoline);
+#else
+    repatchBuffer.relinkCallerToTrampoline(returnAddress, newTrampoline);
+#endif
 }
 
 JIT::JIT(JSGlobalData* globalData, CodeBlock* codeBlock)
@@ -504,7 +523,7 @@ void JIT::privateCompileSlowCases()
 JITCode JIT::privateCompile(CodePtr* functionEntryArityCheck)
 {
 #if ENABLE(TIERED_COMPILATION)
-    m_canBeOptimized = m_codeBlock->canCompileWithDFG();
+    m_canBeOptimized = Options::useDFGJIT && m_codeBlock->canCompileWithDFG();
     if (m_canBeOptimized)
         m_startOfCode = label();
 #endif
@@ -628,13 +647,18 @@ JITCode JIT::privateCompile(CodePtr* functionEntryArityCheck)
     m_codeBlock->setNumberOfStructureStubInfos(m_propertyAccessCompilationInfo.size());
     for (unsigned i = 0; i < m_propertyAccessCompilationInfo.size(); ++i) {
         StructureStubInfo& info = m_codeBlock->structureStubInfo(i);
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+        info.callReturnLocation = CodeLocationCall(patchBuffer.locationOfNearCall(m_propertyAccessCompilationInfo[i].callReturnLocation));
+#else
         info.callReturnLocation = patchBuffer.locationOf(m_propertyAccessCompilationInfo[i].callReturnLocation);
+#endif
         info.hotPathBegin = patchBuffer.locationOf(m_propertyAccessCompilationInfo[i].hotPathBegin);
     }
     m_codeBlock->setNumberOfCallLinkInfos(m_callStructureStubCompilationInfo.size());
     for (unsigned i = 0; i < m_codeBlock->numberOfCallLinkInfos(); ++i) {
         CallLinkInfo& info = m_codeBlock->callLinkInfo(i);
         info.isCall = m_callStructureStubCompilationInfo[i].isCall;
+        info.bytecodeIndex = m_callStructureStubCompilationInfo[i].bytecodeIndex;
         info.callReturnLocation = CodeLocationLabel(patchBuffer.locationOfNearCall(m_callStructureStubCompilationInfo[i].callReturnLocation));
         info.hotPathBegin = patchBuffer.locationOf(m_callStructureStubCompilationInfo[i].hotPathBegin);
         info.hotPathOther = patchBuffer.locationOfNearCall(m_callStructureStubCompilationInfo[i].hotPathOther);
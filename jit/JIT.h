@@ -58,6 +58,7 @@ namespace JSC {
     class JSPropertyNameIterator;
     class Interpreter;
     class Register;
+    class RepatchBuffer;
     class RegisterFile;
     class ScopeChainNode;
     class StructureChain;
@@ -154,6 +155,7 @@ namespace JSC {
         MacroAssembler::DataLabelPtr hotPathBegin;
         MacroAssembler::Call hotPathOther;
         MacroAssembler::Call callReturnLocation;
+        unsigned bytecodeIndex;
         bool isCall;
     };
 
@@ -172,6 +174,11 @@ namespace JSC {
     void ctiPatchCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr returnAddress, MacroAssemblerCodePtr newCalleeFunction);
     void ctiPatchCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr returnAddress, FunctionPtr newCalleeFunction);
 
+    // Calls to stubs are near calls to a stub call thunk when JIT_STUB_CALL_THUNKS is enabled, so
+    // these should be used rather than relinkCallerToFunction / relinkCallerToTrampoline to repatch them.
+    void ctiRelinkStubCall(RepatchBuffer&, JSGlobalData*, ReturnAddressPtr returnAddress, FunctionPtr newStub);
+    void ctiRelinkStubCall(RepatchBuffer&, ReturnAddressPtr returnAddress, CodeLocationLabel newTrampoline);
+
     class JIT : private JSInterfaceJIT {
         friend class JITStubCall;
 
@@ -241,6 +248,14 @@ namespace JSC {
             return jit.privateCompileCTINativeCall(globalData, func);
         }
 
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+        static CodeRef compileStubCallThunk(JSGlobalData* globalData, FunctionPtr stub)
+        {
+            JIT jit(globalData, 0);
+            return jit.privateCompileStubCallThunk(stub);
+        }
+#endif
+
         static void patchGetByIdSelf(CodeBlock* codeblock, StructureStubInfo*, Structure*, size_t cachedOffset, ReturnAddressPtr returnAddress);
         static void patchPutByIdReplace(CodeBlock* codeblock, StructureStubInfo*, Structure*, size_t cachedOffset, ReturnAddressPtr returnAddress, bool direct);
         static void patchMethodCallProto(JSGlobalData&, CodeBlock* codeblock, MethodCallLinkInfo&, JSObject*, Structure*, JSObject*, ReturnAddressPtr);
@@ -281,6 +296,9 @@ namespace JSC {
         PassRefPtr<ExecutableMemoryHandle> privateCompileCTIMachineTrampolines(JSGlobalData*, TrampolineStructure*);
         Label privateCompileCTINativeCall(JSGlobalData*, bool isConstruct = false);
         CodeRef privateCompileCTINativeCall(JSGlobalData*, NativeFunction);
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+        CodeRef privateCompileStubCallThunk(FunctionPtr stub);
+#endif
         void privateCompilePatchGetArrayLength(ReturnAddressPtr returnAddress);
 
         void addSlowCase(Jump);
@@ -608,8 +626,12 @@ namespace JSC {
         static const int patchOffsetGetByIdBranchToSlowCase = 20;
         static const int patchOffsetGetByIdPropertyMapOffset = 28;
         static const int patchOffsetGetByIdPutResult = 28;
-#if ENABLE(OPCODE_SAMPLING)
+#if ENABLE(OPCODE_SAMPLING) && ENABLE(JIT_STUB_CALL_THUNKS)
+        static const int patchOffsetGetByIdSlowCaseCall = 35;
+#elif ENABLE(OPCODE_SAMPLING)
         static const int patchOffsetGetByIdSlowCaseCall = 64;
+#elif ENABLE(JIT_STUB_CALL_THUNKS)
+        static const int patchOffsetGetByIdSlowCaseCall = 25;
 #else
         static const int patchOffsetGetByIdSlowCaseCall = 54;
 #endif
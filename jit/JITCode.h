@@ -101,6 +101,14 @@ namespace JSC {
             return static_cast<unsigned>(result);
         }
 
+        // Returns true if 'pointerIntoCode' is a return address inside this
+        // block of code.
+        bool containsReturnAddress(void* pointerIntoCode)
+        {
+            uintptr_t offset = reinterpret_cast<uintptr_t>(pointerIntoCode) - reinterpret_cast<uintptr_t>(m_ref.code().executableAddress());
+            return offset && offset <= size();
+        }
+
         // Execute the code!
         inline JSValue execute(RegisterFile* registerFile, CallFrame* callFrame, JSGlobalData* globalData)
         {
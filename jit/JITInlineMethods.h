@@ -267,8 +267,14 @@ ALWAYS_INLINE void JIT::restoreArgumentReferenceForTrampoline()
     move(stackPointerRegister, firstArgumentRegister);
 #elif CPU(SH4)
     move(stackPointerRegister, firstArgumentRegister);
-#endif
+#elif ENABLE(JIT_STUB_CALL_THUNKS)
+    // Trampolines are called in place of a stub call thunk, so have to do its work.
+    addPtr(TrustedImm32(sizeof(void*)), stackPointerRegister, firstArgumentRegister);
+    storePtr(callFrameRegister, Address(firstArgumentRegister, OBJECT_OFFSETOF(struct JITStackFrame, callFrame)));
+    updateTopCallFrame();
+#else
     // In the trampoline on x86-64, the first argument register is not overwritten.
+#endif
 }
 
 ALWAYS_INLINE JIT::Jump JIT::checkStructure(RegisterID reg, Structure* structure)
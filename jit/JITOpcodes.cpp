@@ -148,16 +148,16 @@ PassRefPtr<ExecutableMemoryHandle> JIT::privateCompileCTIMachineTrampolines(JSGl
     Label nativeCallThunk = privateCompileCTINativeCall(globalData);    
     Label nativeConstructThunk = privateCompileCTINativeCall(globalData, true);    
 
-    Call string_failureCases1Call = makeTailRecursiveCall(string_failureCases1);
-    Call string_failureCases2Call = makeTailRecursiveCall(string_failureCases2);
-    Call string_failureCases3Call = makeTailRecursiveCall(string_failureCases3);
+    string_failureCases1.link(this);
+    string_failureCases2.link(this);
+    string_failureCases3.link(this);
+    restoreArgumentReferenceForTrampoline();
+    Call string_failureCasesCall = tailRecursiveCall();
 
     // All trampolines constructed! copy the code, link up calls, and set the pointers on the Machine object.
     LinkBuffer patchBuffer(*m_globalData, this);
 
-    patchBuffer.link(string_failureCases1Call, FunctionPtr(cti_op_get_by_id_string_fail));
-    patchBuffer.link(string_failureCases2Call, FunctionPtr(cti_op_get_by_id_string_fail));
-    patchBuffer.link(string_failureCases3Call, FunctionPtr(cti_op_get_by_id_string_fail));
+    patchBuffer.link(string_failureCasesCall, FunctionPtr(cti_op_get_by_id_string_fail));
     patchBuffer.link(callLazyLinkCall, FunctionPtr(cti_vm_lazyLinkCall));
     patchBuffer.link(callLazyLinkConstruct, FunctionPtr(cti_vm_lazyLinkConstruct));
     patchBuffer.link(callCompileCall, FunctionPtr(cti_op_call_jitCompile));
@@ -298,6 +298,20 @@ JIT::CodeRef JIT::privateCompileCTINativeCall(JSGlobalData* globalData, NativeFu
     return CodeRef::createSelfManagedCodeRef(globalData->jitStubs->ctiNativeCall());
 }
 
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+JIT::CodeRef JIT::privateCompileStubCallThunk(FunctionPtr stub)
+{
+    // Set up the stub's argument as JITStubCall::call() would, then jump to the stub;
+    // it returns straight to the JIT code that called this thunk.
+    restoreArgumentReferenceForTrampoline();
+    Call stubCall = tailRecursiveCall();
+
+    LinkBuffer patchBuffer(*m_globalData, this);
+    patchBuffer.link(stubCall, stub);
+    return patchBuffer.finalizeCode();
+}
+#endif
+
 void JIT::emit_op_mov(Instruction* currentInstruction)
 {
     int dst = currentInstruction[1].u.operand;
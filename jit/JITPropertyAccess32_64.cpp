@@ -462,10 +462,13 @@ void JIT::compileGetDirectOffset(RegisterID base, RegisterID resultTag, Register
     }
 }
 
+// The collector may move the property storage, so only the address of the
+// pointer to it is baked in.
 void JIT::compileGetDirectOffset(JSObject* base, RegisterID resultTag, RegisterID resultPayload, size_t cachedOffset)
 {
-    load32(reinterpret_cast<char*>(&base->m_propertyStorage[cachedOffset]) + OBJECT_OFFSETOF(JSValue, u.asBits.payload), resultPayload);
-    load32(reinterpret_cast<char*>(&base->m_propertyStorage[cachedOffset]) + OBJECT_OFFSETOF(JSValue, u.asBits.tag), resultTag);
+    loadPtr(static_cast<void*>(&base->m_propertyStorage), resultTag);
+    load32(Address(resultTag, cachedOffset * sizeof(JSValue) + OBJECT_OFFSETOF(JSValue, u.asBits.payload)), resultPayload);
+    load32(Address(resultTag, cachedOffset * sizeof(JSValue) + OBJECT_OFFSETOF(JSValue, u.asBits.tag)), resultTag);
 }
 
 void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct)
@@ -1096,6 +1099,22 @@ void JIT::emitWriteBarrier(RegisterID owner, RegisterID scratch, WriteBarrierUse
 #if ENABLE(WRITE_BARRIER_PROFILING)
     emitCount(WriteBarrierCounters::jitCounterFor(useKind));
 #endif
+
+#if ENABLE(GGC)
+    // Mark the card holding the owner, using only one scratch register. If t is
+    // the owner's offset in its block and c = t / bytesPerCard its card, then
+    // ((t + 1) * (bytesPerCard - 1)) / bytesPerCard == t - c. Subtracting that
+    // from the owner points it at the block plus c, so the card can be stored
+    // relative to it before the owner is restored.
+    move(owner, scratch);
+    andPtr(TrustedImm32(MarkedBlock::blockSize - 1), scratch);
+    add32(TrustedImm32(1), scratch);
+    mul32(TrustedImm32(MarkedBlock::bytesPerCard - 1), scratch, scratch);
+    urshift32(TrustedImm32(MarkedBlock::log2BytesPerCard), scratch);
+    subPtr(scratch, owner);
+    store8(TrustedImm32(1), Address(owner, MarkedBlock::offsetOfCards()));
+    addPtr(scratch, owner);
+#endif
 }
 
 } // namespace JSC
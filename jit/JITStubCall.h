@@ -171,10 +171,16 @@ namespace JSC {
                 m_jit->sampleInstruction(m_jit->m_codeBlock->instructions().begin() + m_jit->m_bytecodeOffset, true);
 #endif
 
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+            // The thunk sets up the stub's argument and the top call frame, then jumps to the stub.
+            JIT::Call call = m_jit->nearCall();
+            m_jit->m_calls.append(CallRecord(call, m_jit->m_bytecodeOffset, m_jit->m_globalData->jitStubs->ctiStubCallThunk(m_jit->m_globalData, m_stub).executableAddress()));
+#else
             m_jit->restoreArgumentReference();
             m_jit->updateTopCallFrame();
             JIT::Call call = m_jit->call();
             m_jit->m_calls.append(CallRecord(call, m_jit->m_bytecodeOffset, m_stub.value()));
+#endif
 
 #if ENABLE(OPCODE_SAMPLING)
             if (m_jit->m_bytecodeOffset != (unsigned)-1)
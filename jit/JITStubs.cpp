@@ -37,6 +37,7 @@
 #include "CallFrame.h"
 #include "CodeBlock.h"
 #include "DFGOSREntry.h"
+#include "DFGWorklist.h"
 #include "Debugger.h"
 #include "ExceptionHelpers.h"
 #include "GetterSetter.h"
@@ -53,6 +54,7 @@
 #include "JSString.h"
 #include "ObjectPrototype.h"
 #include "Operations.h"
+#include "Options.h"
 #include "Parser.h"
 #include "Profiler.h"
 #include "RegExpObject.h"
@@ -1817,6 +1819,33 @@ DEFINE_STUB_FUNCTION(void, op_check_has_instance)
     VM_THROW_EXCEPTION_AT_END();
 }
 
+#if ENABLE(CONCURRENT_JIT)
+// The DFG compiles functions on a thread of its own. The code it finishes is
+// installed here, when baseline code next checks whether to optimize.
+static void completeConcurrentCompilations(CallFrame* callFrame)
+{
+    if (DFG::Worklist* worklist = callFrame->globalData().dfgWorklist.get())
+        worklist->completeAllReadyPlans();
+}
+
+static bool isCompilingConcurrently(CallFrame* callFrame, CodeBlock* codeBlock)
+{
+    DFG::Worklist* worklist = callFrame->globalData().dfgWorklist.get();
+    return worklist && worklist->isCompiling(codeBlock);
+}
+
+static bool isConcurrentCompilationQueueFull(CallFrame* callFrame, CodeBlock* codeBlock)
+{
+    if (codeBlock->codeType() != FunctionCode || !Options::useConcurrentJIT)
+        return false;
+    DFG::Worklist* worklist = callFrame->globalData().dfgWorklist.get();
+    if (!worklist || !worklist->isFull())
+        return false;
+    worklist->didRejectCompilation();
+    return true;
+}
+#endif
+
 DEFINE_STUB_FUNCTION(void, optimize_from_loop)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1825,7 +1854,27 @@ DEFINE_STUB_FUNCTION(void, optimize_from_loop)
     CodeBlock* codeBlock = callFrame->codeBlock();
     unsigned bytecodeIndex = stackFrame.args[0].int32();
 
+#if ENABLE(CONCURRENT_JIT)
+    completeConcurrentCompilations(callFrame);
+#endif
+
+#if ENABLE(DFG_JIT)
+    if (codeBlock->hasOptimizedReplacement() && codeBlock->replacement()->shouldReoptimizeNow()) {
+#if ENABLE(JIT_VERBOSE_OSR)
+        printf("Reoptimizing %p (in loop) after %u OSR exits.\n", codeBlock, codeBlock->replacement()->osrExitCounter());
+#endif
+        codeBlock->reoptimize();
+        return;
+    }
+#endif
+
     if (!codeBlock->hasOptimizedReplacement()) {
+#if ENABLE(CONCURRENT_JIT)
+        if (isCompilingConcurrently(callFrame, codeBlock)) {
+            codeBlock->optimizeSoon();
+            return;
+        }
+#endif
         if (!codeBlock->shouldOptimizeNow()) {
 #if ENABLE(JIT_VERBOSE_OSR)
             printf("Delaying optimization for %p (in loop) because of insufficient profiling.\n", codeBlock);
@@ -1833,6 +1882,13 @@ DEFINE_STUB_FUNCTION(void, optimize_from_loop)
             return;
         }
         
+#if ENABLE(CONCURRENT_JIT)
+        if (isConcurrentCompilationQueueFull(callFrame, codeBlock)) {
+            codeBlock->optimizeAfterWarmUp();
+            return;
+        }
+#endif
+        
         ScopeChainNode* scopeChain = callFrame->scopeChain();
         
         JSObject* error = codeBlock->compileOptimized(callFrame, scopeChain);
@@ -1843,6 +1899,16 @@ DEFINE_STUB_FUNCTION(void, optimize_from_loop)
         UNUSED_PARAM(error);
 #endif
         
+#if ENABLE(CONCURRENT_JIT)
+        if (isCompilingConcurrently(callFrame, codeBlock)) {
+#if ENABLE(JIT_VERBOSE_OSR)
+            printf("Optimizing %p from loop in the background.\n", codeBlock);
+#endif
+            codeBlock->optimizeSoon();
+            return;
+        }
+#endif
+        
         if (codeBlock->replacement() == codeBlock) {
 #if ENABLE(JIT_VERBOSE_OSR)
             printf("Optimizing %p from loop failed.\n", codeBlock);
@@ -1859,7 +1925,7 @@ DEFINE_STUB_FUNCTION(void, optimize_from_loop)
     
     if (void* address = DFG::prepareOSREntry(callFrame, optimizedCodeBlock, bytecodeIndex)) {
 #if ENABLE(JIT_VERBOSE_OSR)
-        printf("Optimizing %p from loop succeeded, performing OSR.\n", codeBlock);
+        printf("Optimizing %p from loop succeeded (CSE eliminated %u nodes), performing OSR.\n", codeBlock, optimizedCodeBlock->numberOfNodesEliminatedByCSE());
 #endif
 
         codeBlock->optimizeSoon();
@@ -1868,7 +1934,7 @@ DEFINE_STUB_FUNCTION(void, optimize_from_loop)
     }
     
 #if ENABLE(JIT_VERBOSE_OSR)
-    printf("Optimizing %p from loop succeeded, OSR failed.\n", codeBlock);
+    printf("Optimizing %p from loop succeeded (CSE eliminated %u nodes), OSR failed.\n", codeBlock, optimizedCodeBlock->numberOfNodesEliminatedByCSE());
 #endif
 
     // OSR failed this time, but it might succeed next time! Let the code run a bit
@@ -1883,9 +1949,29 @@ DEFINE_STUB_FUNCTION(void, optimize_from_ret)
     CallFrame* callFrame = stackFrame.callFrame;
     CodeBlock* codeBlock = callFrame->codeBlock();
     
-    if (codeBlock->hasOptimizedReplacement())
+#if ENABLE(CONCURRENT_JIT)
+    completeConcurrentCompilations(callFrame);
+#endif
+
+    if (codeBlock->hasOptimizedReplacement()) {
+#if ENABLE(DFG_JIT)
+        if (codeBlock->replacement()->shouldReoptimizeNow()) {
+#if ENABLE(JIT_VERBOSE_OSR)
+            printf("Reoptimizing %p (in return) after %u OSR exits.\n", codeBlock, codeBlock->replacement()->osrExitCounter());
+#endif
+            codeBlock->reoptimize();
+        }
+#endif
         return;
+    }
     
+#if ENABLE(CONCURRENT_JIT)
+    if (isCompilingConcurrently(callFrame, codeBlock)) {
+        codeBlock->optimizeSoon();
+        return;
+    }
+#endif
+
     if (!codeBlock->shouldOptimizeNow()) {
 #if ENABLE(JIT_VERBOSE_OSR)
         printf("Delaying optimization for %p (in return) because of insufficient profiling.\n", codeBlock);
@@ -1893,12 +1979,29 @@ DEFINE_STUB_FUNCTION(void, optimize_from_ret)
         return;
     }
     
+#if ENABLE(CONCURRENT_JIT)
+    if (isConcurrentCompilationQueueFull(callFrame, codeBlock)) {
+        codeBlock->optimizeAfterWarmUp();
+        return;
+    }
+#endif
+
     ScopeChainNode* scopeChain = callFrame->scopeChain();
 
     JSObject* error = codeBlock->compileOptimized(callFrame, scopeChain);
     if (error)
         fprintf(stderr, "WARNING: optimized compilation from ret failed.\n");
     
+#if ENABLE(CONCURRENT_JIT)
+    if (isCompilingConcurrently(callFrame, codeBlock)) {
+#if ENABLE(JIT_VERBOSE_OSR)
+        printf("Optimizing %p from return in the background.\n", codeBlock);
+#endif
+        codeBlock->optimizeSoon();
+        return;
+    }
+#endif
+    
     if (codeBlock->replacement() == codeBlock) {
 #if ENABLE(JIT_VERBOSE_OSR)
         printf("Optimizing %p from return failed.\n", codeBlock);
@@ -1912,7 +2015,7 @@ DEFINE_STUB_FUNCTION(void, optimize_from_ret)
     ASSERT(codeBlock->replacement()->getJITType() == JITCode::DFGJIT);
 
 #if ENABLE(JIT_VERBOSE_OSR)
-    printf("Optimizing %p from return succeeded.\n", codeBlock);
+    printf("Optimizing %p from return succeeded (CSE eliminated %u nodes).\n", codeBlock, codeBlock->replacement()->numberOfNodesEliminatedByCSE());
 #endif
     
     codeBlock->optimizeSoon();
@@ -3682,6 +3785,16 @@ MacroAssemblerCodeRef JITThunks::ctiStub(JSGlobalData* globalData, ThunkGenerato
     return entry.first->second;
 }
 
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+MacroAssemblerCodePtr JITThunks::ctiStubCallThunk(JSGlobalData* globalData, FunctionPtr stub)
+{
+    std::pair<StubCallThunkMap::iterator, bool> entry = m_stubCallThunkMap.add(stub.value(), MacroAssemblerCodeRef());
+    if (entry.second)
+        entry.first->second = JIT::compileStubCallThunk(globalData, stub);
+    return entry.first->second.code();
+}
+#endif
+
 NativeExecutable* JITThunks::hostFunctionStub(JSGlobalData* globalData, NativeFunction function)
 {
     std::pair<HostFunctionStubMap::iterator, bool> entry = m_hostFunctionStubMap->add(function, Weak<NativeExecutable>());
@@ -295,6 +295,9 @@ namespace JSC {
         MacroAssemblerCodePtr ctiSoftModulo() { return m_trampolineStructure.ctiSoftModulo; }
 
         MacroAssemblerCodeRef ctiStub(JSGlobalData*, ThunkGenerator);
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+        MacroAssemblerCodePtr ctiStubCallThunk(JSGlobalData*, FunctionPtr stub);
+#endif
 
         NativeExecutable* hostFunctionStub(JSGlobalData*, NativeFunction);
         NativeExecutable* hostFunctionStub(JSGlobalData*, NativeFunction, ThunkGenerator);
@@ -304,6 +307,10 @@ namespace JSC {
     private:
         typedef HashMap<ThunkGenerator, MacroAssemblerCodeRef> CTIStubMap;
         CTIStubMap m_ctiStubMap;
+#if ENABLE(JIT_STUB_CALL_THUNKS)
+        typedef HashMap<void*, MacroAssemblerCodeRef> StubCallThunkMap;
+        StubCallThunkMap m_stubCallThunkMap;
+#endif
         typedef HashMap<NativeFunction, Weak<NativeExecutable> > HostFunctionStubMap;
         OwnPtr<HostFunctionStubMap> m_hostFunctionStubMap;
         RefPtr<ExecutableMemoryHandle> m_executableMemory;
@@ -136,7 +136,12 @@ public:
 
 template<typename T> inline void MarkStack::append(JITWriteBarrier<T>* slot)
 {
-    internalAppend(slot->get());
+    // Machine code holds the pointer, so the cell must stay where it is.
+    JSCell* cell = slot->get();
+    if (UNLIKELY(m_slotObserver))
+        m_slotObserver->observeSlot(&cell);
+    Heap::pin(cell);
+    internalAppend(cell);
 }
 
 }
@@ -22,15 +22,19 @@
 
 #include "config.h"
 
+#include "BytecodeCache.h"
 #include "BytecodeGenerator.h"
 #include "Completion.h"
 #include "CurrentTime.h"
+#include "DFGWorklist.h"
 #include "ExceptionHelpers.h"
+#include "HeapSnapshot.h"
 #include "InitializeThreading.h"
 #include "JSArray.h"
 #include "JSFunction.h"
 #include "JSLock.h"
 #include "JSString.h"
+#include "Options.h"
 #include "SamplingTool.h"
 #include <math.h>
 #include <stdio.h>
@@ -74,6 +78,15 @@ static bool fillBufferWithContentsOfFile(const UString& fileName, Vector<char>&
 static EncodedJSValue JSC_HOST_CALL functionPrint(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionDebug(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionGC(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionCompactHeap(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionHeapSnapshot(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionGCStats(ExecState*);
+#if ENABLE(CONCURRENT_JIT)
+static EncodedJSValue JSC_HOST_CALL functionDFGStats(ExecState*);
+#endif
+#if ENABLE(JIT)
+static EncodedJSValue JSC_HOST_CALL functionInlineCacheStats(ExecState*);
+#endif
 #ifndef NDEBUG
 static EncodedJSValue JSC_HOST_CALL functionReleaseExecutableMemory(ExecState*);
 #endif
@@ -101,15 +114,17 @@ struct Script {
     }
 };
 
-struct Options {
-    Options()
+struct CommandLine {
+    CommandLine()
         : interactive(false)
         , dump(false)
+        , heapSnapshotReport(0)
     {
     }
 
     bool interactive;
     bool dump;
+    const char* heapSnapshotReport;
     Vector<Script> scripts;
     Vector<UString> arguments;
 };
@@ -166,6 +181,15 @@ protected:
         putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 1, Identifier(globalExec(), "print"), functionPrint));
         putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 0, Identifier(globalExec(), "quit"), functionQuit));
         putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 0, Identifier(globalExec(), "gc"), functionGC));
+        putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 0, Identifier(globalExec(), "compactHeap"), functionCompactHeap));
+        putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 1, Identifier(globalExec(), "heapSnapshot"), functionHeapSnapshot));
+        putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 0, Identifier(globalExec(), "gcStats"), functionGCStats));
+#if ENABLE(CONCURRENT_JIT)
+        putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 0, Identifier(globalExec(), "dfgStats"), functionDFGStats));
+#endif
+#if ENABLE(JIT)
+        putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 1, Identifier(globalExec(), "inlineCacheStats"), functionInlineCacheStats));
+#endif
 #ifndef NDEBUG
         putDirectFunction(globalExec(), JSFunction::create(globalExec(), this, functionStructure(), 0, Identifier(globalExec(), "releaseExecutableMemory"), functionReleaseExecutableMemory));
 #endif
@@ -222,6 +246,127 @@ EncodedJSValue JSC_HOST_CALL functionGC(ExecState* exec)
     return JSValue::encode(jsUndefined());
 }
 
+EncodedJSValue JSC_HOST_CALL functionCompactHeap(ExecState* exec)
+{
+    JSLock lock(SilenceAssertionsOnly);
+    exec->heap()->collectAllGarbage(Heap::DoCompact);
+    return JSValue::encode(jsUndefined());
+}
+
+static bool writeToFile(const void* data, size_t size, void* file)
+{
+    return fwrite(data, 1, size, static_cast<FILE*>(file)) == size;
+}
+
+EncodedJSValue JSC_HOST_CALL functionHeapSnapshot(ExecState* exec)
+{
+    UString fileName = exec->argument(0).toString(exec);
+    FILE* file = fopen(fileName.utf8().data(), "wb");
+    if (!file)
+        return JSValue::encode(throwError(exec, createError(exec, "Could not open file.")));
+
+    JSLock lock(SilenceAssertionsOnly);
+    HeapSnapshotWriter writer(writeToFile, file);
+    bool success = exec->heap()->writeSnapshot(writer);
+    if (fclose(file))
+        success = false;
+    return JSValue::encode(jsBoolean(success));
+}
+
+// Describes the last collection, as Heap::lastCollectionStatistics() does. Times are in seconds.
+EncodedJSValue JSC_HOST_CALL functionGCStats(ExecState* exec)
+{
+    JSGlobalData& globalData = exec->globalData();
+    const GCStatistics& statistics = exec->heap()->lastCollectionStatistics();
+
+    JSObject* result = constructEmptyObject(exec);
+    result->putDirect(globalData, Identifier(exec, "collectionNumber"), jsNumber(statistics.collectionNumber));
+    result->putDirect(globalData, Identifier(exec, "isFullCollection"), jsBoolean(statistics.isFullCollection));
+    result->putDirect(globalData, Identifier(exec, "pauseTime"), jsNumber(statistics.pauseTime));
+
+    JSObject* phaseTimes = constructEmptyObject(exec);
+    for (size_t i = 0; i < GCStatistics::NumberOfPhases; ++i) {
+        GCStatistics::Phase phase = static_cast<GCStatistics::Phase>(i);
+        phaseTimes->putDirect(globalData, Identifier(exec, GCStatistics::phaseName(phase)), jsNumber(statistics.phaseTimes[phase]));
+    }
+    result->putDirect(globalData, Identifier(exec, "phaseTimes"), phaseTimes);
+
+    result->putDirect(globalData, Identifier(exec, "incrementalMarkingSliceCount"), jsNumber(statistics.incrementalMarkingSliceCount));
+    result->putDirect(globalData, Identifier(exec, "incrementalMarkingTime"), jsNumber(statistics.incrementalMarkingTime));
+    result->putDirect(globalData, Identifier(exec, "longestIncrementalMarkingSlice"), jsNumber(statistics.longestIncrementalMarkingSlice));
+    result->putDirect(globalData, Identifier(exec, "bytesAllocated"), jsNumber(statistics.bytesAllocated));
+    result->putDirect(globalData, Identifier(exec, "extraMemoryCost"), jsNumber(statistics.extraMemoryCost));
+    result->putDirect(globalData, Identifier(exec, "sizeBefore"), jsNumber(statistics.sizeBefore));
+    result->putDirect(globalData, Identifier(exec, "sizeAfter"), jsNumber(statistics.sizeAfter));
+    result->putDirect(globalData, Identifier(exec, "survivorRatio"), jsNumber(statistics.survivorRatio()));
+
+    JSArray* sizeClasses = constructEmptyArray(exec);
+    for (size_t i = 0; i < statistics.sizeClasses.size(); ++i) {
+        JSObject* sizeClass = constructEmptyObject(exec);
+        sizeClass->putDirect(globalData, Identifier(exec, "cellSize"), jsNumber(statistics.sizeClasses[i].cellSize));
+        sizeClass->putDirect(globalData, Identifier(exec, "bytesAllocated"), jsNumber(statistics.sizeClasses[i].bytesAllocated));
+        sizeClass->putDirect(globalData, Identifier(exec, "bytesSurvived"), jsNumber(statistics.sizeClasses[i].bytesSurvived));
+        sizeClasses->push(exec, sizeClass);
+    }
+    result->putDirect(globalData, Identifier(exec, "sizeClasses"), sizeClasses);
+
+    result->putDirect(globalData, Identifier(exec, "totalPauseTime"), jsNumber(statistics.totalPauseTime));
+    result->putDirect(globalData, Identifier(exec, "longestPause"), jsNumber(statistics.longestPause));
+    return JSValue::encode(result);
+}
+
+#if ENABLE(CONCURRENT_JIT)
+EncodedJSValue JSC_HOST_CALL functionDFGStats(ExecState* exec)
+{
+    JSGlobalData& globalData = exec->globalData();
+    DFG::CompilationStatistics statistics;
+    if (globalData.dfgWorklist)
+        statistics = globalData.dfgWorklist->statistics();
+
+    JSObject* result = constructEmptyObject(exec);
+    result->putDirect(globalData, Identifier(exec, "compilationCount"), jsNumber(statistics.compilationCount));
+    result->putDirect(globalData, Identifier(exec, "discardedCount"), jsNumber(statistics.discardedCount));
+    result->putDirect(globalData, Identifier(exec, "rejectedCount"), jsNumber(statistics.rejectedCount));
+    result->putDirect(globalData, Identifier(exec, "totalCompileTime"), jsNumber(statistics.totalCompileTime));
+    result->putDirect(globalData, Identifier(exec, "longestCompileTime"), jsNumber(statistics.longestCompileTime));
+    result->putDirect(globalData, Identifier(exec, "totalLatency"), jsNumber(statistics.totalLatency));
+    result->putDirect(globalData, Identifier(exec, "longestLatency"), jsNumber(statistics.longestLatency));
+    return JSValue::encode(result);
+}
+#endif
+
+#if ENABLE(JIT)
+// Describes the state of the inline cache at each property access site of the
+// code a function currently runs, in the order the code was generated.
+EncodedJSValue JSC_HOST_CALL functionInlineCacheStats(ExecState* exec)
+{
+    JSGlobalData& globalData = exec->globalData();
+    JSValue value = exec->argument(0);
+    if (!value.inherits(&JSFunction::s_info))
+        return JSValue::encode(jsUndefined());
+    JSFunction* function = asFunction(value);
+    if (function->isHostFunction() || !function->jsExecutable()->isGeneratedForCall())
+        return JSValue::encode(jsUndefined());
+    CodeBlock& codeBlock = function->jsExecutable()->generatedBytecodeForCall();
+
+    JSObject* result = constructEmptyObject(exec);
+    result->putDirect(globalData, Identifier(exec, "optimized"), jsBoolean(codeBlock.getJITType() == JITCode::DFGJIT));
+
+    JSArray* sites = constructEmptyArray(exec);
+    for (size_t i = 0; i < codeBlock.numberOfStructureStubInfos(); ++i) {
+        StructureStubInfo& stubInfo = codeBlock.structureStubInfo(i);
+        int structureCount = stubInfo.numberOfCachedStructures();
+        JSObject* site = constructEmptyObject(exec);
+        site->putDirect(globalData, Identifier(exec, "state"), jsString(exec, StructureStubInfo::accessTypeName(static_cast<AccessType>(stubInfo.accessType))));
+        site->putDirect(globalData, Identifier(exec, "structureCount"), jsNumber(structureCount));
+        site->putDirect(globalData, Identifier(exec, "megamorphic"), jsBoolean(structureCount == POLYMORPHIC_LIST_CACHE_SIZE));
+        sites->push(exec, site);
+    }
+    result->putDirect(globalData, Identifier(exec, "sites"), sites);
+    return JSValue::encode(result);
+}
+#endif
+
 #ifndef NDEBUG
 EncodedJSValue JSC_HOST_CALL functionReleaseExecutableMemory(ExecState* exec)
 {
@@ -516,6 +661,20 @@ static NO_RETURN void printUsageStatement(JSGlobalData* globalData, bool help =
     fprintf(stderr, "  -d         Dumps bytecode (debug builds only)\n");
     fprintf(stderr, "  -e         Evaluate argument as script code\n");
     fprintf(stderr, "  -f         Specifies a source file (deprecated)\n");
+    fprintf(stderr, "  --gc-markers <n>  Number of threads that take part in marking (1 disables parallel marking)\n");
+    fprintf(stderr, "  --no-ggc   Disables generational collection; every collection marks the whole heap\n");
+    fprintf(stderr, "  --gc-pause-budget <ms>  Marks the heap incrementally, in slices of at most <ms> milliseconds\n");
+#if ENABLE(DFG_JIT)
+    fprintf(stderr, "  --no-dfg   Keeps all code in the baseline JIT\n");
+    fprintf(stderr, "  --force-dfg  Hands code to the DFG JIT on its first loop iteration or return, without waiting for profiling\n");
+#endif
+#if ENABLE(CONCURRENT_JIT)
+    fprintf(stderr, "  --concurrent-dfg  Compiles functions in the DFG JIT on a thread of its own, even with a single processor core\n");
+    fprintf(stderr, "  --no-concurrent-dfg  Compiles functions in the DFG JIT on the thread that runs them\n");
+    fprintf(stderr, "  --dfg-queue-depth <n>  Number of functions that may wait for the DFG JIT's compilation thread\n");
+#endif
+    fprintf(stderr, "  --bytecode-cache <dir>  Keeps the bytecode of the scripts run in <dir>, for later runs to reuse\n");
+    fprintf(stderr, "  --heap-snapshot-report <file>  Prints what retains the most memory in a snapshot written by heapSnapshot()\n");
     fprintf(stderr, "  -h|--help  Prints this help message\n");
     fprintf(stderr, "  -i         Enables interactive mode (default if no files are specified)\n");
 #if HAVE(SIGNAL_H)
@@ -526,7 +685,7 @@ static NO_RETURN void printUsageStatement(JSGlobalData* globalData, bool help =
     exit(help ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 
-static void parseArguments(int argc, char** argv, Options& options, JSGlobalData* globalData)
+static void parseArguments(int argc, char** argv, CommandLine& options, JSGlobalData* globalData)
 {
     int i = 1;
     for (; i < argc; ++i) {
@@ -547,6 +706,72 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
             options.interactive = true;
             continue;
         }
+        if (!strcmp(arg, "--gc-markers")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            int numberOfGCMarkers = atoi(argv[i]);
+            if (numberOfGCMarkers < 1)
+                printUsageStatement(globalData);
+            JSC::Options::numberOfGCMarkers = numberOfGCMarkers;
+            continue;
+        }
+        if (!strcmp(arg, "--no-ggc")) {
+            JSC::Options::useGenerationalGC = false;
+            continue;
+        }
+        if (!strcmp(arg, "--gc-pause-budget")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            double pauseBudget = atof(argv[i]);
+            if (pauseBudget < 0)
+                printUsageStatement(globalData);
+            JSC::Options::incrementalMarkingPauseBudget = pauseBudget / 1000;
+            continue;
+        }
+#if ENABLE(DFG_JIT)
+        if (!strcmp(arg, "--no-dfg")) {
+            JSC::Options::useDFGJIT = false;
+            continue;
+        }
+        if (!strcmp(arg, "--force-dfg")) {
+            JSC::Options::useDFGJIT = true;
+            JSC::Options::executionCounterValueForOptimizeAfterWarmUp = -1;
+            JSC::Options::executionCounterValueForOptimizeSoon = -1;
+            JSC::Options::maximumOptimizationDelay = 0;
+            continue;
+        }
+#endif
+#if ENABLE(CONCURRENT_JIT)
+        if (!strcmp(arg, "--concurrent-dfg")) {
+            JSC::Options::useConcurrentJIT = true;
+            continue;
+        }
+        if (!strcmp(arg, "--no-concurrent-dfg")) {
+            JSC::Options::useConcurrentJIT = false;
+            continue;
+        }
+        if (!strcmp(arg, "--dfg-queue-depth")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            int queueDepth = atoi(argv[i]);
+            if (queueDepth < 1)
+                printUsageStatement(globalData);
+            JSC::Options::maximumCompilationQueueDepth = queueDepth;
+            continue;
+        }
+#endif
+        if (!strcmp(arg, "--bytecode-cache")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            globalData->bytecodeCache = BytecodeCache::create(argv[i]);
+            continue;
+        }
+        if (!strcmp(arg, "--heap-snapshot-report")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.heapSnapshotReport = argv[i];
+            continue;
+        }
         if (!strcmp(arg, "-d")) {
             options.dump = true;
             continue;
@@ -576,13 +801,71 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
         options.arguments.append(argv[i]);
 }
 
+static size_t readFromFile(void* buffer, size_t size, void* file)
+{
+    return fread(buffer, 1, size, static_cast<FILE*>(file));
+}
+
+static bool printHeapSnapshotReport(const char* fileName)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (!file) {
+        fprintf(stderr, "Could not open file: %s\n", fileName);
+        return false;
+    }
+    HeapSnapshot snapshot;
+    bool success = snapshot.read(readFromFile, file);
+    fclose(file);
+    if (!success) {
+        fprintf(stderr, "Not a heap snapshot: %s\n", fileName);
+        return false;
+    }
+    snapshot.computeDominators();
+
+    printf("%u cells, %lu bytes\n\n", snapshot.nodeCount() - 1, static_cast<unsigned long>(snapshot.retainedSize(0)));
+
+    static const size_t maxClasses = 20;
+    Vector<HeapSnapshot::ClassSummary> classes;
+    snapshot.summarizeByClass(classes);
+    printf("%-24s %10s %12s %12s\n", "Class", "Count", "Self", "Retained");
+    for (size_t i = 0; i < classes.size() && i < maxClasses; ++i) {
+        printf("%-24s %10lu %12lu %12lu\n", classes[i].className, static_cast<unsigned long>(classes[i].count),
+            static_cast<unsigned long>(classes[i].selfSize), static_cast<unsigned long>(classes[i].retainedSize));
+    }
+
+    // The cells that the roots dominate directly, which own everything else.
+    static const size_t maxRetainers = 20;
+    Vector<unsigned> retainers;
+    for (unsigned node = 1; node < snapshot.nodeCount(); ++node) {
+        if (snapshot.dominator(node))
+            continue;
+        size_t index = retainers.size();
+        if (index == maxRetainers) {
+            if (snapshot.retainedSize(node) <= snapshot.retainedSize(retainers.last()))
+                continue;
+            --index;
+        } else
+            retainers.append(node);
+        for (; index && snapshot.retainedSize(retainers[index - 1]) < snapshot.retainedSize(node); --index)
+            retainers[index] = retainers[index - 1];
+        retainers[index] = node;
+    }
+    printf("\n%-24s %10s %12s\n", "Retainer", "Cell", "Retained");
+    for (size_t i = 0; i < retainers.size(); ++i)
+        printf("%-24s %10u %12lu\n", snapshot.className(retainers[i]), retainers[i], static_cast<unsigned long>(snapshot.retainedSize(retainers[i])));
+    return true;
+}
+
 int jscmain(int argc, char** argv, JSGlobalData* globalData)
 {
     JSLock lock(SilenceAssertionsOnly);
 
-    Options options;
+    CommandLine options;
     parseArguments(argc, argv, options, globalData);
 
+    if (options.heapSnapshotReport)
+        return printHeapSnapshotReport(options.heapSnapshotReport) ? 0 : 3;
+
     GlobalObject* globalObject = GlobalObject::create(*globalData, GlobalObject::createStructure(*globalData, jsNull()), options.arguments);
     bool success = runWithScripts(globalObject, options.scripts, options.dump);
     if (options.interactive && success)
@@ -67,6 +67,10 @@ namespace JSC {
 
         SourceProviderCache* cache() const { return m_cache; }
         void notifyCacheSizeChanged(int delta) { if (!m_cacheOwned) cacheSizeChanged(delta); }
+
+        // Names the source's file in the bytecode cache; see BytecodeCache.
+        const UString& bytecodeCacheKey() const { return m_bytecodeCacheKey; }
+        void setBytecodeCacheKey(const UString& key) { m_bytecodeCacheKey = key; }
         
     private:
         virtual void cacheSizeChanged(int delta) { UNUSED_PARAM(delta); }
@@ -75,6 +79,7 @@ namespace JSC {
         bool m_validated;
         SourceProviderCache* m_cache;
         bool m_cacheOwned;
+        UString m_bytecodeCacheKey;
     };
 
     class UStringSourceProvider : public SourceProvider {
@@ -26,10 +26,14 @@
 #include "config.h"
 #include "Executable.h"
 
+#include "BytecodeCache.h"
 #include "BytecodeGenerator.h"
 #include "CodeBlock.h"
+#include "DFGCapabilities.h"
 #include "DFGDriver.h"
+#include "DFGWorklist.h"
 #include "JIT.h"
+#include "Options.h"
 #include "Parser.h"
 #include "UStringBuilder.h"
 #include "Vector.h"
@@ -127,6 +131,28 @@ JSObject* EvalExecutable::compileOptimized(ExecState* exec, ScopeChainNode* scop
     return error;
 }
 
+#if ENABLE(DFG_JIT)
+// The jettisoned code goes on referring to the baseline code as its
+// alternative(), for the call frames that may still be running it.
+template<typename T>
+static void jettisonCodeBlock(JSGlobalData& globalData, OwnPtr<T>& codeBlock)
+{
+    ASSERT(codeBlock->getJITType() == JITCode::DFGJIT);
+    ASSERT(codeBlock->alternative());
+    OwnPtr<T> codeBlockToJettison = codeBlock.release();
+    codeBlock = adoptPtr(static_cast<T*>(codeBlockToJettison->alternative()));
+    codeBlockToJettison->unlinkIncomingCalls();
+    globalData.heap.jettisonDFGCodeBlock(static_pointer_cast<CodeBlock>(codeBlockToJettison.release()));
+}
+
+void EvalExecutable::jettisonOptimizedCode(JSGlobalData& globalData)
+{
+    jettisonCodeBlock(globalData, m_evalCodeBlock);
+    m_jitCodeForCall = m_evalCodeBlock->getJITCode();
+    ASSERT(!m_jitCodeForCallWithArityCheck);
+}
+#endif
+
 JSObject* EvalExecutable::compileInternal(ExecState* exec, ScopeChainNode* scopeChainNode, JITCode::JITType jitType)
 {
 #if !ENABLE(JIT)
@@ -257,26 +283,41 @@ JSObject* ProgramExecutable::compileInternal(ExecState* exec, ScopeChainNode* sc
     JSObject* exception = 0;
     JSGlobalData* globalData = &exec->globalData();
     JSGlobalObject* lexicalGlobalObject = exec->lexicalGlobalObject();
-    RefPtr<ProgramNode> programNode = globalData->parser->parse<ProgramNode>(lexicalGlobalObject, lexicalGlobalObject->debugger(), exec, m_source, 0, isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
-    if (!programNode) {
-        ASSERT(exception);
-        return exception;
+    BytecodeCache* bytecodeCache = BytecodeCache::forScopeChain(scopeChainNode);
+    OwnPtr<CachedBytecode> cachedBytecode;
+    if (bytecodeCache)
+        cachedBytecode = bytecodeCache->findProgram(this, scopeChainNode, !m_programCodeBlock);
+    RefPtr<ProgramNode> programNode;
+    if (cachedBytecode)
+        recordParse(cachedBytecode->features, cachedBytecode->hasCapturedVariables, cachedBytecode->lineNo, cachedBytecode->lastLine);
+    else {
+        programNode = globalData->parser->parse<ProgramNode>(lexicalGlobalObject, lexicalGlobalObject->debugger(), exec, m_source, 0, isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
+        if (!programNode) {
+            ASSERT(exception);
+            return exception;
+        }
+        recordParse(programNode->features(), programNode->hasCapturedVariables(), programNode->lineNo(), programNode->lastLine());
     }
-    recordParse(programNode->features(), programNode->hasCapturedVariables(), programNode->lineNo(), programNode->lastLine());
 
     JSGlobalObject* globalObject = scopeChainNode->globalObject.get();
     
     OwnPtr<CodeBlock> previousCodeBlock = m_programCodeBlock.release();
     ASSERT((jitType == JITCode::bottomTierJIT()) == !previousCodeBlock);
     m_programCodeBlock = adoptPtr(new ProgramCodeBlock(this, GlobalCode, globalObject, source().provider(), previousCodeBlock.release()));
-    OwnPtr<BytecodeGenerator> generator(adoptPtr(new BytecodeGenerator(programNode.get(), scopeChainNode, &globalObject->symbolTable(), m_programCodeBlock.get(), !!m_programCodeBlock->alternative() ? BytecodeGenerator::OptimizingCompilation : BytecodeGenerator::FirstCompilation)));
-    if ((exception = generator->generate())) {
-        m_programCodeBlock = static_pointer_cast<ProgramCodeBlock>(m_programCodeBlock->releaseAlternative());
+    if (cachedBytecode)
+        cachedBytecode->fill(m_programCodeBlock.get(), scopeChainNode);
+    else {
+        OwnPtr<BytecodeGenerator> generator(adoptPtr(new BytecodeGenerator(programNode.get(), scopeChainNode, &globalObject->symbolTable(), m_programCodeBlock.get(), !!m_programCodeBlock->alternative() ? BytecodeGenerator::OptimizingCompilation : BytecodeGenerator::FirstCompilation)));
+        if ((exception = generator->generate())) {
+            m_programCodeBlock = static_pointer_cast<ProgramCodeBlock>(m_programCodeBlock->releaseAlternative());
+            programNode->destroyData();
+            return exception;
+        }
+        if (bytecodeCache)
+            bytecodeCache->storeProgram(this, programNode.get(), m_programCodeBlock.get(), *generator, scopeChainNode);
         programNode->destroyData();
-        return exception;
     }
 
-    programNode->destroyData();
     m_programCodeBlock->copyDataFromAlternative();
 
 #if ENABLE(JIT)
@@ -316,6 +357,15 @@ JSObject* ProgramExecutable::compileInternal(ExecState* exec, ScopeChainNode* sc
     return 0;
 }
 
+#if ENABLE(DFG_JIT)
+void ProgramExecutable::jettisonOptimizedCode(JSGlobalData& globalData)
+{
+    jettisonCodeBlock(globalData, m_programCodeBlock);
+    m_jitCodeForCall = m_programCodeBlock->getJITCode();
+    ASSERT(!m_jitCodeForCallWithArityCheck);
+}
+#endif
+
 void ProgramExecutable::unlinkCalls()
 {
 #if ENABLE(JIT)
@@ -374,26 +424,42 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
 #endif
     JSObject* exception = 0;
     JSGlobalData* globalData = scopeChainNode->globalData;
-    RefPtr<FunctionBodyNode> body = globalData->parser->parse<FunctionBodyNode>(exec->lexicalGlobalObject(), 0, 0, m_source, m_parameters.get(), isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
-    if (!body) {
-        ASSERT(exception);
-        return exception;
+    BytecodeCache* bytecodeCache = BytecodeCache::forScopeChain(scopeChainNode);
+    OwnPtr<CachedBytecode> cachedBytecode;
+    if (bytecodeCache)
+        cachedBytecode = bytecodeCache->findFunction(this, CodeForCall, scopeChainNode);
+    RefPtr<FunctionBodyNode> body;
+    if (cachedBytecode)
+        recordParse(cachedBytecode->features, cachedBytecode->hasCapturedVariables, cachedBytecode->lineNo, cachedBytecode->lastLine);
+    else {
+        body = globalData->parser->parse<FunctionBodyNode>(exec->lexicalGlobalObject(), 0, 0, m_source, m_parameters.get(), isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
+        if (!body) {
+            ASSERT(exception);
+            return exception;
+        }
+        if (m_forceUsesArguments)
+            body->setUsesArguments();
+        body->finishParsing(m_parameters, m_name);
+        recordParse(body->features(), body->hasCapturedVariables(), body->lineNo(), body->lastLine());
     }
-    if (m_forceUsesArguments)
-        body->setUsesArguments();
-    body->finishParsing(m_parameters, m_name);
-    recordParse(body->features(), body->hasCapturedVariables(), body->lineNo(), body->lastLine());
 
     JSGlobalObject* globalObject = scopeChainNode->globalObject.get();
 
     OwnPtr<CodeBlock> previousCodeBlock = m_codeBlockForCall.release();
     ASSERT((jitType == JITCode::bottomTierJIT()) == !previousCodeBlock);
     m_codeBlockForCall = adoptPtr(new FunctionCodeBlock(this, FunctionCode, globalObject, source().provider(), source().startOffset(), false, previousCodeBlock.release()));
-    OwnPtr<BytecodeGenerator> generator(adoptPtr(new BytecodeGenerator(body.get(), scopeChainNode, m_codeBlockForCall->symbolTable(), m_codeBlockForCall.get(), !!m_codeBlockForCall->alternative() ? BytecodeGenerator::OptimizingCompilation : BytecodeGenerator::FirstCompilation)));
-    if ((exception = generator->generate())) {
-        m_codeBlockForCall = static_pointer_cast<FunctionCodeBlock>(m_codeBlockForCall->releaseAlternative());
+    if (cachedBytecode)
+        cachedBytecode->fill(m_codeBlockForCall.get(), scopeChainNode);
+    else {
+        OwnPtr<BytecodeGenerator> generator(adoptPtr(new BytecodeGenerator(body.get(), scopeChainNode, m_codeBlockForCall->symbolTable(), m_codeBlockForCall.get(), !!m_codeBlockForCall->alternative() ? BytecodeGenerator::OptimizingCompilation : BytecodeGenerator::FirstCompilation)));
+        if ((exception = generator->generate())) {
+            m_codeBlockForCall = static_pointer_cast<FunctionCodeBlock>(m_codeBlockForCall->releaseAlternative());
+            body->destroyData();
+            return exception;
+        }
+        if (bytecodeCache)
+            bytecodeCache->storeFunction(this, CodeForCall, body.get(), m_codeBlockForCall.get(), *generator, scopeChainNode);
         body->destroyData();
-        return exception;
     }
 
     m_numParametersForCall = m_codeBlockForCall->m_numParameters;
@@ -401,12 +467,22 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
     m_numCapturedVariables = m_codeBlockForCall->m_numCapturedVars;
     m_symbolTable = m_codeBlockForCall->sharedSymbolTable();
 
-    body->destroyData();
     m_codeBlockForCall->copyDataFromAlternative();
 
 #if ENABLE(JIT)
     if (exec->globalData().canUseJIT()) {
         bool dfgCompiled = false;
+#if ENABLE(CONCURRENT_JIT)
+        if (jitType == JITCode::DFGJIT && Options::useConcurrentJIT) {
+            // The baseline code runs on until the optimized code is installed;
+            // see installOptimizedCodeForCall().
+            OwnPtr<FunctionCodeBlock> optimizedCodeBlock = m_codeBlockForCall.release();
+            m_codeBlockForCall = adoptPtr(static_cast<FunctionCodeBlock*>(optimizedCodeBlock->alternative()));
+            m_symbolTable = m_codeBlockForCall->sharedSymbolTable();
+            DFG::enqueueFunctionCompilation(exec, calleeArgsExec, this, optimizedCodeBlock.release());
+            return 0;
+        }
+#endif
         if (jitType == JITCode::DFGJIT)
             dfgCompiled = DFG::tryCompileFunction(exec, calleeArgsExec, m_codeBlockForCall.get(), m_jitCodeForCall, m_jitCodeForCallWithArityCheck);
         if (dfgCompiled) {
@@ -421,7 +497,8 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
             m_jitCodeForCall = JIT::compile(scopeChainNode->globalData, m_codeBlockForCall.get(), &m_jitCodeForCallWithArityCheck);
         }
 #if !ENABLE(OPCODE_SAMPLING)
-        if (!BytecodeGenerator::dumpsGeneratedCode())
+        // The DFG inlines small functions by parsing their bytecode.
+        if (!BytecodeGenerator::dumpsGeneratedCode() && !DFG::canInlineFunctionForCall(m_codeBlockForCall.get()))
             m_codeBlockForCall->discardBytecode();
 #endif
         
@@ -445,32 +522,74 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
     return 0;
 }
 
+#if ENABLE(CONCURRENT_JIT)
+void FunctionExecutable::installOptimizedCodeForCall(PassOwnPtr<FunctionCodeBlock> codeBlock, const JITCode& jitCode, MacroAssemblerCodePtr jitCodeWithArityCheck)
+{
+    // The optimized CodeBlock takes over the baseline one, which it already
+    // refers to as its alternative.
+    ASSERT(codeBlock->alternative() == m_codeBlockForCall.get());
+    m_codeBlockForCall.leakPtr();
+    m_codeBlockForCall = codeBlock;
+    m_symbolTable = m_codeBlockForCall->sharedSymbolTable();
+    m_jitCodeForCall = jitCode;
+    m_jitCodeForCallWithArityCheck = jitCodeWithArityCheck;
+
+    m_codeBlockForCall->alternative()->unlinkIncomingCalls();
+#if !ENABLE(OPCODE_SAMPLING)
+    if (!BytecodeGenerator::dumpsGeneratedCode() && !DFG::canInlineFunctionForCall(m_codeBlockForCall.get()))
+        m_codeBlockForCall->discardBytecode();
+#endif
+    m_codeBlockForCall->setJITCode(m_jitCodeForCall, m_jitCodeForCallWithArityCheck);
+
+    // The new CodeBlock's constants may be younger than we are, or not yet
+    // marked if marking is under way.
+    Heap::writeBarrier(this);
+    Heap::heap(this)->reportExtraMemoryCost(sizeof(*m_codeBlockForCall) + m_jitCodeForCall.size());
+}
+#endif
+
 JSObject* FunctionExecutable::compileForConstructInternal(ExecState* exec, ScopeChainNode* scopeChainNode, JITCode::JITType jitType)
 {
     UNUSED_PARAM(jitType);
     
     JSObject* exception = 0;
     JSGlobalData* globalData = scopeChainNode->globalData;
-    RefPtr<FunctionBodyNode> body = globalData->parser->parse<FunctionBodyNode>(exec->lexicalGlobalObject(), 0, 0, m_source, m_parameters.get(), isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
-    if (!body) {
-        ASSERT(exception);
-        return exception;
+    BytecodeCache* bytecodeCache = BytecodeCache::forScopeChain(scopeChainNode);
+    OwnPtr<CachedBytecode> cachedBytecode;
+    if (bytecodeCache)
+        cachedBytecode = bytecodeCache->findFunction(this, CodeForConstruct, scopeChainNode);
+    RefPtr<FunctionBodyNode> body;
+    if (cachedBytecode)
+        recordParse(cachedBytecode->features, cachedBytecode->hasCapturedVariables, cachedBytecode->lineNo, cachedBytecode->lastLine);
+    else {
+        body = globalData->parser->parse<FunctionBodyNode>(exec->lexicalGlobalObject(), 0, 0, m_source, m_parameters.get(), isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
+        if (!body) {
+            ASSERT(exception);
+            return exception;
+        }
+        if (m_forceUsesArguments)
+            body->setUsesArguments();
+        body->finishParsing(m_parameters, m_name);
+        recordParse(body->features(), body->hasCapturedVariables(), body->lineNo(), body->lastLine());
     }
-    if (m_forceUsesArguments)
-        body->setUsesArguments();
-    body->finishParsing(m_parameters, m_name);
-    recordParse(body->features(), body->hasCapturedVariables(), body->lineNo(), body->lastLine());
 
     JSGlobalObject* globalObject = scopeChainNode->globalObject.get();
 
     OwnPtr<CodeBlock> previousCodeBlock = m_codeBlockForConstruct.release();
     ASSERT((jitType == JITCode::bottomTierJIT()) == !previousCodeBlock);
     m_codeBlockForConstruct = adoptPtr(new FunctionCodeBlock(this, FunctionCode, globalObject, source().provider(), source().startOffset(), true, previousCodeBlock.release()));
-    OwnPtr<BytecodeGenerator> generator(adoptPtr(new BytecodeGenerator(body.get(), scopeChainNode, m_codeBlockForConstruct->symbolTable(), m_codeBlockForConstruct.get(), !!m_codeBlockForConstruct->alternative() ? BytecodeGenerator::OptimizingCompilation : BytecodeGenerator::FirstCompilation)));
-    if ((exception = generator->generate())) {
-        m_codeBlockForConstruct = static_pointer_cast<FunctionCodeBlock>(m_codeBlockForConstruct->releaseAlternative());
+    if (cachedBytecode)
+        cachedBytecode->fill(m_codeBlockForConstruct.get(), scopeChainNode);
+    else {
+        OwnPtr<BytecodeGenerator> generator(adoptPtr(new BytecodeGenerator(body.get(), scopeChainNode, m_codeBlockForConstruct->symbolTable(), m_codeBlockForConstruct.get(), !!m_codeBlockForConstruct->alternative() ? BytecodeGenerator::OptimizingCompilation : BytecodeGenerator::FirstCompilation)));
+        if ((exception = generator->generate())) {
+            m_codeBlockForConstruct = static_pointer_cast<FunctionCodeBlock>(m_codeBlockForConstruct->releaseAlternative());
+            body->destroyData();
+            return exception;
+        }
+        if (bytecodeCache)
+            bytecodeCache->storeFunction(this, CodeForConstruct, body.get(), m_codeBlockForConstruct.get(), *generator, scopeChainNode);
         body->destroyData();
-        return exception;
     }
 
     m_numParametersForConstruct = m_codeBlockForConstruct->m_numParameters;
@@ -478,7 +597,6 @@ JSObject* FunctionExecutable::compileForConstructInternal(ExecState* exec, Scope
     m_numCapturedVariables = m_codeBlockForConstruct->m_numCapturedVars;
     m_symbolTable = m_codeBlockForConstruct->sharedSymbolTable();
 
-    body->destroyData();
     m_codeBlockForConstruct->copyDataFromAlternative();
 
 #if ENABLE(JIT)
@@ -519,6 +637,24 @@ JSObject* FunctionExecutable::compileForConstructInternal(ExecState* exec, Scope
     return 0;
 }
 
+#if ENABLE(DFG_JIT)
+void FunctionExecutable::jettisonOptimizedCodeForCall(JSGlobalData& globalData)
+{
+    jettisonCodeBlock(globalData, m_codeBlockForCall);
+    m_symbolTable = m_codeBlockForCall->sharedSymbolTable();
+    m_jitCodeForCall = m_codeBlockForCall->getJITCode();
+    m_jitCodeForCallWithArityCheck = m_codeBlockForCall->getJITCodeWithArityCheck();
+}
+
+void FunctionExecutable::jettisonOptimizedCodeForConstruct(JSGlobalData& globalData)
+{
+    jettisonCodeBlock(globalData, m_codeBlockForConstruct);
+    m_symbolTable = m_codeBlockForConstruct->sharedSymbolTable();
+    m_jitCodeForConstruct = m_codeBlockForConstruct->getJITCode();
+    m_jitCodeForConstructWithArityCheck = m_codeBlockForConstruct->getJITCodeWithArityCheck();
+}
+#endif
+
 void FunctionExecutable::visitChildren(SlotVisitor& visitor)
 {
     ASSERT_GC_OBJECT_INHERITS(this, &s_info);
@@ -543,6 +679,11 @@ void FunctionExecutable::discardCode()
         return;
     if (!m_jitCodeForConstruct && m_codeBlockForConstruct)
         return;
+#endif
+#if ENABLE(CONCURRENT_JIT)
+    // Any pending compilation may have inlined our bytecode.
+    if (DFG::Worklist* worklist = Heap::heap(this)->globalData()->dfgWorklist.get())
+        worklist->removeAllPlans();
 #endif
     clearCode();
 }
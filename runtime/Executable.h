@@ -312,6 +312,10 @@ namespace JSC {
         }
         
         JSObject* compileOptimized(ExecState*, ScopeChainNode*);
+        
+#if ENABLE(DFG_JIT)
+        void jettisonOptimizedCode(JSGlobalData&);
+#endif
 
         EvalCodeBlock& generatedBytecode()
         {
@@ -377,6 +381,10 @@ namespace JSC {
         }
 
         JSObject* compileOptimized(ExecState*, ScopeChainNode*);
+        
+#if ENABLE(DFG_JIT)
+        void jettisonOptimizedCode(JSGlobalData&);
+#endif
 
         ProgramCodeBlock& generatedBytecode()
         {
@@ -541,11 +549,34 @@ namespace JSC {
 
         const Identifier& name() { return m_name; }
         JSString* nameValue() const { return m_nameValue.get(); }
+        FunctionParameters* parameters() const { return m_parameters.get(); }
         size_t parameterCount() const { return m_parameters->size(); }
+        bool forceUsesArguments() const { return m_forceUsesArguments; }
         unsigned capturedVariableCount() const { return m_numCapturedVariables; }
         UString paramString() const;
         SharedSymbolTable* symbolTable() const { return m_symbolTable; }
 
+#if ENABLE(DFG_JIT)
+        void jettisonOptimizedCodeForCall(JSGlobalData&);
+        void jettisonOptimizedCodeForConstruct(JSGlobalData&);
+        
+        void jettisonOptimizedCodeFor(JSGlobalData& globalData, CodeSpecializationKind kind)
+        {
+            if (kind == CodeForCall)
+                jettisonOptimizedCodeForCall(globalData);
+            else {
+                ASSERT(kind == CodeForConstruct);
+                jettisonOptimizedCodeForConstruct(globalData);
+            }
+        }
+#endif
+
+#if ENABLE(CONCURRENT_JIT)
+        // Called back by the DFG when an optimizing compilation started by
+        // compileOptimizedForCall() has finished on its thread.
+        void installOptimizedCodeForCall(PassOwnPtr<FunctionCodeBlock>, const JITCode&, MacroAssemblerCodePtr jitCodeWithArityCheck);
+#endif
+
         void discardCode();
         void visitChildren(SlotVisitor&);
         static FunctionExecutable* fromGlobalCode(const Identifier&, ExecState*, Debugger*, const SourceCode&, JSObject** exception);
@@ -33,6 +33,7 @@
 #include "Heap.h"
 #include "Identifier.h"
 #include "JSGlobalObject.h"
+#include "Options.h"
 #include "UString.h"
 #include "WriteBarrier.h"
 #include "dtoa.h"
@@ -52,6 +53,7 @@ static void initializeThreadingOnce()
 {
     WTF::double_conversion::initialize();
     WTF::initializeThreading();
+    Options::initializeOptions();
 #if ENABLE(WRITE_BARRIER_PROFILING)
     WriteBarrierCounters::initialize();
 #endif
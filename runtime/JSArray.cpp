@@ -143,14 +143,14 @@ void JSArray::finishCreation(JSGlobalData& globalData)
 
     unsigned initialCapacity = 0;
 
-    m_storage = static_cast<ArrayStorage*>(fastZeroedMalloc(storageSize(initialCapacity)));
+    m_storage = static_cast<ArrayStorage*>(globalData.heap.allocateStorage(this, storageSize(initialCapacity)));
+    memset(m_storage, 0, storageSize(initialCapacity));
     m_storage->m_allocBase = m_storage;
     m_indexBias = 0;
     m_vectorLength = initialCapacity;
+    m_sparseValueMap = 0;
 
     checkConsistency();
-
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(0));
 }
 
 void JSArray::finishCreation(JSGlobalData& globalData, unsigned initialLength, ArrayCreationMode creationMode)
@@ -164,12 +164,12 @@ void JSArray::finishCreation(JSGlobalData& globalData, unsigned initialLength, A
     else
         initialCapacity = min(BASE_VECTOR_LEN, MIN_SPARSE_ARRAY_INDEX);
     
-    m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
+    m_storage = static_cast<ArrayStorage*>(globalData.heap.allocateStorage(this, storageSize(initialCapacity)));
     m_storage->m_allocBase = m_storage;
     m_storage->m_length = initialLength;
     m_indexBias = 0;
     m_vectorLength = initialCapacity;
-    m_storage->m_sparseValueMap = 0;
+    m_sparseValueMap = 0;
     m_storage->subclassData = 0;
     m_storage->reportedMapCapacity = 0;
 
@@ -191,8 +191,6 @@ void JSArray::finishCreation(JSGlobalData& globalData, unsigned initialLength, A
     }
 
     checkConsistency();
-    
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(initialCapacity));
 }
 
 void JSArray::finishCreation(JSGlobalData& globalData, const ArgList& list)
@@ -210,13 +208,13 @@ void JSArray::finishCreation(JSGlobalData& globalData, const ArgList& list)
     else
         initialStorage = initialCapacity;
     
-    m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialStorage)));
+    m_storage = static_cast<ArrayStorage*>(globalData.heap.allocateStorage(this, storageSize(initialStorage)));
     m_storage->m_allocBase = m_storage;
     m_indexBias = 0;
     m_storage->m_length = initialCapacity;
     m_vectorLength = initialStorage;
     m_storage->m_numValuesInVector = initialCapacity;
-    m_storage->m_sparseValueMap = 0;
+    m_sparseValueMap = 0;
     m_storage->subclassData = 0;
     m_storage->reportedMapCapacity = 0;
 #if CHECK_ARRAY_CONSISTENCY
@@ -232,17 +230,16 @@ void JSArray::finishCreation(JSGlobalData& globalData, const ArgList& list)
         vector[i].clear();
 
     checkConsistency();
-
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(initialStorage));
 }
 
+// By the time a dead array is destroyed, a collection may have freed the
+// copied block that its storage was in, so the storage must not be touched.
 JSArray::~JSArray()
 {
     ASSERT(vptr() == JSGlobalData::jsArrayVPtr);
-    checkConsistency(DestructorConsistencyCheck);
 
-    delete m_storage->m_sparseValueMap;
-    fastFree(m_storage->m_allocBase);
+    delete m_sparseValueMap;
+    Heap::heap(this)->freeStorage(this, reinterpret_cast<char*>(m_storage) - m_indexBias * sizeof(JSValue));
 }
 
 bool JSArray::getOwnPropertySlot(ExecState* exec, unsigned i, PropertySlot& slot)
@@ -261,7 +258,7 @@ bool JSArray::getOwnPropertySlot(ExecState* exec, unsigned i, PropertySlot& slot
             slot.setValue(value);
             return true;
         }
-    } else if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    } else if (SparseArrayValueMap* map = m_sparseValueMap) {
         if (i >= MIN_SPARSE_ARRAY_INDEX) {
             SparseArrayValueMap::iterator it = map->find(i);
             if (it != map->end()) {
@@ -309,7 +306,7 @@ bool JSArray::getOwnPropertyDescriptor(ExecState* exec, const Identifier& proper
                 descriptor.setDescriptor(value.get(), 0);
                 return true;
             }
-        } else if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+        } else if (SparseArrayValueMap* map = m_sparseValueMap) {
             if (i >= MIN_SPARSE_ARRAY_INDEX) {
                 SparseArrayValueMap::iterator it = map->find(i);
                 if (it != map->end()) {
@@ -377,7 +374,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
 {
     ArrayStorage* storage = m_storage;
     
-    SparseArrayValueMap* map = storage->m_sparseValueMap;
+    SparseArrayValueMap* map = m_sparseValueMap;
 
     if (i >= MIN_SPARSE_ARRAY_INDEX) {
         if (i > MAX_ARRAY_INDEX) {
@@ -391,7 +388,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
         if ((i > MAX_STORAGE_VECTOR_INDEX) || !isDenseEnoughForVector(i + 1, storage->m_numValuesInVector + 1)) {
             if (!map) {
                 map = new SparseArrayValueMap;
-                storage->m_sparseValueMap = map;
+                m_sparseValueMap = map;
             }
 
             WriteBarrier<Unknown> temp;
@@ -445,8 +442,9 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
     }
 
     void* baseStorage = storage->m_allocBase;
+    size_t usedBytes = reinterpret_cast<char*>(storage->m_vector + m_vectorLength) - static_cast<char*>(baseStorage);
     
-    if (!tryFastRealloc(baseStorage, storageSize(newVectorLength + m_indexBias)).getValue(baseStorage)) {
+    if (!Heap::heap(this)->tryReallocateStorage(this, baseStorage, usedBytes, storageSize(newVectorLength + m_indexBias))) {
         throwOutOfMemoryError(exec);
         return;
     }
@@ -479,8 +477,6 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
     storage->m_vector[i].set(exec->globalData(), this, value);
 
     checkConsistency();
-
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(newVectorLength) - storageSize(vectorLength));
 }
 
 bool JSArray::deleteProperty(ExecState* exec, const Identifier& propertyName)
@@ -514,7 +510,7 @@ bool JSArray::deleteProperty(ExecState* exec, unsigned i)
         return true;
     }
 
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         if (i >= MIN_SPARSE_ARRAY_INDEX) {
             SparseArrayValueMap::iterator it = map->find(i);
             if (it != map->end()) {
@@ -547,7 +543,7 @@ void JSArray::getOwnPropertyNames(ExecState* exec, PropertyNameArray& propertyNa
             propertyNames.add(Identifier::from(exec, i));
     }
 
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         SparseArrayValueMap::iterator end = map->end();
         for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it)
             propertyNames.add(Identifier::from(exec, it->first));
@@ -598,8 +594,9 @@ bool JSArray::increaseVectorLength(unsigned newLength)
     ASSERT(newLength <= MAX_STORAGE_VECTOR_INDEX);
     unsigned newVectorLength = getNewVectorLength(newLength);
     void* baseStorage = storage->m_allocBase;
+    size_t usedBytes = reinterpret_cast<char*>(storage->m_vector + vectorLength) - static_cast<char*>(baseStorage);
 
-    if (!tryFastRealloc(baseStorage, storageSize(newVectorLength + m_indexBias)).getValue(baseStorage))
+    if (!Heap::heap(this)->tryReallocateStorage(this, baseStorage, usedBytes, storageSize(newVectorLength + m_indexBias)))
         return false;
 
     storage = m_storage = reinterpret_cast_ptr<ArrayStorage*>(static_cast<char*>(baseStorage) + m_indexBias * sizeof(JSValue));
@@ -610,8 +607,6 @@ bool JSArray::increaseVectorLength(unsigned newLength)
         vector[i].clear();
 
     m_vectorLength = newVectorLength;
-    
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(newVectorLength) - storageSize(vectorLength));
 
     return true;
 }
@@ -628,7 +623,7 @@ bool JSArray::increaseVectorPrefixLength(unsigned newLength)
     ASSERT(newLength <= MAX_STORAGE_VECTOR_INDEX);
     unsigned newVectorLength = getNewVectorLength(newLength);
 
-    void* newBaseStorage = fastMalloc(storageSize(newVectorLength + m_indexBias));
+    void* newBaseStorage = Heap::heap(this)->tryAllocateStorage(this, storageSize(newVectorLength + m_indexBias));
     if (!newBaseStorage)
         return false;
     
@@ -642,12 +637,11 @@ bool JSArray::increaseVectorPrefixLength(unsigned newLength)
     m_storage->m_allocBase = newBaseStorage;
     m_vectorLength = newLength;
     
-    fastFree(storage->m_allocBase);
+    Heap::heap(this)->freeStorage(this, storage->m_allocBase);
     ASSERT(newLength > vectorLength);
     unsigned delta = newLength - vectorLength;
     for (unsigned i = 0; i < delta; i++)
         m_storage->m_vector[i].clear();
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(newVectorLength) - storageSize(vectorLength));
     
     return true;
 }
@@ -675,7 +669,7 @@ void JSArray::setLength(unsigned newLength)
             storage->m_numValuesInVector -= hadValue;
         }
 
-        if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+        if (SparseArrayValueMap* map = m_sparseValueMap) {
             SparseArrayValueMap copy = *map;
             SparseArrayValueMap::iterator end = copy.end();
             for (SparseArrayValueMap::iterator it = copy.begin(); it != end; ++it) {
@@ -684,7 +678,7 @@ void JSArray::setLength(unsigned newLength)
             }
             if (map->isEmpty()) {
                 delete map;
-                storage->m_sparseValueMap = 0;
+                m_sparseValueMap = 0;
             }
         }
     }
@@ -718,14 +712,14 @@ JSValue JSArray::pop()
             result = jsUndefined();
     } else {
         result = jsUndefined();
-        if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+        if (SparseArrayValueMap* map = m_sparseValueMap) {
             SparseArrayValueMap::iterator it = map->find(length);
             if (it != map->end()) {
                 result = it->second.get();
                 map->remove(it);
                 if (map->isEmpty()) {
                     delete map;
-                    storage->m_sparseValueMap = 0;
+                    m_sparseValueMap = 0;
                 }
             }
         }
@@ -759,7 +753,7 @@ void JSArray::push(ExecState* exec, JSValue value)
     }
 
     if (storage->m_length < MIN_SPARSE_ARRAY_INDEX) {
-        SparseArrayValueMap* map = storage->m_sparseValueMap;
+        SparseArrayValueMap* map = m_sparseValueMap;
         if (!map || map->isEmpty()) {
             if (increaseVectorLength(storage->m_length + 1)) {
                 storage = m_storage;
@@ -898,7 +892,7 @@ void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType cal
     ArrayStorage* storage = m_storage;
 
     unsigned lengthNotIncludingUndefined = compactForSorting();
-    if (storage->m_sparseValueMap) {
+    if (m_sparseValueMap) {
         throwOutOfMemoryError(exec);
         return;
     }
@@ -931,7 +925,7 @@ void JSArray::sort(ExecState* exec)
     ArrayStorage* storage = m_storage;
 
     unsigned lengthNotIncludingUndefined = compactForSorting();
-    if (storage->m_sparseValueMap) {
+    if (m_sparseValueMap) {
         throwOutOfMemoryError(exec);
         return;
     }
@@ -1089,7 +1083,7 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
         return;
 
     unsigned usedVectorLength = min(storage->m_length, m_vectorLength);
-    unsigned nodeCount = usedVectorLength + (storage->m_sparseValueMap ? storage->m_sparseValueMap->size() : 0);
+    unsigned nodeCount = usedVectorLength + (m_sparseValueMap ? m_sparseValueMap->size() : 0);
 
     if (!nodeCount)
         return;
@@ -1139,7 +1133,7 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
 
     unsigned newUsedVectorLength = numDefined + numUndefined;
 
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         newUsedVectorLength += map->size();
         if (newUsedVectorLength > m_vectorLength) {
             // Check that it is possible to allocate an array large enough to hold all the entries.
@@ -1159,7 +1153,7 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
         }
 
         delete map;
-        storage->m_sparseValueMap = 0;
+        m_sparseValueMap = 0;
     }
 
     ASSERT(tree.abstractor().m_nodes.size() >= numDefined);
@@ -1254,7 +1248,7 @@ unsigned JSArray::compactForSorting()
 
     unsigned newUsedVectorLength = numDefined + numUndefined;
 
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         newUsedVectorLength += map->size();
         if (newUsedVectorLength > m_vectorLength) {
             // Check that it is possible to allocate an array large enough to hold all the entries - if not,
@@ -1270,7 +1264,7 @@ unsigned JSArray::compactForSorting()
             storage->m_vector[numDefined++].setWithoutWriteBarrier(it->second.get());
 
         delete map;
-        storage->m_sparseValueMap = 0;
+        m_sparseValueMap = 0;
     }
 
     for (unsigned i = numDefined; i < newUsedVectorLength; ++i)
@@ -1303,7 +1297,7 @@ void JSArray::checkConsistency(ConsistencyCheckType type)
 
     ASSERT(storage);
     if (type == SortConsistencyCheck)
-        ASSERT(!storage->m_sparseValueMap);
+        ASSERT(!m_sparseValueMap);
 
     unsigned numValuesInVector = 0;
     for (unsigned i = 0; i < m_vectorLength; ++i) {
@@ -1320,9 +1314,9 @@ void JSArray::checkConsistency(ConsistencyCheckType type)
     ASSERT(numValuesInVector == storage->m_numValuesInVector);
     ASSERT(numValuesInVector <= storage->m_length);
 
-    if (storage->m_sparseValueMap) {
-        SparseArrayValueMap::iterator end = storage->m_sparseValueMap->end();
-        for (SparseArrayValueMap::iterator it = storage->m_sparseValueMap->begin(); it != end; ++it) {
+    if (m_sparseValueMap) {
+        SparseArrayValueMap::iterator end = m_sparseValueMap->end();
+        for (SparseArrayValueMap::iterator it = m_sparseValueMap->begin(); it != end; ++it) {
             unsigned index = it->first;
             ASSERT(index < storage->m_length);
             ASSERT(index >= storage->m_vectorLength);
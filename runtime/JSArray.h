@@ -37,9 +37,8 @@ namespace JSC {
     struct ArrayStorage {
         unsigned m_length; // The "length" property on the array
         unsigned m_numValuesInVector;
-        SparseArrayValueMap* m_sparseValueMap;
         void* subclassData; // A JSArray subclass can use this to fill the vector lazily.
-        void* m_allocBase; // Pointer to base address returned by malloc().  Keeping this pointer does eliminate false positives from the leak detector.
+        void* m_allocBase; // Pointer to base address returned by Heap::allocateStorage().
         size_t reportedMapCapacity;
 #if CHECK_ARRAY_CONSISTENCY
         bool m_inCompactInitialization;
@@ -193,6 +192,7 @@ namespace JSC {
         unsigned m_vectorLength; // The valid length of m_vector
         int m_indexBias; // The number of JSValue sized blocks before ArrayStorage.
         ArrayStorage *m_storage;
+        SparseArrayValueMap* m_sparseValueMap; // Kept out of the storage, which the array's destructor cannot touch.
     };
 
     JSArray* asArray(JSValue);
@@ -217,10 +217,18 @@ namespace JSC {
         
         ArrayStorage* storage = m_storage;
 
+        void* baseStorage = storage->m_allocBase;
+        size_t usedBytes = reinterpret_cast<char*>(storage->m_vector + m_vectorLength) - static_cast<char*>(baseStorage);
+        void* newBaseStorage = visitor.visitStorage(baseStorage, usedBytes);
+        if (newBaseStorage != baseStorage) {
+            storage = m_storage = reinterpret_cast_ptr<ArrayStorage*>(static_cast<char*>(newBaseStorage) + m_indexBias * sizeof(JSValue));
+            storage->m_allocBase = newBaseStorage;
+        }
+
         unsigned usedVectorLength = std::min(storage->m_length, m_vectorLength);
         visitor.appendValues(storage->m_vector, usedVectorLength);
 
-        if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+        if (SparseArrayValueMap* map = m_sparseValueMap) {
             SparseArrayValueMap::iterator end = map->end();
             for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it)
                 visitor.append(&it->second);
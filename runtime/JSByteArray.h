@@ -102,6 +102,8 @@ namespace JSC {
 
         WTF::ByteArray* storage() const { return m_storage.get(); }
 
+        static size_t offsetOfStorage() { return OBJECT_OFFSETOF(JSByteArray, m_storage); }
+
 #if !ASSERT_DISABLED
         virtual ~JSByteArray();
 #endif
@@ -31,8 +31,10 @@
 #include "JSGlobalData.h"
 
 #include "ArgList.h"
+#include "BytecodeCache.h"
 #include "Heap.h"
 #include "CommonIdentifiers.h"
+#include "DFGWorklist.h"
 #include "DebuggerActivation.h"
 #include "FunctionConstructor.h"
 #include "GetterSetter.h"
@@ -135,7 +137,7 @@ void JSGlobalData::storeVPtrs()
 {
     // Enough storage to fit a JSArray, JSByteArray, JSString, or JSFunction.
     // COMPILE_ASSERTS below check that this is true.
-    char storage[64];
+    char storage[80];
 
     COMPILE_ASSERT(sizeof(JSFinalObject) <= sizeof(storage), sizeof_JSFinalObject_must_be_less_than_storage);
     JSCell* jsFinalObject = new (storage) JSFinalObject(JSFinalObject::VPtrStealingHack);
@@ -68,6 +68,7 @@ inline double fmodSin(double v)
 
 namespace JSC {
 
+    class BytecodeCache;
     class CodeBlock;
     class CommonIdentifiers;
     class HandleStack;
@@ -85,6 +86,11 @@ namespace JSC {
 #if ENABLE(REGEXP_TRACING)
     class RegExp;
 #endif
+#if ENABLE(CONCURRENT_JIT)
+    namespace DFG {
+    class Worklist;
+    }
+#endif
 
     struct HashTable;
     struct Instruction;
@@ -234,6 +240,12 @@ namespace JSC {
         NativeExecutable* getHostFunction(NativeFunction, ThunkGenerator);
 #endif
         NativeExecutable* getHostFunction(NativeFunction);
+#if ENABLE(CONCURRENT_JIT)
+        // Created with the first optimizing compilation of a function.
+        OwnPtr<DFG::Worklist> dfgWorklist;
+#endif
+        // Set by embedders that want bytecode kept on disk between runs.
+        OwnPtr<BytecodeCache> bytecodeCache;
 
         TimeoutChecker timeoutChecker;
         Terminator terminator;
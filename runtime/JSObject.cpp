@@ -613,26 +613,14 @@ void JSObject::allocatePropertyStorage(JSGlobalData& globalData, size_t oldSize,
 
     // It's important that this function not rely on m_structure, since
     // we might be in the middle of a transition.
-    PropertyStorage newPropertyStorage = 0;
-    if (globalData.heap.inPropertyStorageNursery(m_propertyStorage.get())) {
-        newPropertyStorage = static_cast<PropertyStorage>(globalData.heap.allocatePropertyStorage(newSize * sizeof(WriteBarrierBase<Unknown>)));
-        if (!newPropertyStorage || !globalData.heap.inPropertyStorageNursery(m_propertyStorage.get())) {
-            // If allocation failed because it's too big, or it triggered a GC
-            // that promoted us to old space, we need to allocate our property
-            // storage in old space.
-            newPropertyStorage = new WriteBarrierBase<Unknown>[newSize];
-        }
-    } else
-        newPropertyStorage = new WriteBarrierBase<Unknown>[newSize];
-
+    PropertyStorage newPropertyStorage = static_cast<PropertyStorage>(globalData.heap.allocateStorage(this, newSize * sizeof(WriteBarrierBase<Unknown>)));
     PropertyStorage oldPropertyStorage = m_propertyStorage.get();
-    ASSERT(newPropertyStorage);
 
     for (unsigned i = 0; i < oldSize; ++i)
        newPropertyStorage[i] = oldPropertyStorage[i];
 
-    if (!isUsingInlineStorage() && !globalData.heap.inPropertyStorageNursery(m_propertyStorage.get()))
-        delete [] oldPropertyStorage;
+    if (!isUsingInlineStorage())
+        globalData.heap.freeStorage(this, oldPropertyStorage);
 
     m_propertyStorage.set(globalData, this, newPropertyStorage);
 }
@@ -219,9 +219,14 @@ namespace JSC {
         void allocatePropertyStorage(JSGlobalData&, size_t oldSize, size_t newSize);
         bool isUsingInlineStorage() const { return static_cast<const void*>(m_propertyStorage.get()) == static_cast<const void*>(this + 1); }
 
-        void* addressOfPropertyAtOffset(size_t offset)
+        // A compacting collection moves a final object by copying its bytes,
+        // after which the copy must point at its own inline storage.
+        void didMoveFrom(const JSObject* oldCell)
         {
-            return static_cast<void*>(&m_propertyStorage[offset]);
+            if (oldCell->isUsingInlineStorage())
+                m_propertyStorage.set(reinterpret_cast<PropertyStorage>(this + 1), StorageBarrier::Unchecked);
+            else
+                Heap::heap(this)->didMoveStorage(m_propertyStorage.get(), oldCell, this);
         }
 
         static const unsigned baseExternalStorageCapacity = 16;
@@ -449,8 +454,8 @@ inline JSObject::JSObject(JSGlobalData& globalData, Structure* structure, Proper
 
 inline JSObject::~JSObject()
 {
-    if (!isUsingInlineStorage() && !Heap::heap(this)->inPropertyStorageNursery(m_propertyStorage.get()))
-        delete [] m_propertyStorage.get();
+    if (!isUsingInlineStorage())
+        Heap::heap(this)->freeStorage(this, m_propertyStorage.get());
 }
 
 inline JSValue JSObject::prototype() const
@@ -871,11 +876,9 @@ ALWAYS_INLINE void JSObject::visitChildrenDirect(SlotVisitor& visitor)
     JSCell::visitChildren(visitor);
 
     PropertyStorage storage = propertyStorage();
-    if (Heap::heap(this)->inPropertyStorageNursery(storage)) {
-        m_propertyStorage.set(new WriteBarrierBase<Unknown>[structure()->propertyStorageCapacity()], StorageBarrier::Unchecked);
-        if (structure()->propertyStorageCapacity() > m_structure->propertyStorageSize())
-            ASSERT(!storage[m_structure->propertyStorageSize()]);
-        memcpy(m_propertyStorage.get(), storage, m_structure->propertyStorageSize() * sizeof(WriteBarrierBase<Unknown>));
+    if (!isUsingInlineStorage()) {
+        storage = static_cast<PropertyStorage>(visitor.visitStorage(storage, m_structure->propertyStorageCapacity() * sizeof(WriteBarrierBase<Unknown>)));
+        m_propertyStorage.set(storage, StorageBarrier::Unchecked);
     }
     size_t storageSize = m_structure->propertyStorageSize();
     visitor.appendValues(storage, storageSize);
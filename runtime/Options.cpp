@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "Options.h"
+
+#include <algorithm>
+#include <wtf/NumberOfCores.h>
+
+#if PLATFORM(EA)
+#include <JSSettingsEA.h>
+#endif
+
+namespace JSC { namespace Options {
+
+unsigned numberOfGCMarkers;
+unsigned opaqueRootMergeThreshold;
+unsigned minimumNumberOfCellsToKeep;
+unsigned minimumNumberOfScansBetweenRebalance;
+unsigned sharedStackWakeupThreshold;
+
+bool useGenerationalGC;
+
+double incrementalMarkingPauseBudget;
+unsigned maximumNumberOfCellsPerMarkingSlice;
+
+double compactionOccupancyThreshold;
+
+bool useDFGJIT;
+int executionCounterValueForOptimizeAfterWarmUp;
+int executionCounterValueForOptimizeSoon;
+unsigned maximumOptimizationDelay;
+
+bool useConcurrentJIT;
+unsigned maximumCompilationQueueDepth;
+
+unsigned maximumInliningDepth;
+unsigned maximumInliningInstructionCount;
+
+unsigned osrExitCountForReoptimization;
+unsigned osrExitCountForFrequentExitSite;
+
+static const unsigned maximumNumberOfGCMarkers = 4;
+
+#define SET(variable, value) variable = value
+
+void initializeOptions()
+{
+    int cpusToUse = 1;
+#if ENABLE(PARALLEL_GC)
+    cpusToUse = std::min(std::max(WTF::numberOfProcessorCores(), 1), static_cast<int>(maximumNumberOfGCMarkers));
+#endif
+#if PLATFORM(EA)
+    // The host application decides how many cores the collector may use.
+    cpusToUse = static_cast<int>(JSGetGCMarkerThreadCount());
+#endif
+
+    SET(numberOfGCMarkers, cpusToUse);
+    SET(opaqueRootMergeThreshold, 1000);
+    SET(minimumNumberOfCellsToKeep, 10);
+    SET(minimumNumberOfScansBetweenRebalance, 10000);
+    SET(sharedStackWakeupThreshold, 1);
+
+    SET(useGenerationalGC, true);
+
+    double pauseBudget = 0;
+#if PLATFORM(EA)
+    pauseBudget = JSGetGCPauseBudget() / 1000;
+#endif
+
+    SET(incrementalMarkingPauseBudget, pauseBudget);
+    SET(maximumNumberOfCellsPerMarkingSlice, 0);
+
+    SET(compactionOccupancyThreshold, 0.5);
+
+    SET(useDFGJIT, true);
+    SET(executionCounterValueForOptimizeAfterWarmUp, -1000);
+    SET(executionCounterValueForOptimizeSoon, -100);
+    SET(maximumOptimizationDelay, 5);
+
+    SET(useConcurrentJIT, WTF::numberOfProcessorCores() > 1);
+    SET(maximumCompilationQueueDepth, 16);
+
+    SET(maximumInliningDepth, 5);
+    SET(maximumInliningInstructionCount, 100);
+
+    SET(osrExitCountForReoptimization, 100);
+    SET(osrExitCountForFrequentExitSite, 10);
+}
+
+} } // namespace JSC::Options
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2013 Electronic Arts, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS, INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ELECTRONIC ARTS, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef Options_h
+#define Options_h
+
+namespace JSC { namespace Options {
+
+// Tunables for the garbage collector and the JITs. These are set once by
+// initializeOptions() and may be overridden by the embedder (see jsc.cpp and
+// JSSettingsEA) before the first collection.
+
+extern unsigned numberOfGCMarkers;
+extern unsigned opaqueRootMergeThreshold;
+extern unsigned minimumNumberOfCellsToKeep;
+extern unsigned minimumNumberOfScansBetweenRebalance;
+extern unsigned sharedStackWakeupThreshold;
+
+extern bool useGenerationalGC;
+
+// Seconds that one slice of incremental marking may take; 0 marks the whole
+// heap in a single pause. A slice also ends after visiting
+// maximumNumberOfCellsPerMarkingSlice cells, unless that is 0.
+extern double incrementalMarkingPauseBudget;
+extern unsigned maximumNumberOfCellsPerMarkingSlice;
+
+// A compacting collection evacuates the blocks whose live cells fill less than
+// this fraction of them, as long as the rest of their size class has room.
+extern double compactionOccupancyThreshold;
+
+// Tiered compilation. Baseline code counts up from
+// executionCounterValueForOptimizeAfterWarmUp on loop back edges and returns;
+// when the counter reaches zero the DFG is tried, but only once the value
+// profiles are warm or the attempt has been put off maximumOptimizationDelay
+// times already.
+extern bool useDFGJIT;
+extern int executionCounterValueForOptimizeAfterWarmUp;
+extern int executionCounterValueForOptimizeSoon;
+extern unsigned maximumOptimizationDelay;
+
+// Where threads are available, the DFG compiles functions on a thread of its
+// own while their baseline code keeps running. Once
+// maximumCompilationQueueDepth functions are waiting for it, others put off
+// their tier-up until they warm up again.
+extern bool useConcurrentJIT;
+extern unsigned maximumCompilationQueueDepth;
+
+// The DFG inlines a call whose baseline call site has only seen one callee,
+// as long as that callee has at most maximumInliningInstructionCount
+// instructions and the call is no more than maximumInliningDepth calls deep.
+extern unsigned maximumInliningDepth;
+extern unsigned maximumInliningInstructionCount;
+
+// Optimized code that takes osrExitCountForReoptimization OSR exits is thrown
+// away and the function reoptimized later, twice as patiently each time. The
+// exits taken osrExitCountForFrequentExitSite times or more tell the next
+// compilation which speculations to avoid.
+extern unsigned osrExitCountForReoptimization;
+extern unsigned osrExitCountForFrequentExitSite;
+
+void initializeOptions();
+
+} } // namespace JSC::Options
+
+#endif // Options_h
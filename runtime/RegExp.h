@@ -47,6 +47,7 @@ namespace JSC {
         bool global() const { return m_flags & FlagGlobal; }
         bool ignoreCase() const { return m_flags & FlagIgnoreCase; }
         bool multiline() const { return m_flags & FlagMultiline; }
+        RegExpFlags flags() const { return m_flags; }
 
         const UString& pattern() const { return m_patternString; }
 
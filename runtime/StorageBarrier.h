@@ -49,8 +49,7 @@ public:
     
     void set(JSGlobalData& globalData, JSCell* owner, PropertyStorage newStorage)
     {
-        if (!globalData.heap.inPropertyStorageNursery(m_storage))
-            globalData.heap.writeBarrier(owner, JSValue());
+        globalData.heap.writeBarrier(owner, JSValue());
         m_storage = newStorage;
     }
     
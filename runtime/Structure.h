@@ -341,6 +341,13 @@ namespace JSC {
             m_values.append(cell);
     }
 
+    inline void MarkStack::appendRememberedCell(JSCell* cell)
+    {
+        ASSERT(Heap::isMarked(cell));
+        if (cell->structure() && cell->structure()->typeInfo().type() >= CompoundType)
+            m_values.append(cell);
+    }
+
     inline StructureTransitionTable::Hash::Key StructureTransitionTable::keyForWeakGCMapFinalizer(void*, Structure* structure)
     {
         // Newer versions of the STL have an std::make_pair function that takes rvalue references.
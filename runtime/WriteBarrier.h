@@ -218,12 +218,16 @@ template <typename U, typename V> inline bool operator==(const WriteBarrierBase<
 
 template<typename T> inline void MarkStack::append(WriteBarrierBase<T>* slot)
 {
+    if (UNLIKELY(m_slotObserver))
+        m_slotObserver->observeSlot(slot->slot());
     internalAppend(*slot->slot());
 }
 
 inline void MarkStack::appendValues(WriteBarrierBase<Unknown>* barriers, size_t count)
 {
     JSValue* values = barriers->slot();
+    if (UNLIKELY(m_slotObserver))
+        m_slotObserver->observeSlots(values, count);
 #if ENABLE(GC_VALIDATION)
     validateSet(values, count);
 #endif
@@ -156,6 +156,18 @@ inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_
 
 #endif
 
+#if ENABLE(COMPARE_AND_SWAP)
+// A weak compare-and-swap may fail spuriously; callers are expected to retry in a loop.
+inline bool weakCompareAndSwap(unsigned* location, unsigned expected, unsigned newValue)
+{
+#if COMPILER(MSVC)
+    return InterlockedCompareExchange(reinterpret_cast<long volatile*>(location), static_cast<long>(newValue), static_cast<long>(expected)) == static_cast<long>(expected);
+#else
+    return __sync_bool_compare_and_swap(location, expected, newValue);
+#endif
+}
+#endif // ENABLE(COMPARE_AND_SWAP)
+
 } // namespace WTF
 
 #if USE(LOCKFREE_THREADSAFEREFCOUNTED)
@@ -163,4 +175,8 @@ using WTF::atomicDecrement;
 using WTF::atomicIncrement;
 #endif
 
+#if ENABLE(COMPARE_AND_SWAP)
+using WTF::weakCompareAndSwap;
+#endif
+
 #endif // Atomics_h
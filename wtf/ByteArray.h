@@ -30,6 +30,7 @@
 #include <wtf/PassRefPtr.h>
 #include <wtf/Platform.h>
 #include <wtf/RefCounted.h>
+#include <wtf/StdLibExtras.h>
 
 namespace WTF {
     class ByteArray : public RefCountedBase {
@@ -70,6 +71,9 @@ namespace WTF {
 
         unsigned char* data() { return m_data; }
 
+        static size_t offsetOfSize() { return OBJECT_OFFSETOF(ByteArray, m_size); }
+        static size_t offsetOfData() { return OBJECT_OFFSETOF(ByteArray, m_data); }
+
         void deref()
         {
             if (derefBase()) {
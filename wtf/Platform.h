@@ -1041,15 +1041,25 @@
 #endif
 //-EAWebKitChange
 
-/* Currently only implemented for JSVALUE64, only tested on PLATFORM(MAC) */
-#if !defined(ENABLE_DFG_JIT) && ENABLE(JIT) && USE(JSVALUE64) && PLATFORM(MAC)
+/* Currently only implemented for JSVALUE64, only tested on PLATFORM(MAC) and on Linux x86-64 */
+#if !defined(ENABLE_DFG_JIT) && ENABLE(JIT) && USE(JSVALUE64) && (PLATFORM(MAC) || (OS(LINUX) && CPU(X86_64)))
 #define ENABLE_DFG_JIT 1
 #endif
 
+#if !defined(ENABLE_TIERED_COMPILATION) && ENABLE(DFG_JIT)
+#define ENABLE_TIERED_COMPILATION 1
+#endif
+
 #if !defined(ENABLE_TIERED_COMPILATION)
 #define ENABLE_TIERED_COMPILATION 0
 #endif
 
+/* Optimizing compilations of functions run on a thread of their own, while
+   the baseline code keeps running. */
+#if !defined(ENABLE_CONCURRENT_JIT) && ENABLE(DFG_JIT) && ENABLE(JSC_MULTIPLE_THREADS)
+#define ENABLE_CONCURRENT_JIT 1
+#endif
+
 /* Currently only implemented for JSVALUE64, only tested on PLATFORM(MAC) */
 #if !defined(ENABLE_VALUE_PROFILER)
 #define ENABLE_VALUE_PROFILER ENABLE_TIERED_COMPILATION
@@ -1148,12 +1158,45 @@
 #endif
 #endif
 
+/* Baseline JIT code calls its C++ stubs through small shared thunks that set up
+   the stub's argument frame, rather than inlining that setup at every call site.
+   The thunks are reached with near calls, so all JIT code must share one pool. */
+#if !defined(ENABLE_JIT_STUB_CALL_THUNKS) && ENABLE(JIT) && CPU(X86_64) && USE(JSVALUE64) && ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
+#define ENABLE_JIT_STUB_CALL_THUNKS 1
+#endif
+
 #if !defined(ENABLE_LAZY_BLOCK_FREEING)
 #if ENABLE(JSC_MULTIPLE_THREADS)
 #define ENABLE_LAZY_BLOCK_FREEING 1
 #endif
 #endif
 
+#if !defined(ENABLE_CONCURRENT_SWEEPING)
+#if ENABLE(JSC_MULTIPLE_THREADS)
+#define ENABLE_CONCURRENT_SWEEPING 1
+#endif
+#endif
+
+#if !defined(ENABLE_COMPARE_AND_SWAP) && (COMPILER(GCC) || (COMPILER(MSVC) && OS(WINDOWS))) && (CPU(X86) || CPU(X86_64) || CPU(ARM_THUMB2))
+#define ENABLE_COMPARE_AND_SWAP 1
+#endif
+
+#if !defined(ENABLE_PARALLEL_GC) && ENABLE(WTF_MULTIPLE_THREADS) && ENABLE(COMPARE_AND_SWAP)
+#define ENABLE_PARALLEL_GC 1
+#endif
+
+/* Generational collection relies on every store of a cell into the heap going
+   through a card-marking write barrier, which the JIT only emits on x86. */
+#if !defined(ENABLE_GGC) && (!ENABLE(JIT) || CPU(X86) || CPU(X86_64))
+#define ENABLE_GGC 1
+#endif
+
+/* Incremental marking finds the cells that JIT code stored into between
+   marking slices through the card table of the generational collector. */
+#if !defined(ENABLE_INCREMENTAL_MARKING) && ENABLE(GGC)
+#define ENABLE_INCREMENTAL_MARKING 1
+#endif
+
 #ifndef ENABLE_LARGE_HEAP
 #if CPU(X86) || CPU(X86_64)
 #define ENABLE_LARGE_HEAP 1